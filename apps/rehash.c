@@ -99,6 +99,7 @@ static const EVP_MD *evpmd;
 static int remove_links = 1;
 static int verbose = 0;
 static BUCKET *hash_table[257];
+static STACK_OF(X509) *index_certs = NULL;
 
 static const char *suffixes[] = { "", "r" };
 static const char *extensions[] = { "pem", "crt", "cer", "crl" };
@@ -265,6 +266,21 @@ static int do_file(const char *filename, const char *fullpath, enum Hash h)
     if (inf == NULL)
         goto end;
 
+    /* For an index file, collect all certificates, and ignore CRLs */
+    if (index_certs != NULL) {
+        for (i = 0; i < (size_t)sk_X509_INFO_num(inf); i++) {
+            x = sk_X509_INFO_value(inf, i);
+            if (x->x509 != NULL && !X509_add_cert(index_certs, x->x509,
+                                                  X509_ADD_FLAG_UP_REF
+                                                  | X509_ADD_FLAG_NO_DUP)) {
+                BIO_printf(bio_err, "out of memory\n");
+                ++errs;
+                break;
+            }
+        }
+        goto end;
+    }
+
     if (sk_X509_INFO_num(inf) != 1) {
         BIO_printf(bio_err,
                    "%s: warning: skipping %s, "
@@ -360,7 +376,7 @@ static int do_dir(const char *dirname, enum Hash h)
     char *buf = NULL, *copy = NULL;
     STACK_OF(OPENSSL_STRING) *files = NULL;
 
-    if (app_access(dirname, W_OK) < 0) {
+    if (index_certs == NULL && app_access(dirname, W_OK) < 0) {
         BIO_printf(bio_err, "Skipping %s, can't write\n", dirname);
         return 1;
     }
@@ -406,7 +422,8 @@ static int do_dir(const char *dirname, enum Hash h)
             continue;
         if (lstat(buf, &st) < 0)
             continue;
-        if (S_ISLNK(st.st_mode) && handle_symlink(filename, buf) == 0)
+        if (index_certs == NULL && S_ISLNK(st.st_mode)
+                && handle_symlink(filename, buf) == 0)
             continue;
         errs += do_file(filename, buf, h);
     }
@@ -483,9 +500,135 @@ static int do_dir(const char *dirname, enum Hash h)
     return errs;
 }
 
+/*
+ * An index file holds the DER-encoded certificates together with a hash
+ * table of their subject name hashes, see crypto/x509/by_index.c.
+ */
+typedef struct {
+    unsigned int hash;
+    X509 *x509;
+} INDEX_ENTRY;
+
+static unsigned int index_buckets;
+
+static int index_entry_cmp(const void *a, const void *b)
+{
+    const INDEX_ENTRY *ea = a, *eb = b;
+    unsigned int ba = ea->hash & (index_buckets - 1);
+    unsigned int bb = eb->hash & (index_buckets - 1);
+
+    if (ba != bb)
+        return ba < bb ? -1 : 1;
+    if (ea->hash != eb->hash)
+        return ea->hash < eb->hash ? -1 : 1;
+    return 0;
+}
+
+static int put_u32(BIO *out, unsigned int v)
+{
+    unsigned char b[4];
+
+    b[0] = (unsigned char)(v >> 24);
+    b[1] = (unsigned char)(v >> 16);
+    b[2] = (unsigned char)(v >> 8);
+    b[3] = (unsigned char)v;
+    return BIO_write(out, b, 4) == 4;
+}
+
+/*
+ * Write the collected certificates to |filename|; return number of errors.
+ * The file is replaced in one step, as it may be mapped by running programs.
+ */
+static int write_index(const char *filename)
+{
+    INDEX_ENTRY *entries = NULL;
+    BIO *out = NULL;
+    char *tmpname = NULL;
+    unsigned char *der = NULL;
+    unsigned int num = sk_X509_num(index_certs), i, b, off;
+    int len, ok, errs = 1;
+
+    entries = app_malloc(sizeof(*entries) * (num > 0 ? num : 1), "index");
+    for (i = 0; i < num; i++) {
+        entries[i].x509 = sk_X509_value(index_certs, i);
+        entries[i].hash =
+            (unsigned int)X509_NAME_hash_ex(X509_get_subject_name(entries[i].x509),
+                                            app_get0_libctx(), app_get0_propq(),
+                                            &ok);
+        if (!ok) {
+            BIO_printf(bio_err, "%s: error calculating SHA1 hash value\n",
+                       opt_getprog());
+            goto end;
+        }
+    }
+    for (index_buckets = 1; index_buckets < num; index_buckets <<= 1)
+        continue;
+    qsort(entries, num, sizeof(*entries), index_entry_cmp);
+
+    tmpname = app_malloc(strlen(filename) + 5, "filename buffer");
+    strcpy(tmpname, filename);
+    strcat(tmpname, ".tmp");
+    if ((out = bio_open_default(tmpname, 'w', FORMAT_BINARY)) == NULL)
+        goto end;
+
+    /* Header */
+    if (BIO_write(out, "OSSLCIDX", 8) != 8
+            || !put_u32(out, 1) || !put_u32(out, index_buckets)
+            || !put_u32(out, num) || !put_u32(out, 0))
+        goto end;
+    /* First entry of each bucket, and the end of the last one */
+    for (b = 0, i = 0; b <= index_buckets; b++) {
+        while (i < num && (entries[i].hash & (index_buckets - 1)) < b)
+            i++;
+        if (!put_u32(out, i))
+            goto end;
+    }
+    /* Entries, followed by the certificates they refer to */
+    off = 24 + 4 * (index_buckets + 1) + 12 * num;
+    for (i = 0; i < num; i++) {
+        if ((len = i2d_X509(entries[i].x509, NULL)) <= 0
+                || !put_u32(out, entries[i].hash) || !put_u32(out, off)
+                || !put_u32(out, (unsigned int)len))
+            goto end;
+        off += len;
+    }
+    for (i = 0; i < num; i++) {
+        if ((len = i2d_X509(entries[i].x509, &der)) <= 0
+                || BIO_write(out, der, len) != len)
+            goto end;
+        OPENSSL_free(der);
+        der = NULL;
+    }
+    if (BIO_flush(out) <= 0)
+        goto end;
+    BIO_free(out);
+    out = NULL;
+
+    if (rename(tmpname, filename) < 0) {
+        BIO_printf(bio_err, "%s: Can't rename %s to %s, %s\n",
+                   opt_getprog(), tmpname, filename, strerror(errno));
+        goto end;
+    }
+    if (verbose)
+        BIO_printf(bio_out, "index %s: %u certificates\n", filename, num);
+    errs = 0;
+
+ end:
+    if (errs != 0)
+        ERR_print_errors(bio_err);
+    OPENSSL_free(der);
+    if (out != NULL) {
+        BIO_free(out);
+        unlink(tmpname);
+    }
+    OPENSSL_free(tmpname);
+    OPENSSL_free(entries);
+    return errs;
+}
+
 typedef enum OPTION_choice {
     OPT_COMMON,
-    OPT_COMPAT, OPT_OLD, OPT_N, OPT_VERBOSE,
+    OPT_COMPAT, OPT_OLD, OPT_N, OPT_INDEX, OPT_VERBOSE,
     OPT_PROV_ENUM
 } OPTION_CHOICE;
 
@@ -498,6 +641,8 @@ const OPTIONS rehash_options[] = {
     {"compat", OPT_COMPAT, '-', "Create both new- and old-style hash links"},
     {"old", OPT_OLD, '-', "Use old-style hash to generate links"},
     {"n", OPT_N, '-', "Do not remove existing links"},
+    {"index", OPT_INDEX, '>',
+     "Write the certificates to an index file instead of creating links"},
 
     OPT_SECTION("Output"),
     {"v", OPT_VERBOSE, '-', "Verbose output"},
@@ -512,7 +657,7 @@ const OPTIONS rehash_options[] = {
 
 int rehash_main(int argc, char **argv)
 {
-    const char *env, *prog;
+    const char *env, *prog, *index_file = NULL;
     char *e, *m;
     int errs = 0;
     OPTION_CHOICE o;
@@ -537,6 +682,9 @@ int rehash_main(int argc, char **argv)
         case OPT_N:
             remove_links = 0;
             break;
+        case OPT_INDEX:
+            index_file = opt_arg();
+            break;
         case OPT_VERBOSE:
             verbose = 1;
             break;
@@ -557,6 +705,13 @@ int rehash_main(int argc, char **argv)
     if (evpmdsize <= 0 || evpmdsize > EVP_MAX_MD_SIZE)
         goto end;
 
+    if (index_file != NULL
+            && (index_certs = sk_X509_new_null()) == NULL) {
+        BIO_puts(bio_err, "out of memory\n");
+        errs = 1;
+        goto end;
+    }
+
     if (*argv != NULL) {
         while (*argv != NULL)
             errs += do_dir(*argv++, h);
@@ -575,7 +730,11 @@ int rehash_main(int argc, char **argv)
         errs += do_dir(X509_get_default_cert_dir(), h);
     }
 
+    if (index_file != NULL && errs == 0)
+        errs += write_index(index_file);
+
  end:
+    OSSL_STACK_OF_X509_free(index_certs);
     return errs;
 }
 
@@ -236,7 +236,7 @@ typedef enum OPTION_choice {
     OPT_ELAPSED, OPT_EVP, OPT_HMAC, OPT_DECRYPT, OPT_ENGINE, OPT_MULTI,
     OPT_MR, OPT_MB, OPT_MISALIGN, OPT_ASYNCJOBS, OPT_R_ENUM, OPT_PROV_ENUM,
     OPT_CONFIG, OPT_PRIMES, OPT_SECONDS, OPT_BYTES, OPT_AEAD, OPT_CMAC,
-    OPT_MLOCK, OPT_TESTMODE, OPT_KEM, OPT_SIG
+    OPT_MLOCK, OPT_TESTMODE, OPT_KEM, OPT_SIG, OPT_RAND_BUFFER
 } OPTION_CHOICE;
 
 const OPTIONS speed_options[] = {
@@ -288,6 +288,8 @@ const OPTIONS speed_options[] = {
      "Run [non-PKI] benchmarks on custom-sized buffer"},
     {"misalign", OPT_MISALIGN, 'p',
      "Use specified offset to mis-align buffers"},
+    {"rand_buffer", OPT_RAND_BUFFER, 'N',
+     "Per thread buffer size for small CSPRNG requests (0 to disable)"},
 
     OPT_R_OPTIONS,
     OPT_PROV_OPTIONS,
@@ -305,6 +307,7 @@ enum {
     D_CBC_128_AES, D_CBC_192_AES, D_CBC_256_AES,
     D_CBC_128_CML, D_CBC_192_CML, D_CBC_256_CML,
     D_EVP, D_GHASH, D_RAND, D_EVP_CMAC, D_KMAC128, D_KMAC256,
+    D_CTR_DRBG, D_HASH_DRBG, D_HMAC_DRBG, D_B64_ENCODE, D_B64_DECODE,
     ALGOR_NUM
 };
 /* name of algorithms to test. MUST BE KEEP IN SYNC with above enum ! */
@@ -315,7 +318,8 @@ static const char *names[ALGOR_NUM] = {
     "rc2-cbc", "rc5-cbc", "blowfish", "cast-cbc",
     "aes-128-cbc", "aes-192-cbc", "aes-256-cbc",
     "camellia-128-cbc", "camellia-192-cbc", "camellia-256-cbc",
-    "evp", "ghash", "rand", "cmac", "kmac128", "kmac256"
+    "evp", "ghash", "rand", "cmac", "kmac128", "kmac256",
+    "ctr-drbg", "hash-drbg", "hmac-drbg", "base64-encode", "base64-decode"
 };
 
 /* list of configured algorithm (remaining), with some few alias */
@@ -359,6 +363,11 @@ static const OPT_PAIR doit_choices[] = {
     {"rand", D_RAND},
     {"kmac128", D_KMAC128},
     {"kmac256", D_KMAC256},
+    {"ctr-drbg", D_CTR_DRBG},
+    {"hash-drbg", D_HASH_DRBG},
+    {"hmac-drbg", D_HMAC_DRBG},
+    {"base64-encode", D_B64_ENCODE},
+    {"base64-decode", D_B64_DECODE},
 };
 
 static double results[ALGOR_NUM][SIZE_NUM];
@@ -565,6 +574,10 @@ typedef struct loopargs_st {
 #endif
     EVP_CIPHER_CTX *ctx;
     EVP_MAC_CTX *mctx;
+    EVP_RAND_CTX *rctx;
+    EVP_ENCODE_CTX *ectx;
+    unsigned char *b64;
+    int b64_len;
     EVP_PKEY_CTX *kem_gen_ctx[MAX_KEM_NUM];
     EVP_PKEY_CTX *kem_encaps_ctx[MAX_KEM_NUM];
     EVP_PKEY_CTX *kem_decaps_ctx[MAX_KEM_NUM];
@@ -877,6 +890,161 @@ static int RAND_bytes_loop(void *args)
     return count;
 }
 
+/* DRBG implementations to test, indexed from D_CTR_DRBG */
+static const char *const drbg_names[] = {
+    "CTR-DRBG", "HASH-DRBG", "HMAC-DRBG"
+};
+
+static int drbg_setup(int alg, loopargs_t *loopargs,
+                      unsigned int loopargs_len)
+{
+    EVP_RAND *rand;
+    EVP_RAND_CTX *primary = RAND_get0_primary(app_get0_libctx());
+    OSSL_PARAM params[4], *p = params;
+    unsigned int reseed_requests = 1 << 16;
+    unsigned int i;
+    int ret = 1;
+
+    rand = EVP_RAND_fetch(app_get0_libctx(),
+                          drbg_names[alg - D_CTR_DRBG], app_get0_propq());
+    if (rand == NULL || primary == NULL) {
+        EVP_RAND_free(rand);
+        return 0;
+    }
+    if (alg == D_CTR_DRBG)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_CIPHER,
+                                                "AES-256-CTR", 0);
+    else
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_DIGEST,
+                                                "SHA256", 0);
+    if (alg == D_HMAC_DRBG)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_MAC,
+                                                "HMAC", 0);
+    /* Reseed as seldom as the public DRBG does */
+    *p++ = OSSL_PARAM_construct_uint(OSSL_DRBG_PARAM_RESEED_REQUESTS,
+                                     &reseed_requests);
+    *p = OSSL_PARAM_construct_end();
+
+    for (i = 0; i < loopargs_len; i++) {
+        loopargs[i].rctx = EVP_RAND_CTX_new(rand, primary);
+        if (loopargs[i].rctx == NULL
+            || !EVP_RAND_instantiate(loopargs[i].rctx, 0, 0, NULL, 0,
+                                     params)) {
+            ret = 0;
+            break;
+        }
+    }
+    EVP_RAND_free(rand);
+    return ret;
+}
+
+static void drbg_teardown(loopargs_t *loopargs, unsigned int loopargs_len)
+{
+    unsigned int i;
+
+    for (i = 0; i < loopargs_len; i++) {
+        EVP_RAND_CTX_free(loopargs[i].rctx);
+        loopargs[i].rctx = NULL;
+    }
+}
+
+static int DRBG_loop(int alg, void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    unsigned char *buf = tempargs->buf;
+    int count;
+
+    for (count = 0; COND(c[alg][testnum]); count++)
+        if (!EVP_RAND_generate(tempargs->rctx, buf, lengths[testnum],
+                               0, 0, NULL, 0))
+            return -1;
+    return count;
+}
+
+static int CTR_DRBG_loop(void *args)
+{
+    return DRBG_loop(D_CTR_DRBG, args);
+}
+
+static int HASH_DRBG_loop(void *args)
+{
+    return DRBG_loop(D_HASH_DRBG, args);
+}
+
+static int HMAC_DRBG_loop(void *args)
+{
+    return DRBG_loop(D_HMAC_DRBG, args);
+}
+
+static int b64_setup(int buflen, loopargs_t *loopargs,
+                     unsigned int loopargs_len)
+{
+    unsigned int i;
+
+    for (i = 0; i < loopargs_len; i++) {
+        loopargs[i].ectx = EVP_ENCODE_CTX_new();
+        if (loopargs[i].ectx == NULL)
+            return 0;
+        loopargs[i].b64 = app_malloc(EVP_ENCODE_LENGTH(buflen),
+                                     "base64 buffer");
+    }
+    return 1;
+}
+
+static void b64_teardown(loopargs_t *loopargs, unsigned int loopargs_len)
+{
+    unsigned int i;
+
+    for (i = 0; i < loopargs_len; i++) {
+        EVP_ENCODE_CTX_free(loopargs[i].ectx);
+        loopargs[i].ectx = NULL;
+        OPENSSL_free(loopargs[i].b64);
+        loopargs[i].b64 = NULL;
+    }
+}
+
+/* Encodes lengths[testnum] bytes of buf into b64, as PEM_write_bio() does */
+static int b64_encode(loopargs_t *tempargs)
+{
+    int len, tail;
+
+    EVP_EncodeInit(tempargs->ectx);
+    if (!EVP_EncodeUpdate(tempargs->ectx, tempargs->b64, &len,
+                          tempargs->buf, lengths[testnum]))
+        return 0;
+    EVP_EncodeFinal(tempargs->ectx, tempargs->b64 + len, &tail);
+    tempargs->b64_len = len + tail;
+    return 1;
+}
+
+static int B64_encode_loop(void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    int count;
+
+    for (count = 0; COND(c[D_B64_ENCODE][testnum]); count++)
+        if (!b64_encode(tempargs))
+            return -1;
+    return count;
+}
+
+/* The throughput is given in decoded bytes, like for encoding */
+static int B64_decode_loop(void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    unsigned char *buf2 = tempargs->buf2;
+    int count, len, tail;
+
+    for (count = 0; COND(c[D_B64_DECODE][testnum]); count++) {
+        EVP_DecodeInit(tempargs->ectx);
+        if (EVP_DecodeUpdate(tempargs->ectx, buf2, &len, tempargs->b64,
+                             tempargs->b64_len) < 0
+            || EVP_DecodeFinal(tempargs->ectx, buf2 + len, &tail) < 0)
+            return -1;
+    }
+    return count;
+}
+
 static int decrypt = 0;
 static int EVP_Update_loop(void *args)
 {
@@ -2177,6 +2345,13 @@ int speed_main(int argc, char **argv)
             lengths = &lengths_single;
             size_num = 1;
             break;
+        case OPT_RAND_BUFFER:
+            if (!RAND_set_public_buffer_size(app_get0_libctx(),
+                                             opt_int_arg())) {
+                BIO_printf(bio_err, "%s: invalid CSPRNG buffer size\n", prog);
+                goto end;
+            }
+            break;
         case OPT_AEAD:
             aead = 1;
             break;
@@ -2428,6 +2603,14 @@ int speed_main(int argc, char **argv)
             doit[D_EVP_CMAC] = 1;
             algo_found = 1;
         }
+        if (strcmp(algo, "drbg") == 0) {
+            doit[D_CTR_DRBG] = doit[D_HASH_DRBG] = doit[D_HMAC_DRBG] = 1;
+            algo_found = 1;
+        }
+        if (strcmp(algo, "base64") == 0) {
+            doit[D_B64_ENCODE] = doit[D_B64_DECODE] = 1;
+            algo_found = 1;
+        }
 
         if (!algo_found) {
             BIO_printf(bio_err, "%s: Unknown algorithm %s\n", prog, algo);
@@ -2582,6 +2765,15 @@ int speed_main(int argc, char **argv)
         } else {
             doit[D_HMAC] = 0;
         }
+        for (i = D_CTR_DRBG; i <= D_HMAC_DRBG; i++) {
+            EVP_RAND *rand = EVP_RAND_fetch(app_get0_libctx(),
+                                            drbg_names[i - D_CTR_DRBG],
+                                            app_get0_propq());
+
+            if (rand == NULL)
+                doit[i] = 0;
+            EVP_RAND_free(rand);
+        }
         ERR_pop_to_mark();
         memset(rsa_doit, 1, sizeof(rsa_doit));
 #ifndef OPENSSL_NO_DH
@@ -2924,6 +3116,64 @@ int speed_main(int argc, char **argv)
         }
     }
 
+    for (k = D_CTR_DRBG; k <= D_HMAC_DRBG; k++) {
+        static int (*const drbg_loops[])(void *) = {
+            CTR_DRBG_loop, HASH_DRBG_loop, HMAC_DRBG_loop
+        };
+
+        if (!doit[k])
+            continue;
+        if (!drbg_setup(k, loopargs, loopargs_len)) {
+            BIO_printf(bio_err, "\nFailed to set up %s\n",
+                       drbg_names[k - D_CTR_DRBG]);
+            dofail();
+            ERR_print_errors(bio_err);
+            drbg_teardown(loopargs, loopargs_len);
+            goto end;
+        }
+        for (testnum = 0; testnum < size_num; testnum++) {
+            print_message(names[k], lengths[testnum], seconds.sym);
+            Time_F(START);
+            count = run_benchmark(async_jobs, drbg_loops[k - D_CTR_DRBG],
+                                  loopargs);
+            d = Time_F(STOP);
+            print_result(k, testnum, count, d);
+            if (count < 0)
+                break;
+        }
+        drbg_teardown(loopargs, loopargs_len);
+    }
+
+    if (doit[D_B64_ENCODE] || doit[D_B64_DECODE]) {
+        if (!b64_setup(buflen, loopargs, loopargs_len)) {
+            BIO_printf(bio_err, "\nFailed to set up base64\n");
+            dofail();
+            ERR_print_errors(bio_err);
+            b64_teardown(loopargs, loopargs_len);
+            goto end;
+        }
+        for (k = D_B64_ENCODE; k <= D_B64_DECODE; k++) {
+            if (!doit[k])
+                continue;
+            for (testnum = 0; testnum < size_num; testnum++) {
+                if (k == D_B64_DECODE)
+                    for (i = 0; i < loopargs_len; i++)
+                        b64_encode(&loopargs[i]);
+                print_message(names[k], lengths[testnum], seconds.sym);
+                Time_F(START);
+                count = run_benchmark(async_jobs, k == D_B64_ENCODE
+                                                  ? B64_encode_loop
+                                                  : B64_decode_loop,
+                                      loopargs);
+                d = Time_F(STOP);
+                print_result(k, testnum, count, d);
+                if (count < 0)
+                    break;
+            }
+        }
+        b64_teardown(loopargs, loopargs_len);
+    }
+
     /*-
      * There are three scenarios for D_EVP:
      * 1- Using authenticated encryption (AE) e.g. CCM, GCM, OCB etc.
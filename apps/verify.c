@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2022 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -17,12 +17,17 @@
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
+#include <openssl/thread.h>
 
 static int cb(int ok, X509_STORE_CTX *ctx);
 static int check(X509_STORE *ctx, const char *file,
                  STACK_OF(X509) *uchain, STACK_OF(X509) *tchain,
                  STACK_OF(X509_CRL) *crls, int show_chain,
                  STACK_OF(OPENSSL_STRING) *opts);
+static int check_parallel(X509_STORE *ctx, char **files, int num,
+                          STACK_OF(X509) *uchain, STACK_OF(X509) *tchain,
+                          STACK_OF(X509_CRL) *crls, int show_chain,
+                          STACK_OF(OPENSSL_STRING) *opts, int threads);
 static int v_verbose = 0, vflags = 0;
 
 typedef enum OPTION_choice {
@@ -31,7 +36,7 @@ typedef enum OPTION_choice {
     OPT_NOCAPATH, OPT_NOCAFILE, OPT_NOCASTORE,
     OPT_UNTRUSTED, OPT_TRUSTED, OPT_CRLFILE, OPT_CRL_DOWNLOAD, OPT_SHOW_CHAIN,
     OPT_V_ENUM, OPT_NAMEOPT, OPT_VFYOPT,
-    OPT_VERBOSE,
+    OPT_VERBOSE, OPT_PARALLEL,
     OPT_PROV_ENUM
 } OPTION_CHOICE;
 
@@ -46,6 +51,10 @@ const OPTIONS verify_options[] = {
     {"verbose", OPT_VERBOSE, '-',
         "Print extra information about the operations being performed."},
     {"nameopt", OPT_NAMEOPT, 's', "Certificate subject/issuer name printing options"},
+#ifndef OPENSSL_NO_THREAD_POOL
+    {"parallel", OPT_PARALLEL, 'p',
+        "Verify the certificates using up to the given number of threads"},
+#endif
 
     OPT_SECTION("Certificate chain"),
     {"trusted", OPT_TRUSTED, '<', "A file of trusted certificates"},
@@ -87,6 +96,7 @@ int verify_main(int argc, char **argv)
     const char *prog, *CApath = NULL, *CAfile = NULL, *CAstore = NULL;
     int noCApath = 0, noCAfile = 0, noCAstore = 0;
     int vpmtouched = 0, crl_download = 0, show_chain = 0, i = 0, ret = 1;
+    int parallel = 0;
     OPTION_CHOICE o;
 
     if ((vpm = X509_VERIFY_PARAM_new()) == NULL)
@@ -187,6 +197,9 @@ int verify_main(int argc, char **argv)
         case OPT_VERBOSE:
             v_verbose = 1;
             break;
+        case OPT_PARALLEL:
+            parallel = atoi(opt_arg());
+            break;
         case OPT_PROV_CASES:
             if (!opt_provider(o))
                 goto end;
@@ -224,6 +237,13 @@ int verify_main(int argc, char **argv)
         if (check(store, NULL, untrusted, trusted, crls, show_chain,
                   vfyopts) != 1)
             ret = -1;
+    } else if (parallel > 1 && argc > 1) {
+        if (!OSSL_set_max_threads(NULL, parallel))
+            BIO_printf(bio_err, "%s: Warning: threads are not available\n",
+                       prog);
+        if (check_parallel(store, argv, argc, untrusted, trusted, crls,
+                           show_chain, vfyopts, parallel) != 1)
+            ret = -1;
     } else {
         for (i = 0; i < argc; i++)
             if (check(store, argv[i], untrusted, trusted, crls, show_chain,
@@ -242,16 +262,19 @@ int verify_main(int argc, char **argv)
     return (ret < 0 ? 2 : ret);
 }
 
-static int check(X509_STORE *ctx, const char *file,
-                 STACK_OF(X509) *uchain, STACK_OF(X509) *tchain,
-                 STACK_OF(X509_CRL) *crls, int show_chain,
-                 STACK_OF(OPENSSL_STRING) *opts)
+/*
+ * Loads the certificate in |file| and prepares its verification.  Output of
+ * the verify callback goes to |out| if it is not NULL.
+ */
+static X509_STORE_CTX *check_setup(X509_STORE *ctx, const char *file,
+                                   STACK_OF(X509) *uchain,
+                                   STACK_OF(X509) *tchain,
+                                   STACK_OF(X509_CRL) *crls,
+                                   STACK_OF(OPENSSL_STRING) *opts, BIO *out)
 {
     X509 *x = NULL;
-    int i = 0, ret = 0;
+    int i = 0;
     X509_STORE_CTX *csc;
-    STACK_OF(X509) *chain = NULL;
-    int num_untrusted;
 
     x = load_cert(file, FORMAT_UNDEF, "certificate file");
     if (x == NULL)
@@ -264,7 +287,7 @@ static int check(X509_STORE *ctx, const char *file,
                 BIO_printf(bio_err, "parameter error \"%s\"\n", opt);
                 ERR_print_errors(bio_err);
                 X509_free(x);
-                return 0;
+                return NULL;
             }
         }
     }
@@ -288,7 +311,24 @@ static int check(X509_STORE *ctx, const char *file,
         X509_STORE_CTX_set0_trusted_stack(csc, tchain);
     if (crls != NULL)
         X509_STORE_CTX_set0_crls(csc, crls);
-    i = X509_verify_cert(csc);
+    if (out != NULL)
+        X509_STORE_CTX_set_app_data(csc, out);
+    return csc;
+
+ end:
+    ERR_print_errors(bio_err);
+    X509_free(x);
+    return NULL;
+}
+
+/* Reports the result |i| of verifying |csc| and frees it */
+static int check_result(X509_STORE_CTX *csc, const char *file, int i,
+                        int show_chain)
+{
+    X509 *x = X509_STORE_CTX_get0_cert(csc);
+    STACK_OF(X509) *chain = NULL;
+    int num_untrusted, ret = 0;
+
     if (i > 0 && X509_STORE_CTX_get_error(csc) == X509_V_OK) {
         BIO_printf(bio_out, "%s: OK\n", (file == NULL) ? "stdin" : file);
         ret = 1;
@@ -317,7 +357,6 @@ static int check(X509_STORE *ctx, const char *file,
     }
     X509_STORE_CTX_free(csc);
 
- end:
     if (i <= 0)
         ERR_print_errors(bio_err);
     X509_free(x);
@@ -325,19 +364,95 @@ static int check(X509_STORE *ctx, const char *file,
     return ret;
 }
 
+static int check(X509_STORE *ctx, const char *file,
+                 STACK_OF(X509) *uchain, STACK_OF(X509) *tchain,
+                 STACK_OF(X509_CRL) *crls, int show_chain,
+                 STACK_OF(OPENSSL_STRING) *opts)
+{
+    X509_STORE_CTX *csc;
+
+    csc = check_setup(ctx, file, uchain, tchain, crls, opts, NULL);
+    if (csc == NULL)
+        return 0;
+    return check_result(csc, file, X509_verify_cert(csc), show_chain);
+}
+
+/*
+ * Verifies the certificates in |files| using up to |threads| threads.  The
+ * output of the verify callback is collected per certificate and printed
+ * along with its result, in the order of |files|.
+ */
+static int check_parallel(X509_STORE *ctx, char **files, int num,
+                          STACK_OF(X509) *uchain, STACK_OF(X509) *tchain,
+                          STACK_OF(X509_CRL) *crls, int show_chain,
+                          STACK_OF(OPENSSL_STRING) *opts, int threads)
+{
+    X509_STORE_CTX **cscs = NULL;
+    BIO **outs = NULL;
+    int *results = NULL, *jobs = NULL;
+    int i, n = 0, ret = 1;
+    char *data;
+    long len;
+
+    cscs = app_malloc(num * sizeof(*cscs), "verify contexts");
+    outs = app_malloc(num * sizeof(*outs), "verify outputs");
+    results = app_malloc(num * sizeof(*results), "verify results");
+    jobs = app_malloc(num * sizeof(*jobs), "verify jobs");
+
+    for (i = 0; i < num; i++) {
+        if ((outs[n] = BIO_new(BIO_s_mem())) == NULL) {
+            ret = 0;
+            continue;
+        }
+        cscs[n] = check_setup(ctx, files[i], uchain, tchain, crls, opts,
+                              outs[n]);
+        if (cscs[n] == NULL) {
+            BIO_free(outs[n]);
+            ret = 0;
+            continue;
+        }
+        jobs[n++] = i;
+    }
+
+    if (!X509_verify_cert_batch(cscs, n, results, threads)) {
+        ERR_print_errors(bio_err);
+        for (i = 0; i < n; i++)
+            results[i] = -1;
+    }
+    for (i = 0; i < n; i++) {
+        len = BIO_get_mem_data(outs[i], &data);
+        if (len > 0)
+            BIO_write(bio_err, data, (int)len);
+        BIO_free(outs[i]);
+        if (check_result(cscs[i], files[jobs[i]], results[i], show_chain) != 1)
+            ret = 0;
+    }
+
+    OPENSSL_free(cscs);
+    OPENSSL_free(outs);
+    OPENSSL_free(results);
+    OPENSSL_free(jobs);
+    return ret;
+}
+
 static int cb(int ok, X509_STORE_CTX *ctx)
 {
     int cert_error = X509_STORE_CTX_get_error(ctx);
     X509 *current_cert = X509_STORE_CTX_get_current_cert(ctx);
+    X509_STORE_CTX *top = X509_STORE_CTX_get0_parent_ctx(ctx);
+    BIO *out = X509_STORE_CTX_get_app_data(top != NULL ? top : ctx);
 
+    /* With -parallel the output is collected per certificate */
+    if (out == NULL)
+        out = bio_err;
     if (!ok) {
         if (current_cert != NULL) {
-            X509_NAME_print_ex(bio_err,
+            X509_NAME_print_ex(out,
                             X509_get_subject_name(current_cert),
                             0, get_nameopt());
-            BIO_printf(bio_err, "\n");
+            BIO_printf(out, "\n");
         }
-        BIO_printf(bio_err, "%serror %d at %d depth lookup: %s\n",
+        BIO_printf(out, "%serror %d at %d depth lookup: %s\n",
                X509_STORE_CTX_get0_parent_ctx(ctx) ? "[CRL path] " : "",
                cert_error,
                X509_STORE_CTX_get_error_depth(ctx),
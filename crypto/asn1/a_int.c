@@ -151,8 +151,8 @@ static size_t i2c_ibuf(const unsigned char *b, size_t blen, int neg,
  * NULL just return length.
  */
 
-static size_t c2i_ibuf(unsigned char *b, int *pneg,
-                       const unsigned char *p, size_t plen)
+size_t ossl_c2i_ibuf(unsigned char *b, int *pneg,
+                     const unsigned char *p, size_t plen)
 {
     int neg, pad;
     /* Zero content length is illegal */
@@ -290,7 +290,7 @@ ASN1_INTEGER *ossl_c2i_ASN1_INTEGER(ASN1_INTEGER **a, const unsigned char **pp,
     size_t r;
     int neg;
 
-    r = c2i_ibuf(NULL, NULL, *pp, len);
+    r = ossl_c2i_ibuf(NULL, NULL, *pp, len);
 
     if (r == 0)
         return NULL;
@@ -308,7 +308,7 @@ ASN1_INTEGER *ossl_c2i_ASN1_INTEGER(ASN1_INTEGER **a, const unsigned char **pp,
         goto err;
     }
 
-    c2i_ibuf(ret->data, &neg, *pp, len);
+    ossl_c2i_ibuf(ret->data, &neg, *pp, len);
 
     if (neg != 0)
         ret->type |= V_ASN1_NEG;
@@ -619,14 +619,14 @@ int ossl_c2i_uint64_int(uint64_t *ret, int *neg,
     unsigned char buf[sizeof(uint64_t)];
     size_t buflen;
 
-    buflen = c2i_ibuf(NULL, NULL, *pp, len);
+    buflen = ossl_c2i_ibuf(NULL, NULL, *pp, len);
     if (buflen == 0)
         return 0;
     if (buflen > sizeof(uint64_t)) {
         ERR_raise(ERR_LIB_ASN1, ASN1_R_TOO_LARGE);
         return 0;
     }
-    (void)c2i_ibuf(buf, neg, *pp, len);
+    (void)ossl_c2i_ibuf(buf, neg, *pp, len);
     return asn1_get_uint64(ret, buf, buflen);
 }
 
@@ -84,6 +84,8 @@ ASN1_BIT_STRING *ossl_c2i_ASN1_BIT_STRING(ASN1_BIT_STRING **a,
 int ossl_i2c_ASN1_INTEGER(ASN1_INTEGER *a, unsigned char **pp);
 ASN1_INTEGER *ossl_c2i_ASN1_INTEGER(ASN1_INTEGER **a, const unsigned char **pp,
                                     long length);
+size_t ossl_c2i_ibuf(unsigned char *b, int *pneg, const unsigned char *p,
+                     size_t plen);
 
 /* Internal functions used by x_int64.c */
 int ossl_c2i_uint64_int(uint64_t *ret, int *neg, const unsigned char **pp,
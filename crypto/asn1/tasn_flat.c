@@ -0,0 +1,1379 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <openssl/asn1.h>
+#include <openssl/asn1t.h>
+#include <openssl/objects.h>
+#include <openssl/err.h>
+#include "internal/refcount.h"
+#include "crypto/asn1.h"
+#include "crypto/x509.h"
+#include "asn1_local.h"
+
+/*
+ * An alternative to the template decoder in tasn_dec.c for applications that
+ * decode large numbers of short lived structures.
+ *
+ * The ASN1_ITEMs are compiled into flat tables of ops, one program per
+ * SEQUENCE and CHOICE item, the first time an arena decodes them. A program
+ * is then run by a loop that keeps an explicit stack of frames for the
+ * constructed types it is in rather than by recursing, and that parses every
+ * TLV header only once even when it has to be looked at to find out whether
+ * an OPTIONAL field or a CHOICE alternative is present.
+ *
+ * All structures and their contents are allocated from the chunks of the
+ * arena and are only freed, all at once, by ASN1_ARENA_reset() or
+ * ASN1_ARENA_free(). Items with callbacks or reference counts, such as X509
+ * and X509_CRL, are the exception: they are allocated and set up as
+ * ASN1_item_new() would, their D2I callbacks are run around the decoding of
+ * their fields, which still go to the arena, and their FREE callbacks are
+ * run when the arena is reset. Items that need more than the templates (ADB,
+ * extern and primitive functions) are decoded with the template decoder and
+ * freed when the arena is reset, as are the STACKs of SET OF and SEQUENCE OF
+ * fields. Encodings that are not DER in the sense that they use indefinite
+ * lengths or constructed strings make the whole structure be decoded by the
+ * template decoder.
+ */
+
+#define FLAT_CHUNK_SIZE     16384
+#define FLAT_ALIGN          16
+/* The same limit as ASN1_MAX_CONSTRUCTED_NEST of the template decoder */
+#define FLAT_MAX_DEPTH      30
+/* The root plus at most an EXPLICIT tag, a SET OF and the item per level */
+#define FLAT_MAX_FRAMES     (3 * (FLAT_MAX_DEPTH + 1) + 1)
+
+/* Return value of the decoder if the template decoder must be used */
+#define FLAT_FALLBACK       -2
+
+enum {
+    FLAT_OP_PRIM,           /* primitive type, MSTRING or ANY */
+    FLAT_OP_SEQ,            /* SEQUENCE, runs the program of the item */
+    FLAT_OP_CHOICE,         /* CHOICE, runs the matching branch */
+    FLAT_OP_EXTERN,         /* item decoded by the template decoder */
+    FLAT_OP_EXPLICIT,       /* EXPLICIT tag around the following field */
+    FLAT_OP_SETOF,          /* SET OF or SEQUENCE OF the following field */
+    FLAT_OP_SETOF_NEXT,     /* adds the element and loops */
+    FLAT_OP_END,            /* end of a SEQUENCE, CHOICE or EXPLICIT tag */
+    FLAT_OP_BRANCH,         /* entry of the branch table of a CHOICE */
+    FLAT_OP_HALT
+};
+
+/* How to tell whether a field is present */
+enum {
+    FLAT_MATCH_TAG,         /* |tag| and |aclass| */
+    FLAT_MATCH_MSTRING,     /* universal tag in |mask| */
+    FLAT_MATCH_CHOICE,      /* any of the branches of |prog| */
+    FLAT_MATCH_ANY,         /* anything */
+    FLAT_MATCH_DELEGATE     /* the template decoder knows */
+};
+
+enum {
+    FLAT_PROG_COMPILING,
+    FLAT_PROG_READY,
+    FLAT_PROG_DELEGATED
+};
+
+enum {
+    FLAT_CLEANUP_ITEM,      /* item decoded by the template decoder */
+    FLAT_CLEANUP_STACK,     /* STACK of a SET OF or SEQUENCE OF */
+    FLAT_CLEANUP_SHELL      /* item with callbacks, see flat_shell_new() */
+};
+
+enum {
+    FLAT_FRAME_ROOT,
+    FLAT_FRAME_SEQ,
+    FLAT_FRAME_CHOICE,
+    FLAT_FRAME_EXPLICIT,
+    FLAT_FRAME_SETOF
+};
+
+typedef struct flat_prog_st FLAT_PROG;
+
+typedef struct {
+    unsigned char op;
+    unsigned char match;
+    unsigned char opt;
+    unsigned char embed;
+    /* The item has callbacks or a reference count */
+    unsigned char shell;
+    int tag;
+    int aclass;
+    /* Universal type of FLAT_OP_PRIM, selector of FLAT_OP_BRANCH */
+    int utype;
+    unsigned long mask;
+    /* Offset of the field in the enclosing structure */
+    size_t offset;
+    /* Number of ops to skip if absent, index of the body for FLAT_OP_BRANCH */
+    size_t skip;
+    const ASN1_ITEM *it;
+    FLAT_PROG *prog;
+} FLAT_OP;
+
+struct flat_prog_st {
+    const ASN1_ITEM *it;
+    int root;
+    int state;
+    size_t nbranches;
+    FLAT_OP *ops;
+    size_t nops;
+    size_t aops;
+};
+
+typedef struct flat_chunk_st {
+    struct flat_chunk_st *next;
+    size_t size;
+    size_t used;
+} FLAT_CHUNK;
+
+#define FLAT_CHUNK_HDR \
+    ((sizeof(FLAT_CHUNK) + FLAT_ALIGN - 1) & ~(size_t)(FLAT_ALIGN - 1))
+
+typedef struct flat_cleanup_st {
+    struct flat_cleanup_st *next;
+    int type;
+    int embed;
+    /* Result of the FREE_PRE callback of a shell */
+    int freed;
+    void *val;
+    const ASN1_ITEM *it;
+} FLAT_CLEANUP;
+
+typedef struct {
+    int type;
+    const FLAT_OP *ret;
+    const unsigned char *start;
+    const unsigned char *end;
+    unsigned char *base;
+    const ASN1_ITEM *it;
+    OPENSSL_STACK *sk;
+    ASN1_VALUE *elem;
+} FLAT_FRAME;
+
+struct asn1_arena_st {
+    FLAT_CHUNK *chunks;
+    FLAT_CLEANUP *cleanup;
+    FLAT_PROG **progs;
+    size_t nprogs;
+    size_t aprogs;
+    FLAT_FRAME frames[FLAT_MAX_FRAMES];
+};
+
+typedef struct {
+    ASN1_ARENA *arena;
+    const unsigned char *p;
+    int nframes;
+    int depth;
+    /* The last TLV header that was parsed */
+    const unsigned char *hp;
+    const unsigned char *hend;
+    const unsigned char *hcont;
+    long hlen;
+    int htag;
+    int hclass;
+    int hcst;
+} FLAT_DEC;
+
+/*
+ * Arena memory
+ */
+
+static void *flat_alloc(ASN1_ARENA *arena, size_t len)
+{
+    FLAT_CHUNK *c = arena->chunks;
+    size_t size;
+    unsigned char *ret;
+
+    len = (len + FLAT_ALIGN - 1) & ~(size_t)(FLAT_ALIGN - 1);
+    if (c == NULL || c->size - c->used < len) {
+        size = len > FLAT_CHUNK_SIZE ? len : FLAT_CHUNK_SIZE;
+        if ((c = OPENSSL_malloc(FLAT_CHUNK_HDR + size)) == NULL)
+            return NULL;
+        c->size = size;
+        c->used = 0;
+        if (len > FLAT_CHUNK_SIZE / 2 && arena->chunks != NULL) {
+            /* Keep using the current chunk for the small allocations */
+            c->next = arena->chunks->next;
+            arena->chunks->next = c;
+        } else {
+            c->next = arena->chunks;
+            arena->chunks = c;
+        }
+    }
+    ret = (unsigned char *)c + FLAT_CHUNK_HDR + c->used;
+    c->used += len;
+    memset(ret, 0, len);
+    return ret;
+}
+
+static FLAT_CLEANUP *flat_add_cleanup(ASN1_ARENA *arena, int type, void *val,
+                                      const ASN1_ITEM *it)
+{
+    FLAT_CLEANUP *cl = flat_alloc(arena, sizeof(*cl));
+
+    if (cl == NULL)
+        return NULL;
+    cl->type = type;
+    cl->val = val;
+    cl->it = it;
+    cl->next = arena->cleanup;
+    arena->cleanup = cl;
+    return cl;
+}
+
+/* The FREE_PRE callback of a shell, while all of its fields still exist */
+static void flat_shell_free_pre(FLAT_CLEANUP *cl)
+{
+    const ASN1_AUX *aux = cl->it->funcs;
+    ASN1_VALUE *val = cl->val;
+
+    if (aux->asn1_cb != NULL
+        && aux->asn1_cb(ASN1_OP_FREE_PRE, &val, cl->it, NULL) == 2)
+        cl->freed = 1;
+}
+
+/*
+ * The rest of ossl_asn1_item_embed_free() for a shell, once its fields that
+ * are not in the arena are gone. The arena owns the item, so the reference
+ * count is freed whatever its value.
+ */
+static void flat_shell_free(FLAT_CLEANUP *cl)
+{
+    const ASN1_AUX *aux = cl->it->funcs;
+    ASN1_VALUE *val = cl->val;
+    unsigned char *base = cl->val;
+
+    if (cl->freed)
+        return;
+    if (aux->asn1_cb != NULL)
+        aux->asn1_cb(ASN1_OP_FREE_POST, &val, cl->it, NULL);
+    if ((aux->flags & ASN1_AFLG_REFCOUNT) != 0) {
+        CRYPTO_THREAD_lock_free(*(CRYPTO_RWLOCK **)(base + aux->ref_lock));
+        CRYPTO_FREE_REF((CRYPTO_REF_COUNT *)(base + aux->ref_offset));
+    }
+    if (!cl->embed)
+        OPENSSL_free(cl->val);
+}
+
+ASN1_ARENA *ASN1_ARENA_new(void)
+{
+    return OPENSSL_zalloc(sizeof(ASN1_ARENA));
+}
+
+void ASN1_ARENA_reset(ASN1_ARENA *arena)
+{
+    FLAT_CLEANUP *cl;
+    FLAT_CHUNK *c, *next;
+
+    if (arena == NULL)
+        return;
+
+    for (cl = arena->cleanup; cl != NULL; cl = cl->next)
+        if (cl->type == FLAT_CLEANUP_SHELL)
+            flat_shell_free_pre(cl);
+    /* Newest first, so that the fields go before the items they are in */
+    for (cl = arena->cleanup; cl != NULL; cl = cl->next) {
+        switch (cl->type) {
+        case FLAT_CLEANUP_ITEM:
+            ASN1_item_free(cl->val, cl->it);
+            break;
+        case FLAT_CLEANUP_STACK:
+            OPENSSL_sk_free(cl->val);
+            break;
+        case FLAT_CLEANUP_SHELL:
+            flat_shell_free(cl);
+            break;
+        }
+    }
+    arena->cleanup = NULL;
+
+    /* Keep one chunk of the default size around for the next structure */
+    c = arena->chunks;
+    arena->chunks = NULL;
+    for (; c != NULL; c = next) {
+        next = c->next;
+        if (arena->chunks == NULL && c->size == FLAT_CHUNK_SIZE) {
+            c->used = 0;
+            c->next = NULL;
+            arena->chunks = c;
+        } else {
+            OPENSSL_free(c);
+        }
+    }
+}
+
+void ASN1_ARENA_free(ASN1_ARENA *arena)
+{
+    size_t i;
+
+    if (arena == NULL)
+        return;
+
+    ASN1_ARENA_reset(arena);
+    OPENSSL_free(arena->chunks);
+    for (i = 0; i < arena->nprogs; i++) {
+        OPENSSL_free(arena->progs[i]->ops);
+        OPENSSL_free(arena->progs[i]);
+    }
+    OPENSSL_free(arena->progs);
+    OPENSSL_free(arena);
+}
+
+/*
+ * Compiler
+ *
+ * The emit functions return 1 on success, 0 if the item cannot be compiled
+ * and must be decoded with the template decoder, and -1 on fatal errors.
+ */
+
+static FLAT_PROG *flat_program(ASN1_ARENA *arena, const ASN1_ITEM *it,
+                               int root);
+static int flat_emit_template(ASN1_ARENA *arena, FLAT_PROG *prog,
+                              const ASN1_TEMPLATE *tt, int opt, size_t offset);
+
+static int flat_needs_template_decoder(const ASN1_ITEM *it)
+{
+    const ASN1_AUX *aux;
+
+    switch (it->itype) {
+    case ASN1_ITYPE_PRIMITIVE:
+        return it->funcs != NULL;
+    case ASN1_ITYPE_MSTRING:
+        return 0;
+    case ASN1_ITYPE_SEQUENCE:
+    case ASN1_ITYPE_NDEF_SEQUENCE:
+    case ASN1_ITYPE_CHOICE:
+        aux = it->funcs;
+        return aux != NULL && (aux->flags & ASN1_AFLG_BROKEN) != 0;
+    default:
+        return 1;
+    }
+}
+
+/* Types that are represented by an ASN1_STRING */
+static int flat_is_string(int utype)
+{
+    return utype != V_ASN1_OBJECT && utype != V_ASN1_NULL
+        && utype != V_ASN1_BOOLEAN && utype != V_ASN1_ANY;
+}
+
+/* Returns the index of the new op or -1 */
+static ossl_ssize_t flat_emit(FLAT_PROG *prog, int op)
+{
+    FLAT_OP *ops;
+    size_t n;
+
+    if (prog->nops == prog->aops) {
+        n = prog->aops == 0 ? 8 : prog->aops * 2;
+        if ((ops = OPENSSL_realloc(prog->ops, n * sizeof(*ops))) == NULL)
+            return -1;
+        prog->ops = ops;
+        prog->aops = n;
+    }
+    memset(&prog->ops[prog->nops], 0, sizeof(*prog->ops));
+    prog->ops[prog->nops].op = (unsigned char)op;
+    prog->ops[prog->nops].skip = 1;
+    return (ossl_ssize_t)prog->nops++;
+}
+
+static int flat_emit_item(ASN1_ARENA *arena, FLAT_PROG *prog,
+                          const ASN1_ITEM *it, int tag, int aclass, int opt,
+                          int embed, size_t offset)
+{
+    FLAT_PROG *sub = NULL;
+    const ASN1_AUX *aux;
+    FLAT_OP *op;
+    ossl_ssize_t i;
+
+    if (flat_needs_template_decoder(it))
+        goto delegate;
+
+    switch (it->itype) {
+    case ASN1_ITYPE_PRIMITIVE:
+        if (it->templates != NULL) {
+            /* Tagging an item template is illegal, let the decoder say so */
+            if (tag != -1 || opt)
+                return 0;
+            return flat_emit_template(arena, prog, it->templates, 0, offset);
+        }
+        if (it->utype == V_ASN1_OTHER
+            || (it->utype == V_ASN1_ANY && tag != -1)
+            || (embed && !flat_is_string(it->utype)))
+            return 0;
+        if ((i = flat_emit(prog, FLAT_OP_PRIM)) < 0)
+            return -1;
+        op = &prog->ops[i];
+        op->utype = it->utype;
+        if (it->utype == V_ASN1_ANY) {
+            op->match = FLAT_MATCH_ANY;
+        } else if (tag == -1) {
+            op->tag = it->utype;
+            op->aclass = V_ASN1_UNIVERSAL;
+        } else {
+            op->tag = tag;
+            op->aclass = aclass;
+        }
+        break;
+
+    case ASN1_ITYPE_MSTRING:
+        if (tag != -1)
+            return 0;
+        if ((i = flat_emit(prog, FLAT_OP_PRIM)) < 0)
+            return -1;
+        op = &prog->ops[i];
+        op->match = FLAT_MATCH_MSTRING;
+        op->mask = it->utype;
+        op->utype = -1;
+        break;
+
+    case ASN1_ITYPE_SEQUENCE:
+    case ASN1_ITYPE_NDEF_SEQUENCE:
+    case ASN1_ITYPE_CHOICE:
+        if (it->itype == ASN1_ITYPE_CHOICE && tag != -1)
+            return 0;
+        if ((sub = flat_program(arena, it, 0)) == NULL)
+            return -1;
+        if (sub->state == FLAT_PROG_DELEGATED)
+            goto delegate;
+        if (it->itype == ASN1_ITYPE_CHOICE) {
+            if ((i = flat_emit(prog, FLAT_OP_CHOICE)) < 0)
+                return -1;
+            op = &prog->ops[i];
+            op->match = FLAT_MATCH_CHOICE;
+            /* Untagged, as flat_extern() must pass it if it delegates */
+            op->tag = -1;
+            op->aclass = 0;
+        } else {
+            if ((i = flat_emit(prog, FLAT_OP_SEQ)) < 0)
+                return -1;
+            op = &prog->ops[i];
+            op->tag = tag == -1 ? V_ASN1_SEQUENCE : tag;
+            op->aclass = tag == -1 ? V_ASN1_UNIVERSAL : aclass;
+        }
+        op->prog = sub;
+        aux = it->funcs;
+        op->shell = aux != NULL
+            && (aux->asn1_cb != NULL || (aux->flags & ASN1_AFLG_REFCOUNT) != 0);
+        break;
+
+    default:
+        goto delegate;
+    }
+    op->opt = (unsigned char)(opt != 0);
+    op->embed = (unsigned char)(embed != 0);
+    op->offset = offset;
+    op->it = it;
+    return 1;
+
+ delegate:
+    if (embed)
+        return 0;
+    if ((i = flat_emit(prog, FLAT_OP_EXTERN)) < 0)
+        return -1;
+    op = &prog->ops[i];
+    op->match = FLAT_MATCH_DELEGATE;
+    op->opt = (unsigned char)(opt != 0);
+    op->tag = tag;
+    op->aclass = tag == -1 ? 0 : aclass;
+    op->offset = offset;
+    op->it = it;
+    return 1;
+}
+
+/* A template without its EXPLICIT tag */
+static int flat_emit_field(ASN1_ARENA *arena, FLAT_PROG *prog,
+                           const ASN1_TEMPLATE *tt, int opt, size_t offset)
+{
+    unsigned long flags = tt->flags;
+    int aclass = (int)(flags & ASN1_TFLG_TAG_CLASS);
+    int embed = (flags & ASN1_TFLG_EMBED) != 0;
+    ossl_ssize_t i;
+    int ret;
+
+    if ((flags & ASN1_TFLG_SK_MASK) != 0) {
+        if (embed)
+            return 0;
+        if ((i = flat_emit(prog, FLAT_OP_SETOF)) < 0)
+            return -1;
+        if ((flags & ASN1_TFLG_IMPTAG) != 0) {
+            prog->ops[i].tag = (int)tt->tag;
+            prog->ops[i].aclass = aclass;
+        } else {
+            prog->ops[i].tag = (flags & ASN1_TFLG_SET_OF) != 0 ? V_ASN1_SET
+                                                               : V_ASN1_SEQUENCE;
+            prog->ops[i].aclass = V_ASN1_UNIVERSAL;
+        }
+        prog->ops[i].opt = (unsigned char)(opt != 0);
+        prog->ops[i].offset = offset;
+        if ((ret = flat_emit_item(arena, prog, ASN1_ITEM_ptr(tt->item),
+                                  -1, 0, 0, 0, 0)) <= 0)
+            return ret;
+        if (flat_emit(prog, FLAT_OP_SETOF_NEXT) < 0)
+            return -1;
+        prog->ops[i].skip = prog->nops - (size_t)i;
+        return 1;
+    }
+    if ((flags & ASN1_TFLG_IMPTAG) != 0)
+        return flat_emit_item(arena, prog, ASN1_ITEM_ptr(tt->item),
+                              (int)tt->tag, aclass, opt, embed, offset);
+    return flat_emit_item(arena, prog, ASN1_ITEM_ptr(tt->item), -1, 0, opt,
+                          embed, offset);
+}
+
+static int flat_emit_template(ASN1_ARENA *arena, FLAT_PROG *prog,
+                              const ASN1_TEMPLATE *tt, int opt, size_t offset)
+{
+    ossl_ssize_t i;
+    int ret;
+
+    if ((tt->flags & ASN1_TFLG_ADB_MASK) != 0)
+        return 0;
+    offset += tt->offset;
+    if ((tt->flags & ASN1_TFLG_EXPTAG) == 0)
+        return flat_emit_field(arena, prog, tt, opt, offset);
+
+    if ((i = flat_emit(prog, FLAT_OP_EXPLICIT)) < 0)
+        return -1;
+    prog->ops[i].tag = (int)tt->tag;
+    prog->ops[i].aclass = (int)(tt->flags & ASN1_TFLG_TAG_CLASS);
+    prog->ops[i].opt = (unsigned char)(opt != 0);
+    if ((ret = flat_emit_field(arena, prog, tt, 0, offset)) <= 0)
+        return ret;
+    if (flat_emit(prog, FLAT_OP_END) < 0)
+        return -1;
+    prog->ops[i].skip = prog->nops - (size_t)i;
+    return 1;
+}
+
+/* Works out how to recognise a CHOICE alternative, returns 0 if unknown */
+static int flat_branch_match(const ASN1_TEMPLATE *tt, FLAT_OP *op)
+{
+    const ASN1_ITEM *it;
+
+    if ((tt->flags & (ASN1_TFLG_EXPTAG | ASN1_TFLG_IMPTAG)) != 0) {
+        op->tag = (int)tt->tag;
+        op->aclass = (int)(tt->flags & ASN1_TFLG_TAG_CLASS);
+        return 1;
+    }
+    if ((tt->flags & ASN1_TFLG_SK_MASK) != 0) {
+        op->tag = (tt->flags & ASN1_TFLG_SET_OF) != 0 ? V_ASN1_SET
+                                                      : V_ASN1_SEQUENCE;
+        op->aclass = V_ASN1_UNIVERSAL;
+        return 1;
+    }
+
+    it = ASN1_ITEM_ptr(tt->item);
+    switch (it->itype) {
+    case ASN1_ITYPE_PRIMITIVE:
+        if (it->templates != NULL)
+            return flat_branch_match(it->templates, op);
+        if (it->funcs != NULL || it->utype == V_ASN1_ANY)
+            return 0;
+        op->tag = it->utype;
+        op->aclass = V_ASN1_UNIVERSAL;
+        return 1;
+    case ASN1_ITYPE_MSTRING:
+        op->match = FLAT_MATCH_MSTRING;
+        op->mask = it->utype;
+        return 1;
+    case ASN1_ITYPE_SEQUENCE:
+    case ASN1_ITYPE_NDEF_SEQUENCE:
+        op->tag = V_ASN1_SEQUENCE;
+        op->aclass = V_ASN1_UNIVERSAL;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int flat_compile(ASN1_ARENA *arena, FLAT_PROG *prog)
+{
+    const ASN1_ITEM *it = prog->it;
+    const ASN1_TEMPLATE *tt;
+    long i;
+    int ret;
+
+    if (prog->root) {
+        if ((ret = flat_emit_item(arena, prog, it, -1, 0, 0, 0, 0)) <= 0)
+            return ret;
+        return flat_emit(prog, FLAT_OP_HALT) < 0 ? -1 : 1;
+    }
+
+    if (it->itype == ASN1_ITYPE_CHOICE) {
+        /* The branch table comes first, followed by the branch bodies */
+        for (i = 0, tt = it->templates; i < it->tcount; i++, tt++) {
+            if (flat_emit(prog, FLAT_OP_BRANCH) < 0)
+                return -1;
+            prog->ops[i].utype = (int)i;
+            if ((tt->flags & ASN1_TFLG_ADB_MASK) != 0
+                || !flat_branch_match(tt, &prog->ops[i]))
+                return 0;
+        }
+        prog->nbranches = (size_t)it->tcount;
+        for (i = 0, tt = it->templates; i < it->tcount; i++, tt++) {
+            prog->ops[i].skip = prog->nops;
+            if ((ret = flat_emit_template(arena, prog, tt, 0, 0)) <= 0)
+                return ret;
+            if (flat_emit(prog, FLAT_OP_END) < 0)
+                return -1;
+        }
+        return 1;
+    }
+
+    for (i = 0, tt = it->templates; i < it->tcount; i++, tt++)
+        if ((ret = flat_emit_template(arena, prog, tt,
+                                      (tt->flags & ASN1_TFLG_OPTIONAL) != 0,
+                                      0)) <= 0)
+            return ret;
+    return flat_emit(prog, FLAT_OP_END) < 0 ? -1 : 1;
+}
+
+/*
+ * Returns the program of |it|, compiling it first if needed. The program may
+ * still be being compiled if |it| contains itself.
+ */
+static FLAT_PROG *flat_program(ASN1_ARENA *arena, const ASN1_ITEM *it,
+                               int root)
+{
+    FLAT_PROG *prog, **progs;
+    size_t i, n;
+    int ret;
+
+    for (i = 0; i < arena->nprogs; i++)
+        if (arena->progs[i]->it == it && arena->progs[i]->root == root)
+            return arena->progs[i];
+
+    if (arena->nprogs == arena->aprogs) {
+        n = arena->aprogs == 0 ? 16 : arena->aprogs * 2;
+        if ((progs = OPENSSL_realloc(arena->progs, n * sizeof(*progs))) == NULL)
+            return NULL;
+        arena->progs = progs;
+        arena->aprogs = n;
+    }
+    if ((prog = OPENSSL_zalloc(sizeof(*prog))) == NULL)
+        return NULL;
+    prog->it = it;
+    prog->root = root;
+    prog->state = FLAT_PROG_COMPILING;
+    arena->progs[arena->nprogs++] = prog;
+
+    /*
+     * Other programs may already refer to this one, so it is kept even if
+     * compiling it failed
+     */
+    if ((ret = flat_compile(arena, prog)) <= 0) {
+        OPENSSL_free(prog->ops);
+        prog->ops = NULL;
+        prog->nops = prog->aops = 0;
+        prog->state = FLAT_PROG_DELEGATED;
+        return ret < 0 ? NULL : prog;
+    }
+    prog->state = FLAT_PROG_READY;
+    return prog;
+}
+
+/*
+ * Decoder
+ */
+
+/*
+ * Parses the TLV header at the current position unless that has already
+ * been done. Returns 1 on success, 0 on error or FLAT_FALLBACK for an
+ * indefinite length.
+ */
+static int flat_header(FLAT_DEC *d, const unsigned char *end)
+{
+    const unsigned char *q = d->p;
+    long len;
+    int tag, aclass, ret;
+
+    if (d->hp == d->p && d->hend == end)
+        return 1;
+
+    ret = ASN1_get_object(&q, &len, &tag, &aclass, (long)(end - d->p));
+    if ((ret & 0x80) != 0) {
+        ERR_raise(ERR_LIB_ASN1, ERR_R_NESTED_ASN1_ERROR);
+        return 0;
+    }
+    if ((ret & 1) != 0)
+        return FLAT_FALLBACK;
+
+    d->hp = d->p;
+    d->hend = end;
+    d->hcont = q;
+    d->hlen = len;
+    d->htag = tag;
+    d->hclass = aclass;
+    d->hcst = (ret & V_ASN1_CONSTRUCTED) != 0;
+    return 1;
+}
+
+static const FLAT_OP *flat_find_branch(const FLAT_DEC *d, const FLAT_PROG *prog)
+{
+    const FLAT_OP *op;
+    size_t i;
+
+    for (i = 0, op = prog->ops; i < prog->nbranches; i++, op++) {
+        if (op->match == FLAT_MATCH_MSTRING) {
+            if (d->hclass == V_ASN1_UNIVERSAL
+                && (ASN1_tag2bit(d->htag) & op->mask) != 0)
+                return op;
+        } else if (d->htag == op->tag && d->hclass == op->aclass) {
+            return op;
+        }
+    }
+    return NULL;
+}
+
+/* Returns 1 if the field of |op| is next, 0 if not or < 0 on error */
+static int flat_match(FLAT_DEC *d, const FLAT_OP *op, const unsigned char *end)
+{
+    int ret;
+
+    if (op->match == FLAT_MATCH_ANY || op->match == FLAT_MATCH_DELEGATE)
+        return 1;
+    if ((ret = flat_header(d, end)) <= 0)
+        return ret == 0 ? -1 : ret;
+
+    switch (op->match) {
+    case FLAT_MATCH_MSTRING:
+        return d->hclass == V_ASN1_UNIVERSAL
+            && (ASN1_tag2bit(d->htag) & op->mask) != 0;
+    case FLAT_MATCH_CHOICE:
+        return flat_find_branch(d, op->prog) != NULL;
+    default:
+        return d->htag == op->tag && d->hclass == op->aclass;
+    }
+}
+
+static int flat_c2i_object(ASN1_ARENA *arena, ASN1_VALUE **pval,
+                           const unsigned char *cont, long len)
+{
+    ASN1_OBJECT tobj, *obj;
+    unsigned char *data;
+    long i;
+    int nid;
+
+    /* The same checks as ossl_c2i_ASN1_OBJECT() */
+    if (len <= 0 || len > INT_MAX || (cont[len - 1] & 0x80) != 0) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_INVALID_OBJECT_ENCODING);
+        return 0;
+    }
+    tobj.nid = NID_undef;
+    tobj.data = cont;
+    tobj.length = (int)len;
+    tobj.flags = 0;
+    if ((nid = OBJ_obj2nid(&tobj)) != NID_undef) {
+        *pval = (ASN1_VALUE *)OBJ_nid2obj(nid);
+        return 1;
+    }
+    for (i = 0; i < len; i++) {
+        if (cont[i] == 0x80 && (i == 0 || (cont[i - 1] & 0x80) == 0)) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_INVALID_OBJECT_ENCODING);
+            return 0;
+        }
+    }
+    if ((obj = flat_alloc(arena, sizeof(*obj))) == NULL
+        || (data = flat_alloc(arena, len)) == NULL)
+        return 0;
+    memcpy(data, cont, len);
+    obj->data = data;
+    obj->length = (int)len;
+    *pval = (ASN1_VALUE *)obj;
+    return 1;
+}
+
+/* Content octets to structure, see asn1_ex_c2i() */
+static int flat_c2i(ASN1_ARENA *arena, ASN1_VALUE **pval,
+                    const unsigned char *cont, long len, int utype, int embed)
+{
+    ASN1_STRING *str;
+    unsigned char *data = NULL;
+    int neg = 0, bits;
+    size_t ilen;
+
+    switch (utype) {
+    case V_ASN1_OBJECT:
+        return flat_c2i_object(arena, pval, cont, len);
+
+    case V_ASN1_NULL:
+        if (len != 0) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_NULL_IS_WRONG_LENGTH);
+            return 0;
+        }
+        *pval = (ASN1_VALUE *)1;
+        return 1;
+
+    case V_ASN1_BOOLEAN:
+        if (len != 1) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_BOOLEAN_IS_WRONG_LENGTH);
+            return 0;
+        }
+        *(ASN1_BOOLEAN *)pval = *cont;
+        return 1;
+    }
+
+    if (len > INT_MAX - 1) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_STRING_TOO_LONG);
+        return 0;
+    }
+    if (utype == V_ASN1_BMPSTRING && (len & 1) != 0) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_BMPSTRING_IS_WRONG_LENGTH);
+        return 0;
+    }
+    if (utype == V_ASN1_UNIVERSALSTRING && (len & 3) != 0) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_UNIVERSALSTRING_IS_WRONG_LENGTH);
+        return 0;
+    }
+    if (utype == V_ASN1_GENERALIZEDTIME && len < 15) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_GENERALIZEDTIME_IS_TOO_SHORT);
+        return 0;
+    }
+    if (utype == V_ASN1_UTCTIME && len < 13) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_UTCTIME_IS_TOO_SHORT);
+        return 0;
+    }
+
+    if (embed)
+        str = (ASN1_STRING *)pval;
+    else if ((str = flat_alloc(arena, sizeof(*str))) == NULL)
+        return 0;
+    str->type = utype;
+
+    switch (utype) {
+    case V_ASN1_BIT_STRING:
+        if (len < 1) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_STRING_TOO_SHORT);
+            return 0;
+        }
+        if ((bits = *cont++) > 7) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_INVALID_BIT_STRING_BITS_LEFT);
+            return 0;
+        }
+        ossl_asn1_string_set_bits_left(str, bits);
+        if (--len > 0) {
+            if ((data = flat_alloc(arena, len)) == NULL)
+                return 0;
+            memcpy(data, cont, len);
+            data[len - 1] &= 0xff << bits;
+        }
+        break;
+
+    case V_ASN1_INTEGER:
+    case V_ASN1_ENUMERATED:
+        if ((ilen = ossl_c2i_ibuf(NULL, NULL, cont, len)) == 0
+            || (data = flat_alloc(arena, ilen + 1)) == NULL)
+            return 0;
+        ossl_c2i_ibuf(data, &neg, cont, len);
+        if (neg != 0)
+            str->type |= V_ASN1_NEG;
+        len = (long)ilen;
+        break;
+
+    default:
+        if ((data = flat_alloc(arena, len + 1)) == NULL)
+            return 0;
+        memcpy(data, cont, len);
+        break;
+    }
+    str->data = data;
+    str->length = (int)len;
+    if (!embed)
+        *pval = (ASN1_VALUE *)str;
+    return 1;
+}
+
+/* Primitive types, MSTRINGs and ANY, see asn1_d2i_ex_primitive() */
+static int flat_prim(FLAT_DEC *d, const FLAT_OP *op, ASN1_VALUE **pval,
+                     const unsigned char *end)
+{
+    ASN1_TYPE *typ = NULL;
+    const unsigned char *cont, *next;
+    long len;
+    int utype = op->utype, ret;
+
+    if ((ret = flat_header(d, end)) <= 0)
+        return ret;
+
+    if (op->match == FLAT_MATCH_MSTRING)
+        utype = d->htag;
+    else if (utype == V_ASN1_ANY)
+        utype = d->hclass == V_ASN1_UNIVERSAL ? d->htag : V_ASN1_OTHER;
+
+    next = d->hcont + d->hlen;
+    cont = d->hcont;
+    len = d->hlen;
+    if (utype == V_ASN1_SEQUENCE || utype == V_ASN1_SET
+        || utype == V_ASN1_OTHER) {
+        /* These are kept in encoded form */
+        if (utype != V_ASN1_OTHER && !d->hcst) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_TYPE_NOT_CONSTRUCTED);
+            return 0;
+        }
+        cont = d->p;
+        len = (long)(next - d->p);
+    } else if (d->hcst) {
+        if (utype == V_ASN1_NULL || utype == V_ASN1_BOOLEAN
+            || utype == V_ASN1_OBJECT || utype == V_ASN1_INTEGER
+            || utype == V_ASN1_ENUMERATED) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_TYPE_NOT_PRIMITIVE);
+            return 0;
+        }
+        /* A constructed string, which is not DER */
+        return FLAT_FALLBACK;
+    }
+
+    if (op->utype == V_ASN1_ANY) {
+        if ((typ = flat_alloc(d->arena, sizeof(*typ))) == NULL)
+            return 0;
+        typ->type = utype;
+        *pval = (ASN1_VALUE *)typ;
+        pval = &typ->value.asn1_value;
+    }
+    if (!flat_c2i(d->arena, pval, cont, len, utype, op->embed))
+        return 0;
+    if (typ != NULL && utype == V_ASN1_NULL)
+        typ->value.ptr = NULL;
+
+    d->p = next;
+    return 1;
+}
+
+/* Returns 1 if decoded, -1 if absent or 0 on error */
+static int flat_extern(FLAT_DEC *d, const FLAT_OP *op, ASN1_VALUE **pval,
+                       const unsigned char *end)
+{
+    ASN1_VALUE *val = NULL;
+    const unsigned char *q = d->p;
+    int ret;
+
+    ret = ASN1_item_ex_d2i(&val, &q, (long)(end - d->p), op->it, op->tag,
+                           op->aclass, (char)op->opt, NULL);
+    if (ret <= 0)
+        return ret;
+    if (flat_add_cleanup(d->arena, FLAT_CLEANUP_ITEM, val, op->it) == NULL) {
+        ASN1_item_free(val, op->it);
+        return 0;
+    }
+    *pval = val;
+    d->p = q;
+    return 1;
+}
+
+/*
+ * Sets up an item with callbacks or a reference count as
+ * asn1_item_embed_new() would and runs its D2I_PRE callback. Unless it is
+ * embedded, it is allocated outside the arena. Returns 1 on success, 0 on
+ * error or -1 if the NEW_PRE callback allocates the item itself, in which
+ * case only the template decoder can decode it.
+ */
+static int flat_shell_new(ASN1_ARENA *arena, const FLAT_OP *op,
+                          ASN1_VALUE **pval, unsigned char **pbase)
+{
+    const ASN1_ITEM *it = op->it;
+    const ASN1_AUX *aux = it->funcs;
+    ASN1_aux_cb *asn1_cb = aux->asn1_cb;
+    FLAT_CLEANUP *cl;
+    ASN1_VALUE *val = op->embed ? (ASN1_VALUE *)pval : NULL;
+    int i;
+
+    if (asn1_cb != NULL) {
+        if ((i = asn1_cb(ASN1_OP_NEW_PRE, &val, it, NULL)) == 0)
+            goto auxerr;
+        if (i == 2) {
+            if (!op->embed)
+                ASN1_item_free(val, it);
+            return -1;
+        }
+    }
+    if (op->embed)
+        memset(val, 0, it->size);
+    else if ((val = OPENSSL_zalloc(it->size)) == NULL)
+        return 0;
+    if (ossl_asn1_do_lock(&val, 0, it) < 0) {
+        if (!op->embed)
+            OPENSSL_free(val);
+        return 0;
+    }
+    if ((cl = flat_add_cleanup(arena, FLAT_CLEANUP_SHELL, val, it)) == NULL) {
+        (void)ossl_asn1_do_lock(&val, -1, it);
+        if (!op->embed)
+            OPENSSL_free(val);
+        return 0;
+    }
+    cl->embed = op->embed;
+    ossl_asn1_enc_init(&val, it);
+
+    /*
+     * The arena frees the item on reset whatever its reference count, so
+     * X509_up_ref() and X509_CRL_up_ref() must refuse to take references.
+     */
+    if (it == ASN1_ITEM_rptr(X509))
+        ((X509 *)val)->in_arena = 1;
+    else if (it == ASN1_ITEM_rptr(X509_CRL))
+        ((X509_CRL *)val)->in_arena = 1;
+
+    /* From here on the arena frees the item even if decoding it fails */
+    if (asn1_cb != NULL
+        && (!asn1_cb(ASN1_OP_NEW_POST, &val, it, NULL)
+            || !asn1_cb(ASN1_OP_D2I_PRE, &val, it, NULL)))
+        goto auxerr;
+    *pbase = (unsigned char *)val;
+    return 1;
+
+ auxerr:
+    ERR_raise(ERR_LIB_ASN1, ASN1_R_AUX_ERROR);
+    return 0;
+}
+
+/*
+ * Returns the structure of a SEQUENCE or CHOICE in |*pbase|. Returns 1 on
+ * success, 0 on error or -1 if the template decoder must be used.
+ */
+static int flat_struct(ASN1_ARENA *arena, const FLAT_OP *op,
+                       ASN1_VALUE **pval, unsigned char **pbase)
+{
+    if (op->shell)
+        return flat_shell_new(arena, op, pval, pbase);
+    if (op->embed)
+        *pbase = (unsigned char *)pval;
+    else if ((*pbase = flat_alloc(arena, op->it->size)) == NULL)
+        return 0;
+    return 1;
+}
+
+static FLAT_FRAME *flat_push(FLAT_DEC *d, int type, const unsigned char *end,
+                             unsigned char *base)
+{
+    FLAT_FRAME *f;
+
+    if (d->nframes == FLAT_MAX_FRAMES
+        || ((type == FLAT_FRAME_SEQ || type == FLAT_FRAME_CHOICE)
+            && ++d->depth > FLAT_MAX_DEPTH)) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_NESTED_TOO_DEEP);
+        return NULL;
+    }
+    f = &d->arena->frames[d->nframes++];
+    memset(f, 0, sizeof(*f));
+    f->type = type;
+    f->end = end;
+    f->base = base;
+    return f;
+}
+
+/* Stores the default value of an absent OPTIONAL field */
+static void flat_absent(const FLAT_OP *op, unsigned char *base)
+{
+    if (op->op == FLAT_OP_EXPLICIT)
+        op++;
+    if (op->op == FLAT_OP_PRIM && op->utype == V_ASN1_BOOLEAN)
+        *(ASN1_BOOLEAN *)(base + op->offset) = (ASN1_BOOLEAN)op->it->size;
+}
+
+static int flat_missing(FLAT_DEC *d, const FLAT_OP *op,
+                        const unsigned char *end)
+{
+    if (d->p == end)
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_FIELD_MISSING);
+    else if (op->match == FLAT_MATCH_CHOICE)
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_NO_MATCHING_CHOICE_TYPE);
+    else if (op->match == FLAT_MATCH_MSTRING)
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_MSTRING_WRONG_TAG);
+    else
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_WRONG_TAG);
+    return 0;
+}
+
+/*
+ * Runs the program |pc| with the result stored at |root|. Returns 1 on
+ * success, 0 on error or FLAT_FALLBACK.
+ */
+static int flat_run(FLAT_DEC *d, const FLAT_OP *pc, ASN1_VALUE **root,
+                    const unsigned char *end)
+{
+    FLAT_FRAME *f, *nf;
+    const FLAT_OP *br;
+    const ASN1_AUX *aux;
+    ASN1_ENCODING *enc;
+    ASN1_VALUE **pval, *val;
+    unsigned char *base;
+    int ret = 0;
+
+    if (flat_push(d, FLAT_FRAME_ROOT, end, (unsigned char *)root) == NULL)
+        return 0;
+
+    for (;;) {
+        f = &d->arena->frames[d->nframes - 1];
+        pval = (ASN1_VALUE **)(f->base + pc->offset);
+
+        switch (pc->op) {
+        case FLAT_OP_HALT:
+            return 1;
+
+        case FLAT_OP_END:
+            if (f->type == FLAT_FRAME_EXPLICIT) {
+                if (d->p != f->end) {
+                    ERR_raise(ERR_LIB_ASN1, ASN1_R_EXPLICIT_LENGTH_MISMATCH);
+                    goto err;
+                }
+                d->nframes--;
+                pc++;
+                continue;
+            }
+            if (f->type == FLAT_FRAME_SEQ) {
+                if (d->p != f->end) {
+                    ERR_raise(ERR_LIB_ASN1, ASN1_R_SEQUENCE_LENGTH_MISMATCH);
+                    goto err;
+                }
+                aux = f->it->funcs;
+                if (aux != NULL && (aux->flags & ASN1_AFLG_ENCODING) != 0) {
+                    enc = (ASN1_ENCODING *)(f->base + aux->enc_offset);
+                    enc->len = (long)(d->p - f->start);
+                    if ((enc->enc = flat_alloc(d->arena, enc->len)) == NULL)
+                        goto err;
+                    memcpy(enc->enc, f->start, enc->len);
+                    enc->modified = 0;
+                }
+            }
+            aux = f->it->funcs;
+            if (aux != NULL && aux->asn1_cb != NULL) {
+                val = (ASN1_VALUE *)f->base;
+                if (!aux->asn1_cb(ASN1_OP_D2I_POST, &val, f->it, NULL)) {
+                    ERR_raise(ERR_LIB_ASN1, ASN1_R_AUX_ERROR);
+                    goto err;
+                }
+            }
+            d->depth--;
+            d->nframes--;
+            pc = f->ret;
+            continue;
+
+        case FLAT_OP_SETOF_NEXT:
+            if (!OPENSSL_sk_push(f->sk, f->elem)) {
+                ERR_raise(ERR_LIB_ASN1, ERR_R_CRYPTO_LIB);
+                goto err;
+            }
+            f->elem = NULL;
+            if (d->p < f->end) {
+                pc = f->ret;
+            } else {
+                d->nframes--;
+                pc++;
+            }
+            continue;
+        }
+
+        /* Everything else starts a field, which may be absent */
+        if ((f->type == FLAT_FRAME_SEQ || f->type == FLAT_FRAME_SETOF)
+            && f->end - d->p >= 2 && d->p[0] == 0 && d->p[1] == 0) {
+            ERR_raise(ERR_LIB_ASN1, ASN1_R_UNEXPECTED_EOC);
+            goto err;
+        }
+        if (d->p == f->end)
+            ret = 0;
+        else if ((ret = flat_match(d, pc, f->end)) < 0)
+            goto err;
+        if (ret == 0) {
+            if (!pc->opt) {
+                flat_missing(d, pc, f->end);
+                goto err;
+            }
+            flat_absent(pc, f->base);
+            pc += pc->skip;
+            continue;
+        }
+
+        switch (pc->op) {
+        case FLAT_OP_PRIM:
+            if ((ret = flat_prim(d, pc, pval, f->end)) <= 0)
+                goto err;
+            pc++;
+            break;
+
+        case FLAT_OP_SEQ:
+            if (pc->prog->state != FLAT_PROG_READY)
+                goto delegate;
+            if ((ret = flat_header(d, f->end)) <= 0)
+                goto err;
+            if (!d->hcst) {
+                ERR_raise(ERR_LIB_ASN1, ASN1_R_SEQUENCE_NOT_CONSTRUCTED);
+                ret = 0;
+                goto err;
+            }
+            if ((ret = flat_struct(d->arena, pc, pval, &base)) < 0) {
+                /* The item allocates itself, don't try again */
+                pc->prog->state = FLAT_PROG_DELEGATED;
+                goto delegate;
+            }
+            if (ret == 0)
+                goto err;
+            if ((nf = flat_push(d, FLAT_FRAME_SEQ, d->hcont + d->hlen,
+                                base)) == NULL)
+                goto err;
+            if (!pc->embed)
+                *pval = (ASN1_VALUE *)base;
+            nf->ret = pc + 1;
+            nf->start = d->p;
+            nf->it = pc->it;
+            d->p = d->hcont;
+            pc = pc->prog->ops;
+            break;
+
+        case FLAT_OP_CHOICE:
+            if (pc->prog->state != FLAT_PROG_READY)
+                goto delegate;
+            /* flat_match() has found the branch */
+            br = flat_find_branch(d, pc->prog);
+            if ((ret = flat_struct(d->arena, pc, pval, &base)) < 0) {
+                pc->prog->state = FLAT_PROG_DELEGATED;
+                goto delegate;
+            }
+            if (ret == 0)
+                goto err;
+            if ((nf = flat_push(d, FLAT_FRAME_CHOICE, f->end, base)) == NULL)
+                goto err;
+            if (!pc->embed)
+                *pval = (ASN1_VALUE *)base;
+            *(int *)(base + pc->it->utype) = br->utype;
+            nf->ret = pc + 1;
+            nf->it = pc->it;
+            pc = pc->prog->ops + br->skip;
+            break;
+
+        case FLAT_OP_EXPLICIT:
+            if ((ret = flat_header(d, f->end)) <= 0)
+                goto err;
+            if (!d->hcst) {
+                ERR_raise(ERR_LIB_ASN1, ASN1_R_EXPLICIT_TAG_NOT_CONSTRUCTED);
+                ret = 0;
+                goto err;
+            }
+            if (flat_push(d, FLAT_FRAME_EXPLICIT, d->hcont + d->hlen,
+                          f->base) == NULL)
+                goto err;
+            d->p = d->hcont;
+            pc++;
+            break;
+
+        case FLAT_OP_SETOF:
+            if ((ret = flat_header(d, f->end)) <= 0)
+                goto err;
+            if (!d->hcst) {
+                ERR_raise(ERR_LIB_ASN1, ASN1_R_TYPE_NOT_CONSTRUCTED);
+                ret = 0;
+                goto err;
+            }
+            if ((*pval = (ASN1_VALUE *)OPENSSL_sk_new_null()) == NULL) {
+                ERR_raise(ERR_LIB_ASN1, ERR_R_CRYPTO_LIB);
+                goto err;
+            }
+            if (flat_add_cleanup(d->arena, FLAT_CLEANUP_STACK, *pval,
+                                 NULL) == NULL) {
+                OPENSSL_sk_free((OPENSSL_STACK *)*pval);
+                *pval = NULL;
+                goto err;
+            }
+            d->p = d->hcont;
+            if (d->hlen == 0) {
+                pc += pc->skip;
+                break;
+            }
+            if ((nf = flat_push(d, FLAT_FRAME_SETOF, d->hcont + d->hlen,
+                                NULL)) == NULL)
+                goto err;
+            nf->base = (unsigned char *)&nf->elem;
+            nf->sk = (OPENSSL_STACK *)*pval;
+            nf->ret = ++pc;
+            break;
+
+        case FLAT_OP_EXTERN:
+ delegate:
+            if (pc->embed) {
+                ERR_raise(ERR_LIB_ASN1, ASN1_R_BAD_TEMPLATE);
+                goto err;
+            }
+            if ((ret = flat_extern(d, pc, pval, f->end)) == 0)
+                goto err;
+            pc++;
+            break;
+
+        default:
+            ERR_raise(ERR_LIB_ASN1, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+    }
+
+ err:
+    if (ret != FLAT_FALLBACK) {
+        for (; d->nframes > 0; d->nframes--) {
+            f = &d->arena->frames[d->nframes - 1];
+            if (f->it != NULL)
+                break;
+        }
+        ERR_add_error_data(2, "Type=",
+                           d->nframes > 0 ? f->it->sname : "");
+        ret = 0;
+    }
+    d->nframes = 0;
+    d->depth = 0;
+    return ret;
+}
+
+ASN1_VALUE *ASN1_item_d2i_arena(ASN1_ARENA *arena, const unsigned char **in,
+                                long len, const ASN1_ITEM *it)
+{
+    FLAT_PROG *prog;
+    FLAT_DEC d;
+    ASN1_VALUE *val = NULL;
+    const unsigned char *p;
+    int ret;
+
+    if (arena == NULL || in == NULL || *in == NULL || it == NULL) {
+        ERR_raise(ERR_LIB_ASN1, ERR_R_PASSED_NULL_PARAMETER);
+        return NULL;
+    }
+    if (len <= 0) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_TOO_SMALL);
+        return NULL;
+    }
+    if ((prog = flat_program(arena, it, 1)) == NULL)
+        return NULL;
+
+    if (prog->state == FLAT_PROG_READY
+        && prog->ops[0].op != FLAT_OP_EXTERN) {
+        memset(&d, 0, sizeof(d));
+        d.arena = arena;
+        d.p = *in;
+        ERR_set_mark();
+        ret = flat_run(&d, prog->ops, &val, *in + len);
+        if (ret > 0) {
+            ERR_clear_last_mark();
+            *in = d.p;
+            return val;
+        }
+        if (ret != FLAT_FALLBACK) {
+            ERR_clear_last_mark();
+            return NULL;
+        }
+        ERR_pop_to_mark();
+        val = NULL;
+    }
+
+    p = *in;
+    if ((val = ASN1_item_d2i(NULL, &p, len, it)) == NULL)
+        return NULL;
+    if (flat_add_cleanup(arena, FLAT_CLEANUP_ITEM, val, it) == NULL) {
+        ASN1_item_free(val, it);
+        return NULL;
+    }
+    *in = p;
+    return val;
+}
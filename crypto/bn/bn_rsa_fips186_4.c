@@ -1,5 +1,5 @@
 /*
- * Copyright 2018-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2018-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2018-2019, Oracle and/or its affiliates.  All rights reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
@@ -27,6 +27,7 @@
 #include "bn_local.h"
 #include "crypto/bn.h"
 #include "internal/nelem.h"
+#include "internal/thread.h"
 
 #if BN_BITS2 == 64
 # define BN_DEF(lo, hi) (BN_ULONG)hi<<32|lo
@@ -177,6 +178,7 @@ err:
  *              internally. Used to find p1, p2.
  *     nlen The bit length of the modulus (the key size).
  *     e The public exponent.
+ *     threads The number of threads to search for p with.
  *     ctx A BN_CTX object.
  *     cb An optional BIGNUM callback.
  * Returns: 1 on success otherwise it returns 0.
@@ -185,8 +187,8 @@ int ossl_bn_rsa_fips186_4_gen_prob_primes(BIGNUM *p, BIGNUM *Xpout,
                                           BIGNUM *p1, BIGNUM *p2,
                                           const BIGNUM *Xp, const BIGNUM *Xp1,
                                           const BIGNUM *Xp2, int nlen,
-                                          const BIGNUM *e, BN_CTX *ctx,
-                                          BN_GENCB *cb)
+                                          const BIGNUM *e, int threads,
+                                          BN_CTX *ctx, BN_GENCB *cb)
 {
     int ret = 0;
     BIGNUM *p1i = NULL, *p2i = NULL, *Xp1i = NULL, *Xp2i = NULL;
@@ -234,7 +236,7 @@ int ossl_bn_rsa_fips186_4_gen_prob_primes(BIGNUM *p, BIGNUM *Xpout,
         goto err;
     /* (Steps 4.3/5.3) - generate prime */
     if (!ossl_bn_rsa_fips186_4_derive_prime(p, Xpout, Xp, p1i, p2i, nlen, e,
-                                            ctx, cb))
+                                            threads, ctx, cb))
         goto err;
     ret = 1;
 err:
@@ -251,6 +253,275 @@ err:
     return ret;
 }
 
+/*
+ * Searches Y, Y + r1r2x2, Y + 2 * r1r2x2, ... for the first probable prime.
+ *
+ * See FIPS 186-4 C.9 (Steps 5-10).
+ *
+ * Params:
+ *     Y The starting point, returns the prime that was found.
+ *     r1r2x2 The distance between two candidates.
+ *     e The public exponent.
+ *     bits The maximum size of the prime in bits.
+ *     rounds The number of Miller Rabin rounds.
+ *     imax The maximum number of candidates to test.
+ *     ctx A BN_CTX object.
+ *     cb An optional BIGNUM callback object.
+ * Returns: 1 if a prime was found, 0 if the candidates became larger than
+ *          |bits| bits first, or -1 on error.
+ */
+static int bn_rsa_fips186_4_find_prime(BIGNUM *Y, const BIGNUM *r1r2x2,
+                                       const BIGNUM *e, int bits, int rounds,
+                                       int imax, BN_CTX *ctx, BN_GENCB *cb)
+{
+    int ret = -1, i = 0, rv;
+    BIGNUM *y1;
+
+    BN_CTX_start(ctx);
+    y1 = BN_CTX_get(ctx);
+    if (y1 == NULL)
+        goto err;
+
+    /* (Step 5) */
+    for (;;) {
+        /* (Step 6) */
+        if (BN_num_bits(Y) > bits) {
+            ret = 0;
+            goto err;
+        }
+        BN_GENCB_call(cb, 0, 2);
+
+        /* (Step 7) If GCD(Y-1) == 1 & Y is probably prime then return Y */
+        if (BN_copy(y1, Y) == NULL
+                || !BN_sub_word(y1, 1))
+            goto err;
+
+        if (BN_are_coprime(y1, e, ctx)) {
+            rv = ossl_bn_check_generated_prime(Y, rounds, ctx, cb);
+
+            if (rv > 0)
+                break;
+            if (rv < 0)
+                goto err;
+        }
+        /* (Step 8-10) */
+        if (++i >= imax) {
+            ERR_raise(ERR_LIB_BN, BN_R_NO_PRIME_CANDIDATE);
+            goto err;
+        }
+        if (!BN_add(Y, Y, r1r2x2))
+            goto err;
+    }
+    ret = 1;
+err:
+    BN_clear(y1);
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+#ifndef OPENSSL_NO_THREAD_POOL
+/*
+ * The parallel search splits the candidate sequence of
+ * bn_rsa_fips186_4_find_prime() between |stride| workers, worker k testing
+ * the candidates k, k + stride, k + 2 * stride, ...  Each worker stops as
+ * soon as it reaches a candidate beyond the first one known to end the
+ * search, so the result is the same as that of the serial search.
+ *
+ * The workers draw the random Miller-Rabin bases from the DRBGs of their own
+ * threads.  The random stream of the calling thread is thus only used for
+ * the values that determine which prime is found, whatever the number of
+ * workers.  The serial search draws the bases from the calling thread, so
+ * with a deterministic DRBG the keys generated with and without the
+ * parallel search differ.
+ */
+# define BN_PRIME_SEARCH_MAX_WORKERS 64
+
+typedef struct {
+    OSSL_LIB_CTX *libctx;
+    const BIGNUM *Y;
+    const BIGNUM *r1r2x2;
+    const BIGNUM *e;
+    int bits;
+    int rounds;
+    int imax;
+    int stride;
+    CRYPTO_MUTEX *lock;
+    /* Protected by lock */
+    int end;
+    int end_result;
+} BN_PRIME_SEARCH;
+
+typedef struct {
+    BN_PRIME_SEARCH *search;
+    int first;
+} BN_PRIME_WORKER;
+
+static void bn_prime_search_end(BN_PRIME_SEARCH *search, int i, int result)
+{
+    ossl_crypto_mutex_lock(search->lock);
+    if (i < search->end) {
+        search->end = i;
+        search->end_result = result;
+    }
+    ossl_crypto_mutex_unlock(search->lock);
+}
+
+static int bn_prime_search_is_ended(BN_PRIME_SEARCH *search, int i)
+{
+    int ret;
+
+    ossl_crypto_mutex_lock(search->lock);
+    ret = i >= search->end;
+    ossl_crypto_mutex_unlock(search->lock);
+    return ret;
+}
+
+static CRYPTO_THREAD_RETVAL bn_prime_search_worker(void *arg)
+{
+    BN_PRIME_WORKER *worker = arg;
+    BN_PRIME_SEARCH *search = worker->search;
+    BN_CTX *ctx;
+    BIGNUM *Y, *y1, *step;
+    int i = worker->first, rv;
+
+    if ((ctx = BN_CTX_secure_new_ex(search->libctx)) == NULL) {
+        bn_prime_search_end(search, i, -1);
+        return 0;
+    }
+    BN_CTX_start(ctx);
+    Y = BN_CTX_get(ctx);
+    y1 = BN_CTX_get(ctx);
+    step = BN_CTX_get(ctx);
+    if (step == NULL)
+        goto err;
+    BN_set_flags(Y, BN_FLG_CONSTTIME);
+
+    /* Y = Y + first * r1r2x2 and step = stride * r1r2x2 */
+    if (!BN_set_word(step, i)
+            || !BN_mul(Y, step, search->r1r2x2, ctx)
+            || !BN_add(Y, Y, search->Y)
+            || !BN_set_word(step, search->stride)
+            || !BN_mul(step, step, search->r1r2x2, ctx))
+        goto err;
+
+    for (; i < search->imax; i += search->stride) {
+        if (bn_prime_search_is_ended(search, i))
+            break;
+        if (BN_num_bits(Y) > search->bits) {
+            bn_prime_search_end(search, i, 0);
+            break;
+        }
+        if (BN_copy(y1, Y) == NULL
+                || !BN_sub_word(y1, 1))
+            goto err;
+        if (BN_are_coprime(y1, search->e, ctx)) {
+            rv = ossl_bn_check_generated_prime(Y, search->rounds, ctx, NULL);
+
+            if (rv != 0) {
+                bn_prime_search_end(search, i, rv > 0 ? 1 : -1);
+                break;
+            }
+        }
+        if (!BN_add(Y, Y, step))
+            goto err;
+    }
+    BN_clear(Y);
+    BN_clear(y1);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return 1;
+
+err:
+    bn_prime_search_end(search, i, -1);
+    BN_clear(Y);
+    BN_clear(y1);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return 0;
+}
+
+/*
+ * Same as bn_rsa_fips186_4_find_prime() but spread over |threads| workers
+ * of the library context thread pool.  |cb| is only called once the search
+ * ends.  Returns -2 if the thread pool is not available, in which case the
+ * serial search should be used.
+ */
+static int bn_rsa_fips186_4_find_prime_parallel(BIGNUM *Y,
+                                                const BIGNUM *r1r2x2,
+                                                const BIGNUM *e, int bits,
+                                                int rounds, int imax,
+                                                int threads, BN_CTX *ctx,
+                                                BN_GENCB *cb)
+{
+    BN_PRIME_SEARCH search;
+    BN_PRIME_WORKER *workers = NULL;
+    OSSL_THREAD_TASK **tasks = NULL;
+    BIGNUM *tmp;
+    int i, ret = -1;
+
+    if (threads > BN_PRIME_SEARCH_MAX_WORKERS)
+        threads = BN_PRIME_SEARCH_MAX_WORKERS;
+
+    memset(&search, 0, sizeof(search));
+    search.libctx = ossl_bn_get_libctx(ctx);
+    search.Y = Y;
+    search.r1r2x2 = r1r2x2;
+    search.e = e;
+    search.bits = bits;
+    search.rounds = rounds;
+    search.imax = imax;
+    search.stride = threads;
+    search.end = imax;
+    search.end_result = -1;
+
+    workers = OPENSSL_zalloc(threads * sizeof(*workers));
+    tasks = OPENSSL_zalloc(threads * sizeof(*tasks));
+    search.lock = ossl_crypto_mutex_new();
+    if (workers == NULL || tasks == NULL || search.lock == NULL)
+        goto err;
+
+    for (i = 0; i < threads; i++) {
+        workers[i].search = &search;
+        workers[i].first = i;
+        tasks[i] = ossl_crypto_pool_submit(search.libctx,
+                                           bn_prime_search_worker,
+                                           &workers[i]);
+        if (tasks[i] == NULL) {
+            /* Not all candidates would be covered, stop all workers */
+            bn_prime_search_end(&search, -1, -1);
+            ret = -2;
+            break;
+        }
+    }
+    for (i = 0; i < threads; i++)
+        ossl_crypto_pool_wait(tasks[i], NULL);
+    if (ret == -2)
+        goto err;
+
+    BN_GENCB_call(cb, 0, 2);
+    ret = search.end_result;
+    if (search.end == imax) {
+        ERR_raise(ERR_LIB_BN, BN_R_NO_PRIME_CANDIDATE);
+    } else if (ret > 0) {
+        /* Y = Y + end * r1r2x2 */
+        BN_CTX_start(ctx);
+        if ((tmp = BN_CTX_get(ctx)) == NULL
+                || !BN_set_word(tmp, search.end)
+                || !BN_mul(tmp, tmp, r1r2x2, ctx)
+                || !BN_add(Y, Y, tmp))
+            ret = -1;
+        BN_CTX_end(ctx);
+    }
+err:
+    for (i = 0; tasks != NULL && i < threads; i++)
+        ossl_crypto_pool_task_free(tasks[i]);
+    OPENSSL_free(tasks);
+    OPENSSL_free(workers);
+    ossl_crypto_mutex_free(&search.lock);
+    return ret;
+}
+#endif
+
 /*
  * Constructs a probable prime (a candidate for p or q) using 2 auxiliary
  * prime numbers and the Chinese Remainder Theorem.
@@ -266,6 +537,7 @@ err:
  *     r2 An auxiliary prime.
  *     nlen The desired length of n (the RSA modulus).
  *     e The public exponent.
+ *     threads The number of threads to search for the prime with.
  *     ctx A BN_CTX object.
  *     cb An optional BIGNUM callback object.
  * Returns: 1 on success otherwise it returns 0.
@@ -274,13 +546,13 @@ err:
  */
 int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
                                        const BIGNUM *r1, const BIGNUM *r2,
-                                       int nlen, const BIGNUM *e,
+                                       int nlen, const BIGNUM *e, int threads,
                                        BN_CTX *ctx, BN_GENCB *cb)
 {
     int ret = 0;
-    int i, imax, rounds;
+    int imax, rounds, rv;
     int bits = nlen >> 1;
-    BIGNUM *tmp, *R, *r1r2x2, *y1, *r1x2;
+    BIGNUM *tmp, *R, *r1r2x2, *r1x2;
     BIGNUM *base, *range;
 
     BN_CTX_start(ctx);
@@ -290,7 +562,6 @@ int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
     R = BN_CTX_get(ctx);
     tmp = BN_CTX_get(ctx);
     r1r2x2 = BN_CTX_get(ctx);
-    y1 = BN_CTX_get(ctx);
     r1x2 = BN_CTX_get(ctx);
     if (r1x2 == NULL)
         goto err;
@@ -362,45 +633,30 @@ int ossl_bn_rsa_fips186_4_derive_prime(BIGNUM *Y, BIGNUM *X, const BIGNUM *Xin,
         /* (Step 4) Y = X + ((R - X) mod 2r1r2) */
         if (!BN_mod_sub(Y, R, X, r1r2x2, ctx) || !BN_add(Y, Y, X))
             goto err;
-        /* (Step 5) */
-        i = 0;
-        for (;;) {
-            /* (Step 6) */
-            if (BN_num_bits(Y) > bits) {
-                if (Xin == NULL)
-                    break; /* Randomly Generated X so Go back to Step 3 */
-                else
-                    goto err; /* X is not random so it will always fail */
-            }
-            BN_GENCB_call(cb, 0, 2);
-
-            /* (Step 7) If GCD(Y-1) == 1 & Y is probably prime then return Y */
-            if (BN_copy(y1, Y) == NULL
-                    || !BN_sub_word(y1, 1))
-                goto err;
-
-            if (BN_are_coprime(y1, e, ctx)) {
-                int rv = ossl_bn_check_generated_prime(Y, rounds, ctx, cb);
-
-                if (rv > 0)
-                    goto end;
-                if (rv < 0)
-                    goto err;
-            }
-            /* (Step 8-10) */
-            if (++i >= imax) {
-                ERR_raise(ERR_LIB_BN, BN_R_NO_PRIME_CANDIDATE);
-                goto err;
-            }
-            if (!BN_add(Y, Y, r1r2x2))
-                goto err;
-        }
+        /* (Steps 5-10) */
+        rv = -2;
+#ifndef OPENSSL_NO_THREAD_POOL
+        if (threads > 1)
+            rv = bn_rsa_fips186_4_find_prime_parallel(Y, r1r2x2, e, bits,
+                                                      rounds, imax, threads,
+                                                      ctx, cb);
+#endif
+        if (rv == -2)
+            rv = bn_rsa_fips186_4_find_prime(Y, r1r2x2, e, bits, rounds, imax,
+                                             ctx, cb);
+        if (rv > 0)
+            goto end;
+        if (rv < 0)
+            goto err;
+        /* (Step 6) Y is too large */
+        if (Xin != NULL)
+            goto err; /* X is not random so it will always fail */
+        /* Randomly Generated X so Go back to Step 3 */
     }
 end:
     ret = 1;
     BN_GENCB_call(cb, 3, 0);
 err:
-    BN_clear(y1);
     BN_CTX_end(ctx);
     return ret;
 }
@@ -7,6 +7,7 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <string.h>
 #include <openssl/crypto.h>
 #include <openssl/comp.h>
 #include <openssl/obj_mac.h>
@@ -57,3 +58,63 @@ void ossl_free_compression_methods_int(STACK_OF(SSL_COMP) *methods)
 {
     sk_SSL_COMP_pop_free(methods, cmeth_free);
 }
+
+static unsigned long comp_cert_cache_hash(const OSSL_COMP_CERT_CACHE_ENTRY *e)
+{
+    unsigned long h;
+
+    memcpy(&h, e->md, sizeof(h));
+    return h ^ (unsigned long)e->alg;
+}
+
+static int comp_cert_cache_cmp(const OSSL_COMP_CERT_CACHE_ENTRY *a,
+                               const OSSL_COMP_CERT_CACHE_ENTRY *b)
+{
+    if (a->alg != b->alg)
+        return a->alg < b->alg ? -1 : 1;
+    return memcmp(a->md, b->md, sizeof(a->md));
+}
+
+OSSL_COMP_CERT_CACHE *ossl_comp_cert_cache_new(void)
+{
+    OSSL_COMP_CERT_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    cache->lock = CRYPTO_THREAD_lock_new();
+    cache->entries = lh_OSSL_COMP_CERT_CACHE_ENTRY_new(comp_cert_cache_hash,
+                                                       comp_cert_cache_cmp);
+    if (cache->lock == NULL || cache->entries == NULL) {
+        ossl_comp_cert_cache_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+/*
+ * Drops the reference of the cache. libssl may still hold references of its
+ * own, so this frees the certificate only if it was the last one.
+ */
+static void comp_cert_cache_entry_free(OSSL_COMP_CERT_CACHE_ENTRY *e)
+{
+    int i;
+
+    CRYPTO_DOWN_REF(&e->cc->references, &i);
+    if (i <= 0) {
+        OPENSSL_free(e->cc->data);
+        CRYPTO_FREE_REF(&e->cc->references);
+        OPENSSL_free(e->cc);
+    }
+    OPENSSL_free(e);
+}
+
+void ossl_comp_cert_cache_free(OSSL_COMP_CERT_CACHE *cache)
+{
+    if (cache == NULL)
+        return;
+    lh_OSSL_COMP_CERT_CACHE_ENTRY_doall(cache->entries,
+                                        comp_cert_cache_entry_free);
+    lh_OSSL_COMP_CERT_CACHE_ENTRY_free(cache->entries);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
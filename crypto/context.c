@@ -17,6 +17,7 @@
 #include "internal/provider.h"
 #include "crypto/decoder.h"
 #include "crypto/context.h"
+#include "internal/comp.h"
 
 struct ossl_lib_ctx_st {
     CRYPTO_RWLOCK *lock;
@@ -50,6 +51,7 @@ struct ossl_lib_ctx_st {
     void *fips_prov;
 #endif
     STACK_OF(SSL_COMP) *comp_methods;
+    OSSL_COMP_CERT_CACHE *comp_cert_cache;
 
     int ischild;
     int conf_diagnostics;
@@ -207,6 +209,10 @@ static int context_init(OSSL_LIB_CTX *ctx)
 
 #ifndef FIPS_MODULE
     ctx->comp_methods = ossl_load_builtin_compressions();
+
+    ctx->comp_cert_cache = ossl_comp_cert_cache_new();
+    if (ctx->comp_cert_cache == NULL)
+        goto err;
 #endif
 
     return 1;
@@ -225,6 +231,14 @@ static int context_init(OSSL_LIB_CTX *ctx)
 
 static void context_deinit_objs(OSSL_LIB_CTX *ctx)
 {
+#ifndef OPENSSL_NO_THREAD_POOL
+    /* P0. Thread pool workers may still be using any of the objects below */
+    if (ctx->threads != NULL) {
+        ossl_threads_ctx_free(ctx->threads);
+        ctx->threads = NULL;
+    }
+#endif
+
     /* P2. We want evp_method_store to be cleaned up before the provider store */
     if (ctx->evp_method_store != NULL) {
         ossl_method_store_free(ctx->evp_method_store);
@@ -334,13 +348,6 @@ static void context_deinit_objs(OSSL_LIB_CTX *ctx)
     }
 #endif
 
-#ifndef OPENSSL_NO_THREAD_POOL
-    if (ctx->threads != NULL) {
-        ossl_threads_ctx_free(ctx->threads);
-        ctx->threads = NULL;
-    }
-#endif
-
     /* Low priority. */
 #ifndef FIPS_MODULE
     if (ctx->child_provider != NULL) {
@@ -354,6 +361,9 @@ static void context_deinit_objs(OSSL_LIB_CTX *ctx)
         ossl_free_compression_methods_int(ctx->comp_methods);
         ctx->comp_methods = NULL;
     }
+
+    ossl_comp_cert_cache_free(ctx->comp_cert_cache);
+    ctx->comp_cert_cache = NULL;
 #endif
 
 }
@@ -617,6 +627,11 @@ void *ossl_lib_ctx_get_data(OSSL_LIB_CTX *ctx, int index)
     case OSSL_LIB_CTX_COMP_METHODS:
         return (void *)&ctx->comp_methods;
 
+#ifndef FIPS_MODULE
+    case OSSL_LIB_CTX_COMP_CERT_CACHE_INDEX:
+        return ctx->comp_cert_cache;
+#endif
+
     default:
         return NULL;
     }
@@ -18,6 +18,7 @@
 #include "ec_local.h"
 #include <openssl/evp.h>
 #include <openssl/sha.h>
+#include <openssl/rand.h>
 
 #include "internal/numbers.h"
 
@@ -4528,6 +4529,24 @@ static const ge_precomp Bi[8] = {
     },
 };
 
+/* Ai = A,3A,5A,7A,9A,11A,13A,15A */
+static void ge_p3_odd_multiples(ge_cached Ai[8], const ge_p3 *A)
+{
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 A2;
+    int i;
+
+    ge_p3_to_cached(&Ai[0], A);
+    ge_p3_dbl(&t, A);
+    ge_p1p1_to_p3(&A2, &t);
+    for (i = 1; i < 8; i++) {
+        ge_add(&t, &A2, &Ai[i - 1]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&Ai[i], &u);
+    }
+}
+
 /*
  * r = a * A + b * B
  *
@@ -4543,36 +4562,12 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
     ge_cached Ai[8]; /* A,3A,5A,7A,9A,11A,13A,15A */
     ge_p1p1 t;
     ge_p3 u;
-    ge_p3 A2;
     int i;
 
     slide(aslide, a);
     slide(bslide, b);
 
-    ge_p3_to_cached(&Ai[0], A);
-    ge_p3_dbl(&t, A);
-    ge_p1p1_to_p3(&A2, &t);
-    ge_add(&t, &A2, &Ai[0]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[1], &u);
-    ge_add(&t, &A2, &Ai[1]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[2], &u);
-    ge_add(&t, &A2, &Ai[2]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[3], &u);
-    ge_add(&t, &A2, &Ai[3]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[4], &u);
-    ge_add(&t, &A2, &Ai[4]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[5], &u);
-    ge_add(&t, &A2, &Ai[5]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[6], &u);
-    ge_add(&t, &A2, &Ai[6]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[7], &u);
+    ge_p3_odd_multiples(Ai, A);
 
     ge_p2_0(r);
 
@@ -5555,6 +5550,43 @@ ossl_ed25519_pubkey_verify(const uint8_t *pub, size_t pub_len)
 
 static const char allzeroes[15];
 
+/*
+ * Check 0 <= s < L where L = 2^252 + 27742317777372353535851937790883648493
+ *
+ * If not the signature is publicly invalid. Since it's public we can do the
+ * check in variable time.
+ */
+static int ed25519_scalar_is_canonical(const uint8_t *s)
+{
+    /* 27742317777372353535851937790883648493 in little endian format */
+    static const uint8_t l_low[16] = {
+        0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2,
+        0xDE, 0xF9, 0xDE, 0x14
+    };
+    int i;
+
+    /* First check the most significant byte */
+    if (s[31] > 0x10)
+        return 0;
+    if (s[31] == 0x10) {
+        /*
+         * Most significant byte indicates a value close to 2^252 so check the
+         * rest
+         */
+        if (memcmp(s + 16, allzeroes, sizeof(allzeroes)) != 0)
+            return 0;
+        for (i = 15; i >= 0; i--) {
+            if (s[i] < l_low[i])
+                break;
+            if (s[i] > l_low[i])
+                return 0;
+        }
+        if (i < 0)
+            return 0;
+    }
+    return 1;
+}
+
 int
 ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
                     const uint8_t signature[64], const uint8_t public_key[32],
@@ -5562,7 +5594,6 @@ ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
                     const uint8_t *context, size_t context_len,
                     OSSL_LIB_CTX *libctx, const char *propq)
 {
-    int i;
     ge_p3 A;
     const uint8_t *r, *s;
     EVP_MD *sha512;
@@ -5572,11 +5603,6 @@ ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
     ge_p2 R;
     uint8_t rcheck[32];
     uint8_t h[SHA512_DIGEST_LENGTH];
-    /* 27742317777372353535851937790883648493 in little endian format */
-    const uint8_t l_low[16] = {
-        0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2,
-        0xDE, 0xF9, 0xDE, 0x14
-    };
 
     if (context == NULL)
         context_len = 0;
@@ -5592,32 +5618,8 @@ ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
     r = signature;
     s = signature + 32;
 
-    /*
-     * Check 0 <= s < L where L = 2^252 + 27742317777372353535851937790883648493
-     *
-     * If not the signature is publicly invalid. Since it's public we can do the
-     * check in variable time.
-     *
-     * First check the most significant byte
-     */
-    if (s[31] > 0x10)
+    if (!ed25519_scalar_is_canonical(s))
         return 0;
-    if (s[31] == 0x10) {
-        /*
-         * Most significant byte indicates a value close to 2^252 so check the
-         * rest
-         */
-        if (memcmp(s + 16, allzeroes, sizeof(allzeroes)) != 0)
-            return 0;
-        for (i = 15; i >= 0; i--) {
-            if (s[i] < l_low[i])
-                break;
-            if (s[i] > l_low[i])
-                return 0;
-        }
-        if (i < 0)
-            return 0;
-    }
 
     if (ge_frombytes_vartime(&A, public_key) != 0) {
         return 0;
@@ -5661,6 +5663,418 @@ err:
     return res;
 }
 
+/*
+ * Number of signatures combined into a single multi-scalar multiplication,
+ * the number from which the R_i are summed with Pippenger's method rather
+ * than interleaved with the rest, and the group size below which a failed
+ * group is checked signature by signature rather than halved
+ */
+#define ED25519_BATCH_SIZE 1024
+#define ED25519_PIPPENGER_THRESHOLD 128
+#define ED25519_BATCH_MIN 8
+
+typedef struct {
+    size_t idx;                 /* position in the caller's arrays */
+    const uint8_t *tbs;
+    size_t tbs_len;
+    const uint8_t *sig;
+    const uint8_t *s;           /* the S half of the signature */
+    uint8_t h[SHA512_DIGEST_LENGTH]; /* SHA-512(R || A || M) mod l */
+    uint8_t z[32];              /* random multiplier */
+    signed char zslide[256];
+    ge_p3 R;                    /* -R */
+    ge_cached Ri[8];            /* -R,-3R,-5R,...,-15R */
+    int have_odd_multiples;     /* whether Ri[1..7] are set */
+} ED25519_BATCH_ITEM;
+
+/*
+ * Returns 1 if |s| is the canonical encoding of the point |P| it decodes to,
+ * i.e. y < p and x = 0 comes with a clear sign bit.
+ */
+static int ed25519_point_is_canonical(const uint8_t *s, const ge_p3 *P)
+{
+    int i;
+
+    if ((s[31] & 0x7f) == 0x7f && s[0] >= 0xed) {
+        for (i = 1; i < 31 && s[i] == 0xff; i++)
+            continue;
+        if (i == 31)
+            return 0;
+    }
+    return (s[31] & 0x80) == 0 || fe_isnonzero(P->X);
+}
+
+/*
+ * Returns 1 if [l]P is the neutral element, i.e. P has no small order
+ * component.
+ */
+static int ed25519_point_in_subgroup(const ge_p3 *P)
+{
+    /* l = 2^252 + 27742317777372353535851937790883648493 in little endian */
+    static const uint8_t l[32] = {
+        0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2,
+        0xDE, 0xF9, 0xDE, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+    };
+    static const uint8_t zero[32] = { 0 };
+    ge_p2 r;
+    fe y_minus_z;
+
+    ge_double_scalarmult_vartime(&r, l, P, zero);
+    fe_sub(y_minus_z, r.Y, r.Z);
+    return !fe_isnonzero(r.X) && !fe_isnonzero(y_minus_z);
+}
+
+/* r += q */
+static void ge_p3_add(ge_p3 *r, const ge_p3 *q)
+{
+    ge_cached c;
+    ge_p1p1 t;
+
+    ge_p3_to_cached(&c, q);
+    ge_add(&t, r, &c);
+    ge_p1p1_to_p3(r, &t);
+}
+
+/*
+ * r = sum([z_i](-R_i)) with Pippenger's bucket method, see ec_pippenger_mul()
+ * in ec_mult.c.  The z_i are 128 bits long.
+ */
+static int ed25519_batch_pippenger(ge_p3 *r, const ED25519_BATCH_ITEM *items,
+                                   size_t n)
+{
+    const int bits = 128;
+    int c = ossl_ec_pippenger_window(n, bits);
+    int half = 1 << (c - 1), numwindows = (bits + c) / c;
+    int i, j, digit, pos;
+    unsigned char *carry;
+    ge_p3 *buckets, *windows, sum;
+    ge_p1p1 t;
+    size_t k;
+
+    carry = OPENSSL_zalloc(n);
+    buckets = OPENSSL_malloc(sizeof(*buckets) * half);
+    windows = OPENSSL_malloc(sizeof(*windows) * numwindows);
+    if (carry == NULL || buckets == NULL || windows == NULL) {
+        OPENSSL_free(carry);
+        OPENSSL_free(buckets);
+        OPENSSL_free(windows);
+        return 0;
+    }
+
+    for (j = 0; j < numwindows; j++) {
+        for (i = 0; i < half; i++)
+            ge_p3_0(&buckets[i]);
+
+        pos = j * c;
+        for (k = 0; k < n; k++) {
+            digit = carry[k];
+            for (i = 0; i < c && pos + i < bits; i++)
+                digit += ((items[k].z[(pos + i) / 8] >> ((pos + i) % 8)) & 1)
+                         << i;
+            carry[k] = digit > half;
+            if (carry[k])
+                digit -= 1 << c;
+
+            if (digit > 0) {
+                ge_add(&t, &buckets[digit - 1], &items[k].Ri[0]);
+                ge_p1p1_to_p3(&buckets[digit - 1], &t);
+            } else if (digit < 0) {
+                ge_sub(&t, &buckets[-digit - 1], &items[k].Ri[0]);
+                ge_p1p1_to_p3(&buckets[-digit - 1], &t);
+            }
+        }
+
+        /* windows[j] = sum([i + 1]buckets[i]) */
+        ge_p3_0(&sum);
+        ge_p3_0(&windows[j]);
+        for (i = half - 1; i >= 0; i--) {
+            ge_p3_add(&sum, &buckets[i]);
+            ge_p3_add(&windows[j], &sum);
+        }
+    }
+
+    *r = windows[numwindows - 1];
+    for (j = numwindows - 2; j >= 0; j--) {
+        for (i = 0; i < c; i++) {
+            ge_p3_dbl(&t, r);
+            ge_p1p1_to_p3(r, &t);
+        }
+        ge_p3_add(r, &windows[j]);
+    }
+
+    OPENSSL_free(carry);
+    OPENSSL_free(buckets);
+    OPENSSL_free(windows);
+    return 1;
+}
+
+/*
+ * Returns 1 if [b]B + [a]A + sum([z_i]R_i) is the neutral element, where
+ * A and the R_i are passed as tables of their odd multiples, 0 if it is not
+ * and -1 on allocation failure.
+ */
+static int ed25519_batch_is_identity(const ED25519_BATCH_ITEM *items,
+                                     size_t n, const ge_cached Ai[8],
+                                     const uint8_t *a, const uint8_t *b)
+{
+    signed char aslide[256];
+    signed char bslide[256];
+    ge_p2 r;
+    ge_p1p1 t;
+    ge_p3 u, rsum;
+    fe y_minus_z;
+    size_t j, nrsum = 0;
+    int i, digit;
+
+    /* Many R_i are summed separately, the rest is interleaved below */
+    if (n >= ED25519_PIPPENGER_THRESHOLD) {
+        if (!ed25519_batch_pippenger(&rsum, items, n))
+            return -1;
+        nrsum = n;
+        n = 0;
+    }
+
+    slide(aslide, a);
+    slide(bslide, b);
+
+    for (i = 255; i >= 0; --i) {
+        if (aslide[i] || bslide[i])
+            break;
+        for (j = 0; j < n; j++)
+            if (items[j].zslide[i])
+                break;
+        if (j < n)
+            break;
+    }
+
+    ge_p2_0(&r);
+    for (; i >= 0; --i) {
+        ge_p2_dbl(&t, &r);
+
+        for (j = 0; j < n; j++) {
+            digit = items[j].zslide[i];
+            if (digit > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &items[j].Ri[digit / 2]);
+            } else if (digit < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &items[j].Ri[(-digit) / 2]);
+            }
+        }
+
+        if (aslide[i] > 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_add(&t, &u, &Ai[aslide[i] / 2]);
+        } else if (aslide[i] < 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_sub(&t, &u, &Ai[(-aslide[i]) / 2]);
+        }
+
+        if (bslide[i] > 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &Bi[bslide[i] / 2]);
+        } else if (bslide[i] < 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_msub(&t, &u, &Bi[(-bslide[i]) / 2]);
+        }
+
+        ge_p1p1_to_p2(&r, &t);
+    }
+
+    if (nrsum != 0) {
+        /* (X : Y : Z) is (XZ : YZ : Z^2 : XY) in extended coordinates */
+        fe_mul(u.X, r.X, r.Z);
+        fe_mul(u.Y, r.Y, r.Z);
+        fe_sq(u.Z, r.Z);
+        fe_mul(u.T, r.X, r.Y);
+        ge_p3_add(&u, &rsum);
+        ge_p3_to_p2(&r, &u);
+    }
+
+    fe_sub(y_minus_z, r.Y, r.Z);
+    return !fe_isnonzero(r.X) && !fe_isnonzero(y_minus_z);
+}
+
+/*
+ * Checks the random linear combination of the signatures in |items| and sets
+ * their results if it holds.  Otherwise the group is halved until the
+ * culprits can be found with ossl_ed25519_verify().
+ */
+static int ed25519_batch_check(ED25519_BATCH_ITEM *items, size_t n,
+                               const ge_cached Ai[8],
+                               const uint8_t public_key[32], int *results,
+                               OSSL_LIB_CTX *libctx, const char *propq)
+{
+    uint8_t S[32], H[32];
+    size_t j;
+    int ok;
+
+    memset(S, 0, sizeof(S));
+    memset(H, 0, sizeof(H));
+    for (j = 0; j < n; j++) {
+        sc_muladd(S, items[j].z, items[j].s, S);
+        sc_muladd(H, items[j].z, items[j].h, H);
+    }
+
+    /* The interleaved method needs the odd multiples of each R */
+    if (n < ED25519_PIPPENGER_THRESHOLD)
+        for (j = 0; j < n; j++)
+            if (!items[j].have_odd_multiples) {
+                ge_p3_odd_multiples(items[j].Ri, &items[j].R);
+                items[j].have_odd_multiples = 1;
+            }
+
+    if ((ok = ed25519_batch_is_identity(items, n, Ai, H, S)) < 0)
+        return 0;
+    if (ok) {
+        for (j = 0; j < n; j++)
+            results[items[j].idx] = 1;
+        return 1;
+    }
+
+    if (n > ED25519_BATCH_MIN)
+        return ed25519_batch_check(items, n / 2, Ai, public_key, results,
+                                   libctx, propq)
+            && ed25519_batch_check(items + n / 2, n - n / 2, Ai, public_key,
+                                   results, libctx, propq);
+
+    for (j = 0; j < n; j++)
+        results[items[j].idx] =
+            ossl_ed25519_verify(items[j].tbs, items[j].tbs_len, items[j].sig,
+                                public_key, 0, 0, 0, NULL, 0, libctx, propq);
+    return 1;
+}
+
+/*
+ * Verifies |n| pure Ed25519 signatures made with |public_key| and sets
+ * results[i] to 1 or 0 depending on whether sigs[i] is a valid signature
+ * of tbs[i].  Returns 0 only on internal errors.
+ *
+ * The signatures are checked in groups of up to ED25519_BATCH_SIZE with a
+ * random linear combination of the verification equations
+ *
+ *          [sum(z_i * s_i)]B == sum([z_i]R_i) + [sum(z_i * h_i)]A
+ *
+ * which costs a single multi-scalar multiplication per group.  When a group
+ * fails it is halved until its signatures are checked one by one with
+ * ossl_ed25519_verify().
+ *
+ * The results are those of ossl_ed25519_verify(), which checks the
+ * cofactorless equation.  A small order component in R or A could cancel
+ * out in the combination, so both must be in the prime order subgroup for
+ * it to be used.  If A is not, all signatures are checked one by one, and a
+ * signature whose R is not is invalid because [s]B - [h]A is.  Checking R
+ * costs a scalar multiplication per signature.
+ */
+int
+ossl_ed25519_verify_batch(size_t n, const uint8_t *const *tbs,
+                          const size_t *tbs_len, const uint8_t *const *sigs,
+                          const size_t *sigs_len,
+                          const uint8_t public_key[32], int *results,
+                          OSSL_LIB_CTX *libctx, const char *propq)
+{
+    ED25519_BATCH_ITEM *items = NULL, *item;
+    ge_cached Ai[8];
+    ge_p3 A;
+    EVP_MD *sha512 = NULL;
+    EVP_MD_CTX *hash_ctx = NULL;
+    unsigned char *rnd = NULL;
+    unsigned int sz;
+    size_t i, j, cnt;
+    int ret = 0;
+
+    for (i = 0; i < n; i++)
+        results[i] = 0;
+    if (n == 0 || ge_frombytes_vartime(&A, public_key) != 0)
+        return 1;
+
+    if (!ed25519_point_in_subgroup(&A)) {
+        for (i = 0; i < n; i++)
+            results[i] = ossl_ed25519_verify(tbs[i], tbs_len[i], sigs[i],
+                                             public_key, 0, 0, 0, NULL, 0,
+                                             libctx, propq);
+        return 1;
+    }
+
+    fe_neg(A.X, A.X);
+    fe_neg(A.T, A.T);
+    ge_p3_odd_multiples(Ai, &A);
+
+    sha512 = EVP_MD_fetch(libctx, SN_sha512, propq);
+    if (sha512 == NULL)
+        return 0;
+    hash_ctx = EVP_MD_CTX_new();
+    cnt = n < ED25519_BATCH_SIZE ? n : ED25519_BATCH_SIZE;
+    items = OPENSSL_malloc(sizeof(*items) * cnt);
+    rnd = OPENSSL_malloc(16 * cnt);
+    if (hash_ctx == NULL || items == NULL || rnd == NULL)
+        goto err;
+
+    for (i = 0; i < n; ) {
+        /* Collect the next group of signatures that pass the cheap checks */
+        for (cnt = 0; cnt < ED25519_BATCH_SIZE && i < n; i++) {
+            item = &items[cnt];
+
+            /*
+             * Only the canonical encoding of a point of the prime order
+             * subgroup can match in ossl_ed25519_verify()
+             */
+            if (sigs_len[i] != 64
+                    || !ed25519_scalar_is_canonical(sigs[i] + 32)
+                    || ge_frombytes_vartime(&item->R, sigs[i]) != 0
+                    || !ed25519_point_is_canonical(sigs[i], &item->R)
+                    || !ed25519_point_in_subgroup(&item->R))
+                continue;
+
+            if (!hash_init_with_dom(hash_ctx, sha512, 0, 0, NULL, 0)
+                || !EVP_DigestUpdate(hash_ctx, sigs[i], 32)
+                || !EVP_DigestUpdate(hash_ctx, public_key, 32)
+                || !EVP_DigestUpdate(hash_ctx, tbs[i], tbs_len[i])
+                || !EVP_DigestFinal_ex(hash_ctx, item->h, &sz))
+                goto err;
+            x25519_sc_reduce(item->h);
+
+            fe_neg(item->R.X, item->R.X);
+            fe_neg(item->R.T, item->R.T);
+            ge_p3_to_cached(&item->Ri[0], &item->R);
+            item->have_odd_multiples = 0;
+
+            item->idx = i;
+            item->tbs = tbs[i];
+            item->tbs_len = tbs_len[i];
+            item->sig = sigs[i];
+            item->s = sigs[i] + 32;
+            cnt++;
+        }
+        if (cnt == 0)
+            continue;
+
+        if (RAND_bytes_ex(libctx, rnd, 16 * cnt, 0) <= 0)
+            goto err;
+        for (j = 0; j < cnt; j++) {
+            memset(items[j].z, 0, sizeof(items[j].z));
+            memcpy(items[j].z, rnd + 16 * j, 16);
+            slide(items[j].zslide, items[j].z);
+        }
+
+        if (!ed25519_batch_check(items, cnt, Ai, public_key, results, libctx,
+                                 propq))
+            goto err;
+    }
+    ret = 1;
+
+ err:
+    if (!ret)
+        for (i = 0; i < n; i++)
+            results[i] = 0;
+    OPENSSL_free(items);
+    OPENSSL_free(rnd);
+    EVP_MD_free(sha512);
+    EVP_MD_CTX_free(hash_ctx);
+    return ret;
+}
+
 int
 ossl_ed25519_public_from_private(OSSL_LIB_CTX *ctx, uint8_t out_public_key[32],
                                  const uint8_t private_key[32],
@@ -97,6 +97,7 @@ void EC_KEY_free(EC_KEY *r)
     CRYPTO_FREE_REF(&r->references);
     EC_GROUP_free(r->group);
     EC_POINT_free(r->pub_key);
+    ossl_ec_point_precomp_free(r->pub_precomp);
     BN_clear_free(r->priv_key);
     OPENSSL_free(r->propq);
 
@@ -764,6 +765,82 @@ void ossl_ec_key_set0_libctx(EC_KEY *key, OSSL_LIB_CTX *libctx)
     /* Do we need to propagate this to the group? */
 }
 
+/*
+ * Makes sure |group| has precomputed multiples of the generator, which the
+ * default public key table relies on.  Returns 1 if it has them, 0 on error
+ * and -1 if the group cannot precompute them.
+ */
+static int ec_key_group_precompute_generator(EC_GROUP *group, BN_CTX *ctx)
+{
+    if (group->meth->mul == NULL)
+        return ossl_ec_wNAF_have_precompute_mult(group)
+               || ossl_ec_wNAF_precompute_mult(group, ctx);
+    if (group->meth->precompute_mult == NULL
+        || group->meth->have_precompute_mult == NULL)
+        return -1;
+    return group->meth->have_precompute_mult(group)
+           || group->meth->precompute_mult(group, ctx);
+}
+
+/*
+ * Builds a fixed-base table for the public key, which ECDSA verification uses
+ * instead of a variable-base scalar multiplication.  The table is dropped as
+ * soon as the key changes.
+ *
+ * Unless the curve implementation has its own tables, only the public key
+ * half is precomputed here and the generator half uses the multiples of the
+ * generator kept by the group, which copies of the group share.  If the group
+ * cannot keep those the table would not pay off, so none is built.
+ */
+int ossl_ec_key_precompute_public(EC_KEY *key)
+{
+    EC_POINT_PRECOMP *pre = NULL;
+    BN_CTX *ctx;
+    int gen, ret = 0;
+
+    if (key->group == NULL || key->pub_key == NULL) {
+        ERR_raise(ERR_LIB_EC, EC_R_MISSING_PARAMETERS);
+        return 0;
+    }
+    if (ossl_ec_key_get0_public_precomp(key) != NULL)
+        return 1;
+
+    if ((ctx = BN_CTX_new_ex(key->libctx)) == NULL)
+        return 0;
+    if (key->group->meth->point_precompute == NULL
+        && (gen = ec_key_group_precompute_generator(key->group, ctx)) <= 0) {
+        /* Not being worthwhile for this curve is not an error */
+        ret = gen < 0;
+        goto err;
+    }
+    if ((pre = ossl_ec_point_precomp_new(key->group, key->pub_key,
+                                         ctx)) == NULL)
+        goto err;
+
+    ossl_ec_point_precomp_free(key->pub_precomp);
+    key->pub_precomp = pre;
+    key->pub_precomp_dirty_cnt = key->dirty_cnt;
+    ret = 1;
+ err:
+    BN_CTX_free(ctx);
+    return ret;
+}
+
+int ossl_ec_key_has_public_precomp(const EC_KEY *key)
+{
+    return ossl_ec_key_get0_public_precomp(key) != NULL;
+}
+
+const EC_POINT_PRECOMP *ossl_ec_key_get0_public_precomp(const EC_KEY *key)
+{
+    if (key->pub_precomp == NULL
+        || key->pub_precomp_dirty_cnt != key->dirty_cnt
+        || key->group == NULL
+        || key->pub_precomp->meth != key->group->meth)
+        return NULL;
+    return key->pub_precomp;
+}
+
 const EC_GROUP *EC_KEY_get0_group(const EC_KEY *key)
 {
     return key->group;
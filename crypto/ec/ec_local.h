@@ -35,6 +35,8 @@
 typedef struct ec_method_st EC_METHOD;
 #endif
 
+typedef struct ec_point_precomp_st EC_POINT_PRECOMP;
+
 /*
  * Structure details are not part of the exported interface, so all this may
  * change in future versions.
@@ -197,6 +199,24 @@ struct ec_method_st {
                        EC_POINT *r, EC_POINT *s,
                        EC_POINT *p, BN_CTX *ctx);
     int (*group_full_init)(EC_GROUP *group, const unsigned char *data);
+    /*
+     * used by ossl_ec_point_precomp_new and ossl_ec_point_mul_precomp
+     * (default implementations are used if the function pointers are 0)
+     */
+    int (*point_precompute)(const EC_GROUP *group, EC_POINT_PRECOMP *pre,
+                            const EC_POINT *point, BN_CTX *ctx);
+    int (*mul_precomp)(const EC_GROUP *group, EC_POINT *r,
+                       const BIGNUM *g_scalar, const EC_POINT_PRECOMP *pre,
+                       const BIGNUM *p_scalar, BN_CTX *ctx);
+    /*
+     * used by ossl_ec_points_mul_public, which uses mul if this is 0: a
+     * multiplication that only has to handle public scalars and may take
+     * variable time
+     */
+    int (*mul_public)(const EC_GROUP *group, EC_POINT *r,
+                      const BIGNUM *scalar, size_t num,
+                      const EC_POINT *points[], const BIGNUM *scalars[],
+                      BN_CTX *ctx);
 };
 
 /*
@@ -306,6 +326,10 @@ struct ec_key_st {
 
     /* Provider data */
     size_t dirty_cnt; /* If any key material changes, increment this */
+
+    /* Fixed-base table for pub_key, only valid while dirty_cnt is unchanged */
+    EC_POINT_PRECOMP *pub_precomp;
+    size_t pub_precomp_dirty_cnt;
 };
 
 struct ec_point_st {
@@ -349,6 +373,14 @@ void EC_nistp521_pre_comp_free(NISTP521_PRE_COMP *);
 void EC_nistz256_pre_comp_free(NISTZ256_PRE_COMP *);
 void EC_ec_pre_comp_free(EC_PRE_COMP *);
 
+/*
+ * Number of points from which multi-scalar multiplications switch to
+ * Pippenger's bucket method, and the largest window it uses
+ */
+# define EC_PIPPENGER_THRESHOLD 192
+# define EC_PIPPENGER_MAX_WINDOW 16
+int ossl_ec_pippenger_window(size_t num, int bits);
+
 /*
  * method functions in ec_mult.c (ec_lib.c uses these as defaults if
  * group->method->mul is 0)
@@ -359,6 +391,37 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
 int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *);
 int ossl_ec_wNAF_have_precompute_mult(const EC_GROUP *group);
 
+/*
+ * Fixed-base multiplication tables for points other than the generator.
+ * The tables are immutable once built.  Multiplication with them does not
+ * run in constant time, and is only meant for public scalars, such as in
+ * signature verification.
+ */
+struct ec_point_precomp_st {
+    const EC_METHOD *meth;      /* Method that built the table */
+    /* Used by the default implementation */
+    int w;                      /* Window size */
+    size_t numwindows;
+    EC_POINT **points;          /* numwindows * 2^(w-1) affine points */
+    /* Used by method specific implementations */
+    void *table;
+    void *table_storage;
+};
+
+EC_POINT_PRECOMP *ossl_ec_point_precomp_new(const EC_GROUP *group,
+                                            const EC_POINT *point,
+                                            BN_CTX *ctx);
+void ossl_ec_point_precomp_free(EC_POINT_PRECOMP *pre);
+int ossl_ec_point_mul_precomp(const EC_GROUP *group, EC_POINT *r,
+                              const BIGNUM *g_scalar,
+                              const EC_POINT_PRECOMP *pre,
+                              const BIGNUM *p_scalar, BN_CTX *ctx);
+const EC_POINT_PRECOMP *ossl_ec_key_get0_public_precomp(const EC_KEY *key);
+int ossl_ec_points_mul_public(const EC_GROUP *group, EC_POINT *r,
+                              const BIGNUM *scalar, size_t num,
+                              const EC_POINT *points[],
+                              const BIGNUM *scalars[], BN_CTX *ctx);
+
 /* method functions in ecp_smpl.c */
 int ossl_ec_GFp_simple_group_init(EC_GROUP *);
 void ossl_ec_GFp_simple_group_finish(EC_GROUP *);
@@ -394,6 +394,176 @@ int ossl_ec_scalar_mul_ladder(const EC_GROUP *group, EC_POINT *r,
                   (b) >=   20 ? 2 : \
                   1))
 
+/*
+ * Returns the window size in bits for Pippenger's bucket method with |num|
+ * scalars of up to |bits| bits.  Each window costs one addition per point,
+ * plus two per bucket to sum the buckets up; the signed digits need one
+ * extra bit.
+ */
+int ossl_ec_pippenger_window(size_t num, int bits)
+{
+    size_t cost, best_cost = SIZE_MAX;
+    int c, best = 2;
+
+    for (c = 2; c <= EC_PIPPENGER_MAX_WINDOW; c++) {
+        cost = (size_t)((bits + c) / c) * (num + ((size_t)1 << c));
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = c;
+        }
+    }
+    return best;
+}
+
+static int ec_pippenger_digit(const BIGNUM *k, int pos, int c)
+{
+    int i, d = 0;
+
+    for (i = 0; i < c; i++)
+        if (BN_is_bit_set(k, pos + i))
+            d |= 1 << i;
+    return d;
+}
+
+/*-
+ * Pippenger's bucket method for
+ *      \sum scalars[i]*points[i] + scalar*generator
+ *
+ * Each scalar is split into signed digits of c bits.  For every window the
+ * points are sorted into 2^(c-1) buckets by their digit, and the buckets are
+ * then summed with their weights using two additions each.  The number of
+ * additions per point shrinks as the number of points grows, unlike for the
+ * interleaved wNAF method.  Like the latter this is not constant time.
+ */
+static int ec_pippenger_mul(const EC_GROUP *group, EC_POINT *r,
+                            const BIGNUM *scalar, size_t num,
+                            const EC_POINT *points[],
+                            const BIGNUM *scalars[], BN_CTX *ctx)
+{
+    size_t total = num + (scalar != NULL);
+    size_t i, b, nbuckets = 0;
+    const BIGNUM **k = NULL;
+    EC_POINT **p = NULL;        /* the points in affine form, then their inverses */
+    EC_POINT **buckets = NULL, **windows = NULL, *sum = NULL;
+    unsigned char *carry = NULL;
+    int c, d, half, bits = 0, numwindows = 0, j, ret = 0;
+
+    if (total > OPENSSL_MALLOC_MAX_NELEMS(EC_POINT *) / 2) {
+        ERR_raise(ERR_LIB_EC, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if ((k = OPENSSL_malloc(total * sizeof(*k))) == NULL
+        || (p = OPENSSL_zalloc(2 * total * sizeof(*p))) == NULL
+        || (carry = OPENSSL_zalloc(total)) == NULL)
+        goto err;
+
+    for (i = 0; i < total; i++) {
+        if (i < num) {
+            k[i] = scalars[i];
+            p[i] = EC_POINT_dup(points[i], group);
+        } else {
+            const EC_POINT *generator = EC_GROUP_get0_generator(group);
+
+            if (generator == NULL) {
+                ERR_raise(ERR_LIB_EC, EC_R_UNDEFINED_GENERATOR);
+                goto err;
+            }
+            k[i] = scalar;
+            p[i] = EC_POINT_dup(generator, group);
+        }
+        if (p[i] == NULL)
+            goto err;
+        if (BN_num_bits(k[i]) > bits)
+            bits = BN_num_bits(k[i]);
+    }
+
+    if (!EC_POINTs_make_affine(group, total, p, ctx))
+        goto err;
+    for (i = 0; i < total; i++)
+        if ((p[total + i] = EC_POINT_dup(p[i], group)) == NULL
+            || !EC_POINT_invert(group, p[total + i], ctx))
+            goto err;
+
+    c = ossl_ec_pippenger_window(total, bits);
+    half = 1 << (c - 1);
+    nbuckets = (size_t)half;
+    numwindows = (bits + c) / c;
+
+    if ((buckets = OPENSSL_zalloc(nbuckets * sizeof(*buckets))) == NULL
+        || (windows = OPENSSL_zalloc(numwindows * sizeof(*windows))) == NULL
+        || (sum = EC_POINT_new(group)) == NULL)
+        goto err;
+    for (b = 0; b < nbuckets; b++)
+        if ((buckets[b] = EC_POINT_new(group)) == NULL)
+            goto err;
+
+    for (j = 0; j < numwindows; j++) {
+        if ((windows[j] = EC_POINT_new(group)) == NULL)
+            goto err;
+        for (b = 0; b < nbuckets; b++)
+            if (!EC_POINT_set_to_infinity(group, buckets[b]))
+                goto err;
+
+        for (i = 0; i < total; i++) {
+            d = ec_pippenger_digit(k[i], j * c, c) + carry[i];
+            carry[i] = d > half;
+            if (carry[i])
+                d -= 1 << c;
+            if (BN_is_negative(k[i]))
+                d = -d;
+
+            if (d > 0) {
+                if (!EC_POINT_add(group, buckets[d - 1], buckets[d - 1],
+                                  p[i], ctx))
+                    goto err;
+            } else if (d < 0) {
+                if (!EC_POINT_add(group, buckets[-d - 1], buckets[-d - 1],
+                                  p[total + i], ctx))
+                    goto err;
+            }
+        }
+
+        /* windows[j] = sum((b + 1) * buckets[b]) */
+        if (!EC_POINT_set_to_infinity(group, sum)
+            || !EC_POINT_set_to_infinity(group, windows[j]))
+            goto err;
+        for (b = nbuckets; b-- > 0;)
+            if (!EC_POINT_add(group, sum, sum, buckets[b], ctx)
+                || !EC_POINT_add(group, windows[j], windows[j], sum, ctx))
+                goto err;
+    }
+
+    if (!EC_POINT_set_to_infinity(group, r))
+        goto err;
+    for (j = numwindows - 1; j >= 0; j--) {
+        for (d = 0; d < c && j < numwindows - 1; d++)
+            if (!EC_POINT_dbl(group, r, r, ctx))
+                goto err;
+        if (!EC_POINT_add(group, r, r, windows[j], ctx))
+            goto err;
+    }
+    ret = 1;
+
+ err:
+    if (p != NULL)
+        for (i = 0; i < 2 * total; i++)
+            EC_POINT_free(p[i]);
+    if (buckets != NULL)
+        for (b = 0; b < nbuckets; b++)
+            EC_POINT_free(buckets[b]);
+    if (windows != NULL)
+        for (j = 0; j < numwindows; j++)
+            EC_POINT_free(windows[j]);
+    EC_POINT_free(sum);
+    OPENSSL_free(p);
+    OPENSSL_free(buckets);
+    OPENSSL_free(windows);
+    OPENSSL_free(carry);
+    OPENSSL_free(k);
+    return ret;
+}
+
 /*-
  * Compute
  *      \sum scalars[i]*points[i],
@@ -459,6 +629,9 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
         }
     }
 
+    if (num + (scalar != NULL) >= EC_PIPPENGER_THRESHOLD)
+        return ec_pippenger_mul(group, r, scalar, num, points, scalars, ctx);
+
     if (scalar != NULL) {
         generator = EC_GROUP_get0_generator(group);
         if (generator == NULL) {
@@ -979,3 +1152,243 @@ int ossl_ec_wNAF_have_precompute_mult(const EC_GROUP *group)
 {
     return HAVEPRECOMP(group, ec);
 }
+
+/*
+ * Fixed-base tables for arbitrary points.
+ *
+ * The default implementation splits the scalar into signed windows of
+ * EC_PRECOMP_WINDOW bits, d_j in [-2^(w-1), 2^(w-1)], and stores the
+ * multiples i * 2^(w * j) * P for 1 <= i <= 2^(w-1).  A multiplication is
+ * then one point addition per window and no doublings.
+ */
+#define EC_PRECOMP_WINDOW 5
+
+/*
+ * Returns a NULL terminated array of |numwindows| * 2^(w-1) affine points
+ * holding (i + 1) * 2^(w * j) * point.
+ */
+static EC_POINT **ec_precomp_table_new(const EC_GROUP *group,
+                                       const EC_POINT *point,
+                                       size_t numwindows, BN_CTX *ctx)
+{
+    const size_t half = (size_t)1 << (EC_PRECOMP_WINDOW - 1);
+    size_t num = numwindows * half, i, j;
+    EC_POINT **points, **row;
+
+    if ((points = OPENSSL_zalloc(sizeof(*points) * (num + 1))) == NULL)
+        return NULL;
+    for (i = 0; i < num; i++)
+        if ((points[i] = EC_POINT_new(group)) == NULL)
+            goto err;
+
+    for (j = 0; j < numwindows; j++) {
+        row = points + j * half;
+        if (j == 0) {
+            if (!EC_POINT_copy(row[0], point))
+                goto err;
+        } else if (!EC_POINT_dbl(group, row[0], row[-1], ctx)) {
+            goto err;
+        }
+        if (!EC_POINT_dbl(group, row[1], row[0], ctx))
+            goto err;
+        for (i = 2; i < half; i++)
+            if (!EC_POINT_add(group, row[i], row[i - 1], row[0], ctx))
+                goto err;
+    }
+
+    if (!EC_POINTs_make_affine(group, num, points, ctx))
+        goto err;
+    return points;
+
+ err:
+    for (i = 0; i < num; i++)
+        EC_POINT_free(points[i]);
+    OPENSSL_free(points);
+    return NULL;
+}
+
+static void ec_precomp_table_free(EC_POINT **points)
+{
+    EC_POINT **p;
+
+    if (points == NULL)
+        return;
+    for (p = points; *p != NULL; p++)
+        EC_POINT_free(*p);
+    OPENSSL_free(points);
+}
+
+static int ec_point_precompute_default(const EC_GROUP *group,
+                                       EC_POINT_PRECOMP *pre,
+                                       const EC_POINT *point, BN_CTX *ctx)
+{
+    size_t numwindows;
+
+    numwindows = (BN_num_bits(group->order) + 1 + EC_PRECOMP_WINDOW - 1)
+                 / EC_PRECOMP_WINDOW;
+    if ((pre->points = ec_precomp_table_new(group, point, numwindows,
+                                            ctx)) == NULL)
+        return 0;
+
+    pre->w = EC_PRECOMP_WINDOW;
+    pre->numwindows = numwindows;
+    return 1;
+}
+
+/* Adds d_j * table[j] for the signed window recoding of |scalar| to r */
+static int ec_precomp_table_add(const EC_GROUP *group, EC_POINT *r,
+                                const EC_POINT_PRECOMP *pre,
+                                const BIGNUM *scalar, EC_POINT *tmp,
+                                BN_CTX *ctx)
+{
+    EC_POINT *const *table = pre->points;
+    const size_t half = (size_t)1 << (pre->w - 1);
+    BIGNUM *k;
+    size_t j;
+    int i, bit, d, carry = 0, ret = 0;
+
+    BN_CTX_start(ctx);
+    if ((k = BN_CTX_get(ctx)) == NULL)
+        goto err;
+
+    if (BN_is_negative(scalar)
+        || BN_num_bits(scalar) > BN_num_bits(group->order)) {
+        if (!BN_nnmod(k, scalar, group->order, ctx))
+            goto err;
+    } else if (!BN_copy(k, scalar)) {
+        goto err;
+    }
+
+    for (j = 0, bit = 0; j < pre->numwindows; j++) {
+        d = carry;
+        for (i = 0; i < pre->w; i++, bit++)
+            if (BN_is_bit_set(k, bit))
+                d += 1 << i;
+        carry = d > (int)half;
+        if (carry)
+            d -= 1 << pre->w;
+
+        if (d > 0) {
+            if (!EC_POINT_add(group, r, r, table[j * half + d - 1], ctx))
+                goto err;
+        } else if (d < 0) {
+            if (!EC_POINT_copy(tmp, table[j * half - d - 1])
+                || !EC_POINT_invert(group, tmp, ctx)
+                || !EC_POINT_add(group, r, r, tmp, ctx))
+                goto err;
+        }
+    }
+    ret = 1;
+
+ err:
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+/*
+ * Not constant time: the tables are meant for verification with public
+ * scalars.
+ *
+ * The key half is a series of additions from the table.  The generator half
+ * is left to the multiplication of the group, which takes the key half as an
+ * extra point with scalar 1, so that it uses the precomputed multiples of the
+ * generator the group has, if any (see EC_GROUP_precompute_mult()).
+ */
+static int ec_mul_precomp_default(const EC_GROUP *group, EC_POINT *r,
+                                  const BIGNUM *g_scalar,
+                                  const EC_POINT_PRECOMP *pre,
+                                  const BIGNUM *p_scalar, BN_CTX *ctx)
+{
+    EC_POINT *q = NULL, *tmp = NULL;
+    const EC_POINT *points[1];
+    const BIGNUM *scalars[1];
+    int ret = 0;
+
+    if ((q = EC_POINT_new(group)) == NULL
+        || (tmp = EC_POINT_new(group)) == NULL
+        || !EC_POINT_set_to_infinity(group, q)
+        || !ec_precomp_table_add(group, q, pre, p_scalar, tmp, ctx))
+        goto err;
+
+    if (g_scalar == NULL) {
+        ret = EC_POINT_copy(r, q);
+    } else if (EC_POINT_is_at_infinity(group, q)) {
+        ret = ossl_ec_points_mul_public(group, r, g_scalar, 0, NULL, NULL,
+                                        ctx);
+    } else {
+        points[0] = q;
+        scalars[0] = BN_value_one();
+        ret = ossl_ec_points_mul_public(group, r, g_scalar, 1, points,
+                                        scalars, ctx);
+    }
+
+ err:
+    EC_POINT_free(q);
+    EC_POINT_free(tmp);
+    return ret;
+}
+
+/*
+ * Builds a fixed-base table for |point|, which is expected to be a long-lived
+ * public value such as the public key of a trusted signer.
+ */
+EC_POINT_PRECOMP *ossl_ec_point_precomp_new(const EC_GROUP *group,
+                                            const EC_POINT *point,
+                                            BN_CTX *ctx)
+{
+    EC_POINT_PRECOMP *pre;
+    int ret;
+
+    if (!ec_point_is_compat(point, group)) {
+        ERR_raise(ERR_LIB_EC, EC_R_INCOMPATIBLE_OBJECTS);
+        return NULL;
+    }
+    if (EC_POINT_is_at_infinity(group, point)) {
+        ERR_raise(ERR_LIB_EC, EC_R_POINT_AT_INFINITY);
+        return NULL;
+    }
+    if (group->order == NULL || BN_is_zero(group->order)) {
+        ERR_raise(ERR_LIB_EC, EC_R_UNKNOWN_ORDER);
+        return NULL;
+    }
+
+    if ((pre = OPENSSL_zalloc(sizeof(*pre))) == NULL)
+        return NULL;
+    pre->meth = group->meth;
+
+    if (group->meth->point_precompute != NULL)
+        ret = group->meth->point_precompute(group, pre, point, ctx);
+    else
+        ret = ec_point_precompute_default(group, pre, point, ctx);
+    if (!ret) {
+        ossl_ec_point_precomp_free(pre);
+        return NULL;
+    }
+    return pre;
+}
+
+void ossl_ec_point_precomp_free(EC_POINT_PRECOMP *pre)
+{
+    if (pre == NULL)
+        return;
+
+    ec_precomp_table_free(pre->points);
+    OPENSSL_free(pre->table_storage);
+    OPENSSL_free(pre);
+}
+
+/* r = g_scalar * generator + p_scalar * point, where |pre| was built for point */
+int ossl_ec_point_mul_precomp(const EC_GROUP *group, EC_POINT *r,
+                              const BIGNUM *g_scalar,
+                              const EC_POINT_PRECOMP *pre,
+                              const BIGNUM *p_scalar, BN_CTX *ctx)
+{
+    if (!ec_point_is_compat(r, group) || pre->meth != group->meth) {
+        ERR_raise(ERR_LIB_EC, EC_R_INCOMPATIBLE_OBJECTS);
+        return 0;
+    }
+
+    if (group->meth->mul_precomp != NULL)
+        return group->meth->mul_precomp(group, r, g_scalar, pre, p_scalar, ctx);
+    return ec_mul_precomp_default(group, r, g_scalar, pre, p_scalar, ctx);
+}
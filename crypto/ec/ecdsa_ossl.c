@@ -451,6 +451,7 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
     EC_POINT *point = NULL;
     const EC_GROUP *group;
     const EC_POINT *pub_key;
+    const EC_POINT_PRECOMP *pre;
 
     /* check input values */
     if (eckey == NULL || (group = EC_KEY_get0_group(eckey)) == NULL ||
@@ -528,7 +529,13 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
         ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
         goto err;
     }
-    if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)) {
+    /* Use the fixed-base table for the public key, if there is one */
+    if ((pre = ossl_ec_key_get0_public_precomp(eckey)) != NULL) {
+        if (!ossl_ec_point_mul_precomp(group, point, u1, pre, u2, ctx)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
+            goto err;
+        }
+    } else if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)) {
         ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
         goto err;
     }
@@ -603,6 +603,50 @@ __owur static int ecp_nistz256_bignum_to_field_elem(BN_ULONG out[P256_LIMBS],
     return bn_copy_words(out, in, P256_LIMBS);
 }
 
+/*
+ * Writes |scalar|, reduced modulo the group order if it is out of range, to
+ * |out| as a little-endian string of |len| >= 33 bytes.
+ */
+__owur static int ecp_nistz256_scalar_to_bytes(const EC_GROUP *group,
+                                               unsigned char *out, size_t len,
+                                               const BIGNUM *scalar,
+                                               BN_CTX *ctx)
+{
+    size_t j;
+
+    /* This is an unusual input, we don't guarantee constant-timeness. */
+    if ((BN_num_bits(scalar) > 256) || BN_is_negative(scalar)) {
+        BIGNUM *mod;
+
+        if ((mod = BN_CTX_get(ctx)) == NULL)
+            return 0;
+        if (!BN_nnmod(mod, scalar, group->order, ctx)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            return 0;
+        }
+        scalar = mod;
+    }
+
+    for (j = 0; j < (size_t)bn_get_top(scalar) * BN_BYTES; j += BN_BYTES) {
+        BN_ULONG d = bn_get_words(scalar)[j / BN_BYTES];
+
+        out[j + 0] = (unsigned char)d;
+        out[j + 1] = (unsigned char)(d >> 8);
+        out[j + 2] = (unsigned char)(d >> 16);
+        out[j + 3] = (unsigned char)(d >>= 24);
+        if (BN_BYTES == 8) {
+            d >>= 8;
+            out[j + 4] = (unsigned char)d;
+            out[j + 5] = (unsigned char)(d >> 8);
+            out[j + 6] = (unsigned char)(d >> 16);
+            out[j + 7] = (unsigned char)(d >> 24);
+        }
+    }
+    for (; j < len; j++)
+        out[j] = 0;
+    return 1;
+}
+
 /* r = sum(scalar[i]*point[i]) */
 __owur static int ecp_nistz256_windowed_mul(const EC_GROUP *group,
                                             P256_POINT *r,
@@ -611,14 +655,13 @@ __owur static int ecp_nistz256_windowed_mul(const EC_GROUP *group,
                                             size_t num, BN_CTX *ctx)
 {
     size_t i;
-    int j, ret = 0;
+    int ret = 0;
     unsigned int idx;
     unsigned char (*p_str)[33] = NULL;
     const unsigned int window_size = 5;
     const unsigned int mask = (1 << (window_size + 1)) - 1;
     unsigned int wvalue;
     P256_POINT *temp;           /* place for 5 temporary points */
-    const BIGNUM **scalars = NULL;
     P256_POINT (*table)[16] = NULL;
     void *table_storage = NULL;
 
@@ -626,8 +669,7 @@ __owur static int ecp_nistz256_windowed_mul(const EC_GROUP *group,
         || (table_storage =
             OPENSSL_malloc((num * 16 + 5) * sizeof(P256_POINT) + 64)) == NULL
         || (p_str =
-            OPENSSL_malloc(num * 33 * sizeof(unsigned char))) == NULL
-        || (scalars = OPENSSL_malloc(num * sizeof(BIGNUM *))) == NULL)
+            OPENSSL_malloc(num * 33 * sizeof(unsigned char))) == NULL)
         goto err;
 
     table = (void *)ALIGNPTR(table_storage, 64);
@@ -636,37 +678,9 @@ __owur static int ecp_nistz256_windowed_mul(const EC_GROUP *group,
     for (i = 0; i < num; i++) {
         P256_POINT *row = table[i];
 
-        /* This is an unusual input, we don't guarantee constant-timeness. */
-        if ((BN_num_bits(scalar[i]) > 256) || BN_is_negative(scalar[i])) {
-            BIGNUM *mod;
-
-            if ((mod = BN_CTX_get(ctx)) == NULL)
-                goto err;
-            if (!BN_nnmod(mod, scalar[i], group->order, ctx)) {
-                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
-                goto err;
-            }
-            scalars[i] = mod;
-        } else
-            scalars[i] = scalar[i];
-
-        for (j = 0; j < bn_get_top(scalars[i]) * BN_BYTES; j += BN_BYTES) {
-            BN_ULONG d = bn_get_words(scalars[i])[j / BN_BYTES];
-
-            p_str[i][j + 0] = (unsigned char)d;
-            p_str[i][j + 1] = (unsigned char)(d >> 8);
-            p_str[i][j + 2] = (unsigned char)(d >> 16);
-            p_str[i][j + 3] = (unsigned char)(d >>= 24);
-            if (BN_BYTES == 8) {
-                d >>= 8;
-                p_str[i][j + 4] = (unsigned char)d;
-                p_str[i][j + 5] = (unsigned char)(d >> 8);
-                p_str[i][j + 6] = (unsigned char)(d >> 16);
-                p_str[i][j + 7] = (unsigned char)(d >> 24);
-            }
-        }
-        for (; j < 33; j++)
-            p_str[i][j] = 0;
+        if (!ecp_nistz256_scalar_to_bytes(group, p_str[i], sizeof(p_str[i]),
+                                          scalar[i], ctx))
+            goto err;
 
         if (!ecp_nistz256_bignum_to_field_elem(temp[0].X, point[i]->X)
             || !ecp_nistz256_bignum_to_field_elem(temp[0].Y, point[i]->Y)
@@ -771,7 +785,185 @@ __owur static int ecp_nistz256_windowed_mul(const EC_GROUP *group,
  err:
     OPENSSL_free(table_storage);
     OPENSSL_free(p_str);
-    OPENSSL_free(scalars);
+    return ret;
+}
+
+static int ecp_nistz256_is_infinity(const P256_POINT *p)
+{
+    BN_ULONG z = 0;
+    int i;
+
+    for (i = 0; i < P256_LIMBS; i++)
+        z |= p->Z[i];
+    return z == 0;
+}
+
+/*
+ * Converts |num| > 0 Jacobian points to affine with a single inversion,
+ * using |prod| as scratch space.  Points at infinity become (0, 0), which
+ * ecp_nistz256_point_add_affine() treats as infinity.
+ */
+static void ecp_nistz256_points_to_affine(P256_POINT_AFFINE *out,
+                                          const P256_POINT *in,
+                                          BN_ULONG (*prod)[P256_LIMBS],
+                                          size_t num)
+{
+    BN_ULONG inv[P256_LIMBS], z_inv[P256_LIMBS], z_inv2[P256_LIMBS];
+    const BN_ULONG *z;
+    size_t i;
+
+    /* Montgomery's trick: prod[i] = Z_0 * ... * Z_i */
+    for (i = 0; i < num; i++) {
+        z = ecp_nistz256_is_infinity(&in[i]) ? ONE : in[i].Z;
+        if (i == 0)
+            memcpy(prod[0], z, sizeof(prod[0]));
+        else
+            ecp_nistz256_mul_mont(prod[i], prod[i - 1], z);
+    }
+    ecp_nistz256_mod_inverse(inv, prod[num - 1]);
+
+    for (i = num; i-- > 0;) {
+        z = ecp_nistz256_is_infinity(&in[i]) ? ONE : in[i].Z;
+        if (i > 0) {
+            ecp_nistz256_mul_mont(z_inv, inv, prod[i - 1]);
+            ecp_nistz256_mul_mont(inv, inv, z);
+        } else {
+            memcpy(z_inv, inv, sizeof(z_inv));
+        }
+        if (z == ONE) {
+            memset(&out[i], 0, sizeof(out[i]));
+            continue;
+        }
+        ecp_nistz256_sqr_mont(z_inv2, z_inv);
+        ecp_nistz256_mul_mont(out[i].X, in[i].X, z_inv2);
+        ecp_nistz256_mul_mont(z_inv2, z_inv2, z_inv);
+        ecp_nistz256_mul_mont(out[i].Y, in[i].Y, z_inv2);
+    }
+}
+
+/* Number of points from which ecp_nistz256_points_mul_public() uses Pippenger */
+#define P256_PIPPENGER_THRESHOLD 64
+
+static unsigned int ecp_nistz256_get_window(const unsigned char *str, int pos,
+                                            int c)
+{
+    unsigned int w;
+
+    w = str[pos / 8] | str[pos / 8 + 1] << 8 | (unsigned int)str[pos / 8 + 2] << 16;
+    return (w >> (pos % 8)) & ((1U << c) - 1);
+}
+
+/*
+ * r = sum(scalar[i]*point[i]) with Pippenger's bucket method, see
+ * ec_pippenger_mul() in ec_mult.c.  Unlike ecp_nistz256_windowed_mul() this
+ * is not constant time, so it is only used through
+ * ossl_ec_points_mul_public() for scalars that are known to be public.
+ */
+__owur static int ecp_nistz256_pippenger_mul(const EC_GROUP *group,
+                                             P256_POINT *r,
+                                             const BIGNUM **scalar,
+                                             const EC_POINT **point,
+                                             size_t num, BN_CTX *ctx)
+{
+    size_t i, b, nbuckets;
+    int c, d, half, numwindows, j, ret = 0;
+    unsigned char (*p_str)[35] = NULL;
+    unsigned char *carry = NULL;
+    P256_POINT *jac = NULL, *buckets = NULL, *windows = NULL, *bkt;
+    P256_POINT_AFFINE *aff = NULL;
+    BN_ULONG (*prod)[P256_LIMBS] = NULL;
+    ALIGN32 P256_POINT sum, save, t;
+    ALIGN32 P256_POINT_AFFINE neg;
+    const P256_POINT_AFFINE *a;
+
+    c = ossl_ec_pippenger_window(num, 256);
+    half = 1 << (c - 1);
+    nbuckets = (size_t)half;
+    numwindows = (256 + c) / c;
+
+    if (num > OPENSSL_MALLOC_MAX_NELEMS(P256_POINT)
+        || (p_str = OPENSSL_malloc(num * sizeof(*p_str))) == NULL
+        || (carry = OPENSSL_zalloc(num)) == NULL
+        || (jac = OPENSSL_malloc(num * sizeof(*jac))) == NULL
+        || (prod = OPENSSL_malloc(num * sizeof(*prod))) == NULL
+        || (aff = OPENSSL_malloc(num * sizeof(*aff))) == NULL
+        || (buckets = OPENSSL_malloc(nbuckets * sizeof(*buckets))) == NULL
+        || (windows = OPENSSL_malloc(numwindows * sizeof(*windows))) == NULL)
+        goto err;
+
+    for (i = 0; i < num; i++) {
+        if (!ecp_nistz256_scalar_to_bytes(group, p_str[i], sizeof(p_str[i]),
+                                          scalar[i], ctx))
+            goto err;
+        if (!ecp_nistz256_bignum_to_field_elem(jac[i].X, point[i]->X)
+            || !ecp_nistz256_bignum_to_field_elem(jac[i].Y, point[i]->Y)
+            || !ecp_nistz256_bignum_to_field_elem(jac[i].Z, point[i]->Z)) {
+            ERR_raise(ERR_LIB_EC, EC_R_COORDINATES_OUT_OF_RANGE);
+            goto err;
+        }
+    }
+    ecp_nistz256_points_to_affine(aff, jac, prod, num);
+
+    for (j = 0; j < numwindows; j++) {
+        memset(buckets, 0, nbuckets * sizeof(*buckets));
+
+        for (i = 0; i < num; i++) {
+            d = ecp_nistz256_get_window(p_str[i], j * c, c) + carry[i];
+            carry[i] = d > half;
+            if (carry[i])
+                d -= 1 << c;
+            if (d == 0)
+                continue;
+
+            a = &aff[i];
+            if (d < 0) {
+                memcpy(neg.X, a->X, sizeof(neg.X));
+                ecp_nistz256_neg(neg.Y, a->Y);
+                a = &neg;
+                d = -d;
+            }
+
+            /*
+             * The mixed addition does not handle doubling, which shows up as
+             * a result at infinity and is redone with the full addition.
+             */
+            bkt = &buckets[d - 1];
+            memcpy(&save, bkt, sizeof(save));
+            ecp_nistz256_point_add_affine(bkt, bkt, a);
+            if (ecp_nistz256_is_infinity(bkt)
+                && !ecp_nistz256_is_infinity(&save)) {
+                memcpy(t.X, a->X, sizeof(t.X));
+                memcpy(t.Y, a->Y, sizeof(t.Y));
+                memcpy(t.Z, ONE, sizeof(t.Z));
+                ecp_nistz256_point_add(bkt, &save, &t);
+            }
+        }
+
+        /* windows[j] = sum((b + 1) * buckets[b]) */
+        memset(&sum, 0, sizeof(sum));
+        memset(&windows[j], 0, sizeof(windows[j]));
+        for (b = nbuckets; b-- > 0;) {
+            ecp_nistz256_point_add(&sum, &sum, &buckets[b]);
+            ecp_nistz256_point_add(&windows[j], &windows[j], &sum);
+        }
+    }
+
+    memcpy(r, &windows[numwindows - 1], sizeof(*r));
+    for (j = numwindows - 2; j >= 0; j--) {
+        for (d = 0; d < c; d++)
+            ecp_nistz256_point_double(r, r);
+        ecp_nistz256_point_add(r, r, &windows[j]);
+    }
+    ret = 1;
+
+ err:
+    OPENSSL_free(p_str);
+    OPENSSL_free(carry);
+    OPENSSL_free(jac);
+    OPENSSL_free(prod);
+    OPENSSL_free(aff);
+    OPENSSL_free(buckets);
+    OPENSSL_free(windows);
     return ret;
 }
 
@@ -935,21 +1127,14 @@ __owur static int ecp_nistz256_set_from_affine(EC_POINT *out, const EC_GROUP *gr
     return ret;
 }
 
-/* r = scalar*G + sum(scalars[i]*points[i]) */
-__owur static int ecp_nistz256_points_mul(const EC_GROUP *group,
-                                          EC_POINT *r,
-                                          const BIGNUM *scalar,
-                                          size_t num,
-                                          const EC_POINT *points[],
-                                          const BIGNUM *scalars[], BN_CTX *ctx)
+/* r = scalar * P, where |table| holds the multiples of P */
+__owur static int ecp_nistz256_precomp_mul(const EC_GROUP *group,
+                                           P256_POINT *r,
+                                           const PRECOMP256_ROW *table,
+                                           const BIGNUM *scalar, BN_CTX *ctx)
 {
-    int i = 0, ret = 0, no_precomp_for_generator = 0, p_is_infinity = 0;
+    int i, ret = 0;
     unsigned char p_str[33] = { 0 };
-    const PRECOMP256_ROW *preComputedTable = NULL;
-    const NISTZ256_PRE_COMP *pre_comp = NULL;
-    const EC_POINT *generator = NULL;
-    const BIGNUM **new_scalars = NULL;
-    const EC_POINT **new_points = NULL;
     unsigned int idx = 0;
     const unsigned int window_size = 7;
     const unsigned int mask = (1 << (window_size + 1)) - 1;
@@ -959,6 +1144,124 @@ __owur static int ecp_nistz256_points_mul(const EC_GROUP *group,
         P256_POINT_AFFINE a;
     } t, p;
     BIGNUM *tmp_scalar;
+    BN_ULONG infty;
+
+    memset(&p, 0, sizeof(p));
+    BN_CTX_start(ctx);
+
+    if ((BN_num_bits(scalar) > 256)
+        || BN_is_negative(scalar)) {
+        if ((tmp_scalar = BN_CTX_get(ctx)) == NULL)
+            goto err;
+
+        if (!BN_nnmod(tmp_scalar, scalar, group->order, ctx)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            goto err;
+        }
+        scalar = tmp_scalar;
+    }
+
+    for (i = 0; i < bn_get_top(scalar) * BN_BYTES; i += BN_BYTES) {
+        BN_ULONG d = bn_get_words(scalar)[i / BN_BYTES];
+
+        p_str[i + 0] = (unsigned char)d;
+        p_str[i + 1] = (unsigned char)(d >> 8);
+        p_str[i + 2] = (unsigned char)(d >> 16);
+        p_str[i + 3] = (unsigned char)(d >>= 24);
+        if (BN_BYTES == 8) {
+            d >>= 8;
+            p_str[i + 4] = (unsigned char)d;
+            p_str[i + 5] = (unsigned char)(d >> 8);
+            p_str[i + 6] = (unsigned char)(d >> 16);
+            p_str[i + 7] = (unsigned char)(d >> 24);
+        }
+    }
+
+    for (; i < 33; i++)
+        p_str[i] = 0;
+
+    /* First window */
+    wvalue = (p_str[0] << 1) & mask;
+    idx += window_size;
+
+    wvalue = _booth_recode_w7(wvalue);
+
+    ecp_nistz256_gather_w7(&p.a, table[0], wvalue >> 1);
+
+    ecp_nistz256_neg(p.p.Z, p.p.Y);
+    copy_conditional(p.p.Y, p.p.Z, wvalue & 1);
+
+    /*
+     * Since affine infinity is encoded as (0,0) and
+     * Jacobian is (,,0), we need to harmonize them
+     * by assigning "one" or zero to Z.
+     */
+    infty = (p.p.X[0] | p.p.X[1] | p.p.X[2] | p.p.X[3] |
+             p.p.Y[0] | p.p.Y[1] | p.p.Y[2] | p.p.Y[3]);
+    if (P256_LIMBS == 8)
+        infty |= (p.p.X[4] | p.p.X[5] | p.p.X[6] | p.p.X[7] |
+                  p.p.Y[4] | p.p.Y[5] | p.p.Y[6] | p.p.Y[7]);
+
+    infty = 0 - is_zero(infty);
+    infty = ~infty;
+
+    p.p.Z[0] = ONE[0] & infty;
+    p.p.Z[1] = ONE[1] & infty;
+    p.p.Z[2] = ONE[2] & infty;
+    p.p.Z[3] = ONE[3] & infty;
+    if (P256_LIMBS == 8) {
+        p.p.Z[4] = ONE[4] & infty;
+        p.p.Z[5] = ONE[5] & infty;
+        p.p.Z[6] = ONE[6] & infty;
+        p.p.Z[7] = ONE[7] & infty;
+    }
+
+    for (i = 1; i < 37; i++) {
+        unsigned int off = (idx - 1) / 8;
+        wvalue = p_str[off] | p_str[off + 1] << 8;
+        wvalue = (wvalue >> ((idx - 1) % 8)) & mask;
+        idx += window_size;
+
+        wvalue = _booth_recode_w7(wvalue);
+
+        ecp_nistz256_gather_w7(&t.a, table[i], wvalue >> 1);
+
+        ecp_nistz256_neg(t.p.Z, t.a.Y);
+        copy_conditional(t.a.Y, t.p.Z, wvalue & 1);
+
+        ecp_nistz256_point_add_affine(&p.p, &p.p, &t.a);
+    }
+
+    memcpy(r, &p.p, sizeof(*r));
+    ret = 1;
+
+ err:
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+/*
+ * r = scalar*G + sum(scalars[i]*points[i]), in constant time unless
+ * |scalars_public| is set
+ */
+__owur static int ecp_nistz256_points_mul_int(const EC_GROUP *group,
+                                              EC_POINT *r,
+                                              const BIGNUM *scalar,
+                                              size_t num,
+                                              const EC_POINT *points[],
+                                              const BIGNUM *scalars[],
+                                              int scalars_public, BN_CTX *ctx)
+{
+    int ret = 0, no_precomp_for_generator = 0, p_is_infinity = 0;
+    const PRECOMP256_ROW *preComputedTable = NULL;
+    const NISTZ256_PRE_COMP *pre_comp = NULL;
+    const EC_POINT *generator = NULL;
+    const BIGNUM **new_scalars = NULL;
+    const EC_POINT **new_points = NULL;
+    ALIGN32 union {
+        P256_POINT p;
+        P256_POINT_AFFINE a;
+    } t, p;
 
     if ((num + 1) == 0 || (num + 1) > OPENSSL_MALLOC_MAX_NELEMS(void *)) {
         ERR_raise(ERR_LIB_EC, ERR_R_PASSED_INVALID_ARGUMENT);
@@ -1011,92 +1314,9 @@ __owur static int ecp_nistz256_points_mul(const EC_GROUP *group,
         }
 
         if (preComputedTable) {
-            BN_ULONG infty;
-
-            if ((BN_num_bits(scalar) > 256)
-                || BN_is_negative(scalar)) {
-                if ((tmp_scalar = BN_CTX_get(ctx)) == NULL)
-                    goto err;
-
-                if (!BN_nnmod(tmp_scalar, scalar, group->order, ctx)) {
-                    ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
-                    goto err;
-                }
-                scalar = tmp_scalar;
-            }
-
-            for (i = 0; i < bn_get_top(scalar) * BN_BYTES; i += BN_BYTES) {
-                BN_ULONG d = bn_get_words(scalar)[i / BN_BYTES];
-
-                p_str[i + 0] = (unsigned char)d;
-                p_str[i + 1] = (unsigned char)(d >> 8);
-                p_str[i + 2] = (unsigned char)(d >> 16);
-                p_str[i + 3] = (unsigned char)(d >>= 24);
-                if (BN_BYTES == 8) {
-                    d >>= 8;
-                    p_str[i + 4] = (unsigned char)d;
-                    p_str[i + 5] = (unsigned char)(d >> 8);
-                    p_str[i + 6] = (unsigned char)(d >> 16);
-                    p_str[i + 7] = (unsigned char)(d >> 24);
-                }
-            }
-
-            for (; i < 33; i++)
-                p_str[i] = 0;
-
-            /* First window */
-            wvalue = (p_str[0] << 1) & mask;
-            idx += window_size;
-
-            wvalue = _booth_recode_w7(wvalue);
-
-            ecp_nistz256_gather_w7(&p.a, preComputedTable[0],
-                                   wvalue >> 1);
-
-            ecp_nistz256_neg(p.p.Z, p.p.Y);
-            copy_conditional(p.p.Y, p.p.Z, wvalue & 1);
-
-            /*
-             * Since affine infinity is encoded as (0,0) and
-             * Jacobian is (,,0), we need to harmonize them
-             * by assigning "one" or zero to Z.
-             */
-            infty = (p.p.X[0] | p.p.X[1] | p.p.X[2] | p.p.X[3] |
-                     p.p.Y[0] | p.p.Y[1] | p.p.Y[2] | p.p.Y[3]);
-            if (P256_LIMBS == 8)
-                infty |= (p.p.X[4] | p.p.X[5] | p.p.X[6] | p.p.X[7] |
-                          p.p.Y[4] | p.p.Y[5] | p.p.Y[6] | p.p.Y[7]);
-
-            infty = 0 - is_zero(infty);
-            infty = ~infty;
-
-            p.p.Z[0] = ONE[0] & infty;
-            p.p.Z[1] = ONE[1] & infty;
-            p.p.Z[2] = ONE[2] & infty;
-            p.p.Z[3] = ONE[3] & infty;
-            if (P256_LIMBS == 8) {
-                p.p.Z[4] = ONE[4] & infty;
-                p.p.Z[5] = ONE[5] & infty;
-                p.p.Z[6] = ONE[6] & infty;
-                p.p.Z[7] = ONE[7] & infty;
-            }
-
-            for (i = 1; i < 37; i++) {
-                unsigned int off = (idx - 1) / 8;
-                wvalue = p_str[off] | p_str[off + 1] << 8;
-                wvalue = (wvalue >> ((idx - 1) % 8)) & mask;
-                idx += window_size;
-
-                wvalue = _booth_recode_w7(wvalue);
-
-                ecp_nistz256_gather_w7(&t.a,
-                                       preComputedTable[i], wvalue >> 1);
-
-                ecp_nistz256_neg(t.p.Z, t.a.Y);
-                copy_conditional(t.a.Y, t.p.Z, wvalue & 1);
-
-                ecp_nistz256_point_add_affine(&p.p, &p.p, &t.a);
-            }
+            if (!ecp_nistz256_precomp_mul(group, &p.p, preComputedTable,
+                                          scalar, ctx))
+                goto err;
         } else {
             p_is_infinity = 1;
             no_precomp_for_generator = 1;
@@ -1132,8 +1352,14 @@ __owur static int ecp_nistz256_points_mul(const EC_GROUP *group,
         if (p_is_infinity)
             out = &p.p;
 
-        if (!ecp_nistz256_windowed_mul(group, out, scalars, points, num, ctx))
+        if (scalars_public && num >= P256_PIPPENGER_THRESHOLD) {
+            if (!ecp_nistz256_pippenger_mul(group, out, scalars, points, num,
+                                            ctx))
+                goto err;
+        } else if (!ecp_nistz256_windowed_mul(group, out, scalars, points,
+                                              num, ctx)) {
             goto err;
+        }
 
         if (!p_is_infinity)
             ecp_nistz256_point_add(&p.p, &p.p, out);
@@ -1156,6 +1382,122 @@ err:
     return ret;
 }
 
+__owur static int ecp_nistz256_points_mul(const EC_GROUP *group,
+                                          EC_POINT *r,
+                                          const BIGNUM *scalar,
+                                          size_t num,
+                                          const EC_POINT *points[],
+                                          const BIGNUM *scalars[], BN_CTX *ctx)
+{
+    return ecp_nistz256_points_mul_int(group, r, scalar, num, points, scalars,
+                                       0, ctx);
+}
+
+__owur static int ecp_nistz256_points_mul_public(const EC_GROUP *group,
+                                                 EC_POINT *r,
+                                                 const BIGNUM *scalar,
+                                                 size_t num,
+                                                 const EC_POINT *points[],
+                                                 const BIGNUM *scalars[],
+                                                 BN_CTX *ctx)
+{
+    return ecp_nistz256_points_mul_int(group, r, scalar, num, points, scalars,
+                                       1, ctx);
+}
+
+/*
+ * Builds a table for |point| in the layout of ecp_nistz256_precomputed.  The
+ * multiples are computed in Jacobian coordinates and converted to affine with
+ * a single inversion.
+ */
+__owur static int ecp_nistz256_point_precompute(const EC_GROUP *group,
+                                                EC_POINT_PRECOMP *pre,
+                                                const EC_POINT *point,
+                                                BN_CTX *ctx)
+{
+    const int num = 37 * 64;
+    P256_POINT *jac = NULL, *row;
+    P256_POINT_AFFINE *aff = NULL;
+    BN_ULONG (*prod)[P256_LIMBS] = NULL;
+    PRECOMP256_ROW *table;
+    unsigned char *table_storage = NULL;
+    int i, j, k, ret = 0;
+
+    if ((jac = OPENSSL_malloc(num * sizeof(*jac))) == NULL
+        || (prod = OPENSSL_malloc(num * sizeof(*prod))) == NULL
+        || (aff = OPENSSL_malloc(num * sizeof(*aff))) == NULL
+        || (table_storage =
+            OPENSSL_malloc(num * sizeof(P256_POINT_AFFINE) + 64)) == NULL)
+        goto err;
+    table = (void *)ALIGNPTR(table_storage, 64);
+
+    if (!ecp_nistz256_bignum_to_field_elem(jac[0].X, point->X)
+        || !ecp_nistz256_bignum_to_field_elem(jac[0].Y, point->Y)
+        || !ecp_nistz256_bignum_to_field_elem(jac[0].Z, point->Z)) {
+        ERR_raise(ERR_LIB_EC, EC_R_COORDINATES_OUT_OF_RANGE);
+        goto err;
+    }
+
+    /* jac[64 * j + k] = (k + 1) * 2^(7 * j) * point */
+    for (j = 0; j < 37; j++) {
+        row = jac + 64 * j;
+        if (j > 0)
+            ecp_nistz256_point_double(&row[0], &row[-1]);
+        ecp_nistz256_point_double(&row[1], &row[0]);
+        for (k = 2; k < 64; k++)
+            ecp_nistz256_point_add(&row[k], &row[k - 1], &row[0]);
+    }
+
+    ecp_nistz256_points_to_affine(aff, jac, prod, num);
+    for (i = 0; i < num; i++)
+        ecp_nistz256_scatter_w7(table[i / 64], &aff[i], i % 64);
+
+    pre->table = table;
+    pre->table_storage = table_storage;
+    table_storage = NULL;
+    ret = 1;
+
+ err:
+    OPENSSL_free(jac);
+    OPENSSL_free(prod);
+    OPENSSL_free(aff);
+    OPENSSL_free(table_storage);
+    return ret;
+}
+
+/* r = g_scalar*G + p_scalar*P, where |pre| was built for P */
+__owur static int ecp_nistz256_mul_precomp(const EC_GROUP *group, EC_POINT *r,
+                                           const BIGNUM *g_scalar,
+                                           const EC_POINT_PRECOMP *pre,
+                                           const BIGNUM *p_scalar,
+                                           BN_CTX *ctx)
+{
+    ALIGN32 P256_POINT p, t;
+
+    if (!ecp_nistz256_precomp_mul(group, &p, pre->table, p_scalar, ctx))
+        return 0;
+
+    if (g_scalar != NULL) {
+        if (!ecp_nistz256_points_mul(group, r, g_scalar, 0, NULL, NULL, ctx))
+            return 0;
+        if (!ecp_nistz256_bignum_to_field_elem(t.X, r->X)
+            || !ecp_nistz256_bignum_to_field_elem(t.Y, r->Y)
+            || !ecp_nistz256_bignum_to_field_elem(t.Z, r->Z)) {
+            ERR_raise(ERR_LIB_EC, EC_R_COORDINATES_OUT_OF_RANGE);
+            return 0;
+        }
+        ecp_nistz256_point_add(&p, &p, &t);
+    }
+
+    /* Not constant-time, but we're only operating on the public output. */
+    if (!bn_set_words(r->X, p.X, P256_LIMBS) ||
+        !bn_set_words(r->Y, p.Y, P256_LIMBS) ||
+        !bn_set_words(r->Z, p.Z, P256_LIMBS))
+        return 0;
+    r->Z_is_one = is_one(r->Z) & 1;
+    return 1;
+}
+
 __owur static int ecp_nistz256_get_affine(const EC_GROUP *group,
                                           const EC_POINT *point,
                                           BIGNUM *x, BIGNUM *y, BN_CTX *ctx)
@@ -1627,7 +1969,10 @@ const EC_METHOD *EC_GFp_nistz256_method(void)
         0,                                          /* ladder_pre */
         0,                                          /* ladder_step */
         0,                                          /* ladder_post */
-        ecp_nistz256group_full_init
+        ecp_nistz256group_full_init,
+        ecp_nistz256_point_precompute,
+        ecp_nistz256_mul_precomp,
+        ecp_nistz256_points_mul_public
     };
 
     return &ret;
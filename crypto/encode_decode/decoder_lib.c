@@ -1,5 +1,5 @@
 /*
- * Copyright 2020-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2020-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -23,6 +23,41 @@
 #include "encoder_local.h"
 #include "internal/e_os.h"
 
+/*
+ * Decoding walks the decoder instances of a context, trying each that takes
+ * the current input until one of them decodes it, and repeats that with the
+ * output until an object can be constructed.  Most of the tried decoders
+ * fail, which is costly when many inputs of the same kind are decoded.
+ * The indexes of the decoder instances that decoded the last input are
+ * therefore remembered, in a path that OSSL_DECODER_CTX_new_for_pkey()
+ * shares between all contexts created for the same parameters, and the
+ * next decoding tries those instances first at each level.
+ *
+ * Trying a decoder out of order must not change the result, so a path is
+ * only kept for contexts where a single chain of decoders can match, see
+ * OSSL_DECODER_CTX_new_for_pkey().
+ */
+#define DECODER_PATH_MAX 8
+
+struct ossl_decoder_path_st {
+    CRYPTO_REF_COUNT references;
+    CRYPTO_RWLOCK *lock;
+    size_t len;                  /* 0 if nothing was learned yet */
+    size_t insts[DECODER_PATH_MAX];
+    /* Bit n is set if the input structure was checked before level n + 1 */
+    unsigned int checked;
+};
+
+/* The path tried first and the one taken by a single decoding */
+typedef struct {
+    size_t hint_len;
+    size_t hint[DECODER_PATH_MAX];
+    unsigned int hint_checked;
+    size_t found_len;
+    size_t found[DECODER_PATH_MAX];
+    unsigned int found_checked;
+} DECODER_PATH_DATA;
+
 struct decoder_process_data_st {
     OSSL_DECODER_CTX *ctx;
 
@@ -33,6 +68,8 @@ struct decoder_process_data_st {
     size_t current_decoder_inst_index;
     /* For tracing, count recursion level */
     size_t recursion;
+    /* Shared by all levels */
+    DECODER_PATH_DATA *path;
 
     /*-
      * Flags
@@ -40,13 +77,101 @@ struct decoder_process_data_st {
     unsigned int flag_next_level_called : 1;
     unsigned int flag_construct_called : 1;
     unsigned int flag_input_structure_checked : 1;
+    /* Set if all decoders so far were those of the learned path */
+    unsigned int flag_on_path : 1;
 };
 
 static int decoder_process(const OSSL_PARAM params[], void *arg);
 
+OSSL_DECODER_PATH *ossl_decoder_path_new(void)
+{
+    OSSL_DECODER_PATH *path = OPENSSL_zalloc(sizeof(*path));
+
+    if (path == NULL)
+        return NULL;
+    if (!CRYPTO_NEW_REF(&path->references, 1)) {
+        OPENSSL_free(path);
+        return NULL;
+    }
+    if ((path->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        CRYPTO_FREE_REF(&path->references);
+        OPENSSL_free(path);
+        return NULL;
+    }
+    return path;
+}
+
+int ossl_decoder_path_up_ref(OSSL_DECODER_PATH *path)
+{
+    int ref = 0;
+
+    return CRYPTO_UP_REF(&path->references, &ref);
+}
+
+void ossl_decoder_path_free(OSSL_DECODER_PATH *path)
+{
+    int ref = 0;
+
+    if (path == NULL)
+        return;
+    CRYPTO_DOWN_REF(&path->references, &ref);
+    if (ref > 0)
+        return;
+    CRYPTO_THREAD_lock_free(path->lock);
+    CRYPTO_FREE_REF(&path->references);
+    OPENSSL_free(path);
+}
+
+static void decoder_path_get(OSSL_DECODER_PATH *path, DECODER_PATH_DATA *data)
+{
+    if (path == NULL || !CRYPTO_THREAD_read_lock(path->lock))
+        return;
+    data->hint_len = path->len;
+    memcpy(data->hint, path->insts, path->len * sizeof(*path->insts));
+    data->hint_checked = path->checked;
+    CRYPTO_THREAD_unlock(path->lock);
+}
+
+/*
+ * Stores the path that was taken if it differs from the learned one.  In the
+ * common case nothing changed since decoder_path_get() and no lock is taken;
+ * otherwise the path is checked again, as another thread may have stored the
+ * same one in between.
+ */
+static void decoder_path_set(OSSL_DECODER_PATH *path,
+                             const DECODER_PATH_DATA *data)
+{
+    size_t len = data->found_len * sizeof(*data->found);
+
+    if (path == NULL || data->found_len == 0
+            || (data->found_len == data->hint_len
+                && data->found_checked == data->hint_checked
+                && memcmp(data->found, data->hint, len) == 0)
+            || !CRYPTO_THREAD_write_lock(path->lock))
+        return;
+    if (path->len != data->found_len
+            || path->checked != data->found_checked
+            || memcmp(path->insts, data->found, len) != 0) {
+        path->len = data->found_len;
+        path->checked = data->found_checked;
+        memcpy(path->insts, data->found, len);
+    }
+    CRYPTO_THREAD_unlock(path->lock);
+}
+
+static void decoder_count(OSSL_DECODER *decoder, int failed)
+{
+    uint64_t tmp;
+
+    CRYPTO_atomic_add64(&decoder->attempts, 1, &tmp, decoder->stats_lock);
+    if (failed)
+        CRYPTO_atomic_add64(&decoder->failures, 1, &tmp, decoder->stats_lock);
+}
+
 int OSSL_DECODER_from_bio(OSSL_DECODER_CTX *ctx, BIO *in)
 {
     struct decoder_process_data_st data;
+    DECODER_PATH_DATA path;
     int ok = 0;
     BIO *new_bio = NULL;
     unsigned long lasterr;
@@ -75,11 +200,17 @@ int OSSL_DECODER_from_bio(OSSL_DECODER_CTX *ctx, BIO *in)
     memset(&data, 0, sizeof(data));
     data.ctx = ctx;
     data.bio = in;
+    memset(&path, 0, sizeof(path));
+    decoder_path_get(ctx->path, &path);
+    data.path = &path;
+    data.flag_on_path = path.hint_len > 0;
 
     /* Enable passphrase caching */
     (void)ossl_pw_enable_passphrase_caching(&ctx->pwdata);
 
     ok = decoder_process(NULL, &data);
+    if (ok && data.flag_construct_called)
+        decoder_path_set(ctx->path, &path);
 
     if (!data.flag_construct_called) {
         const char *spaces
@@ -717,7 +848,7 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
     OSSL_CORE_BIO *cbio = NULL;
     BIO *bio = data->bio;
     long loc;
-    size_t i;
+    size_t i, j, hint;
     int ok = 0;
     /* For recursions */
     struct decoder_process_data_st new_data;
@@ -733,6 +864,7 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
     memset(&new_data, 0, sizeof(new_data));
     new_data.ctx = data->ctx;
     new_data.recursion = data->recursion + 1;
+    new_data.path = data->path;
 
 #define LEVEL_STR ">>>>>>>>>>>>>>>>"
 #define LEVEL (new_data.recursion < sizeof(LEVEL_STR)                   \
@@ -782,6 +914,9 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
             ok = (rv > 0);
             if (ok) {
                 data->flag_construct_called = 1;
+                /* The decoders of the levels above complete the path */
+                data->path->found_len
+                    = data->recursion <= DECODER_PATH_MAX ? data->recursion : 0;
                 goto end;
             }
         }
@@ -858,17 +993,38 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
         goto end;
     }
 
-    for (i = data->current_decoder_inst_index; i-- > 0;) {
-        OSSL_DECODER_INSTANCE *new_decoder_inst =
-            sk_OSSL_DECODER_INSTANCE_value(ctx->decoder_insts, i);
-        OSSL_DECODER *new_decoder =
-            OSSL_DECODER_INSTANCE_get_decoder(new_decoder_inst);
-        void *new_decoderctx =
-            OSSL_DECODER_INSTANCE_get_decoder_ctx(new_decoder_inst);
-        const char *new_input_type =
-            OSSL_DECODER_INSTANCE_get_input_type(new_decoder_inst);
+    /*
+     * If the decoders so far are those of the learned path, its decoder for
+     * this level is tried first, as if it came before all others, and then
+     * skipped in the normal order.  Without a hint, |hint| is out of range.
+     * The hinted decoder passed the checks below when the path was learned.
+     * The input structure check is not repeated for it, as that check is
+     * only done once per level and would then skip decoders that the normal
+     * order tries; the state it left for the next level is taken from the
+     * path instead.
+     */
+    hint = data->current_decoder_inst_index;
+    if (data->flag_on_path && data->recursion < data->path->hint_len
+            && data->path->hint[data->recursion] < hint)
+        hint = data->path->hint[data->recursion];
+
+    for (j = data->current_decoder_inst_index
+             + (hint < data->current_decoder_inst_index); j-- > 0;) {
+        OSSL_DECODER_INSTANCE *new_decoder_inst;
+        OSSL_DECODER *new_decoder;
+        void *new_decoderctx;
+        const char *new_input_type;
         int n_i_s_was_set = 0;   /* We don't care here */
-        const char *new_input_structure =
+        const char *new_input_structure;
+
+        if (j == hint)
+            continue;
+        i = j == data->current_decoder_inst_index ? hint : j;
+        new_decoder_inst = sk_OSSL_DECODER_INSTANCE_value(ctx->decoder_insts, i);
+        new_decoder = OSSL_DECODER_INSTANCE_get_decoder(new_decoder_inst);
+        new_decoderctx = OSSL_DECODER_INSTANCE_get_decoder_ctx(new_decoder_inst);
+        new_input_type = OSSL_DECODER_INSTANCE_get_input_type(new_decoder_inst);
+        new_input_structure =
             OSSL_DECODER_INSTANCE_get_input_structure(new_decoder_inst,
                                                       &n_i_s_was_set);
 
@@ -951,7 +1107,8 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
          * decoder_process() calls, check that it matches the user provided
          * input structure, if one is given.
          */
-        if (!data->flag_input_structure_checked
+        if (i != hint
+            && !data->flag_input_structure_checked
             && ctx->input_structure != NULL
             && new_input_structure != NULL) {
             data->flag_input_structure_checked = 1;
@@ -995,13 +1152,20 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
         ERR_set_mark();
 
         new_data.current_decoder_inst_index = i;
-        new_data.flag_input_structure_checked
-            = data->flag_input_structure_checked;
+        if (i == hint)
+            new_data.flag_input_structure_checked
+                = (data->path->hint_checked >> data->recursion) & 1;
+        else
+            new_data.flag_input_structure_checked
+                = data->flag_input_structure_checked;
+        new_data.flag_on_path = i == hint;
+        new_data.flag_next_level_called = 0;
         ok = new_decoder->decode(new_decoderctx, cbio,
                                  new_data.ctx->selection,
                                  decoder_process, &new_data,
                                  ossl_pw_passphrase_callback_dec,
                                  &new_data.ctx->pwdata);
+        decoder_count(new_decoder, !ok || !new_data.flag_next_level_called);
 
         OSSL_TRACE_BEGIN(DECODER) {
             BIO_printf(trc_out,
@@ -1018,6 +1182,13 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
         /* Break on error or if we tried to construct an object already */
         if (!ok || data->flag_construct_called) {
             ERR_clear_last_mark();
+            if (ok && data->recursion < DECODER_PATH_MAX) {
+                data->path->found[data->recursion] = i;
+                if (new_data.flag_input_structure_checked)
+                    data->path->found_checked |= 1U << data->recursion;
+                else
+                    data->path->found_checked &= ~(1U << data->recursion);
+            }
             break;
         }
         ERR_pop_to_mark();
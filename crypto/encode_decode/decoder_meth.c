@@ -35,6 +35,10 @@ static OSSL_DECODER *ossl_decoder_new(void)
         OSSL_DECODER_free(decoder);
         return NULL;
     }
+    if ((decoder->stats_lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OSSL_DECODER_free(decoder);
+        return NULL;
+    }
 
     return decoder;
 }
@@ -60,6 +64,7 @@ void OSSL_DECODER_free(OSSL_DECODER *decoder)
     OPENSSL_free(decoder->base.name);
     ossl_property_free(decoder->base.parsed_propdef);
     ossl_provider_free(decoder->base.prov);
+    CRYPTO_THREAD_lock_free(decoder->stats_lock);
     CRYPTO_FREE_REF(&decoder->base.refcnt);
     OPENSSL_free(decoder);
 }
@@ -598,6 +603,24 @@ int OSSL_DECODER_get_params(OSSL_DECODER *decoder, OSSL_PARAM params[])
     return 0;
 }
 
+int OSSL_DECODER_get_stats(OSSL_DECODER *decoder, uint64_t *attempts,
+                           uint64_t *failures)
+{
+    if (decoder == NULL) {
+        ERR_raise(ERR_LIB_OSSL_DECODER, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if (attempts != NULL
+            && !CRYPTO_atomic_load(&decoder->attempts, attempts,
+                                   decoder->stats_lock))
+        return 0;
+    if (failures != NULL
+            && !CRYPTO_atomic_load(&decoder->failures, failures,
+                                   decoder->stats_lock))
+        return 0;
+    return 1;
+}
+
 const OSSL_PARAM *
 OSSL_DECODER_settable_ctx_params(OSSL_DECODER *decoder)
 {
@@ -667,6 +690,7 @@ void OSSL_DECODER_CTX_free(OSSL_DECODER_CTX *ctx)
         sk_OSSL_DECODER_INSTANCE_pop_free(ctx->decoder_insts,
                                           ossl_decoder_instance_free);
         ossl_pw_clear_passphrase_data(&ctx->pwdata);
+        ossl_decoder_path_free(ctx->path);
         OPENSSL_free(ctx);
     }
 }
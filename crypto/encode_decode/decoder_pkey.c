@@ -574,6 +574,10 @@ ossl_decoder_ctx_for_pkey_dup(OSSL_DECODER_CTX *src,
         goto err;
     }
 
+    /* Share what decoding with this template has learned */
+    if (src->path != NULL && ossl_decoder_path_up_ref(src->path))
+        dest->path = src->path;
+
     return dest;
  err:
     if (process_data_dest != NULL) {
@@ -842,6 +846,15 @@ OSSL_DECODER_CTX_new_for_pkey(EVP_PKEY **pkey,
         }
         newcache->selection = selection;
         newcache->template = ctx;
+        /*
+         * Without a path decoding just doesn't get faster over time.  With
+         * the input type, structure or key type left open, several chains of
+         * decoders may decode the same input, and trying the last one first
+         * could give a different result than the usual order, so nothing is
+         * learned then.
+         */
+        if (input_type != NULL && input_structure != NULL && keytype != NULL)
+            ctx->path = ossl_decoder_path_new();
 
         if (!CRYPTO_THREAD_write_lock(cache->lock)) {
             ctx = NULL;
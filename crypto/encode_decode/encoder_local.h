@@ -41,6 +41,8 @@ struct ossl_encoder_st {
     OSSL_FUNC_encoder_free_object_fn *free_object;
 };
 
+typedef struct ossl_decoder_path_st OSSL_DECODER_PATH;
+
 struct ossl_decoder_st {
     struct ossl_endecode_base_st base;
     OSSL_FUNC_decoder_newctx_fn *newctx;
@@ -52,6 +54,11 @@ struct ossl_decoder_st {
     OSSL_FUNC_decoder_does_selection_fn *does_selection;
     OSSL_FUNC_decoder_decode_fn *decode;
     OSSL_FUNC_decoder_export_object_fn *export_object;
+
+    /* Number of decode calls, and of those that decoded nothing */
+    CRYPTO_RWLOCK *stats_lock;
+    uint64_t attempts;
+    uint64_t failures;
 };
 
 struct ossl_encoder_instance_st {
@@ -156,8 +163,18 @@ struct ossl_decoder_ctx_st {
 
     /* For any function that needs a passphrase reader */
     struct ossl_passphrase_data_st pwdata;
+
+    /*
+     * The decoder instances that decoded the last input, shared with the
+     * contexts duplicated from the same template.  May be NULL.
+     */
+    OSSL_DECODER_PATH *path;
 };
 
+OSSL_DECODER_PATH *ossl_decoder_path_new(void);
+int ossl_decoder_path_up_ref(OSSL_DECODER_PATH *path);
+void ossl_decoder_path_free(OSSL_DECODER_PATH *path);
+
 const OSSL_PROPERTY_LIST *
 ossl_decoder_parsed_properties(const OSSL_DECODER *decoder);
 const OSSL_PROPERTY_LIST *
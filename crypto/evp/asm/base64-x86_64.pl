@@ -0,0 +1,199 @@
+#! /usr/bin/env perl
+# Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+#
+# Base64 decoding of a block of 64 characters of the standard alphabet
+# with AVX2, after W. Mula and D. Lemire, "Faster Base64 Encoding and
+# Decoding using AVX2 Instructions", ACM Transactions on the Web 12(3),
+# 2018.
+#
+# int ossl_base64_decode_64_avx2(unsigned char *out,
+#                                const unsigned char *in);
+#
+# Decodes the 64 characters at |in| into 48 bytes at |out| and returns 1
+# if they are all base64 characters other than '='. Otherwise returns 0
+# and leaves |out| unchanged. All of |in| is read before |out| is written,
+# so |out| may overlap |in| as long as it does not come after it. If the
+# assembler does not support AVX2 the function always returns 0 and the
+# caller falls back to its own code.
+#
+# The input is handled as two vectors of 32 characters. The high and low
+# nibbles of each character select bit masks from two tables whose AND is
+# zero for exactly the 64 characters of the alphabet, and the high nibble
+# selects the offset that turns the character into its 6 bit value. Two
+# multiply-adds then pack every 4 values into 3 bytes.
+#
+# 'openssl speed base64-decode' with 8192 byte chunks decodes 2.5-3.5GB/s
+# with this code and 0.4-0.65GB/s with the C code on an AVX-512 capable
+# Xeon virtual machine, i.e. about 5 times as fast. Below 64 characters per
+# call the C code is used in either case.
+#
+
+# $output is the last argument if it looks like a file (it has an extension)
+# $flavour is the first argument if it doesn't look like a file
+$output = $#ARGV >= 0 && $ARGV[$#ARGV] =~ m|\.\w+$| ? pop : undef;
+$flavour = $#ARGV >= 0 && $ARGV[0] !~ m|\.| ? shift : undef;
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.19) + ($1>=2.22);
+}
+
+if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.09) + ($1>=2.10);
+}
+
+if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
+	   `ml64 2>&1` =~ /Version ([0-9]+)\./) {
+	$avx = ($1>=10) + ($1>=11);
+}
+
+if (!$avx && `$ENV{CC} -v 2>&1` =~ /((?:clang|LLVM) version|.*based on LLVM) ([0-9]+\.[0-9]+)/) {
+	$avx = ($2>=3.0) + ($2>3.0);
+}
+
+open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\""
+    or die "can't call $xlate: $!";
+*STDOUT=*OUT;
+
+($out,$inp)=("%rdi","%rsi");
+
+if ($avx>1) {{{
+# Only %ymm0-5 are used, so nothing needs saving on Win64
+my ($in0,$in1,$lut0,$lut1,$t0,$t1)=map("%ymm$_",(0..5));
+
+$code.=<<___;
+.text
+
+.globl	ossl_base64_decode_64_avx2
+.type	ossl_base64_decode_64_avx2,\@function,2
+.align	32
+ossl_base64_decode_64_avx2:
+.cfi_startproc
+	endbranch
+	vmovdqu		($inp),$in0
+	vmovdqu		32($inp),$in1
+	vmovdqa		.Llut_lo(%rip),$lut0
+	vmovdqa		.Llut_hi(%rip),$lut1
+
+	# Check that all characters are in the alphabet
+	vpsrld		\$4,$in0,$t0
+	vpand		.Lmask_2f(%rip),$t0,$t0
+	vpand		.Lmask_2f(%rip),$in0,$t1
+	vpshufb		$t0,$lut1,$t0
+	vpshufb		$t1,$lut0,$t1
+	vptest		$t0,$t1
+	jnz		.Linvalid
+
+	vpsrld		\$4,$in1,$t0
+	vpand		.Lmask_2f(%rip),$t0,$t0
+	vpand		.Lmask_2f(%rip),$in1,$t1
+	vpshufb		$t0,$lut1,$t0
+	vpshufb		$t1,$lut0,$t1
+	vptest		$t0,$t1
+	jnz		.Linvalid
+
+	vmovdqa		.Llut_roll(%rip),$lut0
+	vmovdqa		.Lpermd(%rip),$lut1
+___
+for my $in ($in0,$in1) {
+$code.=<<___;
+
+	# Map the characters to their values, '/' is the odd one out in
+	# its row
+	vpsrld		\$4,$in,$t0
+	vpand		.Lmask_2f(%rip),$t0,$t0
+	vpcmpeqb	.Lmask_2f(%rip),$in,$t1
+	vpaddb		$t1,$t0,$t0
+	vpshufb		$t0,$lut0,$t0
+	vpaddb		$t0,$in,$in
+
+	# Pack 4 values of 6 bits into 3 bytes at the bottom of each lane
+	vpmaddubsw	.Lmerge_ab_bc(%rip),$in,$in
+	vpmaddwd	.Lmerge_abc(%rip),$in,$in
+	vpshufb		.Lshuffle(%rip),$in,$in
+	vpermd		$in,$lut1,$in
+___
+}
+$code.=<<___;
+
+	# Only the bytes decoded are stored
+	vmovdqu		%xmm0,($out)
+	vextracti128	\$1,$in0,%xmm4
+	vmovq		%xmm4,16($out)
+	vmovdqu		%xmm1,24($out)
+	vextracti128	\$1,$in1,%xmm5
+	vmovq		%xmm5,40($out)
+	vzeroupper
+	mov		\$1,%eax
+	ret
+
+.Linvalid:
+	vzeroupper
+	xor		%eax,%eax
+	ret
+.cfi_endproc
+.size	ossl_base64_decode_64_avx2,.-ossl_base64_decode_64_avx2
+
+.section .rodata align=64
+.align	32
+.Llut_lo:
+	.byte	0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11
+	.byte	0x11,0x11,0x13,0x1a,0x1b,0x1b,0x1b,0x1a
+	.byte	0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11
+	.byte	0x11,0x11,0x13,0x1a,0x1b,0x1b,0x1b,0x1a
+.Llut_hi:
+	.byte	0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08
+	.byte	0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10
+	.byte	0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08
+	.byte	0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10
+.Llut_roll:
+	.byte	0,16,19,4,0xbf,0xbf,0xb9,0xb9,0,0,0,0,0,0,0,0
+	.byte	0,16,19,4,0xbf,0xbf,0xb9,0xb9,0,0,0,0,0,0,0,0
+.Lmask_2f:
+	.long	0x2f2f2f2f,0x2f2f2f2f,0x2f2f2f2f,0x2f2f2f2f
+	.long	0x2f2f2f2f,0x2f2f2f2f,0x2f2f2f2f,0x2f2f2f2f
+.Lmerge_ab_bc:
+	.long	0x01400140,0x01400140,0x01400140,0x01400140
+	.long	0x01400140,0x01400140,0x01400140,0x01400140
+.Lmerge_abc:
+	.long	0x00011000,0x00011000,0x00011000,0x00011000
+	.long	0x00011000,0x00011000,0x00011000,0x00011000
+.Lshuffle:
+	.byte	2,1,0,6,5,4,10,9,8,14,13,12,0xff,0xff,0xff,0xff
+	.byte	2,1,0,6,5,4,10,9,8,14,13,12,0xff,0xff,0xff,0xff
+.Lpermd:
+	.long	0,1,2,4,5,6,7,7
+.asciz	"Base64 decoding with AVX2"
+___
+}}} else {{{
+$code.=<<___;	# assembler is too old
+.text
+
+.globl	ossl_base64_decode_64_avx2
+.type	ossl_base64_decode_64_avx2,\@abi-omnipotent
+ossl_base64_decode_64_avx2:
+.cfi_startproc
+	endbranch
+	xor	%eax,%eax
+	ret
+.cfi_endproc
+.size	ossl_base64_decode_64_avx2,.-ossl_base64_decode_64_avx2
+___
+}}}
+
+print $code;
+close STDOUT or die "error closing STDOUT: $!";
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -14,6 +14,17 @@
 #include "crypto/evp.h"
 #include "evp_local.h"
 
+/*
+ * Assembler version of evp_decodeblock_64() for the standard alphabet, see
+ * asm/base64-x86_64.pl
+ */
+#if defined(BASE64_ASM) && (defined(__x86_64) || defined(__x86_64__) \
+                            || defined(_M_AMD64) || defined(_M_X64))
+int ossl_base64_decode_64_avx2(unsigned char *t, const unsigned char *f);
+# define BASE64_DECODE_64_CAPABLE   ((OPENSSL_ia32cap_P[2] & (1 << 5)) != 0)
+# define BASE64_DECODE_64           ossl_base64_decode_64_avx2
+#endif
+
 static unsigned char conv_ascii2bin(unsigned char a,
                                     const unsigned char *table);
 static int evp_encodeblock_int(EVP_ENCODE_CTX *ctx, unsigned char *t,
@@ -240,27 +251,29 @@ static int evp_encodeblock_int(EVP_ENCODE_CTX *ctx, unsigned char *t,
     else
         table = data_bin2ascii;
 
-    for (i = dlen; i > 0; i -= 3) {
-        if (i >= 3) {
-            l = (((unsigned long)f[0]) << 16L) |
-                (((unsigned long)f[1]) << 8L) | f[2];
-            *(t++) = conv_bin2ascii(l >> 18L, table);
-            *(t++) = conv_bin2ascii(l >> 12L, table);
-            *(t++) = conv_bin2ascii(l >> 6L, table);
-            *(t++) = conv_bin2ascii(l, table);
-        } else {
-            l = ((unsigned long)f[0]) << 16L;
-            if (i == 2)
-                l |= ((unsigned long)f[1] << 8L);
-
-            *(t++) = conv_bin2ascii(l >> 18L, table);
-            *(t++) = conv_bin2ascii(l >> 12L, table);
-            *(t++) = (i == 1) ? '=' : conv_bin2ascii(l >> 6L, table);
-            *(t++) = '=';
-        }
-        ret += 4;
+    /* Whole groups of 3 bytes first, so that the loop has no branches */
+    for (i = dlen; i >= 3; i -= 3) {
+        l = (((unsigned long)f[0]) << 16L) |
+            (((unsigned long)f[1]) << 8L) | f[2];
+        t[0] = conv_bin2ascii(l >> 18L, table);
+        t[1] = conv_bin2ascii(l >> 12L, table);
+        t[2] = conv_bin2ascii(l >> 6L, table);
+        t[3] = conv_bin2ascii(l, table);
+        t += 4;
         f += 3;
     }
+    ret = (dlen - i) / 3 * 4;
+    if (i > 0) {
+        l = ((unsigned long)f[0]) << 16L;
+        if (i == 2)
+            l |= ((unsigned long)f[1] << 8L);
+
+        *(t++) = conv_bin2ascii(l >> 18L, table);
+        *(t++) = conv_bin2ascii(l >> 12L, table);
+        *(t++) = (i == 1) ? '=' : conv_bin2ascii(l >> 6L, table);
+        *(t++) = '=';
+        ret += 4;
+    }
 
     *t = '\0';
     return ret;
@@ -280,6 +293,41 @@ void EVP_DecodeInit(EVP_ENCODE_CTX *ctx)
     ctx->flags = 0;
 }
 
+/*
+ * Decodes the 64 characters at |f| into 48 bytes at |t| if they are all
+ * base64 characters other than '='.  Returns 1 on success and 0, leaving |t|
+ * unchanged, otherwise.  |t| may overlap |f| as long as it does not come
+ * after it.
+ */
+static int evp_decodeblock_64(unsigned char *t, const unsigned char *f,
+                              const unsigned char *table)
+{
+    unsigned char buf[48], *p = buf;
+    unsigned int a, b, c, d;
+    int i;
+
+#ifdef BASE64_DECODE_64_CAPABLE
+    if (table == data_ascii2bin && BASE64_DECODE_64_CAPABLE)
+        return BASE64_DECODE_64(t, f);
+#endif
+
+    for (i = 0; i < 64; i += 4, f += 4, p += 3) {
+        a = conv_ascii2bin(f[0], table);
+        b = conv_ascii2bin(f[1], table);
+        c = conv_ascii2bin(f[2], table);
+        d = conv_ascii2bin(f[3], table);
+        /* Padding maps to 0 in the tables, so it is checked separately */
+        if (((a | b | c | d) & 0xC0) != 0
+                || f[0] == '=' || f[1] == '=' || f[2] == '=' || f[3] == '=')
+            return 0;
+        p[0] = (unsigned char)((a << 2) | (b >> 4));
+        p[1] = (unsigned char)((b << 4) | (c >> 2));
+        p[2] = (unsigned char)((c << 6) | d);
+    }
+    memcpy(t, buf, sizeof(buf));
+    return 1;
+}
+
 /*-
  * -1 for error
  *  0 for last line
@@ -328,6 +376,20 @@ int EVP_DecodeUpdate(EVP_ENCODE_CTX *ctx, unsigned char *out, int *outl,
         table = data_ascii2bin;
 
     for (i = 0; i < inl; i++) {
+        /*
+         * A block of 64 base64 characters without padding or whitespace is
+         * decoded straight from the input.  This is what the code below
+         * would do with it, only without saving one character at a time.
+         */
+        if (n == 0 && eof == 0 && inl - i >= 64
+                && evp_decodeblock_64(out, in, table)) {
+            in += 64;
+            i += 63;
+            ret += 48;
+            out += 48;
+            continue;
+        }
+
         tmp = *(in++);
         v = conv_ascii2bin(tmp, table);
         if (v == B64_ERROR) {
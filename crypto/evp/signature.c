@@ -100,6 +100,11 @@ static void *evp_signature_from_algorithm(int name_id,
             signature->sign_message_final
                 = OSSL_FUNC_signature_sign_message_final(fns);
             break;
+        case OSSL_FUNC_SIGNATURE_SIGN_BATCH:
+            if (signature->sign_batch != NULL)
+                break;
+            signature->sign_batch = OSSL_FUNC_signature_sign_batch(fns);
+            break;
         case OSSL_FUNC_SIGNATURE_VERIFY_INIT:
             if (signature->verify_init != NULL)
                 break;
@@ -130,6 +135,11 @@ static void *evp_signature_from_algorithm(int name_id,
             signature->verify_message_final
                 = OSSL_FUNC_signature_verify_message_final(fns);
             break;
+        case OSSL_FUNC_SIGNATURE_VERIFY_BATCH:
+            if (signature->verify_batch != NULL)
+                break;
+            signature->verify_batch = OSSL_FUNC_signature_verify_batch(fns);
+            break;
         case OSSL_FUNC_SIGNATURE_VERIFY_RECOVER_INIT:
             if (signature->verify_recover_init != NULL)
                 break;
@@ -310,7 +320,8 @@ static void *evp_signature_from_algorithm(int name_id,
     if (valid
         && (signature->sign != NULL
             || signature->sign_message_update != NULL
-            || signature->sign_message_final != NULL)
+            || signature->sign_message_final != NULL
+            || signature->sign_batch != NULL)
         && signature->sign_init == NULL
         && signature->sign_message_init == NULL)
         /* signing functions with no sign_init? That's odd */
@@ -328,7 +339,8 @@ static void *evp_signature_from_algorithm(int name_id,
     if (valid
         && (signature->verify != NULL
             || signature->verify_message_update != NULL
-            || signature->verify_message_final != NULL)
+            || signature->verify_message_final != NULL
+            || signature->verify_batch != NULL)
         && signature->verify_init == NULL
         && signature->verify_message_init == NULL)
         /* verification functions with no verify_init? That's odd */
@@ -920,6 +932,66 @@ int EVP_PKEY_sign(EVP_PKEY_CTX *ctx,
         return ctx->pmeth->sign(ctx, sig, siglen, tbs, tbslen);
 }
 
+/*
+ * Signs |n| inputs as EVP_PKEY_sign() would, with a context initialised by
+ * EVP_PKEY_sign_init().  The provider may sign them concurrently.  Not public
+ * until it is shown to pay off for a caller such as libssl.
+ */
+int evp_pkey_sign_batch(EVP_PKEY_CTX *ctx, size_t n,
+                        unsigned char *const *sigs, size_t *siglens,
+                        const unsigned char *const *tbs,
+                        const size_t *tbslens)
+{
+    size_t i;
+
+    if (ctx == NULL || (n > 0 && (sigs == NULL || siglens == NULL
+                                  || tbs == NULL || tbslens == NULL))) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+
+    for (i = 0; i < n; i++)
+        if (sigs[i] == NULL) {
+            ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+            return -1;
+        }
+
+    if (ctx->operation != EVP_PKEY_OP_SIGN) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_INITIALIZED);
+        return -1;
+    }
+
+    if (ctx->op.sig.algctx == NULL)
+        goto legacy;
+
+    if (ctx->op.sig.signature->sign_batch != NULL)
+        return ctx->op.sig.signature->sign_batch(ctx->op.sig.algctx, n,
+                                                 sigs, siglens, tbs, tbslens);
+
+    if (ctx->op.sig.signature->sign == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+
+    for (i = 0; i < n; i++)
+        if (ctx->op.sig.signature->sign(ctx->op.sig.algctx, sigs[i],
+                                        &siglens[i], siglens[i],
+                                        tbs[i], tbslens[i]) <= 0)
+            return 0;
+    return 1;
+ legacy:
+    if (ctx->pmeth == NULL || ctx->pmeth->sign == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+
+    for (i = 0; i < n; i++)
+        if (ctx->pmeth->sign(ctx, sigs[i], &siglens[i],
+                             tbs[i], tbslens[i]) <= 0)
+            return 0;
+    return 1;
+}
+
 int EVP_PKEY_verify_init(EVP_PKEY_CTX *ctx)
 {
     return evp_pkey_signature_init(ctx, NULL, EVP_PKEY_OP_VERIFY, NULL);
@@ -1044,6 +1116,72 @@ int EVP_PKEY_verify(EVP_PKEY_CTX *ctx,
     return ctx->pmeth->verify(ctx, sig, siglen, tbs, tbslen);
 }
 
+int EVP_PKEY_verify_batch(EVP_PKEY_CTX *ctx, size_t n,
+                          const unsigned char *const *sigs,
+                          const size_t *siglens,
+                          const unsigned char *const *tbs,
+                          const size_t *tbslens, int *results)
+{
+    size_t i;
+
+    if (ctx == NULL || (n > 0 && (sigs == NULL || siglens == NULL
+                                  || tbs == NULL || tbslens == NULL
+                                  || results == NULL))) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+
+    if (ctx->operation != EVP_PKEY_OP_VERIFY
+        && ctx->operation != EVP_PKEY_OP_VERIFYMSG) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_INITIALIZED);
+        return -1;
+    }
+
+    if (ctx->op.sig.algctx == NULL)
+        goto legacy;
+
+    if (ctx->op.sig.signature->verify_batch != NULL) {
+        if (!ctx->op.sig.signature->verify_batch(ctx->op.sig.algctx, n,
+                                                 sigs, siglens, tbs, tbslens,
+                                                 results))
+            return -1;
+        goto done;
+    }
+
+    /*
+     * Without a dedicated batch function we can only verify one signature
+     * after the other, and that requires each verification to leave the
+     * context usable for the next.  That's only guaranteed with
+     * EVP_PKEY_verify_init() and friends.
+     */
+    if (ctx->operation != EVP_PKEY_OP_VERIFY
+        || ctx->op.sig.signature->verify == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+
+    for (i = 0; i < n; i++)
+        results[i] = ctx->op.sig.signature->verify(ctx->op.sig.algctx,
+                                                   sigs[i], siglens[i],
+                                                   tbs[i], tbslens[i]) > 0;
+    goto done;
+ legacy:
+    if (ctx->operation != EVP_PKEY_OP_VERIFY
+        || ctx->pmeth == NULL || ctx->pmeth->verify == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+
+    for (i = 0; i < n; i++)
+        results[i] = ctx->pmeth->verify(ctx, sigs[i], siglens[i],
+                                        tbs[i], tbslens[i]) > 0;
+ done:
+    for (i = 0; i < n; i++)
+        if (!results[i])
+            return 0;
+    return 1;
+}
+
 int EVP_PKEY_verify_recover_init(EVP_PKEY_CTX *ctx)
 {
     return evp_pkey_signature_init(ctx, NULL, EVP_PKEY_OP_VERIFYRECOVER, NULL);
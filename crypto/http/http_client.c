@@ -23,6 +23,7 @@
 #include <openssl/trace.h>
 #include "internal/sockets.h"
 #include "internal/common.h" /* for ossl_assert() */
+#include "http_local.h"
 
 #define HTTP_PREFIX "HTTP/"
 #define HTTP_VERSION_PATT "1." /* allow 1.x */
@@ -36,59 +37,6 @@
 #define HTTP_STATUS_CODE_MOVED_PERMANENTLY 301
 #define HTTP_STATUS_CODE_FOUND             302
 
-/* Stateful HTTP request code, supporting blocking and non-blocking I/O */
-
-/* Opaque HTTP request status structure */
-
-struct ossl_http_req_ctx_st {
-    int state;                  /* Current I/O state */
-    unsigned char *buf;         /* Buffer to write request or read response */
-    int buf_size;               /* Buffer size */
-    int free_wbio;              /* wbio allocated internally, free with ctx */
-    BIO *wbio;                  /* BIO to write/send request to */
-    BIO *rbio;                  /* BIO to read/receive response from */
-    OSSL_HTTP_bio_cb_t upd_fn;  /* Optional BIO update callback used for TLS */
-    void *upd_arg;              /* Optional arg for update callback function */
-    int use_ssl;                /* Use HTTPS */
-    char *proxy;                /* Optional proxy name or URI */
-    char *server;               /* Optional server hostname */
-    char *port;                 /* Optional server port */
-    BIO *mem;                   /* Mem BIO holding request header or response */
-    BIO *req;                   /* BIO holding the request provided by caller */
-    int method_POST;            /* HTTP method is POST (else GET) */
-    int text;                   /* Request content type is (likely) text */
-    char *expected_ct;          /* Optional expected Content-Type */
-    int expect_asn1;            /* Response must be ASN.1-encoded */
-    unsigned char *pos;         /* Current position sending data */
-    long len_to_send;           /* Number of bytes still to send */
-    size_t resp_len;            /* Length of response */
-    size_t max_resp_len;        /* Maximum length of response, or 0 */
-    int keep_alive;             /* Persistent conn. 0=no, 1=prefer, 2=require */
-    time_t max_time;            /* Maximum end time of current transfer, or 0 */
-    time_t max_total_time;      /* Maximum end time of total transfer, or 0 */
-    char *redirection_url;      /* Location obtained from HTTP status 301/302 */
-    size_t max_hdr_lines;       /* Max. number of http hdr lines, or 0 */
-};
-
-/* HTTP states */
-
-#define OHS_NOREAD         0x1000 /* If set no reading should be performed */
-#define OHS_ERROR          (0 | OHS_NOREAD) /* Error condition */
-#define OHS_ADD_HEADERS    (1 | OHS_NOREAD) /* Adding header lines to request */
-#define OHS_WRITE_INIT     (2 | OHS_NOREAD) /* 1st call: ready to start send */
-#define OHS_WRITE_HDR1     (3 | OHS_NOREAD) /* Request header to be sent */
-#define OHS_WRITE_HDR      (4 | OHS_NOREAD) /* Request header being sent */
-#define OHS_WRITE_REQ      (5 | OHS_NOREAD) /* Request content being sent */
-#define OHS_FLUSH          (6 | OHS_NOREAD) /* Request being flushed */
-#define OHS_FIRSTLINE       1 /* First line of response being read */
-#define OHS_HEADERS         2 /* MIME headers of response being read */
-#define OHS_HEADERS_ERROR   3 /* MIME headers of resp. being read after error */
-#define OHS_REDIRECT        4 /* MIME headers being read, expecting Location */
-#define OHS_ASN1_HEADER     5 /* ASN1 sequence header (tag+length) being read */
-#define OHS_ASN1_CONTENT    6 /* ASN1 content octets being read */
-#define OHS_ASN1_DONE      (7 | OHS_NOREAD) /* ASN1 content read completed */
-#define OHS_STREAM         (8 | OHS_NOREAD) /* HTTP content stream to be read */
-
 /* Low-level HTTP API implementation */
 
 OSSL_HTTP_REQ_CTX *OSSL_HTTP_REQ_CTX_new(BIO *wbio, BIO *rbio, int buf_size)
@@ -131,6 +79,7 @@ void OSSL_HTTP_REQ_CTX_free(OSSL_HTTP_REQ_CTX *rctx)
     /* do not free rctx->rbio */
     BIO_free(rctx->mem);
     BIO_free(rctx->req);
+    BIO_free(rctx->pending);
     OPENSSL_free(rctx->buf);
     OPENSSL_free(rctx->proxy);
     OPENSSL_free(rctx->server);
@@ -218,6 +167,7 @@ int OSSL_HTTP_REQ_CTX_set_request_line(OSSL_HTTP_REQ_CTX *rctx, int method_POST,
         return 0;
 
     rctx->resp_len = 0;
+    rctx->unanswered = 0;
     rctx->state = OHS_ADD_HEADERS;
     return 1;
 }
@@ -388,12 +338,12 @@ static int add1_headers(OSSL_HTTP_REQ_CTX *rctx,
 }
 
 /* Create OSSL_HTTP_REQ_CTX structure using the values provided. */
-static OSSL_HTTP_REQ_CTX *http_req_ctx_new(int free_wbio, BIO *wbio, BIO *rbio,
-                                           OSSL_HTTP_bio_cb_t bio_update_fn,
-                                           void *arg, int use_ssl,
-                                           const char *proxy,
-                                           const char *server, const char *port,
-                                           int buf_size, int overall_timeout)
+OSSL_HTTP_REQ_CTX *ossl_http_req_ctx_new(int free_wbio, BIO *wbio, BIO *rbio,
+                                         OSSL_HTTP_bio_cb_t bio_update_fn,
+                                         void *arg, int use_ssl,
+                                         const char *proxy,
+                                         const char *server, const char *port,
+                                         int buf_size, int overall_timeout)
 {
     OSSL_HTTP_REQ_CTX *rctx = OSSL_HTTP_REQ_CTX_new(wbio, rbio, buf_size);
 
@@ -537,11 +487,49 @@ static int may_still_retry(time_t max_time, int *ptimeout)
     return 1;
 }
 
+/*
+ * Keep any data following the response of |rctx| in its mem BIO, which can
+ * only be the start of the response to a pipelined request, for that request.
+ */
+static int keep_pending(OSSL_HTTP_REQ_CTX *rctx)
+{
+    const unsigned char *p, *q;
+    long n = BIO_get_mem_data(rctx->mem, &p);
+    long m = 0;
+    BIO *mem, *pending;
+
+    if (n < 0 || (size_t)n <= rctx->resp_len)
+        return 1;
+    if (rctx->pending != NULL)
+        m = BIO_get_mem_data(rctx->pending, &q);
+    if ((mem = BIO_new(BIO_s_mem())) == NULL)
+        return 0;
+    if ((pending = BIO_new(BIO_s_mem())) == NULL
+            || BIO_write(mem, p, (int)rctx->resp_len) != (int)rctx->resp_len
+            || BIO_write(pending, p + rctx->resp_len,
+                         (int)(n - rctx->resp_len)) != (int)(n - rctx->resp_len)
+            || (m > 0 && BIO_write(pending, q, (int)m) != (int)m)) {
+        BIO_free(mem);
+        BIO_free(pending);
+        return 0;
+    }
+    BIO_free(rctx->mem);
+    rctx->mem = mem;
+    BIO_free(rctx->pending);
+    rctx->pending = pending;
+    return 1;
+}
+
 /*
  * Try exchanging request and response via HTTP on (non-)blocking BIO in rctx.
  * Returns 1 on success, 0 on error or redirection, -1 on BIO_should_retry.
  */
 int OSSL_HTTP_REQ_CTX_nbio(OSSL_HTTP_REQ_CTX *rctx)
+{
+    return ossl_http_req_ctx_nbio(rctx, 0);
+}
+
+int ossl_http_req_ctx_nbio(OSSL_HTTP_REQ_CTX *rctx, int send_only)
 {
     int i, found_expected_ct = 0, found_keep_alive = 0;
     int got_text = 1;
@@ -564,7 +552,13 @@ int OSSL_HTTP_REQ_CTX_nbio(OSSL_HTTP_REQ_CTX *rctx)
  next_io:
     buf = (char *)rctx->buf;
     if ((rctx->state & OHS_NOREAD) == 0) {
-        if (rctx->expect_asn1) {
+        if (send_only)
+            return 1;
+        if (rctx->expect_asn1 && rctx->pending != NULL
+                && BIO_ctrl_pending(rctx->pending) > 0) {
+            /* Start with what came with the response to an earlier request */
+            n = BIO_read(rctx->pending, rctx->buf, rctx->buf_size);
+        } else if (rctx->expect_asn1) {
             n = BIO_read(rctx->rbio, rctx->buf, rctx->buf_size);
         } else {
             (void)ERR_set_mark();
@@ -579,6 +573,9 @@ int OSSL_HTTP_REQ_CTX_nbio(OSSL_HTTP_REQ_CTX *rctx)
         if (n <= 0) {
             if (BIO_should_retry(rctx->rbio))
                 return -1;
+            /* The peer closed or reset the connection without responding */
+            rctx->unanswered = rctx->state == OHS_FIRSTLINE
+                && BIO_ctrl_pending(rctx->mem) == 0;
             ERR_raise(ERR_LIB_HTTP, HTTP_R_FAILED_READING_DATA);
             return 0;
         }
@@ -907,6 +904,10 @@ int OSSL_HTTP_REQ_CTX_nbio(OSSL_HTTP_REQ_CTX *rctx)
         if (n < 0 || (size_t)n < rctx->resp_len)
             goto next_io;
 
+        if (!keep_pending(rctx)) {
+            rctx->state = OHS_ERROR;
+            return 0;
+        }
         rctx->state = OHS_ASN1_DONE;
         return 1;
     }
@@ -1086,9 +1087,10 @@ OSSL_HTTP_REQ_CTX *OSSL_HTTP_open(const char *server, const char *port,
         }
     }
 
-    rctx = http_req_ctx_new(bio == NULL, cbio, rbio != NULL ? rbio : cbio,
-                            bio_update_fn, arg, use_ssl, proxy, server, port,
-                            buf_size, overall_timeout);
+    rctx = ossl_http_req_ctx_new(bio == NULL, cbio,
+                                 rbio != NULL ? rbio : cbio,
+                                 bio_update_fn, arg, use_ssl, proxy, server,
+                                 port, buf_size, overall_timeout);
 
  end:
     if (rctx != NULL)
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_CRYPTO_HTTP_LOCAL_H
+# define OSSL_CRYPTO_HTTP_LOCAL_H
+
+# include <time.h>
+# include <openssl/http.h>
+
+/* Stateful HTTP request code, supporting blocking and non-blocking I/O */
+
+/* Opaque HTTP request status structure */
+
+struct ossl_http_req_ctx_st {
+    int state;                  /* Current I/O state */
+    unsigned char *buf;         /* Buffer to write request or read response */
+    int buf_size;               /* Buffer size */
+    int free_wbio;              /* wbio allocated internally, free with ctx */
+    BIO *wbio;                  /* BIO to write/send request to */
+    BIO *rbio;                  /* BIO to read/receive response from */
+    OSSL_HTTP_bio_cb_t upd_fn;  /* Optional BIO update callback used for TLS */
+    void *upd_arg;              /* Optional arg for update callback function */
+    int use_ssl;                /* Use HTTPS */
+    char *proxy;                /* Optional proxy name or URI */
+    char *server;               /* Optional server hostname */
+    char *port;                 /* Optional server port */
+    BIO *mem;                   /* Mem BIO holding request header or response */
+    BIO *req;                   /* BIO holding the request provided by caller */
+    int method_POST;            /* HTTP method is POST (else GET) */
+    int text;                   /* Request content type is (likely) text */
+    char *expected_ct;          /* Optional expected Content-Type */
+    int expect_asn1;            /* Response must be ASN.1-encoded */
+    unsigned char *pos;         /* Current position sending data */
+    long len_to_send;           /* Number of bytes still to send */
+    size_t resp_len;            /* Length of response */
+    size_t max_resp_len;        /* Maximum length of response, or 0 */
+    int keep_alive;             /* Persistent conn. 0=no, 1=prefer, 2=require */
+    time_t max_time;            /* Maximum end time of current transfer, or 0 */
+    time_t max_total_time;      /* Maximum end time of total transfer, or 0 */
+    char *redirection_url;      /* Location obtained from HTTP status 301/302 */
+    size_t max_hdr_lines;       /* Max. number of http hdr lines, or 0 */
+    BIO *pending;               /* Data received after the previous response */
+    int unanswered;             /* Conn. failed before any response data */
+};
+
+/* HTTP states */
+
+# define OHS_NOREAD         0x1000 /* If set no reading should be performed */
+# define OHS_ERROR          (0 | OHS_NOREAD) /* Error condition */
+# define OHS_ADD_HEADERS    (1 | OHS_NOREAD) /* Adding header lines to request */
+# define OHS_WRITE_INIT     (2 | OHS_NOREAD) /* 1st call: ready to start send */
+# define OHS_WRITE_HDR1     (3 | OHS_NOREAD) /* Request header to be sent */
+# define OHS_WRITE_HDR      (4 | OHS_NOREAD) /* Request header being sent */
+# define OHS_WRITE_REQ      (5 | OHS_NOREAD) /* Request content being sent */
+# define OHS_FLUSH          (6 | OHS_NOREAD) /* Request being flushed */
+# define OHS_FIRSTLINE       1 /* First line of response being read */
+# define OHS_HEADERS         2 /* MIME headers of response being read */
+# define OHS_HEADERS_ERROR   3 /* MIME headers of resp. being read after error */
+# define OHS_REDIRECT        4 /* MIME headers being read, expecting Location */
+# define OHS_ASN1_HEADER     5 /* ASN1 sequence header (tag+length) being read */
+# define OHS_ASN1_CONTENT    6 /* ASN1 content octets being read */
+# define OHS_ASN1_DONE      (7 | OHS_NOREAD) /* ASN1 content read completed */
+# define OHS_STREAM         (8 | OHS_NOREAD) /* HTTP content stream to be read */
+
+OSSL_HTTP_REQ_CTX *ossl_http_req_ctx_new(int free_wbio, BIO *wbio, BIO *rbio,
+                                         OSSL_HTTP_bio_cb_t bio_update_fn,
+                                         void *arg, int use_ssl,
+                                         const char *proxy,
+                                         const char *server, const char *port,
+                                         int buf_size, int overall_timeout);
+/*
+ * Like OSSL_HTTP_REQ_CTX_nbio(), but if |send_only| is set return 1 as soon
+ * as the request has been sent, without reading the response.
+ */
+int ossl_http_req_ctx_nbio(OSSL_HTTP_REQ_CTX *rctx, int send_only);
+
+#endif
@@ -0,0 +1,647 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/e_os.h"
+#include <string.h>
+#include <openssl/http.h>
+#include <openssl/httperr.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/crypto.h>
+#include "internal/sockets.h"
+#include "http_local.h"
+
+#define HTTP_POOL_DEFAULT_MAX_IDLE 16
+
+/*
+ * Wait at most |timeout_ms| milliseconds, or without limit if it is negative,
+ * until one of the |num| sockets in |desc| is ready for the OSSL_HTTP_POLL_IN
+ * and OSSL_HTTP_POLL_OUT conditions given in |events|.
+ * Returns the number of sockets ready, 0 on timeout, or -1 on error.
+ */
+static int wait_sockets(const BIO_POLL_DESCRIPTOR *desc, const int *events,
+                        size_t num, int timeout_ms)
+{
+#ifdef OPENSSL_NO_SOCK
+    if (num > 0) {
+        ERR_raise(ERR_LIB_HTTP, HTTP_R_SOCK_NOT_SUPPORTED);
+        return -1;
+    }
+    OSSL_sleep(timeout_ms < 0 ? 0 : (uint64_t)timeout_ms);
+    return 0;
+#elif defined(OPENSSL_SYS_WINDOWS) || !defined(POLLIN)
+    fd_set rfds, wfds;
+    struct timeval tv;
+    int maxfd = -1;
+    size_t i;
+
+    FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+    for (i = 0; i < num; i++) {
+        int fd = desc[i].value.fd;
+
+# ifndef OPENSSL_SYS_WINDOWS
+        if (fd < 0 || fd >= FD_SETSIZE) {
+            ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_INVALID_ARGUMENT);
+            return -1;
+        }
+# endif
+        if ((events[i] & OSSL_HTTP_POLL_IN) != 0)
+            openssl_fdset(fd, &rfds);
+        if ((events[i] & OSSL_HTTP_POLL_OUT) != 0)
+            openssl_fdset(fd, &wfds);
+        if (fd > maxfd)
+            maxfd = fd;
+    }
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(maxfd + 1, (void *)&rfds, (void *)&wfds, NULL,
+                  timeout_ms < 0 ? NULL : &tv);
+#else
+    struct pollfd *pfds;
+    size_t i;
+    int ret;
+
+    if (num == 0)
+        return poll(NULL, 0, timeout_ms);
+    if ((pfds = OPENSSL_malloc(num * sizeof(*pfds))) == NULL)
+        return -1;
+    for (i = 0; i < num; i++) {
+        pfds[i].fd = desc[i].value.fd;
+        pfds[i].events = 0;
+        pfds[i].revents = 0;
+        if ((events[i] & OSSL_HTTP_POLL_IN) != 0)
+            pfds[i].events |= POLLIN;
+        if ((events[i] & OSSL_HTTP_POLL_OUT) != 0)
+            pfds[i].events |= POLLOUT;
+    }
+    ret = poll(pfds, (nfds_t)num, timeout_ms);
+    OPENSSL_free(pfds);
+    return ret;
+#endif
+}
+
+/* Connection pool */
+
+typedef struct {
+    OSSL_HTTP_REQ_CTX *rctx;
+    time_t since;               /* Time the connection became idle */
+} HTTP_POOL_CONN;
+
+struct ossl_http_pool_st {
+    CRYPTO_RWLOCK *lock;
+    HTTP_POOL_CONN *idle;       /* Idle connections, least recently used first */
+    size_t num_idle;
+    size_t max_idle;
+    int idle_timeout;           /* Maximum idle time in seconds, or 0 */
+};
+
+OSSL_HTTP_POOL *OSSL_HTTP_POOL_new(size_t max_idle, int idle_timeout)
+{
+    OSSL_HTTP_POOL *pool;
+
+    if (idle_timeout < 0) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_INVALID_ARGUMENT);
+        return NULL;
+    }
+    if ((pool = OPENSSL_zalloc(sizeof(*pool))) == NULL)
+        return NULL;
+    pool->max_idle = max_idle != 0 ? max_idle : HTTP_POOL_DEFAULT_MAX_IDLE;
+    pool->idle_timeout = idle_timeout;
+    if ((pool->lock = CRYPTO_THREAD_lock_new()) == NULL
+            || (pool->idle = OPENSSL_malloc(pool->max_idle
+                                            * sizeof(*pool->idle))) == NULL) {
+        OSSL_HTTP_POOL_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void OSSL_HTTP_POOL_free(OSSL_HTTP_POOL *pool)
+{
+    size_t i;
+
+    if (pool == NULL)
+        return;
+    for (i = 0; i < pool->num_idle; i++)
+        (void)OSSL_HTTP_close(pool->idle[i].rctx, 1);
+    OPENSSL_free(pool->idle);
+    CRYPTO_THREAD_lock_free(pool->lock);
+    OPENSSL_free(pool);
+}
+
+/* Remove entry |i| from the idle list of |pool| and return its connection */
+static OSSL_HTTP_REQ_CTX *pool_take(OSSL_HTTP_POOL *pool, size_t i)
+{
+    OSSL_HTTP_REQ_CTX *rctx = pool->idle[i].rctx;
+
+    memmove(&pool->idle[i], &pool->idle[i + 1],
+            (pool->num_idle - i - 1) * sizeof(*pool->idle));
+    pool->num_idle--;
+    return rctx;
+}
+
+/*
+ * Return a connection from |pool| that has been idle for too long, or NULL.
+ * As the idle list is ordered by time, only the first entry can be expired.
+ */
+static OSSL_HTTP_REQ_CTX *pool_take_expired(OSSL_HTTP_POOL *pool, time_t now)
+{
+    if (pool->num_idle == 0 || pool->idle_timeout == 0
+            || now - pool->idle[0].since <= pool->idle_timeout)
+        return NULL;
+    return pool_take(pool, 0);
+}
+
+static int str_eq(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return strcmp(a, b) == 0;
+}
+
+/*
+ * An idle connection that has become readable has been closed by the server,
+ * or has received data that cannot belong to any request.
+ */
+static int conn_usable(OSSL_HTTP_REQ_CTX *rctx)
+{
+    BIO_POLL_DESCRIPTOR desc;
+    int events = OSSL_HTTP_POLL_IN;
+    int fd;
+
+    if (BIO_pending(rctx->rbio) > 0)
+        return 0;
+    if (BIO_get_fd(rctx->rbio, &fd) <= 0)
+        return 1;
+    desc.type = BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD;
+    desc.value.fd = fd;
+    return wait_sockets(&desc, &events, 1, 0) == 0;
+}
+
+static OSSL_HTTP_REQ_CTX *pool_get(OSSL_HTTP_POOL *pool,
+                                   const char *server, const char *port,
+                                   const char *proxy, const char *no_proxy,
+                                   int use_ssl,
+                                   OSSL_HTTP_bio_cb_t bio_update_fn, void *arg,
+                                   int buf_size, int overall_timeout,
+                                   int *reused)
+{
+    OSSL_HTTP_REQ_CTX *rctx, *expired;
+    const char *conn_proxy;
+    size_t i;
+
+    *reused = 0;
+    if (pool == NULL || server == NULL) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_NULL_PARAMETER);
+        return NULL;
+    }
+    if (port != NULL && *port == '\0')
+        port = NULL;
+    conn_proxy = OSSL_HTTP_adapt_proxy(proxy, no_proxy, server, use_ssl);
+
+    for (;;) {
+        rctx = NULL;
+        if (!CRYPTO_THREAD_write_lock(pool->lock))
+            return NULL;
+        expired = pool_take_expired(pool, time(NULL));
+        /* Prefer the most recently used connection */
+        for (i = pool->num_idle; rctx == NULL && i-- > 0;) {
+            OSSL_HTTP_REQ_CTX *cand = pool->idle[i].rctx;
+
+            if ((cand->use_ssl != 0) == (use_ssl != 0)
+                    && cand->upd_fn == bio_update_fn
+                    && cand->upd_arg == arg
+                    && str_eq(cand->server, server)
+                    && str_eq(cand->port, port)
+                    && str_eq(cand->proxy, conn_proxy))
+                rctx = pool_take(pool, i);
+        }
+        CRYPTO_THREAD_unlock(pool->lock);
+
+        if (expired != NULL) {
+            (void)OSSL_HTTP_close(expired, 1);
+            if (rctx == NULL)
+                continue; /* there may be more to expire */
+        }
+        if (rctx == NULL || conn_usable(rctx))
+            break;
+        (void)OSSL_HTTP_close(rctx, 0);
+    }
+
+    if (rctx != NULL) {
+        rctx->max_total_time =
+            overall_timeout > 0 ? time(NULL) + overall_timeout : 0;
+        *reused = 1;
+        return rctx;
+    }
+    return OSSL_HTTP_open(server, port, proxy, no_proxy, use_ssl, NULL, NULL,
+                          bio_update_fn, arg, buf_size, overall_timeout);
+}
+
+OSSL_HTTP_REQ_CTX *OSSL_HTTP_POOL_get(OSSL_HTTP_POOL *pool,
+                                      const char *server, const char *port,
+                                      const char *proxy, const char *no_proxy,
+                                      int use_ssl,
+                                      OSSL_HTTP_bio_cb_t bio_update_fn,
+                                      void *arg, int buf_size,
+                                      int overall_timeout)
+{
+    int reused;
+
+    return pool_get(pool, server, port, proxy, no_proxy, use_ssl,
+                    bio_update_fn, arg, buf_size, overall_timeout, &reused);
+}
+
+int OSSL_HTTP_POOL_put(OSSL_HTTP_POOL *pool, OSSL_HTTP_REQ_CTX *rctx, int ok)
+{
+    OSSL_HTTP_REQ_CTX *evicted = NULL, *expired = NULL;
+    int ret = 1;
+
+    if (rctx == NULL)
+        return 1;
+
+    /* Only a connection with a completely read response can be reused */
+    if (pool == NULL || !ok || !OSSL_HTTP_is_alive(rctx)
+            || rctx->state != OHS_ASN1_DONE || rctx->server == NULL
+            || (rctx->pending != NULL && BIO_ctrl_pending(rctx->pending) > 0)
+            || !CRYPTO_THREAD_write_lock(pool->lock))
+        return OSSL_HTTP_close(rctx, ok);
+
+    expired = pool_take_expired(pool, time(NULL));
+    if (pool->num_idle == pool->max_idle)
+        evicted = pool_take(pool, 0);
+    pool->idle[pool->num_idle].rctx = rctx;
+    pool->idle[pool->num_idle].since = time(NULL);
+    pool->num_idle++;
+    CRYPTO_THREAD_unlock(pool->lock);
+
+    if (expired != NULL)
+        ret = OSSL_HTTP_close(expired, 1);
+    if (evicted != NULL)
+        ret = OSSL_HTTP_close(evicted, 1) && ret;
+    return ret;
+}
+
+BIO *OSSL_HTTP_POOL_transfer(OSSL_HTTP_POOL *pool,
+                             const char *server, const char *port,
+                             const char *path, int use_ssl,
+                             const char *proxy, const char *no_proxy,
+                             OSSL_HTTP_bio_cb_t bio_update_fn, void *arg,
+                             int buf_size, const STACK_OF(CONF_VALUE) *headers,
+                             const char *content_type, BIO *req,
+                             const char *expected_ct, int expect_asn1,
+                             size_t max_resp_len, int timeout)
+{
+    OSSL_HTTP_REQ_CTX *rctx;
+    BIO *body = NULL, *resp = NULL;
+    const unsigned char *data;
+    long len;
+    int reused, can_retry = 1;
+
+    /*
+     * The server may close an idle connection just when it is reused.
+     * In this case the request is sent once more on a new connection,
+     * which is only possible if it can be read again.  This is not done
+     * once any part of a response has been received, since the server may
+     * then have acted on the request already.
+     */
+    if (req != NULL) {
+        if (BIO_method_type(req) == BIO_TYPE_MEM
+                && (len = BIO_get_mem_data(req, &data)) >= 0) {
+            if ((body = BIO_new_mem_buf(data, (int)len)) == NULL)
+                return NULL;
+        } else {
+            if (!BIO_up_ref(req))
+                return NULL;
+            body = req;
+            can_retry = 0;
+        }
+    }
+
+    for (;;) {
+        rctx = pool_get(pool, server, port, proxy, no_proxy, use_ssl,
+                        bio_update_fn, arg, buf_size, timeout, &reused);
+        if (rctx == NULL)
+            break;
+        (void)ERR_set_mark();
+        if (OSSL_HTTP_set1_request(rctx, path, headers, content_type, body,
+                                   expected_ct, expect_asn1, max_resp_len,
+                                   timeout, 1 /* prefer keep-alive */))
+            resp = OSSL_HTTP_exchange(rctx, NULL);
+        if (resp == NULL && reused && can_retry && rctx->unanswered
+                && (body == NULL || BIO_reset(body) > 0)) {
+            (void)ERR_pop_to_mark();
+            (void)OSSL_HTTP_close(rctx, 0);
+            can_retry = 0;
+            continue;
+        }
+        (void)ERR_clear_last_mark();
+        if (!OSSL_HTTP_POOL_put(pool, rctx, resp != NULL)) {
+            BIO_free(resp);
+            resp = NULL;
+        }
+        break;
+    }
+    BIO_free(body);
+    return resp;
+}
+
+/* Concurrent and pipelined transfers */
+
+OSSL_HTTP_REQ_CTX *OSSL_HTTP_REQ_CTX_new_pipelined(const OSSL_HTTP_REQ_CTX *rctx)
+{
+    OSSL_HTTP_REQ_CTX *prctx;
+
+    if (rctx == NULL) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_NULL_PARAMETER);
+        return NULL;
+    }
+    /* The connection remains owned by |rctx| */
+    prctx = ossl_http_req_ctx_new(0, rctx->wbio, rctx->rbio, NULL, NULL,
+                                  rctx->use_ssl, rctx->proxy, rctx->server,
+                                  rctx->port, rctx->buf_size, 0);
+    if (prctx != NULL)
+        prctx->max_total_time = rctx->max_total_time;
+    return prctx;
+}
+
+typedef struct {
+    OSSL_HTTP_REQ_CTX *rctx;
+    int status;                 /* 0 while running, 1 if done, -1 if failed */
+} HTTP_MULTI_ITEM;
+
+struct ossl_http_multi_st {
+    HTTP_MULTI_ITEM *items;     /* In the order the requests were added */
+    size_t num;
+    size_t size;
+};
+
+OSSL_HTTP_MULTI *OSSL_HTTP_MULTI_new(void)
+{
+    return OPENSSL_zalloc(sizeof(OSSL_HTTP_MULTI));
+}
+
+void OSSL_HTTP_MULTI_free(OSSL_HTTP_MULTI *multi)
+{
+    if (multi == NULL)
+        return;
+    OPENSSL_free(multi->items);
+    OPENSSL_free(multi);
+}
+
+int OSSL_HTTP_MULTI_add(OSSL_HTTP_MULTI *multi, OSSL_HTTP_REQ_CTX *rctx)
+{
+    HTTP_MULTI_ITEM *items;
+    size_t i;
+
+    if (multi == NULL || rctx == NULL) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    /* The request must be complete and its response length known in advance */
+    if (rctx->state != OHS_ADD_HEADERS || !rctx->expect_asn1) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+    for (i = 0; i < multi->num; i++) {
+        if (multi->items[i].rctx == rctx) {
+            ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+    }
+    if (multi->num == multi->size) {
+        size_t size = multi->size == 0 ? 8 : multi->size * 2;
+
+        items = OPENSSL_realloc(multi->items, size * sizeof(*items));
+        if (items == NULL)
+            return 0;
+        multi->items = items;
+        multi->size = size;
+    }
+    multi->items[multi->num].rctx = rctx;
+    multi->items[multi->num].status = 0;
+    multi->num++;
+    return 1;
+}
+
+/*
+ * Return the running request sent over the same connection as request |i|
+ * just before it, or NULL if there is none.
+ */
+static HTTP_MULTI_ITEM *prev_on_conn(OSSL_HTTP_MULTI *multi, size_t i)
+{
+    BIO *rbio = multi->items[i].rctx->rbio;
+
+    while (i-- > 0)
+        if (multi->items[i].status == 0 && multi->items[i].rctx->rbio == rbio)
+            return &multi->items[i];
+    return NULL;
+}
+
+static HTTP_MULTI_ITEM *next_on_conn(OSSL_HTTP_MULTI *multi, size_t i)
+{
+    BIO *rbio = multi->items[i].rctx->rbio;
+
+    while (++i < multi->num)
+        if (multi->items[i].status == 0 && multi->items[i].rctx->rbio == rbio)
+            return &multi->items[i];
+    return NULL;
+}
+
+/* The responses to later requests on a failed connection will not arrive */
+static void multi_fail(OSSL_HTTP_MULTI *multi, size_t i)
+{
+    HTTP_MULTI_ITEM *next;
+
+    multi->items[i].rctx->state = OHS_ERROR;
+    multi->items[i].status = -1;
+    while ((next = next_on_conn(multi, i)) != NULL) {
+        next->rctx->state = OHS_ERROR;
+        next->status = -1;
+        ERR_raise(ERR_LIB_HTTP, HTTP_R_ERROR_RECEIVING);
+    }
+}
+
+/* Pass on data read beyond the response to the next request on the conn. */
+static void multi_done(OSSL_HTTP_MULTI *multi, size_t i)
+{
+    OSSL_HTTP_REQ_CTX *rctx = multi->items[i].rctx;
+    HTTP_MULTI_ITEM *next = next_on_conn(multi, i);
+
+    multi->items[i].status = 1;
+    if (next != NULL && rctx->pending != NULL) {
+        BIO_free(next->rctx->pending);
+        next->rctx->pending = rctx->pending;
+        rctx->pending = NULL;
+    }
+}
+
+int OSSL_HTTP_MULTI_perform(OSSL_HTTP_MULTI *multi)
+{
+    HTTP_MULTI_ITEM *item, *prev;
+    OSSL_HTTP_REQ_CTX *rctx;
+    time_t now;
+    size_t i;
+    int progress, running, rv;
+
+    if (multi == NULL) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+
+    do {
+        progress = 0;
+        now = time(NULL);
+        for (i = 0; i < multi->num; i++) {
+            item = &multi->items[i];
+            rctx = item->rctx;
+            if (item->status != 0)
+                continue;
+            if (rctx->max_time != 0 && now >= rctx->max_time) {
+                ERR_raise(ERR_LIB_BIO, BIO_R_TRANSFER_TIMEOUT);
+                multi_fail(multi, i);
+                progress = 1;
+                continue;
+            }
+
+            /* Requests on a connection are sent one after the other */
+            prev = prev_on_conn(multi, i);
+            if ((rctx->state & OHS_NOREAD) != 0) {
+                if (prev != NULL && (prev->rctx->state & OHS_NOREAD) != 0)
+                    continue;
+                rv = ossl_http_req_ctx_nbio(rctx, 1);
+                if (rv == 0) {
+                    multi_fail(multi, i);
+                    progress = 1;
+                    continue;
+                }
+                if ((rctx->state & OHS_NOREAD) != 0)
+                    continue;
+                progress = 1;
+            }
+
+            /* and their responses arrive in the same order */
+            if (prev != NULL)
+                continue;
+            rv = ossl_http_req_ctx_nbio(rctx, 0);
+            if (rv == 1) {
+                multi_done(multi, i);
+                progress = 1;
+            } else if (rv == 0) {
+                multi_fail(multi, i);
+                progress = 1;
+            }
+        }
+    } while (progress);
+
+    for (running = 0, i = 0; i < multi->num; i++)
+        if (multi->items[i].status == 0)
+            running++;
+    return running;
+}
+
+OSSL_HTTP_REQ_CTX *OSSL_HTTP_MULTI_get_done(OSSL_HTTP_MULTI *multi, int *ok)
+{
+    OSSL_HTTP_REQ_CTX *rctx;
+    size_t i;
+
+    if (multi == NULL)
+        return NULL;
+    for (i = 0; i < multi->num; i++) {
+        if (multi->items[i].status == 0)
+            continue;
+        rctx = multi->items[i].rctx;
+        if (ok != NULL)
+            *ok = multi->items[i].status > 0;
+        memmove(&multi->items[i], &multi->items[i + 1],
+                (multi->num - i - 1) * sizeof(*multi->items));
+        multi->num--;
+        return rctx;
+    }
+    return NULL;
+}
+
+size_t OSSL_HTTP_MULTI_get_poll_descriptors(OSSL_HTTP_MULTI *multi,
+                                            BIO_POLL_DESCRIPTOR *desc,
+                                            int *events, size_t max)
+{
+    HTTP_MULTI_ITEM *prev;
+    OSSL_HTTP_REQ_CTX *rctx;
+    size_t i, n = 0;
+    int ev, fd;
+
+    if (multi == NULL)
+        return 0;
+    for (i = 0; i < multi->num && n < max; i++) {
+        if (multi->items[i].status != 0)
+            continue;
+        rctx = multi->items[i].rctx;
+        prev = prev_on_conn(multi, i);
+        ev = 0;
+        if ((rctx->state & OHS_NOREAD) != 0) {
+            if (prev == NULL || (prev->rctx->state & OHS_NOREAD) == 0)
+                ev = OSSL_HTTP_POLL_OUT;
+        } else if (prev == NULL) {
+            ev = OSSL_HTTP_POLL_IN;
+        }
+        if (ev == 0 || BIO_get_fd(rctx->rbio, &fd) <= 0)
+            continue;
+        desc[n].type = BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD;
+        desc[n].value.fd = fd;
+        events[n] = ev;
+        n++;
+    }
+    return n;
+}
+
+int OSSL_HTTP_MULTI_wait(OSSL_HTTP_MULTI *multi, int timeout_ms)
+{
+    BIO_POLL_DESCRIPTOR *desc;
+    int *events;
+    time_t now = time(NULL);
+    size_t i, n;
+    int ret = -1;
+
+    if (multi == NULL) {
+        ERR_raise(ERR_LIB_HTTP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+    if (multi->num == 0)
+        return 1;
+
+    /* Wake up in time to notice a request timing out */
+    for (i = 0; i < multi->num; i++) {
+        time_t max_time = multi->items[i].rctx->max_time;
+
+        if (multi->items[i].status != 0)
+            return 1;
+        if (max_time != 0) {
+            int left_ms = max_time > now ? (int)(max_time - now) * 1000 : 0;
+
+            if (timeout_ms < 0 || left_ms < timeout_ms)
+                timeout_ms = left_ms;
+        }
+    }
+
+    desc = OPENSSL_malloc(multi->num * sizeof(*desc));
+    events = OPENSSL_malloc(multi->num * sizeof(*events));
+    if (desc != NULL && events != NULL) {
+        n = OSSL_HTTP_MULTI_get_poll_descriptors(multi, desc, events,
+                                                 multi->num);
+        if (n == 0 && (timeout_ms < 0 || timeout_ms > 100))
+            timeout_ms = 100; /* no sockets to wait for, so poll regularly */
+        ret = wait_sockets(desc, events, n, timeout_ms);
+        if (ret > 0)
+            ret = 1;
+    }
+    OPENSSL_free(desc);
+    OPENSSL_free(events);
+    return ret;
+}
@@ -14,6 +14,8 @@
 #include "crypto/cryptlib.h"
 #include <openssl/err.h>
 #include "crypto/rand.h"
+#include "crypto/rsa.h"
+#include "crypto/x509.h"
 #include "internal/bio.h"
 #include <openssl/evp.h>
 #include "crypto/evp.h"
@@ -423,6 +425,12 @@ void OPENSSL_cleanup(void)
     OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_rand_cleanup_int()\n");
     ossl_rand_cleanup_int();
 
+    OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_rsa_cleanup_int()\n");
+    ossl_rsa_cleanup_int();
+
+    OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_x509_pubkey_cleanup_int()\n");
+    ossl_x509_pubkey_cleanup_int();
+
     OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_config_modules_free()\n");
     ossl_config_modules_free();
 
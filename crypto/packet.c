@@ -100,14 +100,41 @@ static size_t maxmaxsize(size_t lenbytes)
     return ((size_t)1 << (lenbytes * 8)) - 1 + lenbytes;
 }
 
+/*
+ * Sub-packets are always closed in the reverse order they were opened in and
+ * rarely nest deeply, so the first WPACKET_SUB_POOL of them are kept in the
+ * WPACKET itself rather than allocated.
+ */
+static WPACKET_SUB *wpacket_sub_new(WPACKET *pkt)
+{
+    WPACKET_SUB *sub;
+
+    if (pkt->numsubs < WPACKET_SUB_POOL) {
+        sub = &pkt->subpool[pkt->numsubs];
+        memset(sub, 0, sizeof(*sub));
+    } else if ((sub = OPENSSL_zalloc(sizeof(*sub))) == NULL) {
+        return NULL;
+    }
+    pkt->numsubs++;
+    return sub;
+}
+
+/* Frees |sub|, which must be the most recently opened sub-packet */
+static void wpacket_sub_free(WPACKET *pkt, WPACKET_SUB *sub)
+{
+    if (--pkt->numsubs >= WPACKET_SUB_POOL)
+        OPENSSL_free(sub);
+}
+
 static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
 {
     unsigned char *lenchars;
 
     pkt->curr = 0;
     pkt->written = 0;
+    pkt->numsubs = 0;
 
-    if ((pkt->subs = OPENSSL_zalloc(sizeof(*pkt->subs))) == NULL)
+    if ((pkt->subs = wpacket_sub_new(pkt)) == NULL)
         return 0;
 
     if (lenbytes == 0)
@@ -117,7 +144,7 @@ static int wpacket_intern_init_len(WPACKET *pkt, size_t lenbytes)
     pkt->subs->lenbytes = lenbytes;
 
     if (!WPACKET_allocate_bytes(pkt, lenbytes, &lenchars)) {
-        OPENSSL_free(pkt->subs);
+        wpacket_sub_free(pkt, pkt->subs);
         pkt->subs = NULL;
         return 0;
     }
@@ -310,7 +337,7 @@ static int wpacket_intern_close(WPACKET *pkt, WPACKET_SUB *sub, int doclose)
 
     if (doclose) {
         pkt->subs = sub->parent;
-        OPENSSL_free(sub);
+        wpacket_sub_free(pkt, sub);
     }
 
     return 1;
@@ -356,7 +383,7 @@ int WPACKET_finish(WPACKET *pkt)
 
     ret = wpacket_intern_close(pkt, pkt->subs, 1);
     if (ret) {
-        OPENSSL_free(pkt->subs);
+        wpacket_sub_free(pkt, pkt->subs);
         pkt->subs = NULL;
     }
 
@@ -376,7 +403,7 @@ int WPACKET_start_sub_packet_len__(WPACKET *pkt, size_t lenbytes)
     if (lenbytes > 0 && pkt->endfirst)
         return 0;
 
-    if ((sub = OPENSSL_zalloc(sizeof(*sub))) == NULL)
+    if ((sub = wpacket_sub_new(pkt)) == NULL)
         return 0;
 
     sub->parent = pkt->subs;
@@ -529,7 +556,7 @@ void WPACKET_cleanup(WPACKET *pkt)
 
     for (sub = pkt->subs; sub != NULL; sub = parent) {
         parent = sub->parent;
-        OPENSSL_free(sub);
+        wpacket_sub_free(pkt, sub);
     }
     pkt->subs = NULL;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -799,27 +799,31 @@ err:
 enum header_status {
     MAYBE_HEADER,
     IN_HEADER,
-    POST_HEADER
+    POST_HEADER,
+    NO_HEADER
 };
 
 /**
  * Extract the optional PEM header, with details on the type of content and
  * any encryption used on the contents, and the bulk of the data from the bio.
- * The end of the header is marked by a blank line; if the end-of-input marker
- * is reached prior to a blank line, there is no header.
+ * The end of the header is marked by a blank line.  A header starts with a
+ * line containing a colon, so if the first line has none there is no header.
  *
- * The header and data arguments are BIO** since we may have to swap them
- * if there is no header, for efficiency.
+ * The data is base64 decoded line by line as it is read and only the result
+ * is written to |data|, so that the base64 text of large objects is never
+ * held in memory as a whole.
  *
  * We need the name of the PEM-encoded type to verify the end string.
+ * Returns 1 on success, and 0 on error or if there was no data.
  */
-static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
+static int get_header_and_data(BIO *bp, BIO *header, BIO *data, char *name,
                                unsigned int flags)
 {
-    BIO *tmp = *header;
+    EVP_ENCODE_CTX *ctx = NULL;
+    unsigned char *decoded = NULL;
     char *linebuf, *p;
     int len, ret = 0, end = 0, prev_partial_line_read = 0, partial_line_read = 0;
-    /* 0 if not seen (yet), 1 if reading header, 2 if finished header */
+    int rv, outlen, got_data = 0, last = 0;
     enum header_status got_header = MAYBE_HEADER;
     unsigned int flags_mask;
     size_t namelen;
@@ -827,8 +831,15 @@ static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
     /* Need to hold trailing NUL (accounted for by BIO_gets() and the newline
      * that will be added by sanitize_line() (the extra '1'). */
     linebuf = PEM_MALLOC(LINESIZE + 1, flags);
-    if (linebuf == NULL)
-        return 0;
+    /* Holds what a line decodes to, together with what the previous left */
+    decoded = PEM_MALLOC(LINESIZE + 1, flags);
+    if (linebuf == NULL || decoded == NULL)
+        goto err;
+    if ((ctx = EVP_ENCODE_CTX_new()) == NULL) {
+        ERR_raise(ERR_LIB_PEM, ERR_R_EVP_LIB);
+        goto err;
+    }
+    EVP_DecodeInit(ctx);
 
     while(1) {
         flags_mask = ~0u;
@@ -861,18 +872,17 @@ static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
              * regular newline at the end of a line and not an empty line.
              */
             if (!prev_partial_line_read) {
-                if (got_header == POST_HEADER) {
+                if (got_header == POST_HEADER || got_header == NO_HEADER) {
                     /* Another blank line is an error. */
                     ERR_raise(ERR_LIB_PEM, PEM_R_BAD_END_LINE);
                     goto err;
                 }
                 got_header = POST_HEADER;
-                tmp = *data;
             }
             continue;
         }
 
-        /* Check for end of stream (which means there is no header). */
+        /* Check for end of stream. */
         p = linebuf;
         if (CHECK_AND_SKIP_PREFIX(p, ENDSTR)) {
             namelen = strlen(name);
@@ -881,21 +891,34 @@ static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
                 ERR_raise(ERR_LIB_PEM, PEM_R_BAD_END_LINE);
                 goto err;
             }
-            if (got_header == MAYBE_HEADER) {
-                *header = *data;
-                *data = tmp;
-            }
             break;
         } else if (end) {
             /* Malformed input; short line not at end of data. */
             ERR_raise(ERR_LIB_PEM, PEM_R_BAD_END_LINE);
             goto err;
         }
-        /*
-         * Else, a line of text -- could be header or data; we don't
-         * know yet.  Just pass it through.
-         */
-        if (BIO_puts(tmp, linebuf) < 0)
+
+        if (got_header == IN_HEADER) {
+            if (BIO_puts(header, linebuf) < 0)
+                goto err;
+            continue;
+        }
+
+        /* A line of data, which is decoded right away. */
+        if (got_header == MAYBE_HEADER)
+            got_header = NO_HEADER;
+        got_data = 1;
+        rv = EVP_DecodeUpdate(ctx, decoded, &outlen,
+                              (unsigned char *)linebuf, len);
+        /* Nothing may follow the padding */
+        if (rv < 0
+                || (last && (outlen != 0 || EVP_ENCODE_CTX_num(ctx) != 0))) {
+            ERR_raise(ERR_LIB_PEM, PEM_R_BAD_BASE64_DECODE);
+            goto err;
+        }
+        if (rv == 0)
+            last = 1;
+        if (outlen > 0 && BIO_write(data, decoded, outlen) != outlen)
             goto err;
         /*
          * Only encrypted files need the line length check applied.
@@ -909,8 +932,20 @@ static int get_header_and_data(BIO *bp, BIO **header, BIO **data, char *name,
         }
     }
 
+    /* There was no data in the PEM file */
+    if (!got_data)
+        goto err;
+    if (EVP_DecodeFinal(ctx, decoded, &outlen) < 0) {
+        ERR_raise(ERR_LIB_PEM, PEM_R_BAD_BASE64_DECODE);
+        goto err;
+    }
+    if (outlen > 0 && BIO_write(data, decoded, outlen) != outlen)
+        goto err;
+
     ret = 1;
 err:
+    EVP_ENCODE_CTX_free(ctx);
+    PEM_FREE(decoded, flags, LINESIZE + 1);
     PEM_FREE(linebuf, flags, LINESIZE + 1);
     return ret;
 }
@@ -924,12 +959,10 @@ err:
 int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
                     unsigned char **data, long *len_out, unsigned int flags)
 {
-    EVP_ENCODE_CTX *ctx = NULL;
     const BIO_METHOD *bmeth;
     BIO *headerB = NULL, *dataB = NULL;
     char *name = NULL;
-    int len, taillen, headerlen, ret = 0;
-    BUF_MEM *buf_mem;
+    int len, headerlen, ret = 0;
 
     *len_out = 0;
     *name_out = *header = NULL;
@@ -950,33 +983,10 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
 
     if (!get_name(bp, &name, flags))
         goto end;
-    if (!get_header_and_data(bp, &headerB, &dataB, name, flags))
+    if (!get_header_and_data(bp, headerB, dataB, name, flags))
         goto end;
 
-    BIO_get_mem_ptr(dataB, &buf_mem);
-    len = buf_mem->length;
-
-    /* There was no data in the PEM file */
-    if (len == 0)
-        goto end;
-
-    ctx = EVP_ENCODE_CTX_new();
-    if (ctx == NULL) {
-        ERR_raise(ERR_LIB_PEM, ERR_R_EVP_LIB);
-        goto end;
-    }
-
-    EVP_DecodeInit(ctx);
-    if (EVP_DecodeUpdate(ctx, (unsigned char*)buf_mem->data, &len,
-                         (unsigned char*)buf_mem->data, len) < 0
-            || EVP_DecodeFinal(ctx, (unsigned char*)&(buf_mem->data[len]),
-                               &taillen) < 0) {
-        ERR_raise(ERR_LIB_PEM, PEM_R_BAD_BASE64_DECODE);
-        goto end;
-    }
-    len += taillen;
-    buf_mem->length = len;
-
+    len = BIO_get_mem_data(dataB, NULL);
     headerlen = BIO_get_mem_data(headerB, NULL);
     *header = PEM_MALLOC(headerlen + 1, flags);
     *data = PEM_MALLOC(len, flags);
@@ -985,7 +995,7 @@ int PEM_read_bio_ex(BIO *bp, char **name_out, char **header,
     if (headerlen != 0 && BIO_read(headerB, *header, headerlen) != headerlen)
         goto out_free;
     (*header)[headerlen] = '\0';
-    if (BIO_read(dataB, *data, len) != len)
+    if (len != 0 && BIO_read(dataB, *data, len) != len)
         goto out_free;
     *len_out = len;
     *name_out = name;
@@ -999,7 +1009,6 @@ out_free:
     PEM_FREE(*data, flags, 0);
     *data = NULL;
 end:
-    EVP_ENCODE_CTX_free(ctx);
     PEM_FREE(name, flags, 0);
     BIO_free(headerB);
     BIO_free(dataB);
@@ -31,6 +31,7 @@
 # include <openssl/conf.h>
 # include <openssl/trace.h>
 # include <openssl/engine.h>
+# include <openssl/provider.h>
 # include "crypto/rand_pool.h"
 # include "prov/seeding.h"
 # include "internal/e_os.h"
@@ -49,6 +50,10 @@ static CRYPTO_ONCE rand_init = CRYPTO_ONCE_STATIC_INIT;
 
 static int rand_inited = 0;
 
+static int rand_bytes_buffered(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand,
+                               unsigned char *out, size_t num,
+                               unsigned int strength);
+
 DEFINE_RUN_ONCE_STATIC(do_rand_init)
 {
 # ifndef OPENSSL_NO_ENGINE
@@ -268,8 +273,10 @@ void RAND_seed(const void *buf, int num)
 # endif
 
     drbg = RAND_get0_primary(NULL);
-    if (drbg != NULL && num > 0)
+    if (drbg != NULL && num > 0) {
         EVP_RAND_reseed(drbg, 0, NULL, 0, buf, num);
+        ossl_rand_buffer_invalidate(NULL);
+    }
 }
 
 void RAND_add(const void *buf, int num, double randomness)
@@ -284,7 +291,7 @@ void RAND_add(const void *buf, int num, double randomness)
     }
 # endif
     drbg = RAND_get0_primary(NULL);
-    if (drbg != NULL && num > 0)
+    if (drbg != NULL && num > 0) {
 # ifdef OPENSSL_RAND_SEED_NONE
         /* Without an entropy source, we have to rely on the user */
         EVP_RAND_reseed(drbg, 0, buf, num, NULL, 0);
@@ -292,6 +299,8 @@ void RAND_add(const void *buf, int num, double randomness)
         /* With an entropy source, we downgrade this to additional input */
         EVP_RAND_reseed(drbg, 0, NULL, 0, buf, num);
 # endif
+        ossl_rand_buffer_invalidate(NULL);
+    }
 }
 
 # if !defined(OPENSSL_NO_DEPRECATED_1_1_0)
@@ -380,10 +389,17 @@ int RAND_bytes_ex(OSSL_LIB_CTX *ctx, unsigned char *buf, size_t num,
 #endif
 
     rand = RAND_get0_public(ctx);
-    if (rand != NULL)
-        return EVP_RAND_generate(rand, buf, num, strength, 0, NULL, 0);
+    if (rand == NULL)
+        return 0;
+#ifndef FIPS_MODULE
+    if (num <= RAND_BUFFER_MAX_REQUEST) {
+        int ret = rand_bytes_buffered(ctx, rand, buf, num, strength);
 
-    return 0;
+        if (ret >= 0)
+            return ret;
+    }
+#endif
+    return EVP_RAND_generate(rand, buf, num, strength, 0, NULL, 0);
 }
 
 int RAND_bytes(unsigned char *buf, int num)
@@ -439,6 +455,17 @@ typedef struct rand_global_st {
      */
     CRYPTO_THREAD_LOCAL private;
 
+#ifndef FIPS_MODULE
+    /*
+     * Per thread buffer of <public> DRBG output used to serve small
+     * RAND_bytes() requests, see rand_bytes_buffered().  Changing
+     * |buffer_generation| discards the buffers of all threads.
+     */
+    CRYPTO_THREAD_LOCAL public_buffer;
+    int buffer_size;
+    int buffer_generation;
+#endif
+
     /* Which RNG is being used by default and it's configuration settings */
     char *rng_name;
     char *rng_cipher;
@@ -479,8 +506,18 @@ void *ossl_rand_ctx_new(OSSL_LIB_CTX *libctx)
     if (!CRYPTO_THREAD_init_local(&dgbl->public, NULL))
         goto err2;
 
+#ifndef FIPS_MODULE
+    if (!CRYPTO_THREAD_init_local(&dgbl->public_buffer, NULL))
+        goto err3;
+    dgbl->buffer_size = RAND_BUFFER_DEFAULT_SIZE;
+#endif
+
     return dgbl;
 
+#ifndef FIPS_MODULE
+ err3:
+    CRYPTO_THREAD_cleanup_local(&dgbl->public);
+#endif
  err2:
     CRYPTO_THREAD_cleanup_local(&dgbl->private);
  err1:
@@ -499,6 +536,9 @@ void ossl_rand_ctx_free(void *vdgbl)
     CRYPTO_THREAD_lock_free(dgbl->lock);
     CRYPTO_THREAD_cleanup_local(&dgbl->private);
     CRYPTO_THREAD_cleanup_local(&dgbl->public);
+#ifndef FIPS_MODULE
+    CRYPTO_THREAD_cleanup_local(&dgbl->public_buffer);
+#endif
     EVP_RAND_CTX_free(dgbl->primary);
     EVP_RAND_CTX_free(dgbl->seed);
     OPENSSL_free(dgbl->rng_name);
@@ -516,6 +556,192 @@ static RAND_GLOBAL *rand_get_global(OSSL_LIB_CTX *libctx)
     return ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_DRBG_INDEX);
 }
 
+#ifndef FIPS_MODULE
+/*
+ * A buffer of output from the <public> DRBG of one thread.  Bytes before
+ * |pos| have already been handed out and are cleansed.
+ */
+typedef struct rand_buffer_st {
+    EVP_RAND_CTX *rand;         /* The DRBG that produced the output */
+    unsigned int strength;
+    int generation;
+    unsigned int reseed_count[2]; /* of |rand| and the primary DRBG */
+    int fork_id;
+    size_t size;                /* zero if buffering is not used */
+    size_t len;
+    size_t pos;
+    unsigned char *data;
+} RAND_BUFFER;
+
+static void rand_buffer_free(RAND_BUFFER *rb)
+{
+    if (rb != NULL)
+        OPENSSL_clear_free(rb, sizeof(*rb) + rb->size);
+}
+
+static void rand_buffer_delete(RAND_GLOBAL *dgbl)
+{
+    RAND_BUFFER *rb = CRYPTO_THREAD_get_local(&dgbl->public_buffer);
+
+    CRYPTO_THREAD_set_local(&dgbl->public_buffer, NULL);
+    rand_buffer_free(rb);
+}
+
+/*
+ * Only the DRBGs of the default provider are buffered.  Test and other
+ * deterministic generators expect to see every request unchanged, and a
+ * FIPS provider has to see every request for its output to count as
+ * coming from the validated generator.
+ */
+static int rand_buffer_usable(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand)
+{
+    EVP_RAND *r = EVP_RAND_CTX_get0_rand(rand);
+    const OSSL_PROVIDER *prov = EVP_RAND_get0_provider(r);
+
+    if (EVP_default_properties_is_fips_enabled(ctx)
+            || prov == NULL
+            || strcmp(OSSL_PROVIDER_get0_name(prov), "default") != 0)
+        return 0;
+
+    return EVP_RAND_is_a(r, "CTR-DRBG")
+        || EVP_RAND_is_a(r, "HASH-DRBG")
+        || EVP_RAND_is_a(r, "HMAC-DRBG");
+}
+
+/*
+ * The reseed counters of the <public> DRBG and of its parent, the <primary>
+ * DRBG.  They change whenever either is reseeded, for whatever reason.
+ */
+static int rand_buffer_reseed_count(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand,
+                                    unsigned int count[2])
+{
+    EVP_RAND_CTX *primary = RAND_get0_primary(ctx);
+    OSSL_PARAM params[2];
+
+    params[1] = OSSL_PARAM_construct_end();
+    params[0] = OSSL_PARAM_construct_uint(OSSL_DRBG_PARAM_RESEED_COUNTER,
+                                          &count[0]);
+    if (!EVP_RAND_CTX_get_params(rand, params))
+        return 0;
+    params[0] = OSSL_PARAM_construct_uint(OSSL_DRBG_PARAM_RESEED_COUNTER,
+                                          &count[1]);
+    return primary != NULL && EVP_RAND_CTX_get_params(primary, params);
+}
+
+static RAND_BUFFER *rand_buffer_new(OSSL_LIB_CTX *ctx, RAND_GLOBAL *dgbl,
+                                    EVP_RAND_CTX *rand, int generation)
+{
+    RAND_BUFFER *rb;
+    int size;
+
+    if (!CRYPTO_THREAD_read_lock(dgbl->lock))
+        return NULL;
+    size = dgbl->buffer_size;
+    CRYPTO_THREAD_unlock(dgbl->lock);
+    if (size > 0 && !rand_buffer_usable(ctx, rand))
+        size = 0;
+
+    rb = OPENSSL_zalloc(sizeof(*rb) + size);
+    if (rb == NULL)
+        return NULL;
+    if (!CRYPTO_THREAD_set_local(&dgbl->public_buffer, rb)) {
+        OPENSSL_free(rb);
+        return NULL;
+    }
+    rb->rand = rand;
+    rb->strength = EVP_RAND_get_strength(rand);
+    rb->generation = generation;
+    rb->fork_id = openssl_get_fork_id();
+    rb->size = size;
+    rb->data = (unsigned char *)(rb + 1);
+    return rb;
+}
+
+/*
+ * Serve a small request from the calling thread's buffer of <public> DRBG
+ * output, refilling the buffer with one large generate call when it runs
+ * short.  This avoids the per call overhead of the DRBG for the many short
+ * nonces, connection IDs and padding requested by the protocol code.
+ *
+ * Every byte is returned at most once and cleansed from the buffer when it
+ * is.  The buffer is discarded when the process forks, when the <public> or
+ * <primary> DRBG has been reseeded since it was filled and when the
+ * <public> DRBG or the buffer size is changed.
+ *
+ * Returns 1 or 0 like RAND_bytes_ex() or -1 if the request has to be passed
+ * to the DRBG directly.
+ */
+static int rand_bytes_buffered(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand,
+                               unsigned char *out, size_t num,
+                               unsigned int strength)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+    RAND_BUFFER *rb;
+    unsigned int reseed_count[2];
+    int generation;
+
+    if (dgbl == NULL
+            || !CRYPTO_atomic_load_int(&dgbl->buffer_generation, &generation,
+                                       dgbl->lock))
+        return -1;
+
+    rb = CRYPTO_THREAD_get_local(&dgbl->public_buffer);
+    if (rb == NULL || rb->rand != rand || rb->generation != generation
+            || rb->fork_id != openssl_get_fork_id()) {
+        rand_buffer_delete(dgbl);
+        if ((rb = rand_buffer_new(ctx, dgbl, rand, generation)) == NULL)
+            return -1;
+    }
+    if (rb->size == 0 || strength > rb->strength
+            || !rand_buffer_reseed_count(ctx, rand, reseed_count))
+        return -1;
+
+    if (rb->len - rb->pos < num
+            || memcmp(reseed_count, rb->reseed_count,
+                      sizeof(reseed_count)) != 0) {
+        OPENSSL_cleanse(rb->data + rb->pos, rb->len - rb->pos);
+        rb->len = rb->pos = 0;
+        if (!EVP_RAND_generate(rand, rb->data, rb->size, 0, 0, NULL, 0)
+                || !rand_buffer_reseed_count(ctx, rand, rb->reseed_count))
+            return 0;
+        rb->len = rb->size;
+    }
+    memcpy(out, rb->data + rb->pos, num);
+    OPENSSL_cleanse(rb->data + rb->pos, num);
+    rb->pos += num;
+    return 1;
+}
+
+/* Discard the buffered <public> DRBG output of all threads */
+void ossl_rand_buffer_invalidate(OSSL_LIB_CTX *ctx)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+    int generation;
+
+    if (dgbl != NULL)
+        CRYPTO_atomic_add(&dgbl->buffer_generation, 1, &generation,
+                          dgbl->lock);
+}
+
+int RAND_set_public_buffer_size(OSSL_LIB_CTX *ctx, size_t size)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+
+    if (dgbl == NULL)
+        return 0;
+    if (size > RAND_BUFFER_MAX_SIZE) {
+        ERR_raise(ERR_LIB_RAND, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+    if (!CRYPTO_THREAD_write_lock(dgbl->lock))
+        return 0;
+    dgbl->buffer_size = (int)size;
+    CRYPTO_THREAD_unlock(dgbl->lock);
+    ossl_rand_buffer_invalidate(ctx);
+    return 1;
+}
+#endif  /* !FIPS_MODULE */
+
 static void rand_delete_thread_state(void *arg)
 {
     OSSL_LIB_CTX *ctx = arg;
@@ -525,6 +751,10 @@ static void rand_delete_thread_state(void *arg)
     if (dgbl == NULL)
         return;
 
+#ifndef FIPS_MODULE
+    rand_buffer_delete(dgbl);
+#endif
+
     rand = CRYPTO_THREAD_get_local(&dgbl->public);
     CRYPTO_THREAD_set_local(&dgbl->public, NULL);
     EVP_RAND_CTX_free(rand);
@@ -886,8 +1116,12 @@ int RAND_set0_public(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand)
     if (dgbl == NULL)
         return 0;
     old = CRYPTO_THREAD_get_local(&dgbl->public);
-    if ((r = CRYPTO_THREAD_set_local(&dgbl->public, rand)) > 0)
+    if ((r = CRYPTO_THREAD_set_local(&dgbl->public, rand)) > 0) {
+#ifndef FIPS_MODULE
+        rand_buffer_delete(dgbl);
+#endif
         EVP_RAND_CTX_free(old);
+    }
     return r;
 }
 
@@ -963,6 +1197,17 @@ static int random_conf_init(CONF_IMODULE *md, const CONF *cnf)
         } else if (OPENSSL_strcasecmp(cval->name, "seed_properties") == 0) {
             if (!random_set_string(&dgbl->seed_propq, cval->value))
                 return 0;
+        } else if (OPENSSL_strcasecmp(cval->name, "buffer_size") == 0) {
+            char *end;
+            unsigned long size = strtoul(cval->value, &end, 10);
+
+            if (end == cval->value || *end != '\0'
+                    || !RAND_set_public_buffer_size(NCONF_get0_libctx((CONF *)cnf),
+                                                    size)) {
+                ERR_raise_data(ERR_LIB_CRYPTO, CRYPTO_R_RANDOM_SECTION_ERROR,
+                               "name=%s, value=%s", cval->name, cval->value);
+                return 0;
+            }
         } else {
             ERR_raise_data(ERR_LIB_CRYPTO,
                            CRYPTO_R_UNKNOWN_NAME_IN_RANDOM_SECTION,
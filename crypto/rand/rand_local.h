@@ -25,9 +25,20 @@
 # define PRIMARY_RESEED_TIME_INTERVAL            (60 * 60) /* 1 hour */
 # define SECONDARY_RESEED_TIME_INTERVAL          (7 * 60)  /* 7 minutes */
 
+/*
+ * Per thread buffering of the public DRBG output: default and maximum
+ * buffer sizes and the largest request that is served from the buffer.
+ * Buffering is off unless the application asks for it.
+ */
+# define RAND_BUFFER_DEFAULT_SIZE                0
+# define RAND_BUFFER_MAX_SIZE                    (1 << 16)
+# define RAND_BUFFER_MAX_REQUEST                 128
+
 # ifndef FIPS_MODULE
 /* The global RAND method, and the global buffer and DRBG instance. */
 extern RAND_METHOD ossl_rand_meth;
+
+void ossl_rand_buffer_invalidate(OSSL_LIB_CTX *ctx);
 # endif
 
 #endif
@@ -15,11 +15,14 @@
 static int drbg_add(const void *buf, int num, double randomness)
 {
     EVP_RAND_CTX *drbg = RAND_get0_primary(NULL);
+    int ret;
 
     if (drbg == NULL || num <= 0)
         return 0;
 
-    return EVP_RAND_reseed(drbg, 0, NULL, 0, buf, num);
+    ret = EVP_RAND_reseed(drbg, 0, NULL, 0, buf, num);
+    ossl_rand_buffer_invalidate(NULL);
+    return ret;
 }
 
 /* Implements the default OpenSSL RAND_seed() method */
@@ -208,6 +208,11 @@ void ossl_rsa_set0_libctx(RSA *r, OSSL_LIB_CTX *libctx)
     r->libctx = libctx;
 }
 
+void ossl_rsa_set_gen_threads(RSA *r, int threads)
+{
+    r->gen_threads = threads;
+}
+
 #ifndef FIPS_MODULE
 int RSA_set_ex_data(RSA *r, int idx, void *arg)
 {
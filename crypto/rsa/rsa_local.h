@@ -96,8 +96,19 @@ struct rsa_st {
     BN_BLINDING *blinding;
     BN_BLINDING *mt_blinding;
     CRYPTO_RWLOCK *lock;
+    /*
+     * Set once the Montgomery contexts above were set up ahead of use by
+     * ossl_rsa_precompute(), they can then be read without locking.
+     */
+    int mont_precomputed;
+#ifndef FIPS_MODULE
+    /* Identifies the key in the per thread blinding caches, 0 for none */
+    uint64_t blinding_id;
+#endif
 
     int dirty_cnt;
+    /* Number of threads to search for primes with during key generation */
+    int gen_threads;
 };
 
 struct rsa_meth_st {
@@ -15,8 +15,11 @@
 
 #include "internal/cryptlib.h"
 #include "crypto/bn.h"
+#include "crypto/cryptlib.h"
 #include "rsa_local.h"
 #include "internal/constant_time.h"
+#include "internal/thread_once.h"
+#include "crypto/rsa.h"
 #include <openssl/evp.h>
 #include <openssl/sha.h>
 #include <openssl/hmac.h>
@@ -96,6 +99,89 @@ const RSA_METHOD *RSA_null_method(void)
     return NULL;
 }
 
+/*
+ * Montgomery contexts are set up on first use, under the key lock, unless
+ * ossl_rsa_precompute() already did so when the key was loaded.  They never
+ * change afterwards, so they can then be used without taking the lock.
+ */
+static BN_MONT_CTX *rsa_mont_ctx(RSA *rsa, BN_MONT_CTX **pmont,
+                                 const BIGNUM *mod, BN_CTX *ctx)
+{
+    if (rsa->mont_precomputed && *pmont != NULL)
+        return *pmont;
+    return BN_MONT_CTX_set_locked(pmont, rsa->lock, mod, ctx);
+}
+
+static int rsa_set_mont_private(RSA *rsa, BN_CTX *ctx)
+{
+    BIGNUM *factor = BN_new();
+    int ret = 0;
+#ifndef FIPS_MODULE
+    int i, ex_primes = 0;
+    RSA_PRIME_INFO *pinfo;
+#endif
+
+    if (factor == NULL)
+        return 0;
+
+    /*
+     * Make sure BN_mod_inverse in Montgomery initialization uses the
+     * BN_FLG_CONSTTIME flag
+     */
+    if (!(BN_with_flags(factor, rsa->p, BN_FLG_CONSTTIME),
+          BN_MONT_CTX_set_locked(&rsa->_method_mod_p, rsa->lock,
+                                 factor, ctx))
+        || !(BN_with_flags(factor, rsa->q, BN_FLG_CONSTTIME),
+             BN_MONT_CTX_set_locked(&rsa->_method_mod_q, rsa->lock,
+                                    factor, ctx)))
+        goto err;
+#ifndef FIPS_MODULE
+    if (rsa->version == RSA_ASN1_VERSION_MULTI)
+        ex_primes = sk_RSA_PRIME_INFO_num(rsa->prime_infos);
+    for (i = 0; i < ex_primes; i++) {
+        pinfo = sk_RSA_PRIME_INFO_value(rsa->prime_infos, i);
+        BN_with_flags(factor, pinfo->r, BN_FLG_CONSTTIME);
+        if (!BN_MONT_CTX_set_locked(&pinfo->m, rsa->lock, factor, ctx))
+            goto err;
+    }
+#endif
+    ret = 1;
+ err:
+    /*
+     * We MUST free |factor| before any further use of the prime factors
+     */
+    BN_free(factor);
+    return ret;
+}
+
+/*
+ * Sets up everything private key operations on |rsa| need to share, so
+ * that they run without taking the key lock.  This must be called before
+ * the key is shared between threads, typically right after loading it.
+ * Keys that don't use the built-in implementation are left alone, and so are
+ * keys for which the setup fails, they get their contexts on first use.
+ */
+void ossl_rsa_precompute(RSA *rsa)
+{
+    BN_CTX *ctx;
+
+    if (rsa->meth != &rsa_pkcs1_ossl_meth || rsa->mont_precomputed
+        || rsa->n == NULL || rsa->d == NULL)
+        return;
+
+    ERR_set_mark();
+    if ((ctx = BN_CTX_new_ex(rsa->libctx)) != NULL
+        && ((rsa->flags & RSA_FLAG_CACHE_PUBLIC) == 0
+            || BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
+                                      rsa->n, ctx) != NULL)
+        && ((rsa->flags & RSA_FLAG_CACHE_PRIVATE) == 0
+            || rsa->p == NULL || rsa->q == NULL
+            || rsa_set_mont_private(rsa, ctx)))
+        rsa->mont_precomputed = 1;
+    ERR_pop_to_mark();
+    BN_CTX_free(ctx);
+}
+
 static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
                                   unsigned char *to, RSA *rsa, int padding)
 {
@@ -187,8 +273,7 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx(rsa, &rsa->_method_mod_n, rsa->n, ctx))
             goto err;
 
     if (!rsa->meth->bn_mod_exp(ret, f, rsa->e, rsa->n, ctx,
@@ -207,10 +292,142 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     return r;
 }
 
+#ifndef FIPS_MODULE
+/*
+ * Each thread keeps blindings for the last few keys it performed private
+ * key operations with, so that threads sharing a key neither need the key
+ * lock nor contend for its shared blinding.  Keys are identified by an id
+ * rather than their address, which may be reused once a key is freed.
+ */
+# define RSA_THREAD_BLINDINGS 4
+
+typedef struct {
+    uint64_t id;
+    int dirty_cnt;
+    BN_BLINDING *blinding;
+} RSA_THREAD_BLINDING;
+
+typedef struct {
+    RSA_THREAD_BLINDING entries[RSA_THREAD_BLINDINGS];
+    size_t next;
+} RSA_THREAD_BLINDINGS_CACHE;
+
+static CRYPTO_ONCE rsa_blinding_init = CRYPTO_ONCE_STATIC_INIT;
+static int rsa_blinding_inited = 0;
+static CRYPTO_THREAD_LOCAL rsa_blinding_local;
+static CRYPTO_RWLOCK *rsa_blinding_id_lock = NULL;
+static uint64_t rsa_blinding_next_id = 0;
+
+DEFINE_RUN_ONCE_STATIC(do_rsa_blinding_init)
+{
+    if (!CRYPTO_THREAD_init_local(&rsa_blinding_local, NULL))
+        return 0;
+    if ((rsa_blinding_id_lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        CRYPTO_THREAD_cleanup_local(&rsa_blinding_local);
+        return 0;
+    }
+    rsa_blinding_inited = 1;
+    return 1;
+}
+
+void ossl_rsa_cleanup_int(void)
+{
+    if (!rsa_blinding_inited)
+        return;
+    CRYPTO_THREAD_cleanup_local(&rsa_blinding_local);
+    CRYPTO_THREAD_lock_free(rsa_blinding_id_lock);
+    rsa_blinding_id_lock = NULL;
+    rsa_blinding_inited = 0;
+}
+
+static void rsa_delete_thread_blindings(void *unused)
+{
+    RSA_THREAD_BLINDINGS_CACHE *cache;
+    size_t i;
+
+    if (!rsa_blinding_inited)
+        return;
+    cache = CRYPTO_THREAD_get_local(&rsa_blinding_local);
+    if (cache == NULL)
+        return;
+    CRYPTO_THREAD_set_local(&rsa_blinding_local, NULL);
+    for (i = 0; i < RSA_THREAD_BLINDINGS; i++)
+        BN_BLINDING_free(cache->entries[i].blinding);
+    OPENSSL_free(cache);
+}
+
+/* Gives |rsa| its id, if possible */
+static void rsa_set_blinding_id(RSA *rsa)
+{
+    uint64_t id;
+
+    rsa->blinding_id = 0;
+    if (RUN_ONCE(&rsa_blinding_init, do_rsa_blinding_init)
+        && rsa_blinding_inited
+        && CRYPTO_atomic_add64(&rsa_blinding_next_id, 1, &id,
+                               rsa_blinding_id_lock))
+        rsa->blinding_id = id;
+}
+
+/*
+ * Returns the blinding of the calling thread for |rsa|, which can be used
+ * without locking, or NULL if there's none.
+ */
+static BN_BLINDING *rsa_get_thread_blinding(RSA *rsa, BN_CTX *ctx)
+{
+    RSA_THREAD_BLINDINGS_CACHE *cache;
+    RSA_THREAD_BLINDING *entry;
+    size_t i;
+
+    if (rsa->blinding_id == 0 || !rsa_blinding_inited)
+        return NULL;
+
+    cache = CRYPTO_THREAD_get_local(&rsa_blinding_local);
+    if (cache == NULL) {
+        if ((cache = OPENSSL_zalloc(sizeof(*cache))) == NULL)
+            return NULL;
+        if (!ossl_init_thread_start(NULL, NULL, rsa_delete_thread_blindings)
+            || !CRYPTO_THREAD_set_local(&rsa_blinding_local, cache)) {
+            OPENSSL_free(cache);
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < RSA_THREAD_BLINDINGS; i++) {
+        entry = &cache->entries[i];
+        if (entry->id == rsa->blinding_id) {
+            if (entry->dirty_cnt == rsa->dirty_cnt)
+                return entry->blinding;
+            /* The key was modified, replace its blinding */
+            break;
+        }
+    }
+    if (i == RSA_THREAD_BLINDINGS) {
+        entry = &cache->entries[cache->next];
+        cache->next = (cache->next + 1) % RSA_THREAD_BLINDINGS;
+    }
+
+    BN_BLINDING_free(entry->blinding);
+    entry->id = 0;
+    if ((entry->blinding = RSA_setup_blinding(rsa, ctx)) == NULL)
+        return NULL;
+    entry->id = rsa->blinding_id;
+    entry->dirty_cnt = rsa->dirty_cnt;
+    return entry->blinding;
+}
+#endif
+
 static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
 {
     BN_BLINDING *ret;
 
+#ifndef FIPS_MODULE
+    if ((ret = rsa_get_thread_blinding(rsa, ctx)) != NULL) {
+        *local = 1;
+        return ret;
+    }
+#endif
+
     if (!CRYPTO_THREAD_read_lock(rsa->lock))
         return NULL;
 
@@ -354,8 +571,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx(rsa, &rsa->_method_mod_n, rsa->n, ctx))
             goto err;
 
     if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
@@ -601,8 +817,7 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
         }
     }
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx(rsa, &rsa->_method_mod_n, rsa->n, ctx))
             goto err;
 
     if (!(rsa->flags & RSA_FLAG_NO_BLINDING)) {
@@ -761,8 +976,7 @@ static int rsa_ossl_public_decrypt(int flen, const unsigned char *from,
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx(rsa, &rsa->_method_mod_n, rsa->n, ctx))
             goto err;
 
     if (!rsa->meth->bn_mod_exp(ret, f, rsa->e, rsa->n, ctx,
@@ -831,39 +1045,10 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 #endif
 
     if (rsa->flags & RSA_FLAG_CACHE_PRIVATE) {
-        BIGNUM *factor = BN_new();
-
-        if (factor == NULL)
+        if ((!rsa->mont_precomputed || rsa->_method_mod_p == NULL)
+            && !rsa_set_mont_private(rsa, ctx))
             goto err;
 
-        /*
-         * Make sure BN_mod_inverse in Montgomery initialization uses the
-         * BN_FLG_CONSTTIME flag
-         */
-        if (!(BN_with_flags(factor, rsa->p, BN_FLG_CONSTTIME),
-              BN_MONT_CTX_set_locked(&rsa->_method_mod_p, rsa->lock,
-                                     factor, ctx))
-            || !(BN_with_flags(factor, rsa->q, BN_FLG_CONSTTIME),
-                 BN_MONT_CTX_set_locked(&rsa->_method_mod_q, rsa->lock,
-                                        factor, ctx))) {
-            BN_free(factor);
-            goto err;
-        }
-#ifndef FIPS_MODULE
-        for (i = 0; i < ex_primes; i++) {
-            pinfo = sk_RSA_PRIME_INFO_value(rsa->prime_infos, i);
-            BN_with_flags(factor, pinfo->r, BN_FLG_CONSTTIME);
-            if (!BN_MONT_CTX_set_locked(&pinfo->m, rsa->lock, factor, ctx)) {
-                BN_free(factor);
-                goto err;
-            }
-        }
-#endif
-        /*
-         * We MUST free |factor| before any further use of the prime factors
-         */
-        BN_free(factor);
-
         smooth = (rsa->meth->bn_mod_exp == BN_mod_exp_mont)
 #ifndef FIPS_MODULE
                  && (ex_primes == 0)
@@ -872,8 +1057,7 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
-        if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
-                                    rsa->n, ctx))
+        if (!rsa_mont_ctx(rsa, &rsa->_method_mod_n, rsa->n, ctx))
             goto err;
 
     if (smooth) {
@@ -1176,6 +1360,9 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 static int rsa_ossl_init(RSA *rsa)
 {
     rsa->flags |= RSA_FLAG_CACHE_PUBLIC | RSA_FLAG_CACHE_PRIVATE;
+#ifndef FIPS_MODULE
+    rsa_set_blinding_id(rsa);
+#endif
     return 1;
 }
 
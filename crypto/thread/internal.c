@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -151,6 +151,7 @@ void ossl_threads_ctx_free(void *vdata)
     if (t == NULL)
         return;
 
+    ossl_crypto_pool_free(t->pool);
     ossl_crypto_mutex_free(&t->lock);
     ossl_crypto_condvar_free(&t->cond_finished);
     OPENSSL_free(t);
@@ -0,0 +1,479 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <openssl/configuration.h>
+#include <openssl/e_os2.h>
+#include <openssl/types.h>
+#include <openssl/crypto.h>
+#include <internal/thread.h>
+#include <internal/thread_arch.h>
+
+#if !defined(OPENSSL_NO_DEFAULT_THREAD_POOL)
+
+/*
+ * A persistent work-stealing executor owned by an OSSL_LIB_CTX.
+ *
+ * Every worker owns a deque of tasks.  A worker pushes and pops its own
+ * tasks at the bottom of its deque and, once that is empty, steals from the
+ * top of the other deques.  Tasks submitted by threads that are not workers
+ * of the pool go to a shared injection deque at index 0.  Idle workers park
+ * on a condition variable and are unparked when new work is queued.
+ *
+ * Workers are started on demand, up to the limit set with
+ * OSSL_set_max_threads(), and live until the library context is freed.
+ * They are accounted separately from the threads started with
+ * ossl_crypto_thread_start().
+ */
+
+# define POOL_MAX_WORKERS       64
+# define DEQUE_INITIAL_SIZE     16
+
+struct ossl_thread_task_st {
+    OSSL_THREAD_POOL *pool;
+    CRYPTO_THREAD_ROUTINE routine;
+    void *data;
+    size_t home;                /* deque the task was queued on */
+    size_t slot;                /* position within that deque */
+    int queued;                 /* protected by the home deque lock */
+    int done;                   /* protected by the pool lock */
+    int cancelled;              /* protected by the pool lock */
+    CRYPTO_THREAD_RETVAL retval;
+};
+
+typedef struct {
+    CRYPTO_MUTEX *lock;
+    OSSL_THREAD_TASK **tasks;
+    size_t size;
+    /* Monotonic positions, the deque holds the tasks in [top, bottom) */
+    size_t top;
+    size_t bottom;
+} TASK_DEQUE;
+
+typedef struct {
+    OSSL_THREAD_POOL *pool;
+    size_t index;
+    CRYPTO_THREAD *thread;
+} POOL_WORKER;
+
+struct ossl_thread_pool_st {
+    CRYPTO_MUTEX *lock;
+    CRYPTO_CONDVAR *work_cond;
+    CRYPTO_CONDVAR *done_cond;
+    CRYPTO_RWLOCK *atomic_lock;
+    CRYPTO_THREAD_LOCAL self;
+    int self_init;
+    /* Atomically accessed counters */
+    int nworkers;
+    int queued;
+    /* Protected by lock */
+    int idle;
+    int stopping;
+    TASK_DEQUE deques[POOL_MAX_WORKERS + 1];
+    POOL_WORKER workers[POOL_MAX_WORKERS];
+};
+
+static int deque_init(TASK_DEQUE *d)
+{
+    d->lock = ossl_crypto_mutex_new();
+    d->tasks = OPENSSL_malloc(DEQUE_INITIAL_SIZE * sizeof(*d->tasks));
+    if (d->lock == NULL || d->tasks == NULL) {
+        ossl_crypto_mutex_free(&d->lock);
+        OPENSSL_free(d->tasks);
+        d->tasks = NULL;
+        return 0;
+    }
+    d->size = DEQUE_INITIAL_SIZE;
+    d->top = d->bottom = 0;
+    return 1;
+}
+
+static void deque_cleanup(TASK_DEQUE *d)
+{
+    ossl_crypto_mutex_free(&d->lock);
+    OPENSSL_free(d->tasks);
+    d->tasks = NULL;
+}
+
+static int deque_push(TASK_DEQUE *d, OSSL_THREAD_TASK *task)
+{
+    ossl_crypto_mutex_lock(d->lock);
+    if (d->bottom - d->top == d->size) {
+        OSSL_THREAD_TASK **n;
+        size_t i;
+
+        n = OPENSSL_malloc(2 * d->size * sizeof(*n));
+        if (n == NULL) {
+            ossl_crypto_mutex_unlock(d->lock);
+            return 0;
+        }
+        for (i = d->top; i != d->bottom; i++) {
+            n[i % (2 * d->size)] = d->tasks[i % d->size];
+            if (n[i % (2 * d->size)] != NULL)
+                n[i % (2 * d->size)]->slot = i % (2 * d->size);
+        }
+        OPENSSL_free(d->tasks);
+        d->tasks = n;
+        d->size *= 2;
+    }
+    task->slot = d->bottom % d->size;
+    task->queued = 1;
+    d->tasks[task->slot] = task;
+    d->bottom++;
+    ossl_crypto_mutex_unlock(d->lock);
+    return 1;
+}
+
+/*
+ * Takes a task from the bottom (owner) or top (thief) of a deque.  Slots of
+ * tasks that were claimed by a waiter or cancelled are NULL and skipped.
+ */
+static OSSL_THREAD_TASK *deque_take(TASK_DEQUE *d, int steal)
+{
+    OSSL_THREAD_TASK *task = NULL;
+
+    ossl_crypto_mutex_lock(d->lock);
+    while (task == NULL && d->bottom != d->top) {
+        if (steal)
+            task = d->tasks[d->top++ % d->size];
+        else
+            task = d->tasks[--d->bottom % d->size];
+    }
+    if (task != NULL)
+        task->queued = 0;
+    ossl_crypto_mutex_unlock(d->lock);
+    return task;
+}
+
+/*
+ * Removes a still queued task from its deque so that the caller can run or
+ * discard it.  Returns 1 if the task was taken, 0 if a worker got it first.
+ */
+static int pool_claim(OSSL_THREAD_POOL *pool, OSSL_THREAD_TASK *task)
+{
+    TASK_DEQUE *d = &pool->deques[task->home];
+    int ret = 0, unused;
+
+    ossl_crypto_mutex_lock(d->lock);
+    if (task->queued) {
+        d->tasks[task->slot] = NULL;
+        task->queued = 0;
+        ret = 1;
+    }
+    ossl_crypto_mutex_unlock(d->lock);
+    if (ret)
+        CRYPTO_atomic_add(&pool->queued, -1, &unused, pool->atomic_lock);
+    return ret;
+}
+
+static OSSL_THREAD_TASK *pool_next_task(OSSL_THREAD_POOL *pool, size_t own)
+{
+    OSSL_THREAD_TASK *task;
+    int n = 0, unused;
+    size_t i;
+
+    if ((task = deque_take(&pool->deques[own], 0)) == NULL) {
+        CRYPTO_atomic_load_int(&pool->nworkers, &n, pool->atomic_lock);
+        for (i = 1; task == NULL && i <= (size_t)n; i++)
+            task = deque_take(&pool->deques[(own + i) % (n + 1)], 1);
+    }
+    if (task != NULL)
+        CRYPTO_atomic_add(&pool->queued, -1, &unused, pool->atomic_lock);
+    return task;
+}
+
+static void pool_run(OSSL_THREAD_POOL *pool, OSSL_THREAD_TASK *task)
+{
+    CRYPTO_THREAD_RETVAL retval = task->routine(task->data);
+
+    ossl_crypto_mutex_lock(pool->lock);
+    task->retval = retval;
+    task->done = 1;
+    ossl_crypto_condvar_broadcast(pool->done_cond);
+    ossl_crypto_mutex_unlock(pool->lock);
+}
+
+static CRYPTO_THREAD_RETVAL pool_worker_main(void *arg)
+{
+    POOL_WORKER *w = arg;
+    OSSL_THREAD_POOL *pool = w->pool;
+    OSSL_THREAD_TASK *task;
+    int queued;
+
+    CRYPTO_THREAD_set_local(&pool->self, w);
+    for (;;) {
+        if ((task = pool_next_task(pool, w->index)) != NULL) {
+            pool_run(pool, task);
+            continue;
+        }
+
+        ossl_crypto_mutex_lock(pool->lock);
+        for (;;) {
+            CRYPTO_atomic_load_int(&pool->queued, &queued, pool->atomic_lock);
+            if (pool->stopping || queued > 0)
+                break;
+            pool->idle++;
+            ossl_crypto_condvar_wait(pool->work_cond, pool->lock);
+            pool->idle--;
+        }
+        if (pool->stopping) {
+            ossl_crypto_mutex_unlock(pool->lock);
+            break;
+        }
+        ossl_crypto_mutex_unlock(pool->lock);
+    }
+    CRYPTO_THREAD_set_local(&pool->self, NULL);
+    return 1;
+}
+
+/* Must be called with pool->lock held */
+static void pool_add_worker(OSSL_THREAD_POOL *pool)
+{
+    POOL_WORKER *w;
+    int n, unused;
+
+    CRYPTO_atomic_load_int(&pool->nworkers, &n, pool->atomic_lock);
+    w = &pool->workers[n];
+    w->pool = pool;
+    w->index = n + 1;
+    if (!deque_init(&pool->deques[w->index]))
+        return;
+    w->thread = ossl_crypto_thread_native_start(pool_worker_main, w, 1);
+    if (w->thread == NULL) {
+        deque_cleanup(&pool->deques[w->index]);
+        return;
+    }
+    /* Publish the deque to thieves only once it is fully set up */
+    CRYPTO_atomic_add(&pool->nworkers, 1, &unused, pool->atomic_lock);
+}
+
+static void pool_free(OSSL_THREAD_POOL *pool)
+{
+    int i, n = 0;
+
+    if (pool == NULL)
+        return;
+
+    if (pool->lock != NULL) {
+        ossl_crypto_mutex_lock(pool->lock);
+        pool->stopping = 1;
+        ossl_crypto_condvar_broadcast(pool->work_cond);
+        ossl_crypto_mutex_unlock(pool->lock);
+    }
+
+    CRYPTO_atomic_load_int(&pool->nworkers, &n, pool->atomic_lock);
+    for (i = 0; i < n; i++) {
+        ossl_crypto_thread_native_join(pool->workers[i].thread, NULL);
+        ossl_crypto_thread_native_clean(pool->workers[i].thread);
+    }
+    for (i = 0; i <= n; i++)
+        deque_cleanup(&pool->deques[i]);
+
+    if (pool->self_init)
+        CRYPTO_THREAD_cleanup_local(&pool->self);
+    CRYPTO_THREAD_lock_free(pool->atomic_lock);
+    ossl_crypto_condvar_free(&pool->done_cond);
+    ossl_crypto_condvar_free(&pool->work_cond);
+    ossl_crypto_mutex_free(&pool->lock);
+    OPENSSL_free(pool);
+}
+
+static OSSL_THREAD_POOL *pool_new(void)
+{
+    OSSL_THREAD_POOL *pool = OPENSSL_zalloc(sizeof(*pool));
+
+    if (pool == NULL)
+        return NULL;
+
+    pool->lock = ossl_crypto_mutex_new();
+    pool->work_cond = ossl_crypto_condvar_new();
+    pool->done_cond = ossl_crypto_condvar_new();
+    pool->atomic_lock = CRYPTO_THREAD_lock_new();
+    if (pool->lock == NULL || pool->work_cond == NULL
+            || pool->done_cond == NULL || pool->atomic_lock == NULL
+            || !deque_init(&pool->deques[0]))
+        goto err;
+    if (!CRYPTO_THREAD_init_local(&pool->self, NULL))
+        goto err;
+    pool->self_init = 1;
+    return pool;
+
+err:
+    pool_free(pool);
+    return NULL;
+}
+
+/*
+ * Returns the pool of |ctx|, creating it if necessary, along with the
+ * current worker limit.  Returns NULL if threading is disabled for |ctx|.
+ */
+static OSSL_THREAD_POOL *pool_get(OSSL_LIB_CTX *ctx, uint64_t *limit)
+{
+    OSSL_LIB_CTX_THREADS *tdata = OSSL_LIB_CTX_GET_THREADS(ctx);
+    OSSL_THREAD_POOL *pool = NULL;
+
+    if (tdata == NULL)
+        return NULL;
+
+    ossl_crypto_mutex_lock(tdata->lock);
+    if (tdata->max_threads > 0) {
+        if (tdata->pool == NULL)
+            tdata->pool = pool_new();
+        pool = tdata->pool;
+        *limit = tdata->max_threads < POOL_MAX_WORKERS
+                 ? tdata->max_threads : POOL_MAX_WORKERS;
+    }
+    ossl_crypto_mutex_unlock(tdata->lock);
+    return pool;
+}
+
+OSSL_THREAD_TASK *ossl_crypto_pool_submit(OSSL_LIB_CTX *ctx,
+                                          CRYPTO_THREAD_ROUTINE routine,
+                                          void *data)
+{
+    OSSL_THREAD_POOL *pool;
+    OSSL_THREAD_TASK *task;
+    POOL_WORKER *self;
+    uint64_t limit = 0;
+    int n, unused;
+
+    if ((pool = pool_get(ctx, &limit)) == NULL)
+        return NULL;
+
+    if ((task = OPENSSL_zalloc(sizeof(*task))) == NULL)
+        return NULL;
+    task->pool = pool;
+    task->routine = routine;
+    task->data = data;
+
+    /* Workers queue nested tasks locally, everybody else on the injector */
+    self = CRYPTO_THREAD_get_local(&pool->self);
+    task->home = self != NULL ? self->index : 0;
+    if (!deque_push(&pool->deques[task->home], task)) {
+        OPENSSL_free(task);
+        return NULL;
+    }
+    CRYPTO_atomic_add(&pool->queued, 1, &unused, pool->atomic_lock);
+
+    ossl_crypto_mutex_lock(pool->lock);
+    CRYPTO_atomic_load_int(&pool->nworkers, &n, pool->atomic_lock);
+    if (pool->idle > 0)
+        ossl_crypto_condvar_signal(pool->work_cond);
+    else if ((uint64_t)n < limit)
+        pool_add_worker(pool);
+    ossl_crypto_mutex_unlock(pool->lock);
+
+    return task;
+}
+
+int ossl_crypto_pool_wait(OSSL_THREAD_TASK *task, CRYPTO_THREAD_RETVAL *retval)
+{
+    OSSL_THREAD_POOL *pool;
+    int ret;
+
+    if (task == NULL)
+        return 0;
+    pool = task->pool;
+
+    /*
+     * If nobody picked the task up yet, run it here.  Besides saving a
+     * context switch this guarantees progress when a worker waits on a task
+     * that it queued itself.
+     */
+    if (pool_claim(pool, task))
+        pool_run(pool, task);
+
+    ossl_crypto_mutex_lock(pool->lock);
+    while (!task->done)
+        ossl_crypto_condvar_wait(pool->done_cond, pool->lock);
+    ret = !task->cancelled;
+    if (ret && retval != NULL)
+        *retval = task->retval;
+    ossl_crypto_mutex_unlock(pool->lock);
+    return ret;
+}
+
+int ossl_crypto_pool_cancel(OSSL_THREAD_TASK *task)
+{
+    OSSL_THREAD_POOL *pool;
+
+    if (task == NULL)
+        return 0;
+    pool = task->pool;
+
+    if (!pool_claim(pool, task))
+        return 0;
+
+    ossl_crypto_mutex_lock(pool->lock);
+    task->cancelled = 1;
+    task->done = 1;
+    ossl_crypto_mutex_unlock(pool->lock);
+    return 1;
+}
+
+int ossl_crypto_pool_task_done(OSSL_THREAD_TASK *task)
+{
+    int ret;
+
+    if (task == NULL)
+        return 0;
+
+    ossl_crypto_mutex_lock(task->pool->lock);
+    ret = task->done;
+    ossl_crypto_mutex_unlock(task->pool->lock);
+    return ret;
+}
+
+void ossl_crypto_pool_task_free(OSSL_THREAD_TASK *task)
+{
+    if (task == NULL)
+        return;
+
+    if (!ossl_crypto_pool_cancel(task))
+        ossl_crypto_pool_wait(task, NULL);
+    OPENSSL_free(task);
+}
+
+void ossl_crypto_pool_free(OSSL_THREAD_POOL *pool)
+{
+    pool_free(pool);
+}
+
+#else
+
+OSSL_THREAD_TASK *ossl_crypto_pool_submit(OSSL_LIB_CTX *ctx,
+                                          CRYPTO_THREAD_ROUTINE routine,
+                                          void *data)
+{
+    return NULL;
+}
+
+int ossl_crypto_pool_wait(OSSL_THREAD_TASK *task, CRYPTO_THREAD_RETVAL *retval)
+{
+    return 0;
+}
+
+int ossl_crypto_pool_cancel(OSSL_THREAD_TASK *task)
+{
+    return 0;
+}
+
+int ossl_crypto_pool_task_done(OSSL_THREAD_TASK *task)
+{
+    return 0;
+}
+
+void ossl_crypto_pool_task_free(OSSL_THREAD_TASK *task)
+{
+}
+
+void ossl_crypto_pool_free(OSSL_THREAD_POOL *pool)
+{
+}
+
+#endif
@@ -0,0 +1,351 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include "internal/cryptlib.h"
+#include <openssl/x509.h>
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# define CERT_IDX_MMAP
+#endif
+
+/*
+ * Lookup of certificates in an index file written by "openssl rehash -index".
+ *
+ * The file is mapped into memory and never changed, so that looking up a
+ * subject takes one hash table probe and no filesystem calls. All numbers
+ * in the file are 32-bit unsigned big-endian integers. The file consists of:
+ *
+ *   - the magic "OSSLCIDX", the format version 1, the number of hash
+ *     buckets, which is a power of 2, the number of entries, and 0,
+ *   - number of buckets + 1 entry numbers, where the entries of bucket b
+ *     are those starting from entry number b up to entry number b + 1,
+ *   - the entries, each consisting of the X509_NAME_hash_ex() value of the
+ *     certificate subject, and the offset and length of the certificate,
+ *   - the DER-encoded certificates.
+ *
+ * The bucket of a certificate is its subject hash modulo the number of
+ * buckets.
+ */
+
+#define CERT_IDX_MAGIC      "OSSLCIDX"
+#define CERT_IDX_VERSION    1
+#define CERT_IDX_HDR_LEN    24
+#define CERT_IDX_ENTRY_LEN  12
+
+typedef struct cert_index_st {
+    const unsigned char *data;
+    size_t len;
+    int mapped;
+    uint32_t num_buckets;
+    uint32_t num_entries;
+    const unsigned char *buckets;
+    const unsigned char *entries;
+} CERT_INDEX;
+
+DEFINE_STACK_OF(CERT_INDEX)
+
+typedef struct lookup_index_st {
+    CRYPTO_RWLOCK *lock;
+    STACK_OF(CERT_INDEX) *indexes;
+} BY_INDEX;
+
+static uint32_t get_u32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+        | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void cert_index_free(CERT_INDEX *idx)
+{
+    if (idx == NULL)
+        return;
+#ifdef CERT_IDX_MMAP
+    if (idx->mapped)
+        munmap((void *)idx->data, idx->len);
+    else
+#endif
+        OPENSSL_free((void *)idx->data);
+    OPENSSL_free(idx);
+}
+
+static int cert_index_read(CERT_INDEX *idx, const char *file)
+{
+    BIO *in;
+    unsigned char *data = NULL, *tmp;
+    long len = 0;
+    int n;
+
+#ifdef CERT_IDX_MMAP
+    struct stat st;
+    void *map;
+    int fd;
+
+    if ((fd = open(file, O_RDONLY)) >= 0) {
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+            && (unsigned long long)st.st_size <= LONG_MAX) {
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                idx->data = map;
+                idx->len = (size_t)st.st_size;
+                idx->mapped = 1;
+            }
+        }
+        close(fd);
+        if (idx->data != NULL)
+            return 1;
+    }
+#endif
+
+    if ((in = BIO_new_file(file, "rb")) == NULL)
+        return 0;
+    for (;;) {
+        if (len > LONG_MAX - 65536
+            || (tmp = OPENSSL_realloc(data, len + 65536)) == NULL) {
+            OPENSSL_free(data);
+            BIO_free(in);
+            return 0;
+        }
+        data = tmp;
+        if ((n = BIO_read(in, data + len, 65536)) <= 0)
+            break;
+        len += n;
+    }
+    BIO_free(in);
+    idx->data = data;
+    idx->len = (size_t)len;
+    return 1;
+}
+
+/* Check the header and the bucket table, the entries are checked on use */
+static int cert_index_check(CERT_INDEX *idx)
+{
+    const unsigned char *p = idx->data;
+    uint32_t b, prev = 0, cur;
+
+    if (idx->len < CERT_IDX_HDR_LEN
+            || memcmp(p, CERT_IDX_MAGIC, 8) != 0
+            || get_u32(p + 8) != CERT_IDX_VERSION)
+        return 0;
+    idx->num_buckets = get_u32(p + 12);
+    idx->num_entries = get_u32(p + 16);
+    if (idx->num_buckets == 0
+            || (idx->num_buckets & (idx->num_buckets - 1)) != 0
+            || (size_t)idx->num_buckets + 1 > (idx->len - CERT_IDX_HDR_LEN) / 4)
+        return 0;
+    idx->buckets = p + CERT_IDX_HDR_LEN;
+    idx->entries = idx->buckets + 4 * ((size_t)idx->num_buckets + 1);
+    if (idx->num_entries > (size_t)(idx->data + idx->len - idx->entries)
+                           / CERT_IDX_ENTRY_LEN)
+        return 0;
+    for (b = 0; b <= idx->num_buckets; b++) {
+        cur = get_u32(idx->buckets + 4 * (size_t)b);
+        if (cur < prev || cur > idx->num_entries)
+            return 0;
+        prev = cur;
+    }
+    return prev == idx->num_entries;
+}
+
+static int by_index_load(BY_INDEX *ctx, const char *file)
+{
+    CERT_INDEX *idx;
+
+    if (file == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if ((idx = OPENSSL_zalloc(sizeof(*idx))) == NULL)
+        return 0;
+    if (!cert_index_read(idx, file))
+        goto err;
+    if (!cert_index_check(idx)) {
+        ERR_raise_data(ERR_LIB_X509, X509_R_INVALID_INDEX_FILE, "%s", file);
+        goto err;
+    }
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        goto err;
+    if (!sk_CERT_INDEX_push(ctx->indexes, idx)) {
+        CRYPTO_THREAD_unlock(ctx->lock);
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return 1;
+
+ err:
+    cert_index_free(idx);
+    return 0;
+}
+
+static int new_index(X509_LOOKUP *lu)
+{
+    BY_INDEX *a = OPENSSL_malloc(sizeof(*a));
+
+    if (a == NULL)
+        return 0;
+    if ((a->indexes = sk_CERT_INDEX_new_null()) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+    if ((a->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        sk_CERT_INDEX_free(a->indexes);
+        goto err;
+    }
+    lu->method_data = a;
+    return 1;
+
+ err:
+    OPENSSL_free(a);
+    return 0;
+}
+
+static void free_index(X509_LOOKUP *lu)
+{
+    BY_INDEX *a = (BY_INDEX *)lu->method_data;
+
+    sk_CERT_INDEX_pop_free(a->indexes, cert_index_free);
+    CRYPTO_THREAD_lock_free(a->lock);
+    OPENSSL_free(a);
+}
+
+static int index_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp,
+                      long argl, char **retp)
+{
+    switch (cmd) {
+    case X509_L_LOAD_INDEX:
+        return by_index_load((BY_INDEX *)ctx->method_data, argp);
+    default:
+        /* Unsupported command */
+        return 0;
+    }
+}
+
+/*
+ * Add all certificates in |idx| with subject |name| and subject hash |h|
+ * to |store|. Returns the number of certificates added, or -1 on error.
+ */
+static int add_index_certs(X509_STORE *store, const CERT_INDEX *idx,
+                           uint32_t h, const X509_NAME *name,
+                           OSSL_LIB_CTX *libctx, const char *propq)
+{
+    uint32_t b = h & (idx->num_buckets - 1);
+    uint32_t e = get_u32(idx->buckets + 4 * (size_t)b);
+    uint32_t end = get_u32(idx->buckets + 4 * ((size_t)b + 1));
+    const unsigned char *p, *der;
+    uint32_t off, len;
+    X509 *x;
+    int n = 0;
+
+    for (; e < end; e++) {
+        p = idx->entries + CERT_IDX_ENTRY_LEN * (size_t)e;
+        if (get_u32(p) != h)
+            continue;
+        off = get_u32(p + 4);
+        len = get_u32(p + 8);
+        if (off > idx->len || len > idx->len - off)
+            continue;
+        der = idx->data + off;
+        if ((x = X509_new_ex(libctx, propq)) == NULL)
+            return -1;
+        if (d2i_X509(&x, &der, (long)len) == NULL) {
+            X509_free(x);
+            continue;
+        }
+        if (X509_NAME_cmp(X509_get_subject_name(x), name) == 0) {
+            if (!X509_STORE_add_cert(store, x)) {
+                X509_free(x);
+                return -1;
+            }
+            n++;
+        }
+        X509_free(x);
+    }
+    return n;
+}
+
+static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                                  const X509_NAME *name, X509_OBJECT *ret,
+                                  OSSL_LIB_CTX *libctx, const char *propq)
+{
+    BY_INDEX *ctx = (BY_INDEX *)xl->method_data;
+    X509_OBJECT *tmp = NULL;
+    unsigned long h;
+    int i, n, found = 0, ok = 0;
+
+    /* Index files hold certificates only */
+    if (name == NULL || type != X509_LU_X509)
+        return 0;
+
+    h = X509_NAME_hash_ex(name, libctx, propq, &ok);
+    if (!ok)
+        return 0;
+
+    if (!CRYPTO_THREAD_read_lock(ctx->lock))
+        return 0;
+    for (i = 0; i < sk_CERT_INDEX_num(ctx->indexes); i++) {
+        n = add_index_certs(xl->store_ctx, sk_CERT_INDEX_value(ctx->indexes, i),
+                            (uint32_t)h, name, libctx, propq);
+        if (n < 0) {
+            found = 0;
+            break;
+        }
+        found += n;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    if (found == 0)
+        return 0;
+
+    /* We have added the certificates to the cache so now pull one out again */
+    if (!X509_STORE_lock(xl->store_ctx))
+        return 0;
+    if (!sk_X509_OBJECT_is_sorted(xl->store_ctx->objs))
+        sk_X509_OBJECT_sort(xl->store_ctx->objs);
+    tmp = X509_OBJECT_retrieve_by_subject(xl->store_ctx->objs, type, name);
+    X509_STORE_unlock(xl->store_ctx);
+
+    if (tmp == NULL)
+        return 0;
+    ret->type = tmp->type;
+    memcpy(&ret->data, &tmp->data, sizeof(ret->data));
+    return 1;
+}
+
+static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                               const X509_NAME *name, X509_OBJECT *ret)
+{
+    return get_cert_by_subject_ex(xl, type, name, ret, NULL, NULL);
+}
+
+static X509_LOOKUP_METHOD x509_index_lookup = {
+    "Load certs from an index file",
+    new_index,                  /* new_item */
+    free_index,                 /* free */
+    NULL,                       /* init */
+    NULL,                       /* shutdown */
+    index_ctrl,                 /* ctrl */
+    get_cert_by_subject,        /* get_by_subject */
+    NULL,                       /* get_by_issuer_serial */
+    NULL,                       /* get_by_fingerprint */
+    NULL,                       /* get_by_alias */
+    get_cert_by_subject_ex,     /* get_by_subject_ex */
+    NULL,                       /* ctrl_ex */
+};
+
+X509_LOOKUP_METHOD *X509_LOOKUP_index(void)
+{
+    return &x509_index_lookup;
+}
@@ -14,6 +14,7 @@
 #include <openssl/objects.h>
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
+#include "x509_local.h"
 
 #ifndef OPENSSL_NO_STDIO
 int X509_CRL_print_fp(FILE *fp, X509_CRL *x)
@@ -39,7 +40,7 @@ int X509_CRL_print(BIO *out, X509_CRL *x)
 
 int X509_CRL_print_ex(BIO *out, X509_CRL *x, unsigned long nmflag)
 {
-    STACK_OF(X509_REVOKED) *rev;
+    STACK_OF(X509_REVOKED) *rev, *indexed;
     X509_REVOKED *r;
     const X509_ALGOR *sig_alg;
     const ASN1_BIT_STRING *sig;
@@ -70,7 +71,10 @@ int X509_CRL_print_ex(BIO *out, X509_CRL *x, unsigned long nmflag)
     X509V3_extensions_print(out, "CRL extensions",
                             X509_CRL_get0_extensions(x), 0, 8);
 
-    rev = X509_CRL_get_REVOKED(x);
+    /* The entries of an indexed CRL are only decoded for this */
+    if (!ossl_x509_crl_index_get1_revoked(x, &indexed))
+        return 0;
+    rev = indexed != NULL ? indexed : X509_CRL_get_REVOKED(x);
 
     if (sk_X509_REVOKED_num(rev) > 0)
         BIO_printf(out, "Revoked Certificates:\n");
@@ -87,6 +91,7 @@ int X509_CRL_print_ex(BIO *out, X509_CRL *x, unsigned long nmflag)
         X509V3_extensions_print(out, "CRL entry extensions",
                                 X509_REVOKED_get0_extensions(r), 0, 8);
     }
+    sk_X509_REVOKED_pop_free(indexed, X509_REVOKED_free);
     X509_signature_print(out, sig_alg, sig);
 
     return 1;
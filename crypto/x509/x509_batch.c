@@ -0,0 +1,308 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/x509.h>
+#include <openssl/evp.h>
+#include <openssl/x509v3.h>
+#include <openssl/lhash.h>
+#include <openssl/thread.h>
+#include "internal/cryptlib.h"
+#include "internal/thread.h"
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+/*
+ * Verification of many certificates against the same store.
+ *
+ * The jobs are spread over the workers of the library context thread pool.
+ * Chains of certificates from the same source usually share their
+ * intermediate CA certificates, so the issuer signatures that were found
+ * valid are remembered in a cache shared by all jobs of a batch and each of
+ * them is only checked once.
+ */
+
+/*
+ * A signature found valid: that of |subject| checked with the public key of
+ * |issuer|. Both are only compared with data that the certificates already
+ * hold, so building a key costs nothing. The SHA-1 fingerprint of the
+ * subject is only used to find candidates, all of its signed part and its
+ * signature are compared as well, like X509_cmp() does.
+ */
+typedef struct {
+    X509 *subject;
+    X509 *issuer;
+} X509_SIG_PAIR;
+
+DEFINE_LHASH_OF_EX(X509_SIG_PAIR);
+
+struct x509_sig_cache_st {
+    CRYPTO_RWLOCK *lock;
+    LHASH_OF(X509_SIG_PAIR) *pairs;
+};
+
+static unsigned long sig_pair_hash(const X509_SIG_PAIR *a)
+{
+    unsigned long h = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(h); i++)
+        h = (h << 8) | a->subject->sha1_hash[i];
+    return h;
+}
+
+static int sig_pair_cmp(const X509_SIG_PAIR *a, const X509_SIG_PAIR *b)
+{
+    const X509 *x = a->subject, *y = b->subject;
+    const unsigned char *xk, *yk;
+    X509_ALGOR *xalg, *yalg;
+    int xklen, yklen, rv;
+
+    if ((rv = memcmp(x->sha1_hash, y->sha1_hash, sizeof(x->sha1_hash))) != 0)
+        return rv;
+    if (x->cert_info.enc.len != y->cert_info.enc.len)
+        return x->cert_info.enc.len < y->cert_info.enc.len ? -1 : 1;
+    if ((rv = memcmp(x->cert_info.enc.enc, y->cert_info.enc.enc,
+                     x->cert_info.enc.len)) != 0
+        || (rv = X509_ALGOR_cmp(&x->sig_alg, &y->sig_alg)) != 0
+        || (rv = ASN1_STRING_cmp(&x->signature, &y->signature)) != 0)
+        return rv;
+
+    if (a->issuer == b->issuer)
+        return 0;
+    if (!X509_PUBKEY_get0_param(NULL, &xk, &xklen, &xalg,
+                                X509_get_X509_PUBKEY(a->issuer))
+        || !X509_PUBKEY_get0_param(NULL, &yk, &yklen, &yalg,
+                                   X509_get_X509_PUBKEY(b->issuer)))
+        return a->issuer < b->issuer ? -1 : 1;
+    if (xklen != yklen)
+        return xklen < yklen ? -1 : 1;
+    if ((rv = memcmp(xk, yk, xklen)) != 0)
+        return rv;
+    return X509_ALGOR_cmp(xalg, yalg);
+}
+
+static void sig_pair_free(X509_SIG_PAIR *a)
+{
+    X509_free(a->subject);
+    X509_free(a->issuer);
+    OPENSSL_free(a);
+}
+
+static X509_SIG_CACHE *sig_cache_new(void)
+{
+    X509_SIG_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    if ((cache->lock = CRYPTO_THREAD_lock_new()) == NULL
+            || (cache->pairs = lh_X509_SIG_PAIR_new(sig_pair_hash,
+                                                    sig_pair_cmp)) == NULL) {
+        CRYPTO_THREAD_lock_free(cache->lock);
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void sig_cache_free(X509_SIG_CACHE *cache)
+{
+    if (cache == NULL)
+        return;
+    lh_X509_SIG_PAIR_doall(cache->pairs, sig_pair_free);
+    lh_X509_SIG_PAIR_free(cache->pairs);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+/*
+ * The fingerprint and the encoding of the signed part are only there once
+ * the extensions were cached and as long as the certificate was not changed.
+ * Certificates built and signed in memory rather than decoded are therefore
+ * always verified.
+ */
+static int sig_pair_usable(const X509 *xs)
+{
+    return (xs->ex_flags & (EXFLAG_SET | EXFLAG_NO_FINGERPRINT)) == EXFLAG_SET
+        && !xs->cert_info.enc.modified && xs->cert_info.enc.enc != NULL;
+}
+
+/*
+ * Same as X509_verify(xs, pkey), where |pkey| is the public key of |xi|, but
+ * consults and updates |cache| if it is not NULL.
+ */
+int ossl_x509_verify_cached(X509_SIG_CACHE *cache, X509 *xs, X509 *xi,
+                            EVP_PKEY *pkey)
+{
+    X509_SIG_PAIR key, *pair;
+    int ret;
+
+    if (cache == NULL || !sig_pair_usable(xs))
+        return X509_verify(xs, pkey);
+
+    key.subject = xs;
+    key.issuer = xi;
+    if (!CRYPTO_THREAD_read_lock(cache->lock))
+        return X509_verify(xs, pkey);
+    pair = lh_X509_SIG_PAIR_retrieve(cache->pairs, &key);
+    CRYPTO_THREAD_unlock(cache->lock);
+    if (pair != NULL)
+        return 1;
+
+    /* Only successes are cached, failures are rare and reported anyway */
+    if ((ret = X509_verify(xs, pkey)) <= 0)
+        return ret;
+    if ((pair = OPENSSL_memdup(&key, sizeof(key))) == NULL)
+        return ret;
+    if (!X509_up_ref(xs)) {
+        OPENSSL_free(pair);
+        return ret;
+    }
+    if (!X509_up_ref(xi)) {
+        X509_free(xs);
+        OPENSSL_free(pair);
+        return ret;
+    }
+    if (!CRYPTO_THREAD_write_lock(cache->lock)) {
+        sig_pair_free(pair);
+        return ret;
+    }
+    if (lh_X509_SIG_PAIR_retrieve(cache->pairs, pair) == NULL) {
+        lh_X509_SIG_PAIR_insert(cache->pairs, pair);
+        if (lh_X509_SIG_PAIR_error(cache->pairs))
+            sig_pair_free(pair);
+    } else {
+        sig_pair_free(pair);
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+    return ret;
+}
+
+#ifndef OPENSSL_NO_THREAD_POOL
+typedef struct {
+    X509_STORE_CTX **ctxs;
+    int *results;
+    size_t num;
+    CRYPTO_MUTEX *lock;
+    size_t next;                /* protected by lock */
+} X509_VERIFY_BATCH;
+
+static CRYPTO_THREAD_RETVAL verify_batch_worker(void *arg)
+{
+    X509_VERIFY_BATCH *batch = arg;
+    size_t i;
+
+    for (;;) {
+        ossl_crypto_mutex_lock(batch->lock);
+        i = batch->next++;
+        ossl_crypto_mutex_unlock(batch->lock);
+        if (i >= batch->num)
+            break;
+        batch->results[i] = X509_verify_cert(batch->ctxs[i]);
+    }
+    return 1;
+}
+
+/*
+ * Runs the jobs on up to |threads| workers of the thread pool of |libctx|.
+ * Returns 0 if the pool is not available, in which case nothing was done.
+ */
+static int verify_batch_parallel(OSSL_LIB_CTX *libctx, X509_STORE_CTX **ctxs,
+                                 size_t num, int *results, size_t threads)
+{
+    X509_VERIFY_BATCH batch;
+    OSSL_THREAD_TASK **tasks;
+    size_t i, started = 0;
+
+    if ((tasks = OPENSSL_zalloc(threads * sizeof(*tasks))) == NULL)
+        return 0;
+    batch.ctxs = ctxs;
+    batch.results = results;
+    batch.num = num;
+    batch.next = 0;
+    if ((batch.lock = ossl_crypto_mutex_new()) == NULL) {
+        OPENSSL_free(tasks);
+        return 0;
+    }
+
+    for (i = 0; i < threads; i++) {
+        tasks[i] = ossl_crypto_pool_submit(libctx, verify_batch_worker, &batch);
+        if (tasks[i] == NULL)
+            break;
+        started++;
+    }
+    /*
+     * Waiting runs the tasks that no worker took yet on this thread, so all
+     * jobs are done once any task was started.
+     */
+    for (i = 0; i < started; i++)
+        ossl_crypto_pool_wait(tasks[i], NULL);
+    for (i = 0; i < started; i++)
+        ossl_crypto_pool_task_free(tasks[i]);
+    OPENSSL_free(tasks);
+    ossl_crypto_mutex_free(&batch.lock);
+    return started > 0;
+}
+#endif
+
+int X509_verify_cert_batch(X509_STORE_CTX **ctxs, size_t num, int *results,
+                           size_t threads)
+{
+    X509_SIG_CACHE *cache;
+    OSSL_LIB_CTX *libctx;
+    const char *propq;
+    size_t i;
+    int done = 0;
+
+    if (num == 0)
+        return 1;
+    if (ctxs == NULL || results == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    for (i = 0; i < num; i++) {
+        if (ctxs[i] == NULL) {
+            ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+            return 0;
+        }
+    }
+    /* The jobs share a thread pool and a cache, so also a library context */
+    libctx = ctxs[0]->libctx;
+    propq = ctxs[0]->propq;
+    for (i = 1; i < num; i++) {
+        if (ctxs[i]->libctx != libctx
+            || (ctxs[i]->propq == NULL) != (propq == NULL)
+            || (propq != NULL && strcmp(ctxs[i]->propq, propq) != 0)) {
+            ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+    }
+
+    /* Without the cache the jobs are still verified, just more slowly */
+    if ((cache = sig_cache_new()) != NULL)
+        for (i = 0; i < num; i++)
+            ctxs[i]->sig_cache = cache;
+
+    if (threads == 0)
+        threads = (size_t)OSSL_get_max_threads(libctx);
+    if (threads > num)
+        threads = num;
+#ifndef OPENSSL_NO_THREAD_POOL
+    if (threads > 1)
+        done = verify_batch_parallel(libctx, ctxs, num, results, threads);
+#endif
+    if (!done)
+        for (i = 0; i < num; i++)
+            results[i] = X509_verify_cert(ctxs[i]);
+
+    for (i = 0; i < num; i++)
+        ctxs[i]->sig_cache = NULL;
+    sig_cache_free(cache);
+    return 1;
+}
@@ -156,4 +156,12 @@ typedef STACK_OF(X509_NAME_ENTRY) STACK_OF_X509_NAME_ENTRY;
 DEFINE_STACK_OF(STACK_OF_X509_NAME_ENTRY)
 
 int ossl_x509_likely_issued(X509 *issuer, X509 *subject);
+void ossl_x509_crl_index_detach(X509_CRL *crl);
+X509_CRL *ossl_x509_crl_get0_delta(X509_CRL *crl);
+int ossl_x509_crl_index_get1_revoked(X509_CRL *crl,
+                                     STACK_OF(X509_REVOKED) **revoked);
 int ossl_x509_signing_allowed(const X509 *issuer, const X509 *subject);
+
+typedef struct x509_sig_cache_st X509_SIG_CACHE;
+int ossl_x509_verify_cached(X509_SIG_CACHE *cache, X509 *xs, X509 *xi,
+                            EVP_PKEY *pkey);
@@ -116,6 +116,11 @@ int X509_up_ref(X509 *x)
 {
     int i;
 
+    if (x->in_arena) {
+        /* The arena would free it under the new holder */
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
     if (CRYPTO_UP_REF(&x->references, &i) <= 0)
         return 0;
 
@@ -1590,6 +1590,7 @@ static int get_crl_delta(X509_STORE_CTX *ctx,
 /* Check CRL validity */
 static int check_crl(X509_STORE_CTX *ctx, X509_CRL *crl)
 {
+    X509_CRL *delta;
     X509 *issuer = NULL;
     EVP_PKEY *ikey = NULL;
     int cnum = ctx->error_depth;
@@ -1661,6 +1662,20 @@ static int check_crl(X509_STORE_CTX *ctx, X509_CRL *crl)
             !verify_cb_crl(ctx, X509_V_ERR_CRL_SIGNATURE_FAILURE))
             return 0;
     }
+
+    /*
+     * A delta CRL set with X509_CRL_set1_delta() is consulted by lookups in
+     * the CRL, so it is checked along with it
+     */
+    if ((delta = ossl_x509_crl_get0_delta(crl)) != NULL) {
+        if (!check_crl_time(ctx, delta, 1))
+            return 0;
+        ctx->current_crl = delta;
+        if (ikey != NULL && X509_CRL_verify(delta, ikey) <= 0 &&
+            !verify_cb_crl(ctx, X509_V_ERR_CRL_SIGNATURE_FAILURE))
+            return 0;
+        ctx->current_crl = crl;
+    }
     return 1;
 }
 
@@ -1668,6 +1683,7 @@ static int check_crl(X509_STORE_CTX *ctx, X509_CRL *crl)
 static int cert_crl(X509_STORE_CTX *ctx, X509_CRL *crl, X509 *x)
 {
     X509_REVOKED *rev;
+    int ret;
 
     /*
      * The rules changed for this... previously if a CRL contained unhandled
@@ -1683,7 +1699,12 @@ static int cert_crl(X509_STORE_CTX *ctx, X509_CRL *crl, X509 *x)
      * Look for serial number of certificate in CRL.  If found, make sure
      * reason is not removeFromCRL.
      */
-    if (X509_CRL_get0_by_cert(crl, &rev, x)) {
+    if ((ret = X509_CRL_get0_by_cert(crl, &rev, x)) < 0) {
+        /* The entry of an indexed CRL could not be decoded */
+        ctx->error = X509_V_ERR_UNSPECIFIED;
+        return 0;
+    }
+    if (ret > 0) {
         if (rev->reason == CRL_REASON_REMOVE_FROM_CRL)
             return 2;
         if (!verify_cb_crl(ctx, X509_V_ERR_CERT_REVOKED))
@@ -1902,7 +1923,8 @@ static int internal_verify(X509_STORE_CTX *ctx)
                 CB_FAIL_IF(1, ctx, xi, issuer_depth,
                            X509_V_ERR_UNABLE_TO_DECODE_ISSUER_PUBLIC_KEY);
             } else {
-                CB_FAIL_IF(X509_verify(xs, pkey) <= 0,
+                CB_FAIL_IF(ossl_x509_verify_cached(ctx->sig_cache,
+                                                   xs, xi, pkey) <= 0,
                            ctx, xs, n, X509_V_ERR_CERT_SIGNATURE_FAILURE);
             }
         }
@@ -2104,8 +2126,8 @@ X509_CRL *X509_CRL_diff(X509_CRL *base, X509_CRL *newer,
                         EVP_PKEY *skey, const EVP_MD *md, unsigned int flags)
 {
     X509_CRL *crl = NULL;
-    int i;
-    STACK_OF(X509_REVOKED) *revs = NULL;
+    int i, r;
+    STACK_OF(X509_REVOKED) *revs = NULL, *indexed = NULL;
 
     /* CRLs can't be delta already */
     if (base->base_crl_number != NULL || newer->base_crl_number != NULL) {
@@ -2184,7 +2206,9 @@ X509_CRL *X509_CRL_diff(X509_CRL *base, X509_CRL *newer,
     }
 
     /* Go through revoked entries, copying as needed */
-    revs = X509_CRL_get_REVOKED(newer);
+    if (!ossl_x509_crl_index_get1_revoked(newer, &indexed))
+        goto err;
+    revs = indexed != NULL ? indexed : X509_CRL_get_REVOKED(newer);
 
     for (i = 0; i < sk_X509_REVOKED_num(revs); i++) {
         X509_REVOKED *rvn, *rvtmp;
@@ -2195,7 +2219,10 @@ X509_CRL *X509_CRL_diff(X509_CRL *base, X509_CRL *newer,
          * Need something cleverer here for some more complex CRLs covering
          * multiple CAs.
          */
-        if (!X509_CRL_get0_by_serial(base, &rvtmp, &rvn->serialNumber)) {
+        if ((r = X509_CRL_get0_by_serial(base, &rvtmp,
+                                         &rvn->serialNumber)) < 0)
+            goto err;
+        if (r == 0) {
             rvtmp = X509_REVOKED_dup(rvn);
             if (rvtmp == NULL) {
                 ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
@@ -2214,9 +2241,11 @@ X509_CRL *X509_CRL_diff(X509_CRL *base, X509_CRL *newer,
         goto err;
     }
 
+    sk_X509_REVOKED_pop_free(indexed, X509_REVOKED_free);
     return crl;
 
  err:
+    sk_X509_REVOKED_pop_free(indexed, X509_REVOKED_free);
     X509_CRL_free(crl);
     return NULL;
 }
@@ -75,6 +75,11 @@ int X509_CRL_up_ref(X509_CRL *crl)
 {
     int i;
 
+    if (crl->in_arena) {
+        /* The arena would free it under the new holder */
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
     if (CRYPTO_UP_REF(&crl->references, &i) <= 0)
         return 0;
 
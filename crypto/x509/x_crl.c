@@ -165,6 +165,7 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
 
     switch (operation) {
     case ASN1_OP_D2I_PRE:
+        ossl_x509_crl_index_detach(crl);
         if (crl->meth->crl_free) {
             if (!crl->meth->crl_free(crl))
                 return 0;
@@ -260,6 +261,11 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         crl->flags |= EXFLAG_SET;
         break;
 
+    case ASN1_OP_FREE_PRE:
+        if (crl->meth != NULL)
+            ossl_x509_crl_index_detach(crl);
+        break;
+
     case ASN1_OP_FREE_POST:
         if (crl->meth != NULL && crl->meth->crl_free != NULL) {
             if (!crl->meth->crl_free(crl))
@@ -0,0 +1,770 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "internal/cryptlib.h"
+#include <openssl/asn1t.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# define CRL_IDX_MMAP
+#endif
+
+/*
+ * Indexed CRLs.
+ *
+ * Decoding a CRL with millions of entries creates several heap objects per
+ * entry, most of which are never looked at: a CRL is normally only asked
+ * whether one particular serial number is revoked. An indexed CRL keeps the
+ * DER encoding, mapped into memory where possible, and only records where
+ * the serial number of every entry is. The index is sorted once and binary
+ * searched; the X509_REVOKED of an entry is decoded when a lookup finds it
+ * and is then kept with the CRL.
+ *
+ * Everything else in the CRL is decoded as usual from a copy of the
+ * encoding that leaves the entries out, so that the cached extensions and
+ * flags are the same as for a fully decoded CRL. The cached encoding of the
+ * X509_CRL_INFO is then replaced by the original one, which is part of the
+ * mapped file, so that signature checks and i2d_X509_CRL() see the whole CRL.
+ *
+ * The entries of an indexed CRL are found through an X509_CRL_METHOD, which
+ * also consults the latest delta CRL for the CRL if one has been set. Delta
+ * CRLs that have been replaced are kept until the CRL is freed, because
+ * lookups may have returned entries that belong to them.
+ */
+
+typedef struct {
+    /* The DER encoding of the X509_REVOKED */
+    const unsigned char *entry;
+    /* Position and length of the contents of its serial number */
+    unsigned int serial_off;
+    unsigned int serial_len;
+} CRL_IDX_ENTRY;
+
+typedef struct {
+    unsigned char *der;
+    size_t derlen;
+    int mapped;
+    CRL_IDX_ENTRY *entries;
+    size_t num;
+    size_t alloc;
+    /* The contents of the SEQUENCE of revoked certificates */
+    const unsigned char *revoked;
+    const unsigned char *revoked_end;
+    /* Entries that have been decoded */
+    STACK_OF(X509_REVOKED) *decoded;
+    /* The delta CRLs that have been set, the last one is current */
+    STACK_OF(X509_CRL) *deltas;
+} CRL_INDEX;
+
+/* Positions in the DER encoding of an indexed CRL */
+typedef struct {
+    const unsigned char *end;
+    const unsigned char *tbs;
+    const unsigned char *tbs_end;
+    /* The contents of the X509_CRL_INFO */
+    const unsigned char *fields;
+    /* The SEQUENCE of revoked certificates, its header and contents */
+    const unsigned char *revoked_hdr;
+    const unsigned char *revoked;
+    const unsigned char *revoked_end;
+    int critical;
+    int indirect;
+} CRL_IDX_LAYOUT;
+
+static int crl_idx_free(X509_CRL *crl);
+static int crl_idx_lookup(X509_CRL *crl, X509_REVOKED **ret,
+                          const ASN1_INTEGER *serial, const X509_NAME *issuer);
+static int crl_idx_verify(X509_CRL *crl, EVP_PKEY *r);
+
+static X509_CRL_METHOD crl_idx_meth = {
+    0,
+    0, crl_idx_free,
+    crl_idx_lookup,
+    crl_idx_verify
+};
+
+static void crl_idx_release(unsigned char *der, size_t derlen, int mapped)
+{
+#ifdef CRL_IDX_MMAP
+    if (mapped) {
+        munmap(der, derlen);
+        return;
+    }
+#endif
+    OPENSSL_free(der);
+}
+
+static void crl_idx_index_free(CRL_INDEX *idx)
+{
+    if (idx == NULL)
+        return;
+    crl_idx_release(idx->der, idx->derlen, idx->mapped);
+    OPENSSL_free(idx->entries);
+    sk_X509_REVOKED_pop_free(idx->decoded, X509_REVOKED_free);
+    sk_X509_CRL_pop_free(idx->deltas, X509_CRL_free);
+    OPENSSL_free(idx);
+}
+
+static int crl_idx_free(X509_CRL *crl)
+{
+    crl_idx_index_free(crl->meth_data);
+    crl->meth_data = NULL;
+    return 1;
+}
+
+/*
+ * The cached encoding of an indexed CRL belongs to the index and must not be
+ * freed with the X509_CRL_INFO.
+ */
+void ossl_x509_crl_index_detach(X509_CRL *crl)
+{
+    if (crl->meth != &crl_idx_meth)
+        return;
+    crl->crl.enc.enc = NULL;
+    crl->crl.enc.len = 0;
+}
+
+/* Returns the current delta CRL of |crl|, or NULL if there is none */
+X509_CRL *ossl_x509_crl_get0_delta(X509_CRL *crl)
+{
+    CRL_INDEX *idx;
+    X509_CRL *delta = NULL;
+
+    if (crl->meth != &crl_idx_meth || (idx = crl->meth_data) == NULL)
+        return NULL;
+    if (!CRYPTO_THREAD_read_lock(crl->lock))
+        return NULL;
+    if (sk_X509_CRL_num(idx->deltas) > 0)
+        delta = sk_X509_CRL_value(idx->deltas, sk_X509_CRL_num(idx->deltas) - 1);
+    CRYPTO_THREAD_unlock(crl->lock);
+    return delta;
+}
+
+static int crl_idx_verify(X509_CRL *crl, EVP_PKEY *r)
+{
+    return ASN1_item_verify_ex(ASN1_ITEM_rptr(X509_CRL_INFO),
+                               &crl->sig_alg, &crl->signature, &crl->crl, NULL,
+                               r, crl->libctx, crl->propq);
+}
+
+static int crl_idx_cmp(const void *a, const void *b)
+{
+    const CRL_IDX_ENTRY *ea = a, *eb = b;
+
+    if (ea->serial_len != eb->serial_len)
+        return ea->serial_len < eb->serial_len ? -1 : 1;
+    return memcmp(ea->entry + ea->serial_off, eb->entry + eb->serial_off,
+                  ea->serial_len);
+}
+
+static int crl_idx_revoked_cmp(const X509_REVOKED *const *a,
+                               const X509_REVOKED *const *b)
+{
+    return ASN1_STRING_cmp(&(*a)->serialNumber, &(*b)->serialNumber);
+}
+
+/* Decodes the entry at |*p| and caches its reason as crl_set_issuers() does */
+static X509_REVOKED *crl_idx_decode_entry(const unsigned char **p, long len)
+{
+    X509_REVOKED *rev;
+    ASN1_ENUMERATED *reason;
+    int i;
+
+    if ((rev = d2i_X509_REVOKED(NULL, p, len)) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+        return NULL;
+    }
+    reason = X509_REVOKED_get_ext_d2i(rev, NID_crl_reason, &i, NULL);
+    if (reason == NULL && i != -1) {
+        X509_REVOKED_free(rev);
+        ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+        return NULL;
+    }
+    rev->reason = reason != NULL ? ASN1_ENUMERATED_get(reason)
+                                 : CRL_REASON_NONE;
+    ASN1_ENUMERATED_free(reason);
+    return rev;
+}
+
+/*
+ * Returns the decoded entry |e| with serial number |serial|, or NULL if it
+ * cannot be decoded
+ */
+static X509_REVOKED *crl_idx_decode(X509_CRL *crl, CRL_INDEX *idx,
+                                    const CRL_IDX_ENTRY *e,
+                                    const ASN1_INTEGER *serial)
+{
+    X509_REVOKED rtmp, *rev = NULL;
+    const unsigned char *p = e->entry;
+    int i;
+
+    rtmp.serialNumber = *serial;
+
+    /*
+     * Entries that have been decoded before only need a read lock. The stack
+     * is sorted after every push, so that finding them does not modify it.
+     */
+    if (!CRYPTO_THREAD_read_lock(crl->lock))
+        return NULL;
+    if (sk_X509_REVOKED_is_sorted(idx->decoded)
+            && (i = sk_X509_REVOKED_find(idx->decoded, &rtmp)) >= 0) {
+        rev = sk_X509_REVOKED_value(idx->decoded, i);
+        CRYPTO_THREAD_unlock(crl->lock);
+        return rev;
+    }
+    CRYPTO_THREAD_unlock(crl->lock);
+
+    /* Another thread might have decoded the entry in the meantime */
+    if (!CRYPTO_THREAD_write_lock(crl->lock))
+        return NULL;
+    if ((i = sk_X509_REVOKED_find(idx->decoded, &rtmp)) >= 0) {
+        rev = sk_X509_REVOKED_value(idx->decoded, i);
+        goto end;
+    }
+
+    if ((rev = crl_idx_decode_entry(&p, (long)(idx->revoked_end - p))) == NULL)
+        goto end;
+    if (!sk_X509_REVOKED_push(idx->decoded, rev)) {
+        X509_REVOKED_free(rev);
+        rev = NULL;
+        goto end;
+    }
+    sk_X509_REVOKED_sort(idx->decoded);
+
+ end:
+    CRYPTO_THREAD_unlock(crl->lock);
+    return rev;
+}
+
+static int crl_idx_lookup(X509_CRL *crl, X509_REVOKED **ret,
+                          const ASN1_INTEGER *serial, const X509_NAME *issuer)
+{
+    CRL_INDEX *idx = crl->meth_data;
+    CRL_IDX_ENTRY key;
+    const CRL_IDX_ENTRY *e;
+    X509_REVOKED *rev;
+    X509_CRL *delta;
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    long len;
+    int derlen, tag, xclass, r = 0;
+
+    if (idx == NULL)
+        return 0;
+
+    /*
+     * Delta CRLs are cumulative, so the latest one overrides the CRL. It is
+     * never freed before the CRL, so its entries can be returned.
+     */
+    delta = ossl_x509_crl_get0_delta(crl);
+    if (delta != NULL && delta->meth->crl_lookup != NULL
+        && (r = delta->meth->crl_lookup(delta, ret, serial, issuer)) != 0)
+        return r;
+
+    if (issuer != NULL && X509_NAME_cmp(issuer, X509_CRL_get_issuer(crl)) != 0)
+        return 0;
+
+    if ((derlen = i2d_ASN1_INTEGER(serial, &der)) <= 0)
+        return 0;
+    p = der;
+    if ((ASN1_get_object(&p, &len, &tag, &xclass, derlen) & 0x80) != 0)
+        goto end;
+    key.entry = der;
+    key.serial_off = (unsigned int)(p - der);
+    key.serial_len = (unsigned int)len;
+
+    e = bsearch(&key, idx->entries, idx->num, sizeof(*idx->entries),
+                crl_idx_cmp);
+    if (e == NULL)
+        goto end;
+    /*
+     * The whole CRL would have been rejected for an entry that cannot be
+     * decoded. Reporting it as not revoked would be wrong, so fail.
+     */
+    if ((rev = crl_idx_decode(crl, idx, e, serial)) == NULL) {
+        r = -1;
+        goto end;
+    }
+    if (ret != NULL)
+        *ret = rev;
+    r = rev->reason == CRL_REASON_REMOVE_FROM_CRL ? 2 : 1;
+
+ end:
+    OPENSSL_free(der);
+    return r;
+}
+
+/*
+ * Parses the definite length TLV header at |*p| and checks that its tag is
+ * |tag| of the universal class unless |tag| is -1.
+ */
+static int crl_idx_tlv(const unsigned char **p, const unsigned char *end,
+                       int tag, int *ptag, long *plen)
+{
+    int ret, t, xclass;
+
+    ret = ASN1_get_object(p, plen, &t, &xclass, (long)(end - *p));
+    if ((ret & 0x80) != 0 || (ret & 1) != 0
+        || (tag != -1 && (t != tag || xclass != V_ASN1_UNIVERSAL))) {
+        ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+        return 0;
+    }
+    if (ptag != NULL)
+        *ptag = xclass == V_ASN1_UNIVERSAL ? t : -1;
+    return 1;
+}
+
+/* The same DER checks of the contents of an INTEGER as the ASN.1 decoder */
+static int crl_idx_serial_ok(const unsigned char *p, long len)
+{
+    if (len == 0 || len > INT_MAX)
+        return 0;
+    if (len == 1)
+        return 1;
+    return !((p[0] == 0x00 && (p[1] & 0x80) == 0)
+             || (p[0] == 0xff && (p[1] & 0x80) != 0));
+}
+
+/*
+ * Checks the extensions of a CRL entry in [p, end) for critical extensions
+ * and certificate issuers, as crl_set_issuers() in x_crl.c does.
+ */
+static int crl_idx_entry_exts(const unsigned char *p, const unsigned char *end,
+                              CRL_IDX_LAYOUT *l)
+{
+    static const unsigned char cert_issuer[] = { 0x55, 0x1d, 0x1d };
+    const unsigned char *ext_end, *oid;
+    long len, oidlen;
+    int tag;
+
+    while (p < end) {
+        if (!crl_idx_tlv(&p, end, V_ASN1_SEQUENCE, NULL, &len))
+            return 0;
+        ext_end = p + len;
+        if (!crl_idx_tlv(&p, ext_end, V_ASN1_OBJECT, NULL, &oidlen))
+            return 0;
+        oid = p;
+        p += oidlen;
+        if (oidlen == sizeof(cert_issuer)
+            && memcmp(oid, cert_issuer, sizeof(cert_issuer)) == 0)
+            l->indirect = 1;
+        if (!crl_idx_tlv(&p, ext_end, -1, &tag, &len))
+            return 0;
+        if (tag == V_ASN1_BOOLEAN) {
+            if (len != 1)
+                return 0;
+            if (*p != 0 && !l->indirect)
+                l->critical = 1;
+            p += len;
+            if (!crl_idx_tlv(&p, ext_end, -1, &tag, &len))
+                return 0;
+        }
+        if (tag != V_ASN1_OCTET_STRING || p + len != ext_end)
+            return 0;
+        p = ext_end;
+    }
+    return 1;
+}
+
+static int crl_idx_add_entries(CRL_INDEX *idx, CRL_IDX_LAYOUT *l)
+{
+    const unsigned char *p = l->revoked, *q, *entry, *entry_end;
+    CRL_IDX_ENTRY *tmp;
+    long len;
+    int tag;
+
+    while (p < l->revoked_end) {
+        entry = p;
+        if (!crl_idx_tlv(&p, l->revoked_end, V_ASN1_SEQUENCE, NULL, &len))
+            return 0;
+        entry_end = p + len;
+
+        q = p;
+        if (!crl_idx_tlv(&q, entry_end, V_ASN1_INTEGER, NULL, &len))
+            return 0;
+        if (!crl_idx_serial_ok(q, len)) {
+            ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+            return 0;
+        }
+        if (idx->num == idx->alloc) {
+            size_t n = idx->alloc == 0 ? 1024 : idx->alloc * 2;
+
+            if ((tmp = OPENSSL_realloc(idx->entries, n * sizeof(*tmp))) == NULL)
+                return 0;
+            idx->entries = tmp;
+            idx->alloc = n;
+        }
+        idx->entries[idx->num].entry = entry;
+        idx->entries[idx->num].serial_off = (unsigned int)(q - entry);
+        idx->entries[idx->num].serial_len = (unsigned int)len;
+        idx->num++;
+        q += len;
+
+        if (!crl_idx_tlv(&q, entry_end, -1, &tag, &len)
+            || (tag != V_ASN1_UTCTIME && tag != V_ASN1_GENERALIZEDTIME))
+            goto err;
+        q += len;
+        if (q < entry_end) {
+            if (!crl_idx_tlv(&q, entry_end, V_ASN1_SEQUENCE, NULL, &len)
+                || q + len != entry_end
+                || !crl_idx_entry_exts(q, entry_end, l))
+                goto err;
+        }
+        p = entry_end;
+    }
+    return 1;
+
+ err:
+    ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+    return 0;
+}
+
+/* Finds the list of revoked certificates in the CRL */
+static int crl_idx_layout(const CRL_INDEX *idx, CRL_IDX_LAYOUT *l)
+{
+    const unsigned char *p = idx->der, *end = idx->der + idx->derlen;
+    long len;
+    int tag, prev = -1;
+
+    memset(l, 0, sizeof(*l));
+    if (!crl_idx_tlv(&p, end, V_ASN1_SEQUENCE, NULL, &len))
+        return 0;
+    l->end = p + len;
+    l->tbs = p;
+    if (!crl_idx_tlv(&p, l->end, V_ASN1_SEQUENCE, NULL, &len))
+        return 0;
+    l->tbs_end = p + len;
+    l->fields = p;
+
+    /* The revoked certificates are a SEQUENCE following thisUpdate */
+    while (p < l->tbs_end) {
+        const unsigned char *field = p;
+
+        if (!crl_idx_tlv(&p, l->tbs_end, -1, &tag, &len))
+            return 0;
+        if (tag == V_ASN1_SEQUENCE
+            && (prev == V_ASN1_UTCTIME || prev == V_ASN1_GENERALIZEDTIME)) {
+            l->revoked_hdr = field;
+            l->revoked = p;
+            l->revoked_end = p + len;
+            return crl_idx_add_entries((CRL_INDEX *)idx, l) ? 1 : 0;
+        }
+        /* Only entries of a version 2 CRL may come after this */
+        prev = field == l->fields && tag == V_ASN1_INTEGER ? -1 : tag;
+        p += len;
+    }
+    return 1;
+}
+
+/*
+ * Reads |file|, mapping it into memory if it can be. PEM files are decoded,
+ * the index then refers to the decoded copy.
+ */
+static int crl_idx_read(CRL_INDEX *idx, const char *file)
+{
+    BIO *in;
+    unsigned char *data = NULL, *tmp;
+    long len = 0;
+    int n;
+
+#ifdef CRL_IDX_MMAP
+    struct stat st;
+    void *map;
+    int fd;
+
+    if ((fd = open(file, O_RDONLY)) >= 0) {
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+            && (unsigned long long)st.st_size <= LONG_MAX) {
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                idx->der = map;
+                idx->derlen = (size_t)st.st_size;
+                idx->mapped = 1;
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    if (idx->der == NULL) {
+        if ((in = BIO_new_file(file, "rb")) == NULL)
+            return 0;
+        for (;;) {
+            if (len > LONG_MAX - 65536
+                || (tmp = OPENSSL_realloc(data, len + 65536)) == NULL) {
+                OPENSSL_free(data);
+                BIO_free(in);
+                return 0;
+            }
+            data = tmp;
+            if ((n = BIO_read(in, data + len, 65536)) <= 0)
+                break;
+            len += n;
+        }
+        BIO_free(in);
+        idx->der = data;
+        idx->derlen = (size_t)len;
+    }
+
+    if (idx->derlen > 0 && idx->der[0] != (V_ASN1_SEQUENCE | V_ASN1_CONSTRUCTED)) {
+        if ((in = BIO_new_mem_buf(idx->der, (int)idx->derlen)) == NULL)
+            return 0;
+        data = NULL;
+        n = PEM_bytes_read_bio(&data, &len, NULL, PEM_STRING_X509_CRL, in,
+                               NULL, NULL);
+        BIO_free(in);
+        if (!n)
+            return 0;
+        crl_idx_release(idx->der, idx->derlen, idx->mapped);
+        idx->der = data;
+        idx->derlen = (size_t)len;
+        idx->mapped = 0;
+    }
+    return 1;
+}
+
+/* Decodes the CRL without the revoked certificates */
+static X509_CRL *crl_idx_decode_shell(const CRL_IDX_LAYOUT *l,
+                                      OSSL_LIB_CTX *libctx, const char *propq)
+{
+    X509_CRL *crl;
+    unsigned char *shell, *p;
+    const unsigned char *q;
+    long before, after, rest, tbslen, len;
+    int total;
+
+    before = (long)(l->revoked_hdr - l->fields);
+    after = (long)(l->tbs_end - l->revoked_end);
+    rest = (long)(l->end - l->tbs_end);
+    tbslen = before + after;
+    len = ASN1_object_size(1, tbslen, V_ASN1_SEQUENCE) + rest;
+    if ((total = ASN1_object_size(1, len, V_ASN1_SEQUENCE)) <= 0
+        || (shell = OPENSSL_malloc(total)) == NULL)
+        return NULL;
+
+    p = shell;
+    ASN1_put_object(&p, 1, len, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL);
+    ASN1_put_object(&p, 1, tbslen, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL);
+    memcpy(p, l->fields, before);
+    p += before;
+    memcpy(p, l->revoked_end, after);
+    p += after;
+    memcpy(p, l->tbs_end, rest);
+
+    q = shell;
+    if ((crl = X509_CRL_new_ex(libctx, propq)) != NULL
+        && d2i_X509_CRL(&crl, &q, total) == NULL)
+        crl = NULL;
+    OPENSSL_free(shell);
+    return crl;
+}
+
+X509_CRL *X509_CRL_load_indexed(const char *file, OSSL_LIB_CTX *libctx,
+                                const char *propq)
+{
+    CRL_INDEX *idx;
+    CRL_IDX_LAYOUT l;
+    X509_CRL *crl = NULL;
+    const unsigned char *p;
+
+    if (file == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return NULL;
+    }
+    if ((idx = OPENSSL_zalloc(sizeof(*idx))) == NULL)
+        return NULL;
+    if (!crl_idx_read(idx, file) || !crl_idx_layout(idx, &l))
+        goto err;
+
+    if (l.revoked == NULL || l.indirect) {
+        /*
+         * Nothing to index, or an indirect CRL in which an entry may apply to
+         * the entries that follow it: decode it as usual
+         */
+        p = idx->der;
+        if ((crl = X509_CRL_new_ex(libctx, propq)) != NULL
+            && d2i_X509_CRL(&crl, &p, (long)idx->derlen) == NULL)
+            crl = NULL;
+        if (crl == NULL || l.indirect)
+            goto end;
+    } else if ((crl = crl_idx_decode_shell(&l, libctx, propq)) == NULL) {
+        goto err;
+    }
+    if ((crl->idp_flags & IDP_INDIRECT) != 0) {
+        X509_CRL_free(crl);
+        p = idx->der;
+        if ((crl = X509_CRL_new_ex(libctx, propq)) != NULL
+            && d2i_X509_CRL(&crl, &p, (long)idx->derlen) == NULL)
+            crl = NULL;
+        goto end;
+    }
+
+    if ((idx->decoded = sk_X509_REVOKED_new(crl_idx_revoked_cmp)) == NULL)
+        goto err;
+    qsort(idx->entries, idx->num, sizeof(*idx->entries), crl_idx_cmp);
+    idx->revoked = l.revoked;
+    idx->revoked_end = l.revoked_end;
+
+    /* Sign and fingerprint the CRL as it is in the file */
+    OPENSSL_free(crl->crl.enc.enc);
+    crl->crl.enc.enc = (unsigned char *)l.tbs;
+    crl->crl.enc.len = (long)(l.tbs_end - l.tbs);
+    crl->crl.enc.modified = 0;
+    crl->meth = &crl_idx_meth;
+    crl->meth_data = idx;
+    if (EVP_Digest(idx->der, l.end - idx->der, crl->sha1_hash, NULL,
+                   EVP_sha1(), NULL))
+        crl->flags &= ~EXFLAG_NO_FINGERPRINT;
+    else
+        crl->flags |= EXFLAG_NO_FINGERPRINT;
+    if (l.critical)
+        crl->flags |= EXFLAG_CRITICAL;
+    return crl;
+
+ err:
+    X509_CRL_free(crl);
+    crl = NULL;
+ end:
+    crl_idx_index_free(idx);
+    return crl;
+}
+
+/*
+ * Sets |*revoked| to a new stack of all entries of |crl| in the order of the
+ * encoding if |crl| is indexed, and to NULL if it is not. Returns 0 if an
+ * entry cannot be decoded.
+ */
+int ossl_x509_crl_index_get1_revoked(X509_CRL *crl,
+                                     STACK_OF(X509_REVOKED) **revoked)
+{
+    CRL_INDEX *idx;
+    STACK_OF(X509_REVOKED) *sk;
+    X509_REVOKED *rev;
+    const unsigned char *p;
+
+    *revoked = NULL;
+    if (crl->meth != &crl_idx_meth || (idx = crl->meth_data) == NULL)
+        return 1;
+    if ((sk = sk_X509_REVOKED_new_reserve(NULL, (int)idx->num)) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        return 0;
+    }
+    for (p = idx->revoked; p < idx->revoked_end;) {
+        if ((rev = crl_idx_decode_entry(&p, (long)(idx->revoked_end - p)))
+            == NULL) {
+            sk_X509_REVOKED_pop_free(sk, X509_REVOKED_free);
+            return 0;
+        }
+        /* Cannot fail, the stack is large enough */
+        sk_X509_REVOKED_push(sk, rev);
+    }
+    *revoked = sk;
+    return 1;
+}
+
+static int crl_idx_ext_match(X509_CRL *a, X509_CRL *b, int nid)
+{
+    ASN1_OCTET_STRING *exta = NULL, *extb = NULL;
+    int i;
+
+    if ((i = X509_CRL_get_ext_by_NID(a, nid, -1)) >= 0)
+        exta = X509_EXTENSION_get_data(X509_CRL_get_ext(a, i));
+    if ((i = X509_CRL_get_ext_by_NID(b, nid, -1)) >= 0)
+        extb = X509_EXTENSION_get_data(X509_CRL_get_ext(b, i));
+    if (exta == NULL || extb == NULL)
+        return exta == extb;
+    return ASN1_OCTET_STRING_cmp(exta, extb) == 0;
+}
+
+int X509_CRL_set1_delta(X509_CRL *crl, X509_CRL *delta, EVP_PKEY *pkey)
+{
+    CRL_INDEX *idx;
+    X509_CRL *cur;
+    int ok;
+
+    if (crl == NULL || delta == NULL || pkey == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if (crl->meth != &crl_idx_meth) {
+        ERR_raise(ERR_LIB_X509, X509_R_METHOD_NOT_SUPPORTED);
+        return 0;
+    }
+    if (crl->base_crl_number != NULL) {
+        ERR_raise(ERR_LIB_X509, X509_R_CRL_ALREADY_DELTA);
+        return 0;
+    }
+    if (crl->crl_number == NULL || delta->crl_number == NULL
+        || delta->base_crl_number == NULL) {
+        ERR_raise(ERR_LIB_X509, X509_R_NO_CRL_NUMBER);
+        return 0;
+    }
+    if (X509_NAME_cmp(X509_CRL_get_issuer(crl),
+                      X509_CRL_get_issuer(delta)) != 0) {
+        ERR_raise(ERR_LIB_X509, X509_R_ISSUER_MISMATCH);
+        return 0;
+    }
+    if (!crl_idx_ext_match(crl, delta, NID_authority_key_identifier)) {
+        ERR_raise(ERR_LIB_X509, X509_R_AKID_MISMATCH);
+        return 0;
+    }
+    if (!crl_idx_ext_match(crl, delta, NID_issuing_distribution_point)) {
+        ERR_raise(ERR_LIB_X509, X509_R_IDP_MISMATCH);
+        return 0;
+    }
+    /* The delta must apply to this CRL and be newer than it */
+    if (ASN1_INTEGER_cmp(delta->base_crl_number, crl->crl_number) > 0
+        || ASN1_INTEGER_cmp(delta->crl_number, crl->crl_number) <= 0) {
+        ERR_raise(ERR_LIB_X509, X509_R_NEWER_CRL_NOT_NEWER);
+        return 0;
+    }
+    /* It is consulted by lookups from now on, so it must be genuine */
+    if (X509_CRL_verify(delta, pkey) <= 0) {
+        ERR_raise(ERR_LIB_X509, X509_R_CRL_VERIFY_FAILURE);
+        return 0;
+    }
+
+    idx = crl->meth_data;
+    if (!CRYPTO_THREAD_write_lock(crl->lock))
+        return 0;
+    if (idx->deltas == NULL && (idx->deltas = sk_X509_CRL_new_null()) == NULL) {
+        CRYPTO_THREAD_unlock(crl->lock);
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        return 0;
+    }
+    cur = sk_X509_CRL_value(idx->deltas, sk_X509_CRL_num(idx->deltas) - 1);
+    if (cur != NULL && ASN1_INTEGER_cmp(delta->crl_number,
+                                        cur->crl_number) <= 0) {
+        CRYPTO_THREAD_unlock(crl->lock);
+        ERR_raise(ERR_LIB_X509, X509_R_NEWER_CRL_NOT_NEWER);
+        return 0;
+    }
+    if (!X509_CRL_up_ref(delta)) {
+        CRYPTO_THREAD_unlock(crl->lock);
+        return 0;
+    }
+    /* The delta it replaces stays with the CRL, see above */
+    ok = sk_X509_CRL_push(idx->deltas, delta) > 0;
+    CRYPTO_THREAD_unlock(crl->lock);
+    if (!ok) {
+        X509_CRL_free(delta);
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+    }
+    return ok;
+}
@@ -27,6 +27,7 @@
 #include <openssl/encoder.h>
 #include "internal/provider.h"
 #include "internal/sizes.h"
+#include "internal/thread_once.h"
 
 struct X509_pubkey_st {
     X509_ALGOR *algor;
@@ -40,6 +41,15 @@ struct X509_pubkey_st {
 
     /* Flag to force legacy keys */
     unsigned int flag_force_legacy : 1;
+
+    /*
+     * Set when the key was parsed as part of a certificate and |pkey| has not
+     * been decoded yet, see x509_pubkey_ex_d2i_lazy(). |spki| holds the
+     * SubjectPublicKeyInfo as it was parsed, for decoding on first access.
+     */
+    uint64_t pending;
+    unsigned char *spki;
+    size_t spki_len;
 };
 
 static int x509_pubkey_decode(EVP_PKEY **pk, const X509_PUBKEY *key);
@@ -92,6 +102,7 @@ static void x509_pubkey_ex_free(ASN1_VALUE **pval, const ASN1_ITEM *it)
         ASN1_BIT_STRING_free(pubkey->public_key);
         EVP_PKEY_free(pubkey->pkey);
         OPENSSL_free(pubkey->propq);
+        OPENSSL_free(pubkey->spki);
         OPENSSL_free(pubkey);
         *pval = NULL;
     }
@@ -127,47 +138,22 @@ static int x509_pubkey_ex_new_ex(ASN1_VALUE **pval, const ASN1_ITEM *it,
     return ret != NULL;
 }
 
-static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
-                                 const unsigned char **in, long len,
-                                 const ASN1_ITEM *it, int tag, int aclass,
-                                 char opt, ASN1_TLC *ctx, OSSL_LIB_CTX *libctx,
-                                 const char *propq)
+/*
+ * Opportunistically decode the SubjectPublicKeyInfo |der| into |pubkey->pkey|
+ * but remove any non fatal errors from the queue. Subsequent explicit attempts
+ * to decode/use the key will return an appropriate error.
+ * Returns 1 if the key was decoded or a non fatal error occurred, 0 or -1 for
+ * a fatal error.
+ */
+static int x509_pubkey_decode_spki(X509_PUBKEY *pubkey,
+                                   const unsigned char *der, size_t derlen)
 {
-    const unsigned char *in_saved = *in;
-    size_t publen;
-    X509_PUBKEY *pubkey;
-    int ret;
     OSSL_DECODER_CTX *dctx = NULL;
-    unsigned char *tmpbuf = NULL;
-
-    if (*pval == NULL && !x509_pubkey_ex_new_ex(pval, it, libctx, propq))
-        return 0;
-    if (!x509_pubkey_ex_populate(pval, NULL)) {
-        ERR_raise(ERR_LIB_ASN1, ERR_R_X509_LIB);
-        return 0;
-    }
-
-    /* This ensures that |*in| advances properly no matter what */
-    if ((ret = ASN1_item_ex_d2i(pval, in, len,
-                                ASN1_ITEM_rptr(X509_PUBKEY_INTERNAL),
-                                tag, aclass, opt, ctx)) <= 0)
-        return ret;
-
-    publen = *in - in_saved;
-    if (!ossl_assert(publen > 0)) {
-        ERR_raise(ERR_LIB_ASN1, ERR_R_INTERNAL_ERROR);
-        return 0;
-    }
+    int ret;
 
-    pubkey = (X509_PUBKEY *)*pval;
     EVP_PKEY_free(pubkey->pkey);
     pubkey->pkey = NULL;
 
-    /*
-     * Opportunistically decode the key but remove any non fatal errors
-     * from the queue. Subsequent explicit attempts to decode/use the key
-     * will return an appropriate error.
-     */
     ERR_set_mark();
 
     /*
@@ -182,22 +168,9 @@ static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
 
     /* Try to decode it into an EVP_PKEY with OSSL_DECODER */
     if (ret <= 0 && !pubkey->flag_force_legacy) {
-        const unsigned char *p;
+        const unsigned char *p = der;
         char txtoidname[OSSL_MAX_NAME_SIZE];
-        size_t slen = publen;
-
-        /*
-        * The decoders don't know how to handle anything other than Universal
-        * class so we modify the data accordingly.
-        */
-        if (aclass != V_ASN1_UNIVERSAL) {
-            tmpbuf = OPENSSL_memdup(in_saved, publen);
-            if (tmpbuf == NULL)
-                return 0;
-            in_saved = tmpbuf;
-            *tmpbuf = V_ASN1_CONSTRUCTED | V_ASN1_SEQUENCE;
-        }
-        p = in_saved;
+        size_t slen = derlen;
 
         if (OBJ_obj2txt(txtoidname, sizeof(txtoidname),
                         pubkey->algor->algorithm, 0) <= 0) {
@@ -231,10 +204,185 @@ static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
     ret = 1;
  end:
     OSSL_DECODER_CTX_free(dctx);
+    return ret;
+}
+
+/* Parses the SubjectPublicKeyInfo without attempting to decode the key */
+static int x509_pubkey_ex_d2i_fields(ASN1_VALUE **pval,
+                                     const unsigned char **in, long len,
+                                     const ASN1_ITEM *it, int tag, int aclass,
+                                     char opt, ASN1_TLC *ctx,
+                                     OSSL_LIB_CTX *libctx, const char *propq)
+{
+    X509_PUBKEY *pubkey;
+    int ret;
+
+    if (*pval == NULL && !x509_pubkey_ex_new_ex(pval, it, libctx, propq))
+        return 0;
+    if (!x509_pubkey_ex_populate(pval, NULL)) {
+        ERR_raise(ERR_LIB_ASN1, ERR_R_X509_LIB);
+        return 0;
+    }
+
+    /* This ensures that |*in| advances properly no matter what */
+    if ((ret = ASN1_item_ex_d2i(pval, in, len,
+                                ASN1_ITEM_rptr(X509_PUBKEY_INTERNAL),
+                                tag, aclass, opt, ctx)) <= 0)
+        return ret;
+
+    pubkey = (X509_PUBKEY *)*pval;
+    EVP_PKEY_free(pubkey->pkey);
+    pubkey->pkey = NULL;
+    pubkey->pending = 0;
+    OPENSSL_free(pubkey->spki);
+    pubkey->spki = NULL;
+    pubkey->spki_len = 0;
+    return ret;
+}
+
+static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
+                                 const unsigned char **in, long len,
+                                 const ASN1_ITEM *it, int tag, int aclass,
+                                 char opt, ASN1_TLC *ctx, OSSL_LIB_CTX *libctx,
+                                 const char *propq)
+{
+    const unsigned char *in_saved = *in;
+    size_t publen;
+    int ret;
+    unsigned char *tmpbuf = NULL;
+
+    if ((ret = x509_pubkey_ex_d2i_fields(pval, in, len, it, tag, aclass, opt,
+                                         ctx, libctx, propq)) <= 0)
+        return ret;
+
+    publen = *in - in_saved;
+    if (!ossl_assert(publen > 0)) {
+        ERR_raise(ERR_LIB_ASN1, ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+
+    /*
+     * The decoders don't know how to handle anything other than Universal
+     * class so we modify the data accordingly.
+     */
+    if (aclass != V_ASN1_UNIVERSAL) {
+        tmpbuf = OPENSSL_memdup(in_saved, publen);
+        if (tmpbuf == NULL)
+            return 0;
+        in_saved = tmpbuf;
+        *tmpbuf = V_ASN1_CONSTRUCTED | V_ASN1_SEQUENCE;
+    }
+
+    ret = x509_pubkey_decode_spki((X509_PUBKEY *)*pval, in_saved, publen);
     OPENSSL_free(tmpbuf);
     return ret;
 }
 
+/*
+ * Certificates are commonly parsed only to be verified or matched by name,
+ * and decoding the public key through the provider decoders is the most
+ * expensive part of d2i_X509(). The key of a certificate is therefore only
+ * decoded on first use, see x509_pubkey_materialize().
+ *
+ * This is the only part of the certificate that is deferred. The extensions
+ * are still decoded into a stack of X509_EXTENSION by d2i_X509() with the
+ * rest of X509_CINF, only the interpretation of their values waits for
+ * ossl_x509v3_cache_extensions().
+ */
+static int x509_pubkey_ex_d2i_lazy(ASN1_VALUE **pval,
+                                   const unsigned char **in, long len,
+                                   const ASN1_ITEM *it, int tag, int aclass,
+                                   char opt, ASN1_TLC *ctx,
+                                   OSSL_LIB_CTX *libctx, const char *propq)
+{
+    const unsigned char *in_saved = *in;
+    X509_PUBKEY *pubkey;
+    int ret;
+
+    if ((ret = x509_pubkey_ex_d2i_fields(pval, in, len, it, tag, aclass, opt,
+                                         ctx, libctx, propq)) <= 0)
+        return ret;
+
+    pubkey = (X509_PUBKEY *)*pval;
+    pubkey->spki_len = *in - in_saved;
+    if (!ossl_assert(pubkey->spki_len > 0)) {
+        ERR_raise(ERR_LIB_ASN1, ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+    if ((pubkey->spki = OPENSSL_memdup(in_saved, pubkey->spki_len)) == NULL)
+        return 0;
+    /* See x509_pubkey_ex_d2i_ex() */
+    if (aclass != V_ASN1_UNIVERSAL)
+        *pubkey->spki = V_ASN1_CONSTRUCTED | V_ASN1_SEQUENCE;
+    pubkey->pending = 1;
+    return ret;
+}
+
+/*
+ * A single lock for all lazily decoded keys, as a lock per certificate costs
+ * more than the decoding it defers.  It is only held to publish a decoded key,
+ * the decoding itself runs without it.
+ */
+static CRYPTO_ONCE x509_pubkey_lazy_init = CRYPTO_ONCE_STATIC_INIT;
+static int x509_pubkey_lazy_inited = 0;
+static CRYPTO_RWLOCK *x509_pubkey_lazy_lock = NULL;
+
+DEFINE_RUN_ONCE_STATIC(do_x509_pubkey_lazy_init)
+{
+    if ((x509_pubkey_lazy_lock = CRYPTO_THREAD_lock_new()) == NULL)
+        return 0;
+    x509_pubkey_lazy_inited = 1;
+    return 1;
+}
+
+void ossl_x509_pubkey_cleanup_int(void)
+{
+    if (!x509_pubkey_lazy_inited)
+        return;
+    CRYPTO_THREAD_lock_free(x509_pubkey_lazy_lock);
+    x509_pubkey_lazy_lock = NULL;
+    x509_pubkey_lazy_inited = 0;
+}
+
+/*
+ * Decodes the key of a lazily parsed X509_PUBKEY if that has not happened
+ * yet. Returns 0 only for a fatal error, in which case a later call tries
+ * again.
+ */
+static int x509_pubkey_materialize(X509_PUBKEY *key)
+{
+    X509_PUBKEY tmp;
+    uint64_t pending;
+
+    if (!RUN_ONCE(&x509_pubkey_lazy_init, do_x509_pubkey_lazy_init)
+        || !CRYPTO_atomic_load(&key->pending, &pending, x509_pubkey_lazy_lock))
+        return 0;
+    if (!pending)
+        return 1;
+
+    /*
+     * Threads that race here each decode the key from the same |spki| and
+     * only the first one keeps the result. |spki| is therefore kept until
+     * |key| is freed.
+     */
+    tmp = *key;
+    tmp.pkey = NULL;
+    if (x509_pubkey_decode_spki(&tmp, key->spki, key->spki_len) <= 0)
+        return 0;
+
+    if (!CRYPTO_THREAD_write_lock(x509_pubkey_lazy_lock)) {
+        EVP_PKEY_free(tmp.pkey);
+        return 0;
+    }
+    if (key->pkey == NULL) {
+        key->pkey = tmp.pkey;
+        tmp.pkey = NULL;
+    }
+    CRYPTO_THREAD_unlock(x509_pubkey_lazy_lock);
+    EVP_PKEY_free(tmp.pkey);
+    return CRYPTO_atomic_store(&key->pending, 0, x509_pubkey_lazy_lock);
+}
+
 static int x509_pubkey_ex_i2d(const ASN1_VALUE **pval, unsigned char **out,
                               const ASN1_ITEM *it, int tag, int aclass)
 {
@@ -264,6 +412,24 @@ static const ASN1_EXTERN_FUNCS x509_pubkey_ff = {
 IMPLEMENT_EXTERN_ASN1(X509_PUBKEY, V_ASN1_SEQUENCE, x509_pubkey_ff)
 IMPLEMENT_ASN1_FUNCTIONS(X509_PUBKEY)
 
+static const ASN1_EXTERN_FUNCS x509_pubkey_lazy_ff = {
+    NULL,
+    NULL,
+    x509_pubkey_ex_free,
+    0,                          /* Default clear behaviour is OK */
+    NULL,
+    x509_pubkey_ex_i2d,
+    x509_pubkey_ex_print,
+    x509_pubkey_ex_new_ex,
+    x509_pubkey_ex_d2i_lazy,
+};
+
+/* The same as X509_PUBKEY, but decodes the key on first use */
+ASN1_ITEM_start(ossl_X509_PUBKEY_LAZY)
+        ASN1_ITYPE_EXTERN, V_ASN1_SEQUENCE, NULL, 0, &x509_pubkey_lazy_ff, 0,
+        "X509_PUBKEY"
+ASN1_ITEM_end(ossl_X509_PUBKEY_LAZY)
+
 X509_PUBKEY *X509_PUBKEY_new_ex(OSSL_LIB_CTX *libctx, const char *propq)
 {
     X509_PUBKEY *pubkey = NULL;
@@ -303,6 +469,11 @@ X509_PUBKEY *X509_PUBKEY_dup(const X509_PUBKEY *a)
         return NULL;
     }
 
+    if (!x509_pubkey_materialize((X509_PUBKEY *)a)) {
+        x509_pubkey_ex_free((ASN1_VALUE **)&pubkey,
+                            ASN1_ITEM_rptr(X509_PUBKEY_INTERNAL));
+        return NULL;
+    }
     if (a->pkey != NULL) {
         ERR_set_mark();
         pubkey->pkey = EVP_PKEY_dup(a->pkey);
@@ -459,6 +630,9 @@ EVP_PKEY *X509_PUBKEY_get0(const X509_PUBKEY *key)
         return NULL;
     }
 
+    if (!x509_pubkey_materialize((X509_PUBKEY *)key))
+        return NULL;
+
     if (key->pkey == NULL) {
         /* We failed to decode the key when we loaded it, or it was never set */
         ERR_raise(ERR_LIB_EVP, EVP_R_DECODE_ERROR);
@@ -66,6 +66,8 @@ int ossl_ec_key_pairwise_check(const EC_KEY *eckey, BN_CTX *ctx);
 OSSL_LIB_CTX *ossl_ec_key_get_libctx(const EC_KEY *eckey);
 const char *ossl_ec_key_get0_propq(const EC_KEY *eckey);
 void ossl_ec_key_set0_libctx(EC_KEY *key, OSSL_LIB_CTX *libctx);
+int ossl_ec_key_precompute_public(EC_KEY *key);
+int ossl_ec_key_has_public_precomp(const EC_KEY *key);
 
 /* Backend support */
 int ossl_ec_group_todata(const EC_GROUP *group, OSSL_PARAM_BLD *tmpl,
@@ -108,6 +108,12 @@ ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
                     const uint8_t *context, size_t context_len,
                     OSSL_LIB_CTX *libctx, const char *propq);
 int
+ossl_ed25519_verify_batch(size_t n, const uint8_t *const *tbs,
+                          const size_t *tbs_len, const uint8_t *const *sigs,
+                          const size_t *sigs_len,
+                          const uint8_t public_key[32], int *results,
+                          OSSL_LIB_CTX *libctx, const char *propq);
+int
 ossl_ed25519_pubkey_verify(const uint8_t *pub, size_t pub_len);
 int
 ossl_ed448_public_from_private(OSSL_LIB_CTX *ctx, uint8_t out_public_key[57],
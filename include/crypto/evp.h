@@ -753,6 +753,10 @@ void evp_app_cleanup_int(void);
 void *evp_pkey_export_to_provider(EVP_PKEY *pk, OSSL_LIB_CTX *libctx,
                                   EVP_KEYMGMT **keymgmt,
                                   const char *propquery);
+int evp_pkey_sign_batch(EVP_PKEY_CTX *ctx, size_t n,
+                        unsigned char *const *sigs, size_t *siglens,
+                        const unsigned char *const *tbs,
+                        const size_t *tbslens);
 #ifndef FIPS_MODULE
 int evp_pkey_copy_downgraded(EVP_PKEY **dest, const EVP_PKEY *src);
 void *evp_pkey_get_legacy(EVP_PKEY *pk);
@@ -61,6 +61,9 @@ const char *ossl_rsa_oaeppss_nid2name(int md);
 RSA *ossl_rsa_new_with_ctx(OSSL_LIB_CTX *libctx);
 OSSL_LIB_CTX *ossl_rsa_get0_libctx(RSA *r);
 void ossl_rsa_set0_libctx(RSA *r, OSSL_LIB_CTX *libctx);
+void ossl_rsa_set_gen_threads(RSA *r, int threads);
+void ossl_rsa_precompute(RSA *rsa);
+void ossl_rsa_cleanup_int(void);
 
 int ossl_rsa_set0_all_params(RSA *r, STACK_OF(BIGNUM) *primes,
                              STACK_OF(BIGNUM) *exps,
@@ -122,6 +122,8 @@ struct X509_crl_st {
     const X509_CRL_METHOD *meth;
     void *meth_data;
     CRYPTO_RWLOCK *lock;
+    /* Decoded into an ASN1_ARENA, which frees it whatever the refcount */
+    int in_arena;
 
     OSSL_LIB_CTX *libctx;
     char *propq;
@@ -205,6 +207,9 @@ struct x509_st {
 
     OSSL_LIB_CTX *libctx;
     char *propq;
+
+    /* Decoded into an ASN1_ARENA, which frees it whatever the refcount */
+    int in_arena;
 } /* X509 */ ;
 
 /*
@@ -283,6 +288,9 @@ struct x509_store_ctx_st {      /* X509_STORE_CTX */
 
     OSSL_LIB_CTX *libctx;
     char *propq;
+
+    /* Issuer signatures known to be valid, shared by a verification batch */
+    struct x509_sig_cache_st *sig_cache;
 };
 
 /* PKCS#8 private key info structure */
@@ -337,6 +345,9 @@ X509_PUBKEY *ossl_d2i_X509_PUBKEY_INTERNAL(const unsigned char **pp,
                                            long len, OSSL_LIB_CTX *libctx,
                                            const char *propq);
 void ossl_X509_PUBKEY_INTERNAL_free(X509_PUBKEY *xpub);
+void ossl_x509_pubkey_cleanup_int(void);
+/* X509_PUBKEY that decodes the key on first use, for the certificate TBS */
+DECLARE_ASN1_ITEM(ossl_X509_PUBKEY_LAZY)
 
 RSA *ossl_d2i_RSA_PSS_PUBKEY(RSA **a, const unsigned char **pp, long length);
 int ossl_i2d_RSA_PSS_PUBKEY(const RSA *a, unsigned char **pp);
@@ -10,6 +10,9 @@
 #define	_INTERNAL_COMP_H
 
 #include <openssl/comp.h>
+#include <openssl/lhash.h>
+#include <openssl/sha.h>
+#include "internal/refcount.h"
 
 void ossl_comp_zlib_cleanup(void);
 void ossl_comp_brotli_cleanup(void);
@@ -21,4 +24,35 @@ struct ssl_comp_st {
     COMP_METHOD *method;
 };
 
+/*
+ * A compressed certificate. These are shared between the SSL_CTX objects of
+ * a library context through the cache below, which libcrypto owns and frees
+ * with the library context, so the structure holds plain data only.
+ */
+struct ossl_comp_cert_st {
+    unsigned char *data;
+    size_t len;
+    size_t orig_len;
+    CRYPTO_REF_COUNT references;
+    int alg;
+};
+typedef struct ossl_comp_cert_st OSSL_COMP_CERT;
+
+/*
+ * Entries are keyed by the SHA-256 digest of the uncompressed Certificate
+ * message and the algorithm, and hold a reference to |cc|.
+ */
+typedef struct ossl_comp_cert_cache_entry_st {
+    unsigned char md[SHA256_DIGEST_LENGTH];
+    int alg;
+    OSSL_COMP_CERT *cc;
+} OSSL_COMP_CERT_CACHE_ENTRY;
+
+DEFINE_LHASH_OF_EX(OSSL_COMP_CERT_CACHE_ENTRY);
+
+typedef struct ossl_comp_cert_cache_st {
+    CRYPTO_RWLOCK *lock;
+    LHASH_OF(OSSL_COMP_CERT_CACHE_ENTRY) *entries;
+} OSSL_COMP_CERT_CACHE;
+
 #endif
@@ -86,6 +86,11 @@ static ossl_inline int ktls_enable_tx_zerocopy_sendfile(int fd)
     return 0;
 }
 
+static ossl_inline int ktls_disable_tx_zerocopy_sendfile(int fd)
+{
+    return 0;
+}
+
 /*
  * Send a TLS record using the tls_en provided in ktls_start and use
  * record_type instead of the default SSL3_RT_APPLICATION_DATA.
@@ -240,8 +245,17 @@ static ossl_inline ossl_ssize_t ktls_sendfile(int s, int fd, off_t off,
 #     endif
 #    endif
 #   endif
+/*
+ * From 6.14 a TLS 1.3 socket accepts a second TLS_TX/TLS_RX setsockopt with
+ * the keys that follow a KeyUpdate. The receive side stops decrypting after
+ * a KeyUpdate message until the new keys are installed.
+ */
+#   if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 14, 0)
+#    define OPENSSL_KTLS_TLS13_REKEY
+#   endif
 
 #   include <sys/sendfile.h>
+#   include <fcntl.h>
 #   include <netinet/tcp.h>
 #   include <linux/socket.h>
 #   include <openssl/ssl3.h>
@@ -318,6 +332,18 @@ static ossl_inline int ktls_enable_tx_zerocopy_sendfile(int fd)
 #endif
 }
 
+static ossl_inline int ktls_disable_tx_zerocopy_sendfile(int fd)
+{
+#ifndef OPENSSL_NO_KTLS_ZC_TX
+    int enable = 0;
+
+    return setsockopt(fd, SOL_TLS, TLS_TX_ZEROCOPY_RO,
+                      &enable, sizeof(enable)) ? 0 : 1;
+#else
+    return 0;
+#endif
+}
+
 /*
  * Send a TLS record using the crypto_info provided in ktls_start and use
  * record_type instead of the default SSL3_RT_APPLICATION_DATA.
@@ -364,6 +390,20 @@ static ossl_inline ossl_ssize_t ktls_sendfile(int s, int fd, off_t off, size_t s
     return sendfile(s, fd, &off, size);
 }
 
+/*
+ * Move up to @size bytes from the pipe @fd to the socket with splice(2), so
+ * that data produced by another splice (e.g. from a second socket) reaches
+ * the TLS socket without being copied through user space. splice() is only
+ * declared when _GNU_SOURCE is defined.
+ */
+#   ifdef SPLICE_F_MOVE
+#    define OPENSSL_KTLS_SPLICE
+static ossl_inline ossl_ssize_t ktls_splice(int s, int fd, size_t size)
+{
+    return splice(fd, NULL, s, NULL, size, SPLICE_F_MOVE);
+}
+#   endif
+
 #   ifdef OPENSSL_NO_KTLS_RX
 
 
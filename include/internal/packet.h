@@ -650,6 +650,9 @@ struct wpacket_sub {
     unsigned int flags;
 };
 
+/* Number of nested sub-packets a WPACKET holds without allocating memory */
+#define WPACKET_SUB_POOL 4
+
 typedef struct wpacket_st WPACKET;
 struct wpacket_st {
     /* The buffer where we store the output data */
@@ -673,6 +676,10 @@ struct wpacket_st {
     /* Our sub-packets (always at least one if not finished) */
     WPACKET_SUB *subs;
 
+    /* Number of open sub-packets, the first ones are stored in |subpool| */
+    size_t numsubs;
+    WPACKET_SUB subpool[WPACKET_SUB_POOL];
+
     /* Writing from the end first? */
     unsigned int endfirst : 1;
 };
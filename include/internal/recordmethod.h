@@ -67,6 +67,14 @@ struct ossl_record_template_st {
     unsigned int version;
     const unsigned char *buf;
     size_t buflen;
+    /*
+     * If |buf| is NULL and |iov| is not then the |buflen| bytes of the record
+     * are gathered from the |iovcnt| buffers in |iov|, starting |iovoff| bytes
+     * into the first of them.
+     */
+    const SSL_IOVEC *iov;
+    size_t iovcnt;
+    size_t iovoff;
 };
 
 typedef struct ossl_record_template_st OSSL_RECORD_TEMPLATE;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -22,6 +22,18 @@ int ossl_crypto_thread_join(void *task, CRYPTO_THREAD_RETVAL *retval);
 int ossl_crypto_thread_clean(void *vhandle);
 uint64_t ossl_get_avail_threads(OSSL_LIB_CTX *ctx);
 
+typedef struct ossl_thread_pool_st OSSL_THREAD_POOL;
+typedef struct ossl_thread_task_st OSSL_THREAD_TASK;
+
+OSSL_THREAD_TASK *ossl_crypto_pool_submit(OSSL_LIB_CTX *ctx,
+                                          CRYPTO_THREAD_ROUTINE routine,
+                                          void *data);
+int ossl_crypto_pool_wait(OSSL_THREAD_TASK *task, CRYPTO_THREAD_RETVAL *retval);
+int ossl_crypto_pool_cancel(OSSL_THREAD_TASK *task);
+int ossl_crypto_pool_task_done(OSSL_THREAD_TASK *task);
+void ossl_crypto_pool_task_free(OSSL_THREAD_TASK *task);
+void ossl_crypto_pool_free(OSSL_THREAD_POOL *pool);
+
 # if defined(OPENSSL_THREADS)
 
 #  define OSSL_LIB_CTX_GET_THREADS(CTX)                                       \
@@ -32,6 +44,7 @@ typedef struct openssl_threads_st {
     uint64_t active_threads;
     CRYPTO_MUTEX *lock;
     CRYPTO_CONDVAR *cond_finished;
+    OSSL_THREAD_POOL *pool;
 } OSSL_LIB_CTX_THREADS;
 
 # endif /* defined(OPENSSL_THREADS) */
@@ -748,6 +748,8 @@ OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, keyexch_gettable_ctx_params,
 # define OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_INIT    30
 # define OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_UPDATE  31
 # define OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_FINAL   32
+# define OSSL_FUNC_SIGNATURE_VERIFY_BATCH           33
+# define OSSL_FUNC_SIGNATURE_SIGN_BATCH             34
 
 OSSL_CORE_MAKE_FUNC(void *, signature_newctx, (void *provctx,
                                                const char *propq))
@@ -764,6 +766,10 @@ OSSL_CORE_MAKE_FUNC(int, signature_sign_message_update,
 OSSL_CORE_MAKE_FUNC(int, signature_sign_message_final,
                     (void *ctx, unsigned char *sig,
                      size_t *siglen, size_t sigsize))
+OSSL_CORE_MAKE_FUNC(int, signature_sign_batch,
+                    (void *ctx, size_t n,
+                     unsigned char *const *sigs, size_t *siglens,
+                     const unsigned char *const *tbs, const size_t *tbslens))
 OSSL_CORE_MAKE_FUNC(int, signature_verify_init, (void *ctx, void *provkey,
                                                  const OSSL_PARAM params[]))
 OSSL_CORE_MAKE_FUNC(int, signature_verify, (void *ctx,
@@ -780,6 +786,11 @@ OSSL_CORE_MAKE_FUNC(int, signature_verify_message_update,
  * is specified via an OSSL_PARAM.
  */
 OSSL_CORE_MAKE_FUNC(int, signature_verify_message_final, (void *ctx))
+OSSL_CORE_MAKE_FUNC(int, signature_verify_batch,
+                    (void *ctx, size_t n,
+                     const unsigned char *const *sigs, const size_t *siglens,
+                     const unsigned char *const *tbs, const size_t *tbslens,
+                     int *results))
 OSSL_CORE_MAKE_FUNC(int, signature_verify_recover_init,
                     (void *ctx, void *provkey, const OSSL_PARAM params[]))
 OSSL_CORE_MAKE_FUNC(int, signature_verify_recover,
@@ -45,6 +45,8 @@ int OSSL_DECODER_names_do_all(const OSSL_DECODER *encoder,
                               void *data);
 const OSSL_PARAM *OSSL_DECODER_gettable_params(OSSL_DECODER *decoder);
 int OSSL_DECODER_get_params(OSSL_DECODER *decoder, OSSL_PARAM params[]);
+int OSSL_DECODER_get_stats(OSSL_DECODER *decoder, uint64_t *attempts,
+                           uint64_t *failures);
 
 const OSSL_PARAM *OSSL_DECODER_settable_ctx_params(OSSL_DECODER *encoder);
 OSSL_DECODER_CTX *OSSL_DECODER_CTX_new(void);
@@ -98,6 +98,42 @@ BIO *OSSL_HTTP_transfer(OSSL_HTTP_REQ_CTX **prctx,
                         size_t max_resp_len, int timeout, int keep_alive);
 int OSSL_HTTP_close(OSSL_HTTP_REQ_CTX *rctx, int ok);
 
+/* Reuse of persistent connections */
+OSSL_HTTP_POOL *OSSL_HTTP_POOL_new(size_t max_idle, int idle_timeout);
+void OSSL_HTTP_POOL_free(OSSL_HTTP_POOL *pool);
+OSSL_HTTP_REQ_CTX *OSSL_HTTP_POOL_get(OSSL_HTTP_POOL *pool,
+                                      const char *server, const char *port,
+                                      const char *proxy, const char *no_proxy,
+                                      int use_ssl,
+                                      OSSL_HTTP_bio_cb_t bio_update_fn,
+                                      void *arg, int buf_size,
+                                      int overall_timeout);
+int OSSL_HTTP_POOL_put(OSSL_HTTP_POOL *pool, OSSL_HTTP_REQ_CTX *rctx, int ok);
+BIO *OSSL_HTTP_POOL_transfer(OSSL_HTTP_POOL *pool,
+                             const char *server, const char *port,
+                             const char *path, int use_ssl,
+                             const char *proxy, const char *no_proxy,
+                             OSSL_HTTP_bio_cb_t bio_update_fn, void *arg,
+                             int buf_size, const STACK_OF(CONF_VALUE) *headers,
+                             const char *content_type, BIO *req,
+                             const char *expected_content_type, int expect_asn1,
+                             size_t max_resp_len, int timeout);
+
+/* Concurrent and pipelined non-blocking transfers */
+#  define OSSL_HTTP_POLL_IN  0x1
+#  define OSSL_HTTP_POLL_OUT 0x2
+
+OSSL_HTTP_REQ_CTX *OSSL_HTTP_REQ_CTX_new_pipelined(const OSSL_HTTP_REQ_CTX *rctx);
+OSSL_HTTP_MULTI *OSSL_HTTP_MULTI_new(void);
+void OSSL_HTTP_MULTI_free(OSSL_HTTP_MULTI *multi);
+int OSSL_HTTP_MULTI_add(OSSL_HTTP_MULTI *multi, OSSL_HTTP_REQ_CTX *rctx);
+int OSSL_HTTP_MULTI_perform(OSSL_HTTP_MULTI *multi);
+OSSL_HTTP_REQ_CTX *OSSL_HTTP_MULTI_get_done(OSSL_HTTP_MULTI *multi, int *ok);
+size_t OSSL_HTTP_MULTI_get_poll_descriptors(OSSL_HTTP_MULTI *multi,
+                                            BIO_POLL_DESCRIPTOR *desc,
+                                            int *events, size_t max);
+int OSSL_HTTP_MULTI_wait(OSSL_HTTP_MULTI *multi, int timeout_ms);
+
 /* Auxiliary functions */
 int OSSL_parse_url(const char *url, char **pscheme, char **puser, char **phost,
                    char **pport, int *pport_num,
@@ -89,6 +89,7 @@ int RAND_set_DRBG_type(OSSL_LIB_CTX *ctx, const char *drbg, const char *propq,
                        const char *cipher, const char *digest);
 int RAND_set_seed_source_type(OSSL_LIB_CTX *ctx, const char *seed,
                               const char *propq);
+int RAND_set_public_buffer_size(OSSL_LIB_CTX *ctx, size_t size);
 
 void RAND_seed(const void *buf, int num);
 void RAND_keep_random_devices_open(int keep);
@@ -198,7 +198,9 @@
 # define SSL_R_NO_COMPRESSION_SPECIFIED                   187
 # define SSL_R_NO_COOKIE_CALLBACK_SET                     287
 # define SSL_R_NO_GOST_CERTIFICATE_SENT_BY_PEER           330
+# define SSL_R_NO_ISSUER_CERTIFICATE                      444
 # define SSL_R_NO_METHOD_SPECIFIED                        188
+# define SSL_R_NO_OCSP_RESPONDER                          445
 # define SSL_R_NO_PEM_EXTENSIONS                          389
 # define SSL_R_NO_PRIVATE_KEY_ASSIGNED                    190
 # define SSL_R_NO_PROTOCOLS_AVAILABLE                     191
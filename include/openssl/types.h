@@ -87,6 +87,7 @@ typedef struct asn1_string_table_st ASN1_STRING_TABLE;
 typedef struct ASN1_ITEM_st ASN1_ITEM;
 typedef struct asn1_pctx_st ASN1_PCTX;
 typedef struct asn1_sctx_st ASN1_SCTX;
+typedef struct asn1_arena_st ASN1_ARENA;
 
 # ifdef BIGNUM
 #  undef BIGNUM
@@ -209,6 +210,8 @@ typedef struct NAME_CONSTRAINTS_st NAME_CONSTRAINTS;
 typedef struct crypto_ex_data_st CRYPTO_EX_DATA;
 
 typedef struct ossl_http_req_ctx_st OSSL_HTTP_REQ_CTX;
+typedef struct ossl_http_pool_st OSSL_HTTP_POOL;
+typedef struct ossl_http_multi_st OSSL_HTTP_MULTI;
 typedef struct ocsp_response_st OCSP_RESPONSE;
 typedef struct ocsp_responder_id_st OCSP_RESPID;
 
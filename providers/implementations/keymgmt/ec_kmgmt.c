@@ -753,6 +753,11 @@ int common_get_params(void *key, OSSL_PARAM params[], int sm2)
             goto err;
     }
 
+    if ((p = OSSL_PARAM_locate(params,
+                               OSSL_PKEY_PARAM_EC_PRECOMPUTE_PUBLIC)) != NULL
+        && !OSSL_PARAM_set_int(p, ossl_ec_key_has_public_precomp(eck)))
+        goto err;
+
     ret = ec_get_ecm_params(ecg, params)
           && ossl_ec_group_todata(ecg, NULL, params, libctx, propq, bnctx,
                                   &genbuf)
@@ -791,6 +796,7 @@ static const OSSL_PARAM ec_known_gettable_params[] = {
     OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_DEFAULT_DIGEST, NULL, 0),
     OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, NULL, 0),
     OSSL_PARAM_int(OSSL_PKEY_PARAM_EC_DECODED_FROM_EXPLICIT_PARAMS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_EC_PRECOMPUTE_PUBLIC, NULL),
     EC_IMEXPORTABLE_DOM_PARAMETERS,
     EC2M_GETTABLE_DOM_PARAMS
     EC_IMEXPORTABLE_PUBLIC_KEY,
@@ -815,6 +821,7 @@ static const OSSL_PARAM ec_known_settable_params[] = {
     OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_EC_SEED, NULL, 0),
     OSSL_PARAM_int(OSSL_PKEY_PARAM_EC_INCLUDE_PUBLIC, NULL),
     OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_EC_GROUP_CHECK_TYPE, NULL, 0),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_EC_PRECOMPUTE_PUBLIC, NULL),
     OSSL_PARAM_END
 };
 
@@ -852,7 +859,20 @@ int ec_set_params(void *key, const OSSL_PARAM params[])
             return 0;
     }
 
-    return ossl_ec_key_otherparams_fromdata(eck, params);
+    if (!ossl_ec_key_otherparams_fromdata(eck, params))
+        return 0;
+
+    /* Must come last, any change to the key invalidates the table */
+    p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_EC_PRECOMPUTE_PUBLIC);
+    if (p != NULL) {
+        int precompute;
+
+        if (!OSSL_PARAM_get_int(p, &precompute))
+            return 0;
+        if (precompute && !ossl_ec_key_precompute_public(eck))
+            return 0;
+    }
+    return 1;
 }
 
 #ifndef FIPS_MODULE
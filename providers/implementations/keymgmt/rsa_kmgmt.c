@@ -195,6 +195,8 @@ static int rsa_import(void *keydata, int selection, const OSSL_PARAM params[])
             selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY ? 1 : 0;
 
         ok = ok && ossl_rsa_fromdata(rsa, params, include_private);
+        if (ok && include_private)
+            ossl_rsa_precompute(rsa);
     }
 
     return ok;
@@ -422,6 +424,7 @@ struct rsa_gen_ctx {
     size_t nbits;
     BIGNUM *pub_exp;
     size_t primes;
+    uint32_t threads;
 
     /* For PSS */
     RSA_PSS_PARAMS_30 pss_params;
@@ -522,6 +525,9 @@ static int rsa_gen_set_params(void *genctx, const OSSL_PARAM params[])
     if ((p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_RSA_E)) != NULL
         && !OSSL_PARAM_get_BN(p, &gctx->pub_exp))
         return 0;
+    if ((p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_RSA_THREADS)) != NULL
+        && !OSSL_PARAM_get_uint32(p, &gctx->threads))
+        return 0;
     /* Only attempt to get PSS parameters when generating an RSA-PSS key */
     if (gctx->rsa_type == RSA_FLAG_TYPE_RSASSAPSS
         && !pss_params_fromdata(&gctx->pss_params, &gctx->pss_defaults_set, params,
@@ -538,7 +544,8 @@ static int rsa_gen_set_params(void *genctx, const OSSL_PARAM params[])
 #define rsa_gen_basic                                           \
     OSSL_PARAM_size_t(OSSL_PKEY_PARAM_RSA_BITS, NULL),          \
     OSSL_PARAM_size_t(OSSL_PKEY_PARAM_RSA_PRIMES, NULL),        \
-    OSSL_PARAM_BN(OSSL_PKEY_PARAM_RSA_E, NULL, 0)
+    OSSL_PARAM_BN(OSSL_PKEY_PARAM_RSA_E, NULL, 0),              \
+    OSSL_PARAM_uint32(OSSL_PKEY_PARAM_RSA_THREADS, NULL)
 
 /*
  * The following must be kept in sync with ossl_rsa_pss_params_30_fromdata()
@@ -602,6 +609,7 @@ static void *rsa_gen(void *genctx, OSSL_CALLBACK *osslcb, void *cbarg)
 
     if ((rsa_tmp = ossl_rsa_new_with_ctx(gctx->libctx)) == NULL)
         return NULL;
+    ossl_rsa_set_gen_threads(rsa_tmp, (int)gctx->threads);
 
     gctx->cb = osslcb;
     gctx->cbarg = cbarg;
@@ -627,6 +635,7 @@ static void *rsa_gen(void *genctx, OSSL_CALLBACK *osslcb, void *cbarg)
 
     RSA_clear_flags(rsa_tmp, RSA_FLAG_TYPE_MASK);
     RSA_set_flags(rsa_tmp, gctx->rsa_type);
+    ossl_rsa_precompute(rsa_tmp);
 
     rsa = rsa_tmp;
     rsa_tmp = NULL;
@@ -664,6 +673,7 @@ static void *common_load(const void *reference, size_t reference_sz,
 
         /* We grabbed, so we detach it */
         *(RSA **)reference = NULL;
+        ossl_rsa_precompute(rsa);
         return rsa;
     }
     return NULL;
@@ -681,11 +691,15 @@ static void *rsapss_load(const void *reference, size_t reference_sz)
 
 static void *rsa_dup(const void *keydata_from, int selection)
 {
-    if (ossl_prov_is_running()
+    RSA *rsa;
+
+    if (!ossl_prov_is_running()
         /* do not allow creating empty keys by duplication */
-        && (selection & OSSL_KEYMGMT_SELECT_KEYPAIR) != 0)
-        return ossl_rsa_dup(keydata_from, selection);
-    return NULL;
+        || (selection & OSSL_KEYMGMT_SELECT_KEYPAIR) == 0)
+        return NULL;
+    if ((rsa = ossl_rsa_dup(keydata_from, selection)) != NULL)
+        ossl_rsa_precompute(rsa);
+    return rsa;
 }
 
 /* For any RSA key, we use the "RSA" algorithms regardless of sub-type. */
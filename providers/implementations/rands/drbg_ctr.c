@@ -252,6 +252,71 @@ __owur static int ctr_df(PROV_DRBG_CTR *ctr,
     return 1;
 }
 
+static void ctr96_inc(unsigned char *counter)
+{
+    u32 n = 12, c = 1;
+
+    do {
+        --n;
+        c += counter[n];
+        counter[n] = (u8)c;
+        c >>= 8;
+    } while (n);
+}
+
+/*
+ * Fill |out| with |outlen| bytes of key stream, the encryption of the
+ * counter blocks starting at V, and advance V past the blocks used.  This
+ * runs the CTR mode cipher over the whole request so the multi-block
+ * implementations of the cipher are used.  A request is split where the
+ * low 32 bits of the counter wrap, the cipher then never has to carry into
+ * the upper 96 bits.
+ */
+__owur static int ctr_keystream(PROV_DRBG_CTR *ctr,
+                                unsigned char *out, size_t outlen)
+{
+    unsigned int ctr32, blocks;
+    int outl, buflen;
+
+    memset(out, 0, outlen);
+
+    while (outlen > 0) {
+        if (!EVP_CipherInit_ex(ctr->ctx_ctr,
+                               NULL, NULL, NULL, ctr->V, -1))
+            return 0;
+
+        /*-
+         * outlen has type size_t while EVP_CipherUpdate takes an
+         * int argument and thus cannot be guaranteed to process more
+         * than 2^31-1 bytes at a time. We process such huge generate
+         * requests in 2^30 byte chunks, which is the greatest multiple
+         * of AES block size lower than or equal to 2^31-1.
+         */
+        buflen = outlen > (1U << 30) ? (1U << 30) : outlen;
+        blocks = (buflen + 15) / 16;
+
+        ctr32 = GETU32(ctr->V + 12) + blocks;
+        if (ctr32 < blocks) {
+            /* 32-bit counter overflow into V. */
+            if (ctr32 != 0) {
+                blocks -= ctr32;
+                buflen = blocks * 16;
+                ctr32 = 0;
+            }
+            ctr96_inc(ctr->V);
+        }
+        PUTU32(ctr->V + 12, ctr32);
+
+        if (!EVP_CipherUpdate(ctr->ctx_ctr, out, &outl, out, buflen)
+            || outl != buflen)
+            return 0;
+
+        out += buflen;
+        outlen -= buflen;
+    }
+    return 1;
+}
+
 /*
  * NB the no-df Update in SP800-90A specifies a constant input length
  * of seedlen, however other uses of this algorithm pad the input with
@@ -264,26 +329,18 @@ __owur static int ctr_update(PROV_DRBG *drbg,
                              const unsigned char *nonce, size_t noncelen)
 {
     PROV_DRBG_CTR *ctr = (PROV_DRBG_CTR *)drbg->data;
-    int outlen = AES_BLOCK_SIZE;
-    unsigned char V_tmp[48], out[48];
-    unsigned char len;
+    unsigned char out[48];
 
-    /* correct key is already set up. */
-    memcpy(V_tmp, ctr->V, 16);
-    inc_128(ctr);
-    memcpy(V_tmp + 16, ctr->V, 16);
-    if (ctr->keylen == 16) {
-        len = 32;
-    } else {
-        inc_128(ctr);
-        memcpy(V_tmp + 32, ctr->V, 16);
-        len = 48;
-    }
-    if (!EVP_CipherUpdate(ctr->ctx_ecb, out, &outlen, V_tmp, len)
-            || outlen != len)
+    /*
+     * The encryptions of V, V + 1 and, for longer keys, V + 2 are the key
+     * stream for the counter blocks starting at V.  The correct key is
+     * already set up in the CTR mode context.
+     */
+    if (!ctr_keystream(ctr, out, ctr->keylen == 16 ? 32 : 48))
         return 0;
     memcpy(ctr->K, out, ctr->keylen);
     memcpy(ctr->V, out + ctr->keylen, 16);
+    OPENSSL_cleanse(out, sizeof(out));
 
     if (ctr->use_df) {
         /* If no input reuse existing derived value */
@@ -298,8 +355,8 @@ __owur static int ctr_update(PROV_DRBG *drbg,
         ctr_XOR(ctr, in2, in2len);
     }
 
-    if (!EVP_CipherInit_ex(ctr->ctx_ecb, NULL, NULL, ctr->K, NULL, -1)
-        || !EVP_CipherInit_ex(ctr->ctx_ctr, NULL, NULL, ctr->K, NULL, -1))
+    /* The ECB context is only used by the df which sets its own key */
+    if (!EVP_CipherInit_ex(ctr->ctx_ctr, NULL, NULL, ctr->K, NULL, -1))
         return 0;
     return 1;
 }
@@ -316,7 +373,7 @@ static int drbg_ctr_instantiate(PROV_DRBG *drbg,
 
     memset(ctr->K, 0, sizeof(ctr->K));
     memset(ctr->V, 0, sizeof(ctr->V));
-    if (!EVP_CipherInit_ex(ctr->ctx_ecb, NULL, NULL, ctr->K, NULL, -1))
+    if (!EVP_CipherInit_ex(ctr->ctx_ctr, NULL, NULL, ctr->K, NULL, -1))
         return 0;
 
     inc_128(ctr);
@@ -373,25 +430,11 @@ static int drbg_ctr_reseed_wrapper(void *vdrbg, int prediction_resistance,
                                  adin, adin_len);
 }
 
-static void ctr96_inc(unsigned char *counter)
-{
-    u32 n = 12, c = 1;
-
-    do {
-        --n;
-        c += counter[n];
-        counter[n] = (u8)c;
-        c >>= 8;
-    } while (n);
-}
-
 static int drbg_ctr_generate(PROV_DRBG *drbg,
                              unsigned char *out, size_t outlen,
                              const unsigned char *adin, size_t adinlen)
 {
     PROV_DRBG_CTR *ctr = (PROV_DRBG_CTR *)drbg->data;
-    unsigned int ctr32, blocks;
-    int outl, buflen;
 
     if (adin != NULL && adinlen != 0) {
         inc_128(ctr);
@@ -417,42 +460,8 @@ static int drbg_ctr_generate(PROV_DRBG *drbg,
         return 1;
     }
 
-    memset(out, 0, outlen);
-
-    do {
-        if (!EVP_CipherInit_ex(ctr->ctx_ctr,
-                               NULL, NULL, NULL, ctr->V, -1))
-            return 0;
-
-        /*-
-         * outlen has type size_t while EVP_CipherUpdate takes an
-         * int argument and thus cannot be guaranteed to process more
-         * than 2^31-1 bytes at a time. We process such huge generate
-         * requests in 2^30 byte chunks, which is the greatest multiple
-         * of AES block size lower than or equal to 2^31-1.
-         */
-        buflen = outlen > (1U << 30) ? (1U << 30) : outlen;
-        blocks = (buflen + 15) / 16;
-
-        ctr32 = GETU32(ctr->V + 12) + blocks;
-        if (ctr32 < blocks) {
-            /* 32-bit counter overflow into V. */
-            if (ctr32 != 0) {
-                blocks -= ctr32;
-                buflen = blocks * 16;
-                ctr32 = 0;
-            }
-            ctr96_inc(ctr->V);
-        }
-        PUTU32(ctr->V + 12, ctr32);
-
-        if (!EVP_CipherUpdate(ctr->ctx_ctr, out, &outl, out, buflen)
-            || outl != buflen)
-            return 0;
-
-        out += buflen;
-        outlen -= buflen;
-    } while (outlen);
+    if (!ctr_keystream(ctr, out, outlen))
+        return 0;
 
     if (!ctr_update(drbg, adin, adinlen, NULL, 0, NULL, 0))
         return 0;
@@ -72,6 +72,7 @@ static OSSL_FUNC_signature_sign_fn ed25519_sign;
 static OSSL_FUNC_signature_sign_fn ed448_sign;
 static OSSL_FUNC_signature_verify_fn ed25519_verify;
 static OSSL_FUNC_signature_verify_fn ed448_verify;
+static OSSL_FUNC_signature_verify_batch_fn ed25519_verify_batch;
 static OSSL_FUNC_signature_digest_sign_init_fn ed25519_digest_signverify_init;
 static OSSL_FUNC_signature_digest_sign_init_fn ed448_digest_signverify_init;
 static OSSL_FUNC_signature_digest_sign_fn ed25519_digest_sign;
@@ -615,6 +616,36 @@ static int ed25519_verify(void *vpeddsactx,
                                peddsactx->libctx, edkey->propq);
 }
 
+static int ed25519_verify_batch(void *vpeddsactx, size_t n,
+                                const unsigned char *const *sigs,
+                                const size_t *siglens,
+                                const unsigned char *const *tbs,
+                                const size_t *tbslens, int *results)
+{
+    PROV_EDDSA_CTX *peddsactx = (PROV_EDDSA_CTX *)vpeddsactx;
+    const ECX_KEY *edkey = peddsactx->key;
+    size_t i;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    /* The batch equation is only implemented for pure Ed25519 */
+    if (peddsactx->dom2_flag
+            || peddsactx->context_string_flag
+            || peddsactx->context_string_len != 0
+            || peddsactx->prehash_flag
+            || peddsactx->prehash_by_caller_flag) {
+        for (i = 0; i < n; i++)
+            results[i] = ed25519_verify(vpeddsactx, sigs[i], siglens[i],
+                                        tbs[i], tbslens[i]) > 0;
+        return 1;
+    }
+
+    return ossl_ed25519_verify_batch(n, tbs, tbslens, sigs, siglens,
+                                     edkey->pubkey, results,
+                                     peddsactx->libctx, edkey->propq);
+}
+
 /*
  * This is used directly for OSSL_FUNC_SIGNATURE_VERIFY and indirectly
  * for OSSL_FUNC_SIGNATURE_DIGEST_VERIFY
@@ -943,6 +974,8 @@ eddsa_settable_variant_ctx_params(ossl_unused void *vpeddsactx,
 #define ed25519_DISPATCH_END                                            \
     { OSSL_FUNC_SIGNATURE_SIGN_INIT,                                    \
         (void (*)(void))ed25519_signverify_init },                      \
+    { OSSL_FUNC_SIGNATURE_VERIFY_BATCH,                                 \
+        (void (*)(void))ed25519_verify_batch },                         \
     { OSSL_FUNC_SIGNATURE_VERIFY_INIT,                                  \
         (void (*)(void))ed25519_signverify_init },                      \
     { OSSL_FUNC_SIGNATURE_DIGEST_SIGN_INIT,                             \
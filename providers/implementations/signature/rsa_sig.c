@@ -23,9 +23,11 @@
 #include <openssl/params.h>
 #include <openssl/evp.h>
 #include <openssl/proverr.h>
+#include <openssl/thread.h>
 #include "internal/cryptlib.h"
 #include "internal/nelem.h"
 #include "internal/sizes.h"
+#include "internal/thread.h"
 #include "crypto/rsa.h"
 #include "prov/providercommon.h"
 #include "prov/implementations.h"
@@ -40,6 +42,7 @@ static OSSL_FUNC_signature_sign_init_fn rsa_sign_init;
 static OSSL_FUNC_signature_verify_init_fn rsa_verify_init;
 static OSSL_FUNC_signature_verify_recover_init_fn rsa_verify_recover_init;
 static OSSL_FUNC_signature_sign_fn rsa_sign;
+static OSSL_FUNC_signature_sign_batch_fn rsa_sign_batch;
 static OSSL_FUNC_signature_sign_message_update_fn rsa_signverify_message_update;
 static OSSL_FUNC_signature_sign_message_final_fn rsa_sign_message_final;
 static OSSL_FUNC_signature_verify_fn rsa_verify;
@@ -911,6 +914,156 @@ static int rsa_sign(void *vprsactx, unsigned char *sig, size_t *siglen,
     return rsa_sign_directly(prsactx, sig, siglen, sigsize, tbs, tbslen);
 }
 
+static int rsa_sign_batch_serial(PROV_RSA_CTX *prsactx, size_t n,
+                                 unsigned char *const *sigs, size_t *siglens,
+                                 const unsigned char *const *tbs,
+                                 const size_t *tbslens)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        if (!rsa_sign_directly(prsactx, sigs[i], &siglens[i], siglens[i],
+                               tbs[i], tbslens[i]))
+            return 0;
+    return 1;
+}
+
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_POOL)
+/*
+ * The private key operations of a batch are independent of each other, so
+ * the batch is cut into contiguous slices that are signed concurrently by
+ * the calling thread and by workers of the library context thread pool.
+ * Each worker signs with its own duplicate of the signature context, as
+ * the padding buffer of a context can't be shared.
+ */
+# define RSA_SIGN_BATCH_MAX_WORKERS 64
+
+typedef struct {
+    PROV_RSA_CTX *prsactx;
+    size_t n;
+    unsigned char *const *sigs;
+    size_t *siglens;
+    const unsigned char *const *tbs;
+    const size_t *tbslens;
+    int ret;
+} RSA_SIGN_BATCH_WORKER;
+
+static CRYPTO_THREAD_RETVAL rsa_sign_batch_worker(void *arg)
+{
+    RSA_SIGN_BATCH_WORKER *worker = arg;
+
+    worker->ret = rsa_sign_batch_serial(worker->prsactx, worker->n,
+                                        worker->sigs, worker->siglens,
+                                        worker->tbs, worker->tbslens);
+    return 0;
+}
+
+/*
+ * Returns -2 if the thread pool is not available, in which case the batch
+ * should be signed serially.
+ */
+static int rsa_sign_batch_parallel(PROV_RSA_CTX *prsactx, size_t n,
+                                   unsigned char *const *sigs,
+                                   size_t *siglens,
+                                   const unsigned char *const *tbs,
+                                   const size_t *tbslens)
+{
+    RSA_SIGN_BATCH_WORKER *workers = NULL;
+    OSSL_THREAD_TASK **tasks = NULL;
+    uint64_t max = OSSL_get_max_threads(prsactx->libctx);
+    size_t nworkers, slice, first, i;
+    int ret = -2;
+
+    if (max == 0 || n < 2)
+        return -2;
+    /*
+     * One slice per pool worker.  Slices that no worker picks up are run by
+     * the calling thread when it waits for them, so there is no need to
+     * look at how many workers are idle right now.  The calling thread signs
+     * the first slice itself.
+     */
+    nworkers = n - 1;
+    if (nworkers > max)
+        nworkers = (size_t)max;
+    if (nworkers > RSA_SIGN_BATCH_MAX_WORKERS)
+        nworkers = RSA_SIGN_BATCH_MAX_WORKERS;
+    slice = n / (nworkers + 1);
+
+    workers = OPENSSL_zalloc(nworkers * sizeof(*workers));
+    tasks = OPENSSL_zalloc(nworkers * sizeof(*tasks));
+    if (workers == NULL || tasks == NULL)
+        goto end;
+
+    for (i = 0, first = n; i < nworkers; i++) {
+        /* Slices are taken from the end, the last ones get the remainder */
+        workers[i].n = slice + (i < n % (nworkers + 1));
+        workers[i].sigs = sigs + first - workers[i].n;
+        workers[i].siglens = siglens + first - workers[i].n;
+        workers[i].tbs = tbs + first - workers[i].n;
+        workers[i].tbslens = tbslens + first - workers[i].n;
+        if ((workers[i].prsactx = rsa_dupctx(prsactx)) == NULL)
+            break;
+        tasks[i] = ossl_crypto_pool_submit(prsactx->libctx,
+                                           rsa_sign_batch_worker,
+                                           &workers[i]);
+        if (tasks[i] == NULL)
+            break;
+        first -= workers[i].n;
+    }
+    /*
+     * Everything below |first| was not handed to a worker, which includes
+     * the slices of a worker that could not be set up.
+     */
+    ret = rsa_sign_batch_serial(prsactx, first, sigs, siglens, tbs, tbslens);
+
+    for (i = 0; i < nworkers && tasks[i] != NULL; i++) {
+        ossl_crypto_pool_wait(tasks[i], NULL);
+        if (ret == 1 && !workers[i].ret) {
+            ERR_raise(ERR_LIB_PROV, ERR_R_RSA_LIB);
+            ret = 0;
+        }
+    }
+ end:
+    for (i = 0; workers != NULL && i < nworkers; i++) {
+        if (tasks[i] != NULL)
+            ossl_crypto_pool_task_free(tasks[i]);
+        rsa_freectx(workers[i].prsactx);
+    }
+    OPENSSL_free(tasks);
+    OPENSSL_free(workers);
+    return ret;
+}
+#endif
+
+static int rsa_sign_batch(void *vprsactx, size_t n,
+                          unsigned char *const *sigs, size_t *siglens,
+                          const unsigned char *const *tbs,
+                          const size_t *tbslens)
+{
+    PROV_RSA_CTX *prsactx = (PROV_RSA_CTX *)vprsactx;
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_POOL)
+    int ret;
+#endif
+
+    if (!ossl_prov_is_running() || prsactx == NULL)
+        return 0;
+    if (!prsactx->flag_allow_oneshot) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_ONESHOT_CALL_OUT_OF_ORDER);
+        return 0;
+    }
+    if (prsactx->operation != EVP_PKEY_OP_SIGN) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return 0;
+    }
+
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_POOL)
+    ret = rsa_sign_batch_parallel(prsactx, n, sigs, siglens, tbs, tbslens);
+    if (ret != -2)
+        return ret;
+#endif
+    return rsa_sign_batch_serial(prsactx, n, sigs, siglens, tbs, tbslens);
+}
+
 static int rsa_verify_recover_init(void *vprsactx, void *vrsa,
                                    const OSSL_PARAM params[])
 {
@@ -1862,6 +2015,7 @@ const OSSL_DISPATCH ossl_rsa_signature_functions[] = {
     { OSSL_FUNC_SIGNATURE_NEWCTX, (void (*)(void))rsa_newctx },
     { OSSL_FUNC_SIGNATURE_SIGN_INIT, (void (*)(void))rsa_sign_init },
     { OSSL_FUNC_SIGNATURE_SIGN, (void (*)(void))rsa_sign },
+    { OSSL_FUNC_SIGNATURE_SIGN_BATCH, (void (*)(void))rsa_sign_batch },
     { OSSL_FUNC_SIGNATURE_VERIFY_INIT, (void (*)(void))rsa_verify_init },
     { OSSL_FUNC_SIGNATURE_VERIFY, (void (*)(void))rsa_verify },
     { OSSL_FUNC_SIGNATURE_VERIFY_RECOVER_INIT,
@@ -2090,6 +2244,8 @@ static int rsa_sigalg_set_ctx_params(void *vprsactx, const OSSL_PARAM params[])
         { OSSL_FUNC_SIGNATURE_SIGN_INIT,                                \
           (void (*)(void))rsa_##md##_sign_init },                       \
         { OSSL_FUNC_SIGNATURE_SIGN, (void (*)(void))rsa_sign },         \
+        { OSSL_FUNC_SIGNATURE_SIGN_BATCH,                               \
+          (void (*)(void))rsa_sign_batch },                             \
         { OSSL_FUNC_SIGNATURE_SIGN_MESSAGE_INIT,                        \
           (void (*)(void))rsa_##md##_sign_message_init },               \
         { OSSL_FUNC_SIGNATURE_SIGN_MESSAGE_UPDATE,                      \
@@ -2204,7 +2204,9 @@ static void quic_post_write(QUIC_XSO *xso, int did_append,
 
 struct quic_write_again_args {
     QUIC_XSO            *xso;
-    const unsigned char *buf;
+    const SSL_IOVEC     *iov;
+    size_t              iovcnt;
+    size_t              pos;
     size_t              len;
     size_t              total_written;
     int                 err;
@@ -2242,25 +2244,49 @@ static int sstream_ensure_spare(QUIC_SSTREAM *sstream, uint64_t spare)
 }
 
 /*
- * Append to a QUIC_STREAM's QUIC_SSTREAM, ensuring buffer space is expanded
- * as needed according to flow control.
+ * Append |len| bytes found |pos| bytes into the concatenation of the |iovcnt|
+ * buffers in |iov| to a QUIC_STREAM's QUIC_SSTREAM, ensuring buffer space is
+ * expanded as needed according to flow control.
  */
 QUIC_NEEDS_LOCK
-static int xso_sstream_append(QUIC_XSO *xso, const unsigned char *buf,
-                              size_t len, size_t *actual_written)
+static int xso_sstream_appendv(QUIC_XSO *xso, const SSL_IOVEC *iov,
+                               size_t iovcnt, size_t pos, size_t len,
+                               size_t *actual_written)
 {
     QUIC_SSTREAM *sstream = xso->stream->sstream;
     uint64_t cur = ossl_quic_sstream_get_cur_size(sstream);
     uint64_t cwm = ossl_quic_txfc_get_cwm(&xso->stream->txfc);
     uint64_t permitted = (cwm >= cur ? cwm - cur : 0);
+    size_t i, n, done;
 
+    *actual_written = 0;
     if (len > permitted)
         len = (size_t)permitted;
 
     if (!sstream_ensure_spare(sstream, len))
         return 0;
 
-    return ossl_quic_sstream_append(sstream, buf, len, actual_written);
+    for (i = 0; i < iovcnt && len > 0; i++) {
+        if (pos >= iov[i].len) {
+            pos -= iov[i].len;
+            continue;
+        }
+
+        n = iov[i].len - pos;
+        if (n > len)
+            n = len;
+        if (!ossl_quic_sstream_append(sstream,
+                                      (const unsigned char *)iov[i].base + pos,
+                                      n, &done))
+            return 0;
+
+        *actual_written += done;
+        if (done < n)
+            break;
+        len -= n;
+        pos = 0;
+    }
+    return 1;
 }
 
 QUIC_NEEDS_LOCK
@@ -2281,13 +2307,14 @@ static int quic_write_again(void *arg)
         return -2;
 
     args->err = ERR_R_INTERNAL_ERROR;
-    if (!xso_sstream_append(args->xso, args->buf, args->len, &actual_written))
+    if (!xso_sstream_appendv(args->xso, args->iov, args->iovcnt, args->pos,
+                             args->len, &actual_written))
         return -2;
 
     quic_post_write(args->xso, actual_written > 0,
                     args->len == actual_written, args->flags, 0);
 
-    args->buf           += actual_written;
+    args->pos           += actual_written;
     args->len           -= actual_written;
     args->total_written += actual_written;
 
@@ -2300,8 +2327,8 @@ static int quic_write_again(void *arg)
 }
 
 QUIC_NEEDS_LOCK
-static int quic_write_blocking(QCTX *ctx, const void *buf, size_t len,
-                               uint64_t flags, size_t *written)
+static int quic_write_blocking(QCTX *ctx, const SSL_IOVEC *iov, size_t iovcnt,
+                               size_t len, uint64_t flags, size_t *written)
 {
     int res;
     QUIC_XSO *xso = ctx->xso;
@@ -2309,7 +2336,7 @@ static int quic_write_blocking(QCTX *ctx, const void *buf, size_t len,
     size_t actual_written = 0;
 
     /* First make a best effort to append as much of the data as possible. */
-    if (!xso_sstream_append(xso, buf, len, &actual_written)) {
+    if (!xso_sstream_appendv(xso, iov, iovcnt, 0, len, &actual_written)) {
         /* Stream already finished or allocation error. */
         *written = 0;
         return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2329,7 +2356,9 @@ static int quic_write_blocking(QCTX *ctx, const void *buf, size_t len,
      * it is freed up.
      */
     args.xso            = xso;
-    args.buf            = (const unsigned char *)buf + actual_written;
+    args.iov            = iov;
+    args.iovcnt         = iovcnt;
+    args.pos            = actual_written;
     args.len            = len - actual_written;
     args.total_written  = 0;
     args.err            = ERR_R_INTERNAL_ERROR;
@@ -2372,12 +2401,12 @@ static void aon_write_finish(QUIC_XSO *xso)
 
 QUIC_NEEDS_LOCK
 static int quic_write_nonblocking_aon(QCTX *ctx, const void *buf,
+                                      const SSL_IOVEC *iov, size_t iovcnt,
                                       size_t len, uint64_t flags,
                                       size_t *written)
 {
     QUIC_XSO *xso = ctx->xso;
-    const void *actual_buf;
-    size_t actual_len, actual_written = 0;
+    size_t actual_pos, actual_len, actual_written = 0;
     int accept_moving_buffer
         = ((xso->ssl_mode & SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER) != 0);
 
@@ -2395,16 +2424,17 @@ static int quic_write_nonblocking_aon(QCTX *ctx, const void *buf,
              */
             return QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_BAD_WRITE_RETRY, NULL);
 
-        actual_buf = (unsigned char *)buf + xso->aon_buf_pos;
+        actual_pos = xso->aon_buf_pos;
         actual_len = len - xso->aon_buf_pos;
         assert(actual_len > 0);
     } else {
-        actual_buf = buf;
+        actual_pos = 0;
         actual_len = len;
     }
 
     /* First make a best effort to append as much of the data as possible. */
-    if (!xso_sstream_append(xso, actual_buf, actual_len, &actual_written)) {
+    if (!xso_sstream_appendv(xso, iov, iovcnt, actual_pos, actual_len,
+                             &actual_written)) {
         /* Stream already finished or allocation error. */
         *written = 0;
         return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2460,13 +2490,14 @@ static int quic_write_nonblocking_aon(QCTX *ctx, const void *buf,
 }
 
 QUIC_NEEDS_LOCK
-static int quic_write_nonblocking_epw(QCTX *ctx, const void *buf, size_t len,
+static int quic_write_nonblocking_epw(QCTX *ctx, const SSL_IOVEC *iov,
+                                      size_t iovcnt, size_t len,
                                       uint64_t flags, size_t *written)
 {
     QUIC_XSO *xso = ctx->xso;
 
     /* Simple best effort operation. */
-    if (!xso_sstream_append(xso, buf, len, written)) {
+    if (!xso_sstream_appendv(xso, iov, iovcnt, 0, len, written)) {
         /* Stream already finished or allocation error. */
         *written = 0;
         return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2524,9 +2555,14 @@ static int quic_validate_for_write(QUIC_XSO *xso, int *err)
     }
 }
 
+/*
+ * Writes the |len| bytes in the |iovcnt| buffers of |iov|. |buf| identifies
+ * the caller's buffer for the AON retry checks.
+ */
 QUIC_TAKES_LOCK
-int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
-                          uint64_t flags, size_t *written)
+static int quic_write_int(SSL *s, const void *buf, const SSL_IOVEC *iov,
+                          size_t iovcnt, size_t len, uint64_t flags,
+                          size_t *written)
 {
     int ret;
     QCTX ctx;
@@ -2583,17 +2619,42 @@ int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
     }
 
     if (xso_blocking_mode(ctx.xso))
-        ret = quic_write_blocking(&ctx, buf, len, flags, written);
+        ret = quic_write_blocking(&ctx, iov, iovcnt, len, flags, written);
     else if (partial_write)
-        ret = quic_write_nonblocking_epw(&ctx, buf, len, flags, written);
+        ret = quic_write_nonblocking_epw(&ctx, iov, iovcnt, len, flags,
+                                         written);
     else
-        ret = quic_write_nonblocking_aon(&ctx, buf, len, flags, written);
+        ret = quic_write_nonblocking_aon(&ctx, buf, iov, iovcnt, len, flags,
+                                         written);
 
 out:
     quic_unlock(ctx.qc);
     return ret;
 }
 
+QUIC_TAKES_LOCK
+int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
+                          uint64_t flags, size_t *written)
+{
+    SSL_IOVEC iov;
+
+    iov.base = buf;
+    iov.len = len;
+    return quic_write_int(s, buf, &iov, 1, len, flags, written);
+}
+
+QUIC_TAKES_LOCK
+int ossl_quic_writev_flags(SSL *s, const SSL_IOVEC *iov, size_t iovcnt,
+                           uint64_t flags, size_t *written)
+{
+    size_t i, len = 0;
+
+    for (i = 0; i < iovcnt; i++)
+        len += iov[i].len;
+
+    return quic_write_int(s, iov, iov, iovcnt, len, flags, written);
+}
+
 QUIC_TAKES_LOCK
 int ossl_quic_write(SSL *s, const void *buf, size_t len, size_t *written)
 {
@@ -89,8 +89,8 @@ struct quic_xso_st {
 
     /*
      * The base buffer pointer the caller passed us for the initial AON write
-     * call. We use this for validation purposes unless
-     * ACCEPT_MOVING_WRITE_BUFFER is enabled.
+     * call, or the iovec array pointer for SSL_writev_ex(). We use this for
+     * validation purposes unless ACCEPT_MOVING_WRITE_BUFFER is enabled.
      *
      * NOTE: We never dereference this, as the caller might pass a different
      * (but identical) buffer if using ACCEPT_MOVING_WRITE_BUFFER. It is for
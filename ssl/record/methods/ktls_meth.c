@@ -1,5 +1,5 @@
 /*
- * Copyright 2018-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2018-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -286,17 +286,16 @@ int ktls_configure_crypto(OSSL_LIB_CTX *libctx, int version, const EVP_CIPHER *c
 
 #endif /* OPENSSL_SYS_LINUX */
 
-static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
+static int ktls_try_crypto_state(OSSL_RECORD_LAYER *rl,
                                  unsigned char *key, size_t keylen,
                                  unsigned char *iv, size_t ivlen,
                                  unsigned char *mackey, size_t mackeylen,
-                                 const EVP_CIPHER *ciph,
-                                 size_t taglen,
-                                 int mactype,
-                                 const EVP_MD *md,
-                                 COMP_METHOD *comp)
+                                 const EVP_CIPHER *ciph, size_t taglen,
+                                 const EVP_MD *md, COMP_METHOD *comp,
+                                 int rekey)
 {
     ktls_crypto_info_t crypto_info;
+    int ret;
 
     /*
      * Check if we are suitable for KTLS. If not suitable we return
@@ -331,10 +330,17 @@ static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
                                iv, ivlen, key, keylen, mackey, mackeylen))
        return OSSL_RECORD_RETURN_NON_FATAL_ERR;
 
-    if (!BIO_set_ktls(rl->bio, &crypto_info, rl->direction))
+    /*
+     * On a rekey this replaces the keys of the running kernel TLS state, see
+     * OPENSSL_KTLS_TLS13_REKEY. Older kernels refuse the second setsockopt().
+     */
+    ret = BIO_set_ktls(rl->bio, &crypto_info, rl->direction);
+    OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+    if (!ret)
         return OSSL_RECORD_RETURN_NON_FATAL_ERR;
 
-    if (rl->direction == OSSL_RECORD_DIRECTION_WRITE &&
+    /* Zerocopy mode is kept across a rekey */
+    if (!rekey && rl->direction == OSSL_RECORD_DIRECTION_WRITE &&
         (rl->options & SSL_OP_ENABLE_KTLS_TX_ZEROCOPY_SENDFILE) != 0)
         /* Ignore errors. The application opts in to using the zerocopy
          * optimization. If the running kernel doesn't support it, just
@@ -345,6 +351,39 @@ static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
     return OSSL_RECORD_RETURN_SUCCESS;
 }
 
+static int ktls_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
+                                 unsigned char *key, size_t keylen,
+                                 unsigned char *iv, size_t ivlen,
+                                 unsigned char *mackey, size_t mackeylen,
+                                 const EVP_CIPHER *ciph,
+                                 size_t taglen,
+                                 int mactype,
+                                 const EVP_MD *md,
+                                 COMP_METHOD *comp)
+{
+    int rekey = 0, ret;
+
+    /*
+     * A TLS 1.3 KeyUpdate gives us new keys for a direction that the kernel
+     * already handles. The old keys are no longer available to any other
+     * record layer, so the new keys have to be handed to the kernel and a
+     * failure to do so is fatal.
+     */
+    if (rl->version == TLS1_3_VERSION)
+        rekey = rl->direction == OSSL_RECORD_DIRECTION_WRITE
+                ? BIO_get_ktls_send(rl->bio) : BIO_get_ktls_recv(rl->bio);
+
+    ret = ktls_try_crypto_state(rl, key, keylen, iv, ivlen, mackey, mackeylen,
+                                ciph, taglen, md, comp, rekey);
+    if (ret != OSSL_RECORD_RETURN_SUCCESS && rekey) {
+        ERR_raise_data(ERR_LIB_SSL, SSL_R_RECORD_LAYER_FAILURE,
+                       "kernel TLS key update failed");
+        return OSSL_RECORD_RETURN_FATAL;
+    }
+
+    return ret;
+}
+
 static int ktls_read_n(OSSL_RECORD_LAYER *rl, size_t n, size_t max, int extend,
                        int clearold, size_t *readbytes)
 {
@@ -366,6 +405,15 @@ static int ktls_read_n(OSSL_RECORD_LAYER *rl, size_t n, size_t max, int extend,
             RLAYERfatal(rl, SSL_AD_PROTOCOL_VERSION,
                         SSL_R_WRONG_VERSION_NUMBER);
             break;
+#ifdef EKEYEXPIRED
+        case EKEYEXPIRED:
+            /*
+             * The kernel holds back records after a KeyUpdate until the new
+             * keys are installed, which we always do before reading on.
+             */
+            RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+            break;
+#endif
         default:
             break;
         }
@@ -469,6 +517,12 @@ static int ktls_initialise_write_packets(OSSL_RECORD_LAYER *rl,
 {
     TLS_BUFFER *wb;
 
+    /* The kernel needs the data of a vectored write in one buffer */
+    if (!tls_flatten_templates(rl, templates, numtempl)) {
+        /* RLAYERfatal() already called */
+        return 0;
+    }
+
     /*
      * We just use the application buffer directly and don't use any WPACKET
      * structures
@@ -324,6 +324,26 @@ struct ossl_record_layer_st {
     size_t block_padding;
     size_t hs_padding;
 
+    /*
+     * Application data records that are held back to be written together
+     * with a single BIO_write() once |coalesce_threshold| bytes are buffered
+     */
+    TLS_BUFFER coalesce;
+    size_t coalesce_threshold;
+
+    /*
+     * Contiguous copy of vectored application data for the cases that cannot
+     * gather it straight into the record (compression and kernel TLS)
+     */
+    TLS_BUFFER gather;
+
+    /*
+     * Pool of the SSL_CTX that |rbuf| and |wbuf| are taken from. Buffers are
+     * handed back to it as soon as they are empty, as if
+     * SSL_MODE_RELEASE_BUFFERS was set. Never used for DTLS.
+     */
+    OSSL_REC_BUF_POOL *bufpool;
+
     /* Only used by SSLv3 */
     unsigned char mac_secret[EVP_MAX_MD_SIZE];
 
@@ -401,6 +421,9 @@ void ossl_rlayer_fatal(OSSL_RECORD_LAYER *rl, int al, int reason,
                                     || (rl)->version == DTLS1_VERSION \
                                     || (rl)->version == DTLS1_2_VERSION)
 
+#define RLAYER_RELEASE_BUFFERS(rl) (((rl)->mode & SSL_MODE_RELEASE_BUFFERS) != 0 \
+                                    || (rl)->bufpool != NULL)
+
 void ossl_tls_rl_record_set_seq_num(TLS_RL_RECORD *r,
                                     const unsigned char *seq_num);
 
@@ -521,6 +544,10 @@ int tls_post_encryption_processing_default(OSSL_RECORD_LAYER *rl,
 int tls_write_records_default(OSSL_RECORD_LAYER *rl,
                               OSSL_RECORD_TEMPLATE *templates,
                               size_t numtempl);
+void tls_gather_template(unsigned char *out,
+                         const OSSL_RECORD_TEMPLATE *templ);
+int tls_flatten_templates(OSSL_RECORD_LAYER *rl,
+                          OSSL_RECORD_TEMPLATE *templates, size_t numtempl);
 
 /* Macros/functions provided by the TLS_BUFFER component */
 
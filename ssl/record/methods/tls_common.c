@@ -133,7 +133,7 @@ static void tls_release_write_buffer_int(OSSL_RECORD_LAYER *rl, size_t start)
         if (TLS_BUFFER_is_app_buffer(wb))
             TLS_BUFFER_set_app_buffer(wb, 0);
         else
-            OPENSSL_free(wb->buf);
+            ossl_rec_buf_pool_put(rl->bufpool, wb->buf, wb->len);
         wb->buf = NULL;
         pipes--;
     }
@@ -187,13 +187,13 @@ int tls_setup_write_buffer(OSSL_RECORD_LAYER *rl, size_t numwpipes,
             len = defltlen;
 
         if (thiswb->len != len) {
-            OPENSSL_free(thiswb->buf);
+            ossl_rec_buf_pool_put(rl->bufpool, thiswb->buf, thiswb->len);
             thiswb->buf = NULL;         /* force reallocation */
         }
 
         p = thiswb->buf;
         if (p == NULL) {
-            p = OPENSSL_malloc(len);
+            p = ossl_rec_buf_pool_get(rl->bufpool, len);
             if (p == NULL) {
                 if (rl->numwpipes < currpipe)
                     rl->numwpipes = currpipe;
@@ -258,7 +258,7 @@ int tls_setup_read_buffer(OSSL_RECORD_LAYER *rl)
         if (b->default_len > len)
             len = b->default_len;
 
-        if ((p = OPENSSL_malloc(len)) == NULL) {
+        if ((p = ossl_rec_buf_pool_get(rl->bufpool, len)) == NULL) {
             /*
              * We've got a malloc failure, and we're still initialising buffers.
              * We assume we're so doomed that we won't even be able to send an
@@ -281,7 +281,7 @@ static int tls_release_read_buffer(OSSL_RECORD_LAYER *rl)
     b = &rl->rbuf;
     if ((rl->options & SSL_OP_CLEANSE_PLAINTEXT) != 0)
         OPENSSL_cleanse(b->buf, b->len);
-    OPENSSL_free(b->buf);
+    ossl_rec_buf_pool_put(rl->bufpool, b->buf, b->len);
     b->buf = NULL;
     rl->packet = NULL;
     rl->packet_length = 0;
@@ -430,7 +430,7 @@ int tls_default_read_n(OSSL_RECORD_LAYER *rl, size_t n, size_t max, int extend,
 
         if (ret <= OSSL_RECORD_RETURN_RETRY) {
             rb->left = left;
-            if ((rl->mode & SSL_MODE_RELEASE_BUFFERS) != 0 && !rl->isdtls)
+            if (RLAYER_RELEASE_BUFFERS(rl) && !rl->isdtls)
                 if (len + left == 0)
                     tls_release_read_buffer(rl);
             return ret;
@@ -1184,7 +1184,7 @@ int tls_release_record(OSSL_RECORD_LAYER *rl, void *rechandle, size_t length)
     rl->num_released++;
 
     if (rl->curr_rec == rl->num_released
-            && (rl->mode & SSL_MODE_RELEASE_BUFFERS) != 0
+            && RLAYER_RELEASE_BUFFERS(rl)
             && TLS_BUFFER_get_left(&rl->rbuf) == 0)
         tls_release_read_buffer(rl);
 
@@ -1227,6 +1227,30 @@ int tls_set_options(OSSL_RECORD_LAYER *rl, const OSSL_PARAM *options)
             ERR_raise(ERR_LIB_SSL, SSL_R_FAILED_TO_GET_PARAMETER);
             return 0;
         }
+        p = OSSL_PARAM_locate_const(options,
+                                    OSSL_LIBSSL_RECORD_LAYER_PARAM_COALESCE);
+        if (p != NULL
+                && !OSSL_PARAM_get_size_t(p, &rl->coalesce_threshold)) {
+            ERR_raise(ERR_LIB_SSL, SSL_R_FAILED_TO_GET_PARAMETER);
+            return 0;
+        }
+    }
+
+    /* The buffer pool can only be set before any buffer was allocated */
+    p = OSSL_PARAM_locate_const(options,
+                                OSSL_LIBSSL_RECORD_LAYER_PARAM_BUFFER_POOL);
+    if (p != NULL && rl->bufpool == NULL
+            && rl->rbuf.buf == NULL && rl->numwpipes == 0) {
+        const void *pool;
+        size_t len;
+
+        if (!OSSL_PARAM_get_octet_ptr(p, &pool, &len)
+                || len != sizeof(OSSL_REC_BUF_POOL *)
+                || !ossl_rec_buf_pool_up_ref((OSSL_REC_BUF_POOL *)pool)) {
+            ERR_raise(ERR_LIB_SSL, SSL_R_FAILED_TO_GET_PARAMETER);
+            return 0;
+        }
+        rl->bufpool = (OSSL_REC_BUF_POOL *)pool;
     }
 
     if (rl->level == OSSL_RECORD_PROTECTION_LEVEL_APPLICATION) {
@@ -1446,9 +1470,13 @@ static void tls_int_free(OSSL_RECORD_LAYER *rl)
     BIO_free(rl->prev);
     BIO_free(rl->bio);
     BIO_free(rl->next);
-    ossl_tls_buffer_release(&rl->rbuf);
+    ossl_rec_buf_pool_put(rl->bufpool, rl->rbuf.buf, rl->rbuf.len);
+    rl->rbuf.buf = NULL;
 
     tls_release_write_buffer(rl);
+    ossl_tls_buffer_release(&rl->coalesce);
+    ossl_tls_buffer_release(&rl->gather);
+    ossl_rec_buf_pool_free(rl->bufpool);
 
     EVP_CIPHER_CTX_free(rl->enc_ctx);
     EVP_MAC_CTX_free(rl->mac_ctx);
@@ -1744,6 +1772,63 @@ int tls_post_encryption_processing_default(OSSL_RECORD_LAYER *rl,
     return 1;
 }
 
+/*
+ * Copy the |templ->buflen| bytes of a template that refers to an iovec into
+ * |out|
+ */
+void tls_gather_template(unsigned char *out, const OSSL_RECORD_TEMPLATE *templ)
+{
+    const SSL_IOVEC *iov = templ->iov;
+    size_t i, n, off = templ->iovoff, left = templ->buflen;
+
+    for (i = 0; left > 0 && i < templ->iovcnt; i++, off = 0) {
+        n = iov[i].len - off;
+        if (n > left)
+            n = left;
+        memcpy(out, (const unsigned char *)iov[i].base + off, n);
+        out += n;
+        left -= n;
+    }
+}
+
+/*
+ * Replace the iovecs in |templates| with a contiguous copy of their data in
+ * rl->gather. The copy stays valid until the next call.
+ */
+int tls_flatten_templates(OSSL_RECORD_LAYER *rl,
+                          OSSL_RECORD_TEMPLATE *templates, size_t numtempl)
+{
+    TLS_BUFFER *gb = &rl->gather;
+    unsigned char *p;
+    size_t i, total = 0;
+
+    for (i = 0; i < numtempl; i++)
+        if (templates[i].buf == NULL && templates[i].iov != NULL)
+            total += templates[i].buflen;
+    if (total == 0)
+        return 1;
+
+    if (total > gb->len) {
+        ossl_tls_buffer_release(gb);
+        gb->len = 0;
+        if ((gb->buf = OPENSSL_malloc(total)) == NULL) {
+            RLAYERfatal(rl, SSL_AD_NO_ALERT, ERR_R_CRYPTO_LIB);
+            return 0;
+        }
+        gb->len = total;
+    }
+
+    for (i = 0, p = gb->buf; i < numtempl; i++) {
+        if (templates[i].buf != NULL || templates[i].iov == NULL)
+            continue;
+        tls_gather_template(p, &templates[i]);
+        templates[i].buf = p;
+        templates[i].iov = NULL;
+        p += templates[i].buflen;
+    }
+    return 1;
+}
+
 int tls_write_records_default(OSSL_RECORD_LAYER *rl,
                               OSSL_RECORD_TEMPLATE *templates,
                               size_t numtempl)
@@ -1766,6 +1851,13 @@ int tls_write_records_default(OSSL_RECORD_LAYER *rl,
         }
     }
 
+    /* Compression needs all of the input of a record in one place */
+    if (rl->compctx != NULL
+            && !tls_flatten_templates(rl, templates, numtempl)) {
+        /* RLAYERfatal() already called */
+        goto err;
+    }
+
     if (!rl->funcs->allocate_write_buffers(rl, templates, numtempl, &prefix)) {
         /* RLAYERfatal() already called */
         goto err;
@@ -1825,7 +1917,18 @@ int tls_write_records_default(OSSL_RECORD_LAYER *rl,
                 goto err;
             }
         } else if (compressdata != NULL) {
-            if (!WPACKET_memcpy(thispkt, thiswr->input, thiswr->length)) {
+            unsigned char *gathered;
+
+            if (thistempl->buf == NULL && thistempl->iov != NULL) {
+                /* Gather the data straight from the application's buffers */
+                if (!WPACKET_allocate_bytes(thispkt, thiswr->length,
+                                            &gathered)) {
+                    RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+                    goto err;
+                }
+                tls_gather_template(gathered, thistempl);
+            } else if (!WPACKET_memcpy(thispkt, thiswr->input,
+                                       thiswr->length)) {
                 RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
                 goto err;
             }
@@ -1883,6 +1986,103 @@ int tls_write_records_default(OSSL_RECORD_LAYER *rl,
     return ret;
 }
 
+/*
+ * Write out all the records held back for coalescing with as few BIO_write()
+ * calls as the BIO allows.
+ */
+static int tls_write_coalesced(OSSL_RECORD_LAYER *rl)
+{
+    TLS_BUFFER *cb = &rl->coalesce;
+    int i, ret;
+
+    while (TLS_BUFFER_get_left(cb) > 0) {
+        clear_sys_error();
+        if (rl->funcs->prepare_write_bio != NULL) {
+            ret = rl->funcs->prepare_write_bio(rl, SSL3_RT_APPLICATION_DATA);
+            if (ret != OSSL_RECORD_RETURN_SUCCESS)
+                return ret;
+        }
+        i = BIO_write(rl->bio, (char *)
+                      &(TLS_BUFFER_get_buf(cb)[TLS_BUFFER_get_offset(cb)]),
+                      (unsigned int)TLS_BUFFER_get_left(cb));
+        if (i <= 0) {
+            if (BIO_should_retry(rl->bio))
+                return OSSL_RECORD_RETURN_RETRY;
+            ERR_raise_data(ERR_LIB_SYS, get_last_sys_error(),
+                           "tls_write_coalesced failure");
+            return OSSL_RECORD_RETURN_FATAL;
+        }
+        TLS_BUFFER_add_offset(cb, i);
+        TLS_BUFFER_sub_left(cb, i);
+    }
+    TLS_BUFFER_set_offset(cb, 0);
+
+    if ((rl->mode & SSL_MODE_RELEASE_BUFFERS) != 0)
+        ossl_tls_buffer_release(cb);
+
+    return OSSL_RECORD_RETURN_SUCCESS;
+}
+
+/*
+ * Move the records that have just been encrypted into the write buffers to
+ * the coalescing buffer. They are written once |coalesce_threshold| bytes
+ * have been collected, before any record of another type, or when the caller
+ * asks for it with retry_write_records().
+ */
+static int tls_coalesce_records(OSSL_RECORD_LAYER *rl)
+{
+    TLS_BUFFER *cb = &rl->coalesce, *wb;
+    size_t len = 0, j;
+    int ret;
+
+    for (j = 0; j < rl->numwpipes; j++)
+        len += TLS_BUFFER_get_left(&rl->wbuf[j]);
+
+    /* Make room, or write the records directly if they would never fit */
+    if (TLS_BUFFER_get_left(cb) + len > rl->coalesce_threshold
+            || TLS_BUFFER_get_offset(cb) + TLS_BUFFER_get_left(cb) + len
+               > TLS_BUFFER_get_len(cb)) {
+        ret = tls_write_coalesced(rl);
+        if (ret != OSSL_RECORD_RETURN_SUCCESS)
+            return ret;
+    }
+    if (len >= rl->coalesce_threshold)
+        return tls_retry_write_records(rl);
+
+    if ((TLS_BUFFER_get_buf(cb) == NULL
+         || TLS_BUFFER_get_len(cb) != rl->coalesce_threshold)
+            && TLS_BUFFER_get_left(cb) == 0) {
+        ossl_tls_buffer_release(cb);
+        cb->buf = OPENSSL_malloc(rl->coalesce_threshold);
+        if (cb->buf == NULL) {
+            /* Not fatal, just write the records as they are */
+            cb->len = 0;
+            return tls_retry_write_records(rl);
+        }
+        cb->len = rl->coalesce_threshold;
+    }
+
+    for (j = 0; j < rl->numwpipes; j++) {
+        wb = &rl->wbuf[j];
+        memcpy(TLS_BUFFER_get_buf(cb) + TLS_BUFFER_get_offset(cb)
+               + TLS_BUFFER_get_left(cb),
+               TLS_BUFFER_get_buf(wb) + TLS_BUFFER_get_offset(wb),
+               TLS_BUFFER_get_left(wb));
+        TLS_BUFFER_set_left(cb, TLS_BUFFER_get_left(cb)
+                                + TLS_BUFFER_get_left(wb));
+        TLS_BUFFER_add_offset(wb, TLS_BUFFER_get_left(wb));
+        TLS_BUFFER_set_left(wb, 0);
+    }
+    rl->nextwbuf = rl->numwpipes;
+    if (RLAYER_RELEASE_BUFFERS(rl))
+        tls_release_write_buffer(rl);
+
+    if (TLS_BUFFER_get_left(cb) < rl->coalesce_threshold)
+        return OSSL_RECORD_RETURN_SUCCESS;
+
+    return tls_write_coalesced(rl);
+}
+
 int tls_write_records(OSSL_RECORD_LAYER *rl, OSSL_RECORD_TEMPLATE *templates,
                       size_t numtempl)
 {
@@ -1899,6 +2099,11 @@ int tls_write_records(OSSL_RECORD_LAYER *rl, OSSL_RECORD_TEMPLATE *templates,
     }
 
     rl->nextwbuf = 0;
+
+    if (rl->coalesce_threshold > 0 && !rl->isdtls
+            && templates[0].type == SSL3_RT_APPLICATION_DATA)
+        return tls_coalesce_records(rl);
+
     /* we now just need to write the buffers */
     return tls_retry_write_records(rl);
 }
@@ -1909,6 +2114,13 @@ int tls_retry_write_records(OSSL_RECORD_LAYER *rl)
     TLS_BUFFER *thiswb;
     size_t tmpwrit = 0;
 
+    /* Records held back for coalescing go first */
+    if (TLS_BUFFER_get_left(&rl->coalesce) > 0) {
+        ret = tls_write_coalesced(rl);
+        if (ret != OSSL_RECORD_RETURN_SUCCESS)
+            return ret;
+    }
+
     if (rl->nextwbuf >= rl->numwpipes)
         return OSSL_RECORD_RETURN_SUCCESS;
 
@@ -1961,7 +2173,7 @@ int tls_retry_write_records(OSSL_RECORD_LAYER *rl)
                 continue;
 
             if (rl->nextwbuf == rl->numwpipes
-                    && (rl->mode & SSL_MODE_RELEASE_BUFFERS) != 0)
+                    && RLAYER_RELEASE_BUFFERS(rl))
                 tls_release_write_buffer(rl);
             return OSSL_RECORD_RETURN_SUCCESS;
         } else if (i <= 0) {
@@ -1972,7 +2184,7 @@ int tls_retry_write_records(OSSL_RECORD_LAYER *rl)
                  */
                 TLS_BUFFER_set_left(thiswb, 0);
                 if (++(rl->nextwbuf) == rl->numwpipes
-                        && (rl->mode & SSL_MODE_RELEASE_BUFFERS) != 0)
+                        && RLAYER_RELEASE_BUFFERS(rl))
                     tls_release_write_buffer(rl);
 
             }
@@ -2139,7 +2351,12 @@ int tls_free_buffers(OSSL_RECORD_LAYER *rl)
                     || TLS_BUFFER_get_left(&rl->wbuf[0]) != 0)
                 return 0;
         }
+        if (TLS_BUFFER_get_left(&rl->coalesce) != 0)
+            return 0;
         tls_release_write_buffer(rl);
+        ossl_tls_buffer_release(&rl->coalesce);
+        ossl_tls_buffer_release(&rl->gather);
+        rl->gather.len = 0;
         return 1;
     }
 
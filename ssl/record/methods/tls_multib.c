@@ -78,6 +78,10 @@ static int tls_write_records_multiblock_int(OSSL_RECORD_LAYER *rl,
     if (numtempl != 4 && numtempl != 8)
         return 0;
 
+    /* Data to be gathered from an iovec goes through the standard path */
+    if (templates[0].buf == NULL)
+        return 0;
+
     /*
      * Check templates have contiguous buffers and are all the same type and
      * length
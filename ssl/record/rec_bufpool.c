@@ -0,0 +1,281 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include "internal/refcount.h"
+#include "../ssl_local.h"
+
+/*
+ * A pool of record layer read and write buffers shared by all connections
+ * created from an SSL_CTX. Buffers are sorted into size classes that are
+ * multiples of REC_BUF_POOL_GRANULE bytes. Each class keeps the idle buffers
+ * in a singly linked list with the link stored in the first bytes of the idle
+ * buffer itself, so a pool needs no memory other than the buffers it holds.
+ * Requests larger than the largest class bypass the pool.
+ *
+ * Every class has its own lock, so only requests for buffers of similar size
+ * contend. With the default buffer sizes read and write buffers fall into the
+ * same class and share its lock, but a buffer freed by one side can then be
+ * reused by the other. The number of idle bytes in the whole pool is
+ * maintained with atomics and is kept below the high watermark: a buffer that
+ * is returned while the pool is full is freed and the pool is then trimmed
+ * down to the low watermark, so a burst of connections going idle does not
+ * result in one free() per buffer.
+ */
+
+#define REC_BUF_POOL_GRANULE    4096
+#define REC_BUF_POOL_CLASSES    16
+#define REC_BUF_POOL_MAX        (REC_BUF_POOL_GRANULE * REC_BUF_POOL_CLASSES)
+
+typedef struct {
+    CRYPTO_RWLOCK *lock;
+    unsigned char *head;
+    size_t count;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t returns;
+    uint64_t frees;
+} REC_BUF_CLASS;
+
+struct ossl_rec_buf_pool_st {
+    CRYPTO_REF_COUNT references;
+    /* Only used by the atomics if the platform has no native support */
+    CRYPTO_RWLOCK *lock;
+    uint64_t low;
+    uint64_t high;
+    uint64_t idle;
+    REC_BUF_CLASS classes[REC_BUF_POOL_CLASSES];
+};
+
+static ossl_inline size_t rec_buf_class(size_t len)
+{
+    return (len - 1) / REC_BUF_POOL_GRANULE;
+}
+
+static ossl_inline size_t rec_buf_class_size(size_t idx)
+{
+    return (idx + 1) * REC_BUF_POOL_GRANULE;
+}
+
+OSSL_REC_BUF_POOL *ossl_rec_buf_pool_new(size_t low, size_t high)
+{
+    OSSL_REC_BUF_POOL *pool;
+    size_t i;
+
+    if (low > high)
+        return NULL;
+
+    if ((pool = OPENSSL_zalloc(sizeof(*pool))) == NULL)
+        return NULL;
+
+    if (!CRYPTO_NEW_REF(&pool->references, 1)) {
+        OPENSSL_free(pool);
+        return NULL;
+    }
+    if ((pool->lock = CRYPTO_THREAD_lock_new()) == NULL)
+        goto err;
+    for (i = 0; i < REC_BUF_POOL_CLASSES; i++)
+        if ((pool->classes[i].lock = CRYPTO_THREAD_lock_new()) == NULL)
+            goto err;
+
+    pool->low = low;
+    pool->high = high;
+    return pool;
+
+ err:
+    ossl_rec_buf_pool_free(pool);
+    return NULL;
+}
+
+int ossl_rec_buf_pool_up_ref(OSSL_REC_BUF_POOL *pool)
+{
+    int i;
+
+    if (CRYPTO_UP_REF(&pool->references, &i) <= 0)
+        return 0;
+
+    REF_PRINT_COUNT("OSSL_REC_BUF_POOL", pool);
+    REF_ASSERT_ISNT(i < 2);
+    return i > 1 ? 1 : 0;
+}
+
+void ossl_rec_buf_pool_free(OSSL_REC_BUF_POOL *pool)
+{
+    REC_BUF_CLASS *c;
+    unsigned char *buf;
+    size_t i;
+    int ref;
+
+    if (pool == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&pool->references, &ref);
+    REF_PRINT_COUNT("OSSL_REC_BUF_POOL", pool);
+    if (ref > 0)
+        return;
+    REF_ASSERT_ISNT(ref < 0);
+
+    for (i = 0; i < REC_BUF_POOL_CLASSES; i++) {
+        c = &pool->classes[i];
+        while ((buf = c->head) != NULL) {
+            memcpy(&c->head, buf, sizeof(c->head));
+            OPENSSL_free(buf);
+        }
+        CRYPTO_THREAD_lock_free(c->lock);
+    }
+    CRYPTO_THREAD_lock_free(pool->lock);
+    CRYPTO_FREE_REF(&pool->references);
+    OPENSSL_free(pool);
+}
+
+/* Frees idle buffers, largest first, until no more than |target| bytes are idle */
+static void rec_buf_pool_trim(OSSL_REC_BUF_POOL *pool, uint64_t target)
+{
+    REC_BUF_CLASS *c;
+    unsigned char *buf;
+    uint64_t idle, size;
+    size_t i = REC_BUF_POOL_CLASSES;
+
+    while (i-- > 0) {
+        c = &pool->classes[i];
+        size = rec_buf_class_size(i);
+        if (!CRYPTO_THREAD_write_lock(c->lock))
+            return;
+        while ((buf = c->head) != NULL) {
+            if (!CRYPTO_atomic_load(&pool->idle, &idle, pool->lock)
+                    || idle <= target)
+                break;
+            memcpy(&c->head, buf, sizeof(c->head));
+            c->count--;
+            c->frees++;
+            CRYPTO_atomic_add64(&pool->idle, (uint64_t)0 - size, &idle,
+                                pool->lock);
+            OPENSSL_free(buf);
+        }
+        CRYPTO_THREAD_unlock(c->lock);
+        if (buf != NULL)
+            return;
+    }
+}
+
+int ossl_rec_buf_pool_set_watermarks(OSSL_REC_BUF_POOL *pool, size_t low,
+                                     size_t high)
+{
+    uint64_t l = low, h = high;
+
+    if (low > high
+            || !CRYPTO_atomic_store(&pool->low, l, pool->lock)
+            || !CRYPTO_atomic_store(&pool->high, h, pool->lock))
+        return 0;
+
+    rec_buf_pool_trim(pool, h);
+    return 1;
+}
+
+/*
+ * Returns a buffer of at least |len| bytes. The caller must hand the same
+ * |len| back to ossl_rec_buf_pool_put() when it no longer needs the buffer.
+ */
+unsigned char *ossl_rec_buf_pool_get(OSSL_REC_BUF_POOL *pool, size_t len)
+{
+    REC_BUF_CLASS *c;
+    unsigned char *buf = NULL;
+    uint64_t idle;
+    size_t idx;
+
+    if (pool == NULL || len == 0 || len > REC_BUF_POOL_MAX)
+        return OPENSSL_malloc(len);
+
+    idx = rec_buf_class(len);
+    c = &pool->classes[idx];
+    if (CRYPTO_THREAD_write_lock(c->lock)) {
+        if ((buf = c->head) != NULL) {
+            memcpy(&c->head, buf, sizeof(c->head));
+            c->count--;
+            c->hits++;
+        } else {
+            c->misses++;
+        }
+        CRYPTO_THREAD_unlock(c->lock);
+    }
+
+    if (buf != NULL) {
+        CRYPTO_atomic_add64(&pool->idle, (uint64_t)0 - rec_buf_class_size(idx),
+                            &idle, pool->lock);
+        return buf;
+    }
+    return OPENSSL_malloc(rec_buf_class_size(idx));
+}
+
+void ossl_rec_buf_pool_put(OSSL_REC_BUF_POOL *pool, unsigned char *buf,
+                           size_t len)
+{
+    REC_BUF_CLASS *c;
+    uint64_t idle, high, low, size;
+    size_t idx;
+
+    if (buf == NULL)
+        return;
+
+    if (pool == NULL || len == 0 || len > REC_BUF_POOL_MAX) {
+        OPENSSL_free(buf);
+        return;
+    }
+
+    idx = rec_buf_class(len);
+    c = &pool->classes[idx];
+    size = rec_buf_class_size(idx);
+
+    if (!CRYPTO_atomic_load(&pool->high, &high, pool->lock)
+            || !CRYPTO_atomic_load(&pool->low, &low, pool->lock)
+            || !CRYPTO_atomic_add64(&pool->idle, size, &idle, pool->lock)) {
+        OPENSSL_free(buf);
+        return;
+    }
+
+    if (idle <= high && CRYPTO_THREAD_write_lock(c->lock)) {
+        memcpy(buf, &c->head, sizeof(c->head));
+        c->head = buf;
+        c->count++;
+        c->returns++;
+        CRYPTO_THREAD_unlock(c->lock);
+        return;
+    }
+
+    CRYPTO_atomic_add64(&pool->idle, (uint64_t)0 - size, &idle, pool->lock);
+    OPENSSL_free(buf);
+    if (CRYPTO_THREAD_write_lock(c->lock)) {
+        c->frees++;
+        CRYPTO_THREAD_unlock(c->lock);
+    }
+    rec_buf_pool_trim(pool, low);
+}
+
+int ossl_rec_buf_pool_get_stats(OSSL_REC_BUF_POOL *pool,
+                                SSL_RECORD_BUFFER_POOL_STATS *stats)
+{
+    REC_BUF_CLASS *c;
+    size_t i;
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < REC_BUF_POOL_CLASSES; i++) {
+        c = &pool->classes[i];
+        if (!CRYPTO_THREAD_read_lock(c->lock))
+            return 0;
+        stats->hits += c->hits;
+        stats->misses += c->misses;
+        stats->returns += c->returns;
+        stats->frees += c->frees;
+        stats->idle_buffers += c->count;
+        stats->idle_bytes += c->count * rec_buf_class_size(i);
+        CRYPTO_THREAD_unlock(c->lock);
+    }
+    return 1;
+}
@@ -45,6 +45,7 @@ int RECORD_LAYER_clear(RECORD_LAYER *rl)
     rl->wpend_tot = 0;
     rl->wpend_type = 0;
     rl->wpend_buf = NULL;
+    rl->coalesce_pending = 0;
     rl->alert_count = 0;
     rl->num_recs = 0;
     rl->curr_rec = 0;
@@ -264,13 +265,45 @@ static int tls_write_check_pending(SSL_CONNECTION *s, uint8_t type,
 }
 
 /*
- * Call this to write data in records of type 'type' It will return <= 0 if
- * not all data has been sent or non-blocking IO.
+ * Point |tmpl| at the |len| bytes found |off| bytes into the data to be
+ * written, which is either |buf| or the concatenation of the |iovcnt| buffers
+ * in |iov|.
  */
-int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
-                     size_t *written)
+static void ssl3_set_template_data(OSSL_RECORD_TEMPLATE *tmpl,
+                                   const unsigned char *buf,
+                                   const SSL_IOVEC *iov, size_t iovcnt,
+                                   size_t off, size_t len)
+{
+    tmpl->buflen = len;
+    if (iov == NULL) {
+        tmpl->buf = buf + off;
+        tmpl->iov = NULL;
+        return;
+    }
+
+    while (iovcnt > 1 && off >= iov->len) {
+        off -= iov->len;
+        iov++;
+        iovcnt--;
+    }
+    tmpl->buf = NULL;
+    tmpl->iov = iov;
+    tmpl->iovcnt = iovcnt;
+    tmpl->iovoff = off;
+}
+
+/*
+ * Writes |len| bytes in records of type |type|, taken either from |buf| or,
+ * if |iov| is not NULL, from the |iovcnt| buffers in |iov|. It will return <= 0
+ * if not all data has been sent or non-blocking IO.
+ */
+static int ssl3_write_bytes_int(SSL *ssl, uint8_t type,
+                                const unsigned char *buf,
+                                const SSL_IOVEC *iov, size_t iovcnt,
+                                size_t len, size_t *written)
 {
-    const unsigned char *buf = buf_;
+    /* Identifies the caller's buffer when a write is retried */
+    const unsigned char *wbuf = iov != NULL ? (const unsigned char *)iov : buf;
     size_t tot;
     size_t n, max_send_fragment, split_send_fragment, maxpipes;
     int i;
@@ -332,7 +365,7 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
         }
     }
 
-    i = tls_write_check_pending(s, type, buf, len);
+    i = tls_write_check_pending(s, type, wbuf, len);
     if (i < 0) {
         /* SSLfatal() already called */
         return i;
@@ -344,6 +377,7 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             s->rlayer.wnum = tot;
             return i;
         }
+        s->rlayer.coalesce_pending = 0;
         tot += s->rlayer.wpend_tot;
         s->rlayer.wpend_tot = 0;
     } /* else no retry required */
@@ -355,7 +389,7 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
          */
         s->rlayer.wpend_tot = 0;
         s->rlayer.wpend_type = type;
-        s->rlayer.wpend_buf = buf;
+        s->rlayer.wpend_buf = wbuf;
     }
 
     if (tot == len) {           /* done? */
@@ -437,8 +471,9 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             for (j = 0; j < maxpipes; j++) {
                 tmpls[j].type = type;
                 tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + (j * split_send_fragment);
-                tmpls[j].buflen = split_send_fragment;
+                ssl3_set_template_data(&tmpls[j], buf, iov, iovcnt,
+                                       tot + j * split_send_fragment,
+                                       split_send_fragment);
             }
             /* Remember how much data we are going to be sending */
             s->rlayer.wpend_tot = maxpipes * split_send_fragment;
@@ -455,8 +490,8 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             for (j = 0; j < maxpipes; j++) {
                 tmpls[j].type = type;
                 tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + lensofar;
-                tmpls[j].buflen = tmppipelen;
+                ssl3_set_template_data(&tmpls[j], buf, iov, iovcnt,
+                                       tot + lensofar, tmppipelen);
                 lensofar += tmppipelen;
                 if (j + 1 == remain)
                     tmppipelen--;
@@ -465,6 +500,8 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             s->rlayer.wpend_tot = n;
         }
 
+        if (type == SSL3_RT_APPLICATION_DATA && s->rlayer.coalesce_threshold > 0)
+            s->rlayer.coalesce_pending = 1;
         i = HANDLE_RLAYER_WRITE_RETURN(s,
             s->rlayer.wrlmethod->write_records(s->rlayer.wrl, tmpls, maxpipes));
         if (i <= 0) {
@@ -486,6 +523,55 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
     }
 }
 
+/*
+ * Call this to write data in records of type 'type' It will return <= 0 if
+ * not all data has been sent or non-blocking IO.
+ */
+int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf, size_t len,
+                     size_t *written)
+{
+    return ssl3_write_bytes_int(ssl, type, buf, NULL, 0, len, written);
+}
+
+/*
+ * As ssl3_write_bytes() but the |len| bytes are gathered from the |iovcnt|
+ * buffers in |iov| by the record layer as it builds the records.
+ */
+int ssl3_writev_bytes(SSL *ssl, uint8_t type, const SSL_IOVEC *iov,
+                      size_t iovcnt, size_t len, size_t *written)
+{
+    return ssl3_write_bytes_int(ssl, type, NULL, iov, iovcnt, len, written);
+}
+
+/*
+ * Consume |len| bytes of the application data last handed out by
+ * SSL_read_borrow(). Returns 1 on success or 0 on error.
+ */
+int ssl3_release_borrowed(SSL_CONNECTION *s, size_t len)
+{
+    TLS_RECORD *rr = &s->rlayer.tlsrecs[s->rlayer.curr_rec];
+
+    if (len > s->rlayer.borrowed_len) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_BAD_LENGTH);
+        return 0;
+    }
+    if (len == 0)
+        return 1;
+
+    /* Anything else reading from |s| in the meantime invalidates the loan */
+    if (s->rlayer.curr_rec >= s->rlayer.num_recs
+            || rr->type != SSL3_RT_APPLICATION_DATA
+            || rr->length < len
+            || &rr->data[rr->off] != s->rlayer.borrowed) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+
+    s->rlayer.borrowed = NULL;
+    s->rlayer.borrowed_len = 0;
+    return ssl_release_record(s, rr, len);
+}
+
 int ossl_tls_handle_rlayer_return(SSL_CONNECTION *s, int writing, int ret,
                                   char *file, int line)
 {
@@ -615,7 +701,7 @@ int ssl3_read_bytes(SSL *ssl, uint8_t type, uint8_t *recvd_type,
                     unsigned char *buf, size_t len,
                     int peek, size_t *readbytes)
 {
-    int i, j, ret;
+    int i, j, ret, borrow;
     size_t n, curr_rec, totalbytes;
     TLS_RECORD *rr;
     void (*cb) (const SSL *ssl, int type2, int val) = NULL;
@@ -683,6 +769,21 @@ int ssl3_read_bytes(SSL *ssl, uint8_t type, uint8_t *recvd_type,
      */
     /* get new records if necessary */
     if (s->rlayer.curr_rec >= s->rlayer.num_recs) {
+        /*
+         * The peer may be waiting for records that we are holding back for
+         * coalescing before it sends anything, so write them out first, even
+         * if coalescing has been turned off since. If the write would block
+         * we read anyway and try again later.
+         */
+        if (s->rlayer.coalesce_pending) {
+            ret = s->rlayer.wrlmethod->retry_write_records(s->rlayer.wrl);
+            if (ret == OSSL_RECORD_RETURN_FATAL) {
+                HANDLE_RLAYER_WRITE_RETURN(s, OSSL_RECORD_RETURN_FATAL);
+                return -1;
+            }
+            if (ret == OSSL_RECORD_RETURN_SUCCESS)
+                s->rlayer.coalesce_pending = 0;
+        }
         s->rlayer.curr_rec = s->rlayer.num_recs = 0;
         do {
             rr = &s->rlayer.tlsrecs[s->rlayer.num_recs];
@@ -780,6 +881,7 @@ int ssl3_read_bytes(SSL *ssl, uint8_t type, uint8_t *recvd_type,
             return 0;
         }
 
+        borrow = s->rlayer.borrow && type == SSL3_RT_APPLICATION_DATA;
         totalbytes = 0;
         curr_rec = s->rlayer.curr_rec;
         do {
@@ -788,8 +890,13 @@ int ssl3_read_bytes(SSL *ssl, uint8_t type, uint8_t *recvd_type,
             else
                 n = len - totalbytes;
 
-            memcpy(buf, &(rr->data[rr->off]), n);
-            buf += n;
+            if (borrow) {
+                /* Hand out the plaintext where the record layer left it */
+                s->rlayer.borrowed = &(rr->data[rr->off]);
+            } else {
+                memcpy(buf, &(rr->data[rr->off]), n);
+                buf += n;
+            }
             if (peek) {
                 /* Mark any zero length record as consumed CVE-2016-6305 */
                 if (rr->length == 0 && !ssl_release_record(s, rr, 0))
@@ -806,7 +913,8 @@ int ssl3_read_bytes(SSL *ssl, uint8_t type, uint8_t *recvd_type,
             totalbytes += n;
         } while (type == SSL3_RT_APPLICATION_DATA
                     && curr_rec < s->rlayer.num_recs
-                    && totalbytes < len);
+                    && totalbytes < len
+                    && !(borrow && totalbytes > 0));
         if (totalbytes == 0) {
             /* We must have read empty records. Get more data */
             goto start;
@@ -1242,7 +1350,7 @@ int ssl_set_new_record_layer(SSL_CONNECTION *s, int version,
                              int mactype, const EVP_MD *md,
                              const SSL_COMP *comp, const EVP_MD *kdfdigest)
 {
-    OSSL_PARAM options[5], *opts = options;
+    OSSL_PARAM options[7], *opts = options;
     OSSL_PARAM settings[6], *set =  settings;
     const OSSL_RECORD_METHOD **thismethod;
     OSSL_RECORD_LAYER **thisrl, *newrl = NULL;
@@ -1292,7 +1400,14 @@ int ssl_set_new_record_layer(SSL_CONNECTION *s, int version,
                                               &s->rlayer.block_padding);
         *opts++ = OSSL_PARAM_construct_size_t(OSSL_LIBSSL_RECORD_LAYER_PARAM_HS_PADDING,
                                               &s->rlayer.hs_padding);
+        *opts++ = OSSL_PARAM_construct_size_t(OSSL_LIBSSL_RECORD_LAYER_PARAM_COALESCE,
+                                              &s->rlayer.coalesce_threshold);
     }
+    /* DTLS keeps buffered records in its own allocations */
+    if (sctx->rec_buf_pool != NULL && !SSL_CONNECTION_IS_DTLS(s))
+        *opts++ = OSSL_PARAM_construct_octet_ptr(OSSL_LIBSSL_RECORD_LAYER_PARAM_BUFFER_POOL,
+                                                 (void **)&sctx->rec_buf_pool,
+                                                 sizeof(sctx->rec_buf_pool));
     *opts = OSSL_PARAM_construct_end();
 
     /* Parameters that *must* be supported by a record layer if passed */
@@ -114,6 +114,17 @@ typedef struct record_layer_st {
     void *record_padding_arg;
     size_t block_padding;
     size_t hs_padding;
+    /*
+     * Number of bytes of encrypted application data records the record layer
+     * may hold back in order to write them with a single BIO_write(), or 0 to
+     * write every record as it is produced
+     */
+    size_t coalesce_threshold;
+    /*
+     * Set once application data has been written with coalescing enabled,
+     * and cleared when everything held back has been written out
+     */
+    int coalesce_pending;
 
     /* How many records we have read from the record layer */
     size_t num_recs;
@@ -122,6 +133,14 @@ typedef struct record_layer_st {
     /* Record layer data to be processed */
     TLS_RECORD tlsrecs[SSL_MAX_PIPELINES];
 
+    /*
+     * Set while SSL_read_borrow() looks for application data, which is then
+     * handed out in place as |borrowed| instead of being copied
+     */
+    int borrow;
+    const unsigned char *borrowed;
+    size_t borrowed_len;
+
 } RECORD_LAYER;
 
 /*****************************************************************************
@@ -144,9 +163,12 @@ int RECORD_LAYER_is_sslv2_record(RECORD_LAYER *rl);
 __owur size_t ssl3_pending(const SSL *s);
 __owur int ssl3_write_bytes(SSL *s, uint8_t type, const void *buf, size_t len,
                             size_t *written);
+__owur int ssl3_writev_bytes(SSL *s, uint8_t type, const SSL_IOVEC *iov,
+                             size_t iovcnt, size_t len, size_t *written);
 __owur int ssl3_read_bytes(SSL *s, uint8_t type, uint8_t *recvd_type,
                            unsigned char *buf, size_t len, int peek,
                            size_t *readbytes);
+__owur int ssl3_release_borrowed(SSL_CONNECTION *s, size_t len);
 
 int DTLS_RECORD_LAYER_new(RECORD_LAYER *rl);
 void DTLS_RECORD_LAYER_free(RECORD_LAYER *rl);
@@ -168,6 +190,23 @@ int ssl_release_record(SSL_CONNECTION *s, TLS_RECORD *rr, size_t length);
 # define HANDLE_RLAYER_WRITE_RETURN(s, ret) \
     ossl_tls_handle_rlayer_return(s, 1, ret, OPENSSL_FILE, OPENSSL_LINE)
 
+/* The largest value accepted by SSL_set_record_coalescing() */
+# define SSL_MAX_RECORD_COALESCING  (1024 * 1024)
+
+/* Record buffer pool shared by the connections of an SSL_CTX */
+typedef struct ossl_rec_buf_pool_st OSSL_REC_BUF_POOL;
+
+OSSL_REC_BUF_POOL *ossl_rec_buf_pool_new(size_t low, size_t high);
+int ossl_rec_buf_pool_up_ref(OSSL_REC_BUF_POOL *pool);
+void ossl_rec_buf_pool_free(OSSL_REC_BUF_POOL *pool);
+int ossl_rec_buf_pool_set_watermarks(OSSL_REC_BUF_POOL *pool, size_t low,
+                                     size_t high);
+unsigned char *ossl_rec_buf_pool_get(OSSL_REC_BUF_POOL *pool, size_t len);
+void ossl_rec_buf_pool_put(OSSL_REC_BUF_POOL *pool, unsigned char *buf,
+                           size_t len);
+int ossl_rec_buf_pool_get_stats(OSSL_REC_BUF_POOL *pool,
+                                SSL_RECORD_BUFFER_POOL_STATS *stats);
+
 int ossl_tls_handle_rlayer_return(SSL_CONNECTION *s, int writing, int ret,
                                   char *file, int line);
 
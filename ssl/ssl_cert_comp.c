@@ -157,6 +157,101 @@ int OSSL_COMP_CERT_up_ref(OSSL_COMP_CERT *cc)
     return ((i > 1) ? 1 : 0);
 }
 
+/*
+ * Compressed certificates are cached in the library context, so that every
+ * SSL_CTX serving the same chain shares one copy of each compressed form and
+ * a chain is only compressed once, however many SSL_CTX or SSL objects it is
+ * configured on. The cache holds a reference to each entry; entries that
+ * nothing else refers to any more are dropped whenever a new one is added.
+ * libcrypto creates the cache and frees it with the library context.
+ */
+static void comp_cert_cache_entry_free(OSSL_COMP_CERT_CACHE_ENTRY *e)
+{
+    OSSL_COMP_CERT_free(e->cc);
+    OPENSSL_free(e);
+}
+
+static void comp_cert_cache_prune(OSSL_COMP_CERT_CACHE_ENTRY *e, void *arg)
+{
+    LHASH_OF(OSSL_COMP_CERT_CACHE_ENTRY) *entries = arg;
+    int refs;
+
+    /* Called with the cache locked, so nobody can take a new reference */
+    if (CRYPTO_GET_REF(&e->cc->references, &refs) && refs == 1) {
+        (void)lh_OSSL_COMP_CERT_CACHE_ENTRY_delete(entries, e);
+        comp_cert_cache_entry_free(e);
+    }
+}
+
+/*
+ * Returns the certificate |data| compressed with |alg|, from the cache of
+ * the library context of |ctx| if it is there.
+ */
+static OSSL_COMP_CERT *ssl_comp_cert_cache_get(SSL_CTX *ctx,
+                                               unsigned char *data, size_t len,
+                                               int alg)
+{
+    OSSL_COMP_CERT_CACHE *cache;
+    OSSL_COMP_CERT_CACHE_ENTRY key, *e;
+    OSSL_COMP_CERT *cc = NULL;
+    const EVP_MD *md = ssl_md(ctx, SSL_MD_SHA256_IDX);
+    unsigned long down_load;
+
+    cache = OSSL_LIB_CTX_get_data(ctx->libctx,
+                                  OSSL_LIB_CTX_COMP_CERT_CACHE_INDEX);
+    if (cache == NULL
+            || md == NULL
+            || !EVP_Digest(data, len, key.md, NULL, md, NULL))
+        return OSSL_COMP_CERT_from_uncompressed_data(data, len, alg);
+    key.alg = alg;
+
+    if (!CRYPTO_THREAD_read_lock(cache->lock))
+        return NULL;
+    if ((e = lh_OSSL_COMP_CERT_CACHE_ENTRY_retrieve(cache->entries, &key)) != NULL
+            && OSSL_COMP_CERT_up_ref(e->cc))
+        cc = e->cc;
+    CRYPTO_THREAD_unlock(cache->lock);
+    if (cc != NULL)
+        return cc;
+
+    /* Compress without holding the lock, another thread may do the same */
+    if ((cc = OSSL_COMP_CERT_from_uncompressed_data(data, len, alg)) == NULL)
+        return NULL;
+
+    if (!CRYPTO_THREAD_write_lock(cache->lock))
+        return cc;
+    if ((e = lh_OSSL_COMP_CERT_CACHE_ENTRY_retrieve(cache->entries, &key)) != NULL) {
+        if (OSSL_COMP_CERT_up_ref(e->cc)) {
+            OSSL_COMP_CERT_free(cc);
+            cc = e->cc;
+        }
+        goto end;
+    }
+
+    down_load = lh_OSSL_COMP_CERT_CACHE_ENTRY_get_down_load(cache->entries);
+    lh_OSSL_COMP_CERT_CACHE_ENTRY_set_down_load(cache->entries, 0);
+    lh_OSSL_COMP_CERT_CACHE_ENTRY_doall_arg(cache->entries,
+                                            comp_cert_cache_prune,
+                                            cache->entries);
+    lh_OSSL_COMP_CERT_CACHE_ENTRY_set_down_load(cache->entries, down_load);
+
+    if ((e = OPENSSL_malloc(sizeof(*e))) == NULL)
+        goto end;
+    *e = key;
+    e->cc = cc;
+    if (!OSSL_COMP_CERT_up_ref(cc)) {
+        OPENSSL_free(e);
+        goto end;
+    }
+    (void)lh_OSSL_COMP_CERT_CACHE_ENTRY_insert(cache->entries, e);
+    if (lh_OSSL_COMP_CERT_CACHE_ENTRY_error(cache->entries))
+        comp_cert_cache_entry_free(e);
+
+ end:
+    CRYPTO_THREAD_unlock(cache->lock);
+    return cc;
+}
+
 static int ssl_set_cert_comp_pref(int *prefs, int *algs, size_t len)
 {
     size_t j = 0;
@@ -242,7 +337,7 @@ static int ssl_compress_one_cert(SSL *ssl, CERT_PKEY *cpk, int alg)
 
     if ((length = ssl_get_cert_to_compress(ssl, cpk, &cert_data)) == 0)
         return 0;
-    comp_cert = OSSL_COMP_CERT_from_uncompressed_data(cert_data, length, alg);
+    comp_cert = ssl_comp_cert_cache_get(ssl->ctx, cert_data, length, alg);
     OPENSSL_free(cert_data);
     if (comp_cert == NULL)
         return 0;
@@ -318,15 +413,14 @@ static size_t ssl_get_compressed_cert(SSL *ssl, CERT_PKEY *cpk, int alg, unsigne
     if ((cert_len = ssl_get_cert_to_compress(ssl, cpk, &cert_data)) == 0)
         goto err;
 
-    comp_cert = OSSL_COMP_CERT_from_uncompressed_data(cert_data, cert_len, alg);
+    comp_cert = ssl_comp_cert_cache_get(ssl->ctx, cert_data, cert_len, alg);
     OPENSSL_free(cert_data);
-    if (comp_cert == NULL)
+    if (comp_cert == NULL
+            || (*data = OPENSSL_memdup(comp_cert->data, comp_cert->len)) == NULL)
         goto err;
 
     comp_len = comp_cert->len;
     *orig_len = comp_cert->orig_len;
-    *data = comp_cert->data;
-    comp_cert->data = NULL;
  err:
     OSSL_COMP_CERT_free(comp_cert);
     return comp_len;
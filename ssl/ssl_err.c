@@ -308,8 +308,11 @@ static const ERR_STRING_DATA SSL_str_reasons[] = {
     "no cookie callback set"},
     {ERR_PACK(ERR_LIB_SSL, 0, SSL_R_NO_GOST_CERTIFICATE_SENT_BY_PEER),
     "Peer haven't sent GOST certificate, required for selected ciphersuite"},
+    {ERR_PACK(ERR_LIB_SSL, 0, SSL_R_NO_ISSUER_CERTIFICATE),
+    "no issuer certificate"},
     {ERR_PACK(ERR_LIB_SSL, 0, SSL_R_NO_METHOD_SPECIFIED),
     "no method specified"},
+    {ERR_PACK(ERR_LIB_SSL, 0, SSL_R_NO_OCSP_RESPONDER), "no ocsp responder"},
     {ERR_PACK(ERR_LIB_SSL, 0, SSL_R_NO_PEM_EXTENSIONS), "no pem extensions"},
     {ERR_PACK(ERR_LIB_SSL, 0, SSL_R_NO_PRIVATE_KEY_ASSIGNED),
     "no private key assigned"},
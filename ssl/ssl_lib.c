@@ -9,6 +9,11 @@
  * https://www.openssl.org/source/license.html
  */
 
+/* splice() is used by SSL_sendfile() with kernel TLS on Linux */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include "internal/e_os.h"
 #include "internal/e_winsock.h"
 #include "ssl_local.h"
@@ -83,10 +88,14 @@ struct ssl_async_args {
     SSL *s;
     void *buf;
     size_t num;
-    enum { READFUNC, WRITEFUNC, OTHERFUNC } type;
+    const SSL_IOVEC *iov;
+    size_t iovcnt;
+    enum { READFUNC, WRITEFUNC, WRITEVFUNC, OTHERFUNC } type;
     union {
         int (*func_read) (SSL *, void *, size_t, size_t *);
         int (*func_write) (SSL *, const void *, size_t, size_t *);
+        int (*func_writev) (SSL *, const SSL_IOVEC *, size_t, size_t,
+                            size_t *);
         int (*func_other) (SSL *);
     } f;
 };
@@ -793,6 +802,7 @@ SSL *ossl_ssl_connection_new_int(SSL_CTX *ctx, SSL *user_ssl,
     s->rlayer.record_padding_arg = ctx->record_padding_arg;
     s->rlayer.block_padding = ctx->block_padding;
     s->rlayer.hs_padding = ctx->hs_padding;
+    s->rlayer.coalesce_threshold = ctx->coalesce_threshold;
     s->sid_ctx_length = ctx->sid_ctx_length;
     if (!ossl_assert(s->sid_ctx_length <= sizeof(s->sid_ctx)))
         goto err;
@@ -1449,6 +1459,7 @@ void ossl_ssl_connection_free(SSL *ssl)
     sk_X509_EXTENSION_pop_free(s->ext.ocsp.exts, X509_EXTENSION_free);
 #ifndef OPENSSL_NO_OCSP
     sk_OCSP_RESPID_pop_free(s->ext.ocsp.ids, OCSP_RESPID_free);
+    ossl_ocsp_staple_free(s->ext.ocsp.staple);
 #endif
 #ifndef OPENSSL_NO_CT
     SCT_LIST_free(s->scts);
@@ -2268,6 +2279,9 @@ static int ssl_io_intern(void *vargs)
         return args->f.func_read(s, buf, num, &sc->asyncrw);
     case WRITEFUNC:
         return args->f.func_write(s, buf, num, &sc->asyncrw);
+    case WRITEVFUNC:
+        return args->f.func_writev(s, args->iov, args->iovcnt, num,
+                                   &sc->asyncrw);
     case OTHERFUNC:
         return args->f.func_other(s);
     }
@@ -2493,19 +2507,49 @@ int SSL_peek_ex(SSL *s, void *buf, size_t num, size_t *readbytes)
     return ret;
 }
 
-int ssl_write_internal(SSL *s, const void *buf, size_t num,
-                       uint64_t flags, size_t *written)
+int SSL_read_borrow(SSL *s, const unsigned char **data, size_t *len)
 {
-    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+    size_t readbytes = 0;
+    int ret;
 
-#ifndef OPENSSL_NO_QUIC
-    if (IS_QUIC(s))
-        return ossl_quic_write_flags(s, buf, num, flags, written);
-#endif
+    if (sc == NULL || SSL_CONNECTION_IS_DTLS(sc)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+        return 0;
+    }
+
+    /* Peek at the next record, which stays where it was decrypted */
+    sc->rlayer.borrow = 1;
+    ret = ssl_peek_internal(s, NULL, SIZE_MAX, &readbytes);
+    sc->rlayer.borrow = 0;
+    if (ret <= 0) {
+        sc->rlayer.borrowed = NULL;
+        sc->rlayer.borrowed_len = 0;
+        return 0;
+    }
+
+    sc->rlayer.borrowed_len = readbytes;
+    *data = sc->rlayer.borrowed;
+    *len = readbytes;
+    return 1;
+}
+
+int SSL_read_release(SSL *s, size_t len)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
 
     if (sc == NULL)
         return 0;
 
+    return ssl3_release_borrowed(sc, len);
+}
+
+/*
+ * Checks that a write on |sc| with |flags| may go ahead. Returns 1 if so, or
+ * the value to return from the write otherwise.
+ */
+static int ssl_write_check(SSL_CONNECTION *sc, uint64_t flags)
+{
     if (sc->handshake_func == NULL) {
         ERR_raise(ERR_LIB_SSL, SSL_R_UNINITIALIZED);
         return -1;
@@ -2530,9 +2574,27 @@ int ssl_write_internal(SSL *s, const void *buf, size_t num,
     }
     /* If we are a client and haven't sent the Finished we better do that */
     ossl_statem_check_finish_init(sc, 1);
+    return 1;
+}
+
+int ssl_write_internal(SSL *s, const void *buf, size_t num,
+                       uint64_t flags, size_t *written)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
+    int ret;
+
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC(s))
+        return ossl_quic_write_flags(s, buf, num, flags, written);
+#endif
+
+    if (sc == NULL)
+        return 0;
+
+    if ((ret = ssl_write_check(sc, flags)) <= 0)
+        return ret;
 
     if ((sc->mode & SSL_MODE_ASYNC) && ASYNC_get_current_job() == NULL) {
-        int ret;
         struct ssl_async_args args;
 
         args.s = s;
@@ -2553,6 +2615,9 @@ ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size, int flags)
 {
     ossl_ssize_t ret;
     SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+#ifndef OPENSSL_NO_KTLS
+    int zerocopy = 0;
+#endif
 
     if (sc == NULL)
         return 0;
@@ -2600,7 +2665,36 @@ ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size, int flags)
                    "can't call ktls_sendfile(), ktls disabled");
     return -1;
 #else
-    ret = ktls_sendfile(SSL_get_wfd(s), fd, offset, size, flags);
+    /*
+     * Zerocopy sendfile may also be enabled for good with
+     * SSL_OP_ENABLE_KTLS_TX_ZEROCOPY_SENDFILE, otherwise it is only turned on
+     * for this call. Ignore errors: if the kernel doesn't support it the data
+     * is still sent, just copied.
+     */
+    if ((flags & SSL_SENDFILE_FLAG_ZEROCOPY) != 0
+            && !BIO_test_flags(sc->wbio, BIO_FLAGS_KTLS_TX_ZEROCOPY_SENDFILE))
+        zerocopy = ktls_enable_tx_zerocopy_sendfile(SSL_get_wfd(s));
+
+    if ((flags & SSL_SENDFILE_FLAG_SPLICE) != 0) {
+# ifdef OPENSSL_KTLS_SPLICE
+        ret = ktls_splice(SSL_get_wfd(s), fd, size);
+# else
+        sc->rwstate = SSL_NOTHING;
+        ERR_raise_data(ERR_LIB_SSL, SSL_R_BAD_VALUE,
+                       "splice is not supported on this platform");
+        return -1;
+# endif
+    } else {
+        ret = ktls_sendfile(SSL_get_wfd(s), fd, offset, size,
+                            flags & ~(SSL_SENDFILE_FLAG_SPLICE
+                                      | SSL_SENDFILE_FLAG_ZEROCOPY));
+    }
+    if (zerocopy) {
+        int err = get_last_sys_error();
+
+        ktls_disable_tx_zerocopy_sendfile(SSL_get_wfd(s));
+        set_sys_error(err);
+    }
     if (ret < 0) {
 #if defined(EAGAIN) && defined(EINTR) && defined(EBUSY)
         if ((get_last_sys_error() == EAGAIN) ||
@@ -2610,7 +2704,8 @@ ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size, int flags)
         else
 #endif
             ERR_raise_data(ERR_LIB_SYS, get_last_sys_error(),
-                           "ktls_sendfile failure");
+                           (flags & SSL_SENDFILE_FLAG_SPLICE) != 0
+                           ? "ktls_splice failure" : "ktls_sendfile failure");
         return ret;
     }
     sc->rwstate = SSL_NOTHING;
@@ -2655,6 +2750,92 @@ int SSL_write_ex2(SSL *s, const void *buf, size_t num, uint64_t flags,
     return ret;
 }
 
+static int ssl_writev_internal(SSL *s, const SSL_IOVEC *iov, size_t iovcnt,
+                               size_t len, uint64_t flags, size_t *written)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
+    unsigned char *flat, *p;
+    size_t i;
+    int ret;
+
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC(s))
+        return ossl_quic_writev_flags(s, iov, iovcnt, flags, written);
+#endif
+
+    if (iovcnt <= 1)
+        return ssl_write_internal(s, iovcnt == 1 ? iov[0].base : NULL, len,
+                                  flags, written);
+
+    if (sc == NULL)
+        return 0;
+
+    if (SSL_CONNECTION_IS_DTLS(sc)) {
+        /*
+         * A DTLS write is a single record, which the record layer copies
+         * before returning, so a temporary flat copy is good enough here.
+         */
+        if ((flat = OPENSSL_malloc(len > 0 ? len : 1)) == NULL)
+            return -1;
+        for (i = 0, p = flat; i < iovcnt; p += iov[i++].len)
+            if (iov[i].len > 0)
+                memcpy(p, iov[i].base, iov[i].len);
+        ret = ssl_write_internal(s, flat, len, flags, written);
+        OPENSSL_free(flat);
+        return ret;
+    }
+
+    if ((ret = ssl_write_check(sc, flags)) <= 0)
+        return ret;
+
+    if ((sc->mode & SSL_MODE_ASYNC) && ASYNC_get_current_job() == NULL) {
+        struct ssl_async_args args;
+
+        args.s = s;
+        args.buf = NULL;
+        args.num = len;
+        args.iov = iov;
+        args.iovcnt = iovcnt;
+        args.type = WRITEVFUNC;
+        args.f.func_writev = ssl3_writev;
+
+        ret = ssl_start_async_job(s, &args, ssl_io_intern);
+        *written = sc->asyncrw;
+        return ret;
+    }
+
+    return ssl3_writev(s, iov, iovcnt, len, written);
+}
+
+int SSL_writev_ex(SSL *s, const SSL_IOVEC *iov, size_t iovcnt, uint64_t flags,
+                  size_t *written)
+{
+    size_t i, len = 0;
+    int ret;
+
+    if (iov == NULL && iovcnt > 0) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].base == NULL && iov[i].len > 0) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+            return 0;
+        }
+        if (iov[i].len > SIZE_MAX - len) {
+            ERR_raise(ERR_LIB_SSL, SSL_R_BAD_LENGTH);
+            return 0;
+        }
+        len += iov[i].len;
+    }
+
+    ret = ssl_writev_internal(s, iov, iovcnt, len, flags, written);
+    if (ret < 0)
+        ret = 0;
+    return ret;
+}
+
 int SSL_write_early_data(SSL *s, const void *buf, size_t num, size_t *written)
 {
     int ret, early_data_state;
@@ -4364,6 +4545,11 @@ void SSL_CTX_free(SSL_CTX *a)
     OPENSSL_free(a->client_cert_type);
     OPENSSL_free(a->server_cert_type);
 
+    ossl_rec_buf_pool_free(a->rec_buf_pool);
+#ifndef OPENSSL_NO_OCSP
+    ossl_ocsp_stapler_free(a->ocsp_stapler);
+#endif
+
     CRYPTO_THREAD_lock_free(a->lock);
     CRYPTO_FREE_REF(&a->references);
 #ifdef TSAN_REQUIRES_LOCKING
@@ -5938,6 +6124,129 @@ int SSL_set_block_padding(SSL *ssl, size_t block_size)
     return SSL_set_block_padding_ex(ssl, block_size, block_size);
 }
 
+int SSL_CTX_set_record_coalescing(SSL_CTX *ctx, size_t threshold)
+{
+    if (IS_QUIC_CTX(ctx)
+            || (ctx->method->ssl3_enc->enc_flags & SSL_ENC_FLAG_DTLS) != 0
+            || threshold > SSL_MAX_RECORD_COALESCING)
+        return 0;
+
+    ctx->coalesce_threshold = threshold;
+    return 1;
+}
+
+int SSL_set_record_coalescing(SSL *ssl, size_t threshold)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(ssl);
+    OSSL_PARAM options[2];
+
+    if (sc == NULL || SSL_CONNECTION_IS_DTLS(sc)
+            || threshold > SSL_MAX_RECORD_COALESCING)
+        return 0;
+
+    sc->rlayer.coalesce_threshold = threshold;
+
+    /* Apply it to the current write record layer as well */
+    if (sc->rlayer.wrlmethod != NULL && sc->rlayer.wrl != NULL) {
+        options[0] = OSSL_PARAM_construct_size_t(OSSL_LIBSSL_RECORD_LAYER_PARAM_COALESCE,
+                                                 &sc->rlayer.coalesce_threshold);
+        options[1] = OSSL_PARAM_construct_end();
+        if (!sc->rlayer.wrlmethod->set_options(sc->rlayer.wrl, options))
+            return 0;
+    }
+    return 1;
+}
+
+int SSL_flush_records(SSL *ssl)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(ssl);
+    int ret;
+
+    if (sc == NULL)
+        return -1;
+
+    if (sc->rlayer.wrlmethod == NULL || sc->rlayer.wrl == NULL)
+        return 1;
+
+    /* retry_write_records() writes everything that is held back */
+    ret = HANDLE_RLAYER_WRITE_RETURN(sc,
+              sc->rlayer.wrlmethod->retry_write_records(sc->rlayer.wrl));
+    if (ret <= 0)
+        return ret;
+
+    sc->rlayer.coalesce_pending = 0;
+    return 1;
+}
+
+int SSL_CTX_set_record_buffer_pool(SSL_CTX *ctx, size_t low_watermark,
+                                   size_t high_watermark)
+{
+    if (IS_QUIC_CTX(ctx)
+            || (ctx->method->ssl3_enc->enc_flags & SSL_ENC_FLAG_DTLS) != 0
+            || low_watermark > high_watermark) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    /*
+     * Record layers that already use the pool keep their own reference to it,
+     * so it stays around until the last of them is freed.
+     */
+    if (high_watermark == 0) {
+        ossl_rec_buf_pool_free(ctx->rec_buf_pool);
+        ctx->rec_buf_pool = NULL;
+        return 1;
+    }
+
+    if (ctx->rec_buf_pool != NULL)
+        return ossl_rec_buf_pool_set_watermarks(ctx->rec_buf_pool,
+                                                low_watermark, high_watermark);
+
+    ctx->rec_buf_pool = ossl_rec_buf_pool_new(low_watermark, high_watermark);
+    if (ctx->rec_buf_pool == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_SSL_LIB);
+        return 0;
+    }
+    return 1;
+}
+
+int SSL_CTX_get_record_buffer_pool_stats(SSL_CTX *ctx,
+                                         SSL_RECORD_BUFFER_POOL_STATS *stats)
+{
+    if (stats == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if (ctx->rec_buf_pool == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return 1;
+    }
+    return ossl_rec_buf_pool_get_stats(ctx->rec_buf_pool, stats);
+}
+
+#ifndef OPENSSL_NO_OCSP
+int SSL_CTX_enable_ocsp_stapling(SSL_CTX *ctx, const char *source,
+                                 uint64_t flags)
+{
+    OSSL_OCSP_STAPLER *st;
+
+    if ((st = ossl_ocsp_stapler_new(ctx, source, flags)) == NULL)
+        return 0;
+    ossl_ocsp_stapler_free(ctx->ocsp_stapler);
+    ctx->ocsp_stapler = st;
+    return 1;
+}
+
+int SSL_CTX_refresh_ocsp_staples(SSL_CTX *ctx)
+{
+    if (ctx->ocsp_stapler == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+    return ossl_ocsp_stapler_refresh(ctx->ocsp_stapler);
+}
+#endif
+
 int SSL_set_num_tickets(SSL *s, size_t num_tickets)
 {
     SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
@@ -37,6 +37,7 @@
 # include "internal/time.h"
 # include "internal/ssl.h"
 # include "internal/cryptlib.h"
+# include "internal/comp.h"
 # include "record/record.h"
 
 # ifdef OPENSSL_BUILD_SHLIBSSL
@@ -787,6 +788,9 @@ typedef struct {
 
 # define TLS_GROUP_FFDHE_FOR_TLS1_3 (TLS_GROUP_FFDHE|TLS_GROUP_ONLY_FOR_TLS1_3)
 
+typedef struct ossl_ocsp_stapler_st OSSL_OCSP_STAPLER;
+typedef struct ossl_ocsp_staple_st OSSL_OCSP_STAPLE;
+
 struct ssl_ctx_st {
     OSSL_LIB_CTX *libctx;
 
@@ -1124,6 +1128,17 @@ struct ssl_ctx_st {
     size_t block_padding;
     size_t hs_padding;
 
+    /* Application data to buffer before writing, see record.h */
+    size_t coalesce_threshold;
+
+    /* Pool that the record layers take their read and write buffers from */
+    OSSL_REC_BUF_POOL *rec_buf_pool;
+
+# ifndef OPENSSL_NO_OCSP
+    /* OCSP responses stapled when no status callback is set */
+    OSSL_OCSP_STAPLER *ocsp_stapler;
+# endif
+
     /* Session ticket appdata */
     SSL_CTX_generate_session_ticket_fn generate_ticket_cb;
     SSL_CTX_decrypt_session_ticket_fn decrypt_ticket_cb;
@@ -1591,6 +1606,10 @@ struct ssl_connection_st {
             /* OCSP response received or to be sent */
             unsigned char *resp;
             size_t resp_len;
+# ifndef OPENSSL_NO_OCSP
+            /* Stapled response to be sent if |resp| is not set */
+            OSSL_OCSP_STAPLE *staple;
+# endif
         } ocsp;
 
         /* RFC4507 session ticket expected to be received or sent */
@@ -1960,16 +1979,28 @@ typedef struct dtls1_state_st {
 #  define EXPLICIT_CHAR2_CURVE_TYPE  2
 #  define NAMED_CURVE_TYPE           3
 
-# ifndef OPENSSL_NO_COMP_ALG
-struct ossl_comp_cert_st {
-    unsigned char *data;
+# ifndef OPENSSL_NO_OCSP
+/*
+ * An encoded OCSP response that is shared by all connections stapling it,
+ * see ssl_stapling.c
+ */
+struct ossl_ocsp_staple_st {
+    unsigned char *der;
     size_t len;
-    size_t orig_len;
+    /* Not to be sent after this time, zero if there is no nextUpdate */
+    OSSL_TIME expires;
     CRYPTO_REF_COUNT references;
-    int alg;
 };
-typedef struct ossl_comp_cert_st OSSL_COMP_CERT;
 
+OSSL_OCSP_STAPLER *ossl_ocsp_stapler_new(SSL_CTX *ctx, const char *source,
+                                         uint64_t flags);
+void ossl_ocsp_stapler_free(OSSL_OCSP_STAPLER *st);
+int ossl_ocsp_stapler_refresh(OSSL_OCSP_STAPLER *st);
+OSSL_OCSP_STAPLE *ossl_ocsp_stapler_get1(OSSL_OCSP_STAPLER *st, X509 *x);
+void ossl_ocsp_staple_free(OSSL_OCSP_STAPLE *staple);
+# endif
+
+# ifndef OPENSSL_NO_COMP_ALG
 void OSSL_COMP_CERT_free(OSSL_COMP_CERT *c);
 int OSSL_COMP_CERT_up_ref(OSSL_COMP_CERT *c);
 # endif
@@ -2636,6 +2667,8 @@ void ssl3_free(SSL *s);
 __owur int ssl3_read(SSL *s, void *buf, size_t len, size_t *readbytes);
 __owur int ssl3_peek(SSL *s, void *buf, size_t len, size_t *readbytes);
 __owur int ssl3_write(SSL *s, const void *buf, size_t len, size_t *written);
+__owur int ssl3_writev(SSL *s, const SSL_IOVEC *iov, size_t iovcnt, size_t len,
+                       size_t *written);
 __owur int ssl3_shutdown(SSL *s);
 int ssl3_clear(SSL *s);
 __owur long ssl3_ctrl(SSL *s, int cmd, long larg, void *parg);
@@ -0,0 +1,511 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/ocsp.h>
+#include <openssl/http.h>
+#include <openssl/rand.h>
+#include "ssl_local.h"
+#include "internal/refcount.h"
+#include "internal/thread_arch.h"
+#include "internal/time.h"
+
+#ifndef OPENSSL_NO_OCSP
+
+/* Refresh interval, in seconds, for responses without a nextUpdate */
+# define STAPLE_REFRESH_DEFAULT  3600
+/* Shortest interval between two fetches for the same certificate */
+# define STAPLE_REFRESH_MIN      60
+/* Failed fetches are retried after 60s, doubling up to this */
+# define STAPLE_RETRY_MAX        3600
+/* Timeout for a request to an OCSP responder */
+# define STAPLE_HTTP_TIMEOUT     10
+/* Clock skew tolerated when checking thisUpdate and nextUpdate */
+# define STAPLE_VALIDITY_SKEW    300
+
+typedef struct {
+    X509 *cert;
+    OCSP_CERTID *id;
+    /* Responder to ask, NULL if the responses are read from a file */
+    char *url;
+    /* Protected by the lock of the stapler */
+    OSSL_OCSP_STAPLE *staple;
+    OSSL_TIME refresh;
+    unsigned int failures;
+} STAPLE_ENTRY;
+
+struct ossl_ocsp_stapler_st {
+    OSSL_LIB_CTX *libctx;
+    char *file;
+    STAPLE_ENTRY entries[SSL_PKEY_NUM];
+    size_t num;
+    CRYPTO_RWLOCK *lock;
+
+    /* Background refresh, absent with SSL_OCSP_STAPLING_NO_THREAD */
+    CRYPTO_THREAD *thread;
+    CRYPTO_MUTEX *mutex;
+    CRYPTO_CONDVAR *cv;
+    int stop;
+};
+
+void ossl_ocsp_staple_free(OSSL_OCSP_STAPLE *staple)
+{
+    int i;
+
+    if (staple == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&staple->references, &i);
+    REF_PRINT_COUNT("OSSL_OCSP_STAPLE", staple);
+    if (i > 0)
+        return;
+    REF_ASSERT_ISNT(i < 0);
+
+    OPENSSL_free(staple->der);
+    CRYPTO_FREE_REF(&staple->references);
+    OPENSSL_free(staple);
+}
+
+static int stapler_source_is_http(const char *source)
+{
+    return OPENSSL_strncasecmp(source, "http://", 7) == 0
+        || OPENSSL_strncasecmp(source, "https://", 8) == 0;
+}
+
+/*
+ * Look for the issuer of the certificate |cpk| in its chain, in the extra
+ * chain certificates and then in the certificate store of |ctx|.
+ */
+static X509 *stapler_find_issuer(SSL_CTX *ctx, CERT_PKEY *cpk)
+{
+    STACK_OF(X509) *chain = cpk->chain != NULL ? cpk->chain : ctx->extra_certs;
+    X509_STORE_CTX *xsctx;
+    X509 *issuer = NULL;
+    int i;
+
+    for (i = 0; i < sk_X509_num(chain); i++) {
+        X509 *x = sk_X509_value(chain, i);
+
+        if (X509_check_issued(x, cpk->x509) == X509_V_OK) {
+            if (!X509_up_ref(x))
+                return NULL;
+            return x;
+        }
+    }
+
+    if (ctx->cert_store == NULL
+            || (xsctx = X509_STORE_CTX_new_ex(ctx->libctx, ctx->propq)) == NULL)
+        return NULL;
+    if (X509_STORE_CTX_init(xsctx, ctx->cert_store, cpk->x509, NULL)
+            && X509_STORE_CTX_get1_issuer(&issuer, xsctx, cpk->x509) <= 0)
+        issuer = NULL;
+    X509_STORE_CTX_free(xsctx);
+    return issuer;
+}
+
+static OCSP_RESPONSE *stapler_fetch_http(STAPLE_ENTRY *e)
+{
+# ifndef OPENSSL_NO_HTTP
+    OCSP_REQUEST *req = NULL;
+    OCSP_CERTID *id = NULL;
+    OCSP_RESPONSE *resp = NULL;
+    BIO *reqbio = NULL, *rspbio = NULL;
+    char *host = NULL, *port = NULL, *path = NULL;
+    int use_ssl;
+
+    if (!OSSL_HTTP_parse_url(e->url, &use_ssl, NULL, &host, &port, NULL,
+                             &path, NULL, NULL))
+        goto end;
+    if (use_ssl) {
+        ERR_raise_data(ERR_LIB_SSL, ERR_R_UNSUPPORTED,
+                       "OCSP responder over TLS: %s", e->url);
+        goto end;
+    }
+
+    if ((req = OCSP_REQUEST_new()) == NULL
+            || (id = OCSP_CERTID_dup(e->id)) == NULL)
+        goto end;
+    if (OCSP_request_add0_id(req, id) == NULL) {
+        OCSP_CERTID_free(id);
+        goto end;
+    }
+    reqbio = ASN1_item_i2d_mem_bio(ASN1_ITEM_rptr(OCSP_REQUEST),
+                                   (const ASN1_VALUE *)req);
+    if (reqbio == NULL)
+        goto end;
+
+    rspbio = OSSL_HTTP_transfer(NULL, host, port, path, 0, NULL, NULL,
+                                NULL, NULL, NULL, NULL, 0, NULL,
+                                "application/ocsp-request", reqbio,
+                                "application/ocsp-response", 1,
+                                OSSL_HTTP_DEFAULT_MAX_RESP_LEN,
+                                STAPLE_HTTP_TIMEOUT, 0);
+    if (rspbio != NULL)
+        resp = (OCSP_RESPONSE *)ASN1_item_d2i_bio(ASN1_ITEM_rptr(OCSP_RESPONSE),
+                                                  rspbio, NULL);
+
+ end:
+    BIO_free(rspbio);
+    BIO_free(reqbio);
+    OCSP_REQUEST_free(req);
+    OPENSSL_free(host);
+    OPENSSL_free(port);
+    OPENSSL_free(path);
+    return resp;
+# else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return NULL;
+# endif
+}
+
+static OCSP_RESPONSE *stapler_fetch(OSSL_OCSP_STAPLER *st, STAPLE_ENTRY *e)
+{
+    OCSP_RESPONSE *resp = NULL;
+    BIO *in;
+
+    if (e->url != NULL)
+        return stapler_fetch_http(e);
+
+    /* The file is read again each time so that it can be replaced */
+    if ((in = BIO_new_file(st->file, "rb")) == NULL)
+        return NULL;
+    resp = d2i_OCSP_RESPONSE_bio(in, NULL);
+    BIO_free(in);
+    return resp;
+}
+
+/*
+ * Check that |resp| is a current response for the certificate of |e| and
+ * make a staple of it. On success |*refresh| is set to the number of seconds
+ * after which a new response should be fetched.
+ */
+static OSSL_OCSP_STAPLE *stapler_make(STAPLE_ENTRY *e, OCSP_RESPONSE *resp,
+                                      int64_t *refresh)
+{
+    OCSP_BASICRESP *bs = NULL;
+    OSSL_OCSP_STAPLE *staple = NULL;
+    ASN1_GENERALIZEDTIME *thisupd, *nextupd;
+    int status, reason, len, day, sec;
+    int64_t left;
+
+    if (OCSP_response_status(resp) != OCSP_RESPONSE_STATUS_SUCCESSFUL
+            || (bs = OCSP_response_get1_basic(resp)) == NULL
+            || !OCSP_resp_find_status(bs, e->id, &status, &reason, NULL,
+                                      &thisupd, &nextupd)
+            || !OCSP_check_validity(thisupd, nextupd, STAPLE_VALIDITY_SKEW, -1)
+            || (nextupd != NULL && !ASN1_TIME_diff(&day, &sec, NULL, nextupd))) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_STATUS_RESPONSE);
+        goto err;
+    }
+
+    if ((staple = OPENSSL_zalloc(sizeof(*staple))) == NULL)
+        goto err;
+    if (!CRYPTO_NEW_REF(&staple->references, 1)) {
+        OPENSSL_free(staple);
+        staple = NULL;
+        goto err;
+    }
+    if ((len = i2d_OCSP_RESPONSE(resp, &staple->der)) <= 0) {
+        ossl_ocsp_staple_free(staple);
+        staple = NULL;
+        goto err;
+    }
+    staple->len = (size_t)len;
+
+    if (nextupd != NULL) {
+        left = (int64_t)day * 86400 + sec;
+        if (left < 0)
+            left = 0;
+        staple->expires = ossl_time_add(ossl_time_now(),
+                                        ossl_seconds2time(left));
+        /* Ask again half way through the remaining validity */
+        *refresh = left / 2;
+        if (*refresh < STAPLE_REFRESH_MIN)
+            *refresh = STAPLE_REFRESH_MIN;
+    } else {
+        *refresh = STAPLE_REFRESH_DEFAULT;
+    }
+
+ err:
+    OCSP_BASICRESP_free(bs);
+    return staple;
+}
+
+/*
+ * Schedule the next fetch for |e| in |secs| seconds, give or take 10% so
+ * that servers started together do not ask the responder at the same time.
+ */
+static void stapler_schedule(OSSL_OCSP_STAPLER *st, STAPLE_ENTRY *e,
+                             int64_t secs)
+{
+    int64_t jitter = secs / 10;
+    uint32_t r;
+
+    if (jitter > 86400)
+        jitter = 86400;
+    if (jitter > 0
+            && RAND_bytes_ex(st->libctx, (unsigned char *)&r, sizeof(r), 0) > 0)
+        secs += (int64_t)(r % (uint32_t)(2 * jitter + 1)) - jitter;
+    e->refresh = ossl_time_add(ossl_time_now(), ossl_seconds2time(secs));
+}
+
+/*
+ * Fetch a new response for |e|. The current staple is kept on failure, it is
+ * no longer sent once it has expired.
+ */
+static int stapler_update(OSSL_OCSP_STAPLER *st, STAPLE_ENTRY *e)
+{
+    OCSP_RESPONSE *resp;
+    OSSL_OCSP_STAPLE *staple = NULL, *old = NULL;
+    int64_t secs = 0;
+
+    if ((resp = stapler_fetch(st, e)) != NULL)
+        staple = stapler_make(e, resp, &secs);
+    else
+        ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_STATUS_RESPONSE);
+    OCSP_RESPONSE_free(resp);
+
+    if (!CRYPTO_THREAD_write_lock(st->lock)) {
+        ossl_ocsp_staple_free(staple);
+        return 0;
+    }
+    if (staple != NULL) {
+        old = e->staple;
+        e->staple = staple;
+        e->failures = 0;
+    } else {
+        secs = STAPLE_REFRESH_MIN << (e->failures < 6 ? e->failures : 6);
+        if (secs > STAPLE_RETRY_MAX)
+            secs = STAPLE_RETRY_MAX;
+        e->failures++;
+    }
+    stapler_schedule(st, e, secs);
+    CRYPTO_THREAD_unlock(st->lock);
+
+    ossl_ocsp_staple_free(old);
+    return staple != NULL;
+}
+
+static OSSL_TIME stapler_next_refresh(OSSL_OCSP_STAPLER *st)
+{
+    OSSL_TIME next = ossl_time_infinite();
+    size_t i;
+
+    if (!CRYPTO_THREAD_read_lock(st->lock))
+        return ossl_time_add(ossl_time_now(),
+                             ossl_seconds2time(STAPLE_REFRESH_MIN));
+    for (i = 0; i < st->num; i++)
+        next = ossl_time_min(next, st->entries[i].refresh);
+    CRYPTO_THREAD_unlock(st->lock);
+    return next;
+}
+
+static int stapler_due(OSSL_OCSP_STAPLER *st, STAPLE_ENTRY *e, OSSL_TIME now)
+{
+    int due;
+
+    if (!CRYPTO_THREAD_read_lock(st->lock))
+        return 0;
+    due = ossl_time_compare(e->refresh, now) <= 0;
+    CRYPTO_THREAD_unlock(st->lock);
+    return due;
+}
+
+static unsigned int stapler_thread_main(void *arg)
+{
+    OSSL_OCSP_STAPLER *st = arg;
+    OSSL_TIME now, next;
+    size_t i;
+
+    ossl_crypto_mutex_lock(st->mutex);
+    while (!st->stop) {
+        now = ossl_time_now();
+        next = stapler_next_refresh(st);
+        if (ossl_time_compare(next, now) > 0) {
+            ossl_crypto_condvar_wait_timeout(st->cv, st->mutex, next);
+            continue;
+        }
+
+        /* Do not hold the mutex while talking to the responder */
+        ossl_crypto_mutex_unlock(st->mutex);
+        for (i = 0; i < st->num; i++)
+            if (stapler_due(st, &st->entries[i], now))
+                stapler_update(st, &st->entries[i]);
+        /* Nobody is there to report failures to */
+        ERR_clear_error();
+        ossl_crypto_mutex_lock(st->mutex);
+    }
+    ossl_crypto_mutex_unlock(st->mutex);
+    return 1;
+}
+
+OSSL_OCSP_STAPLER *ossl_ocsp_stapler_new(SSL_CTX *ctx, const char *source,
+                                         uint64_t flags)
+{
+    OSSL_OCSP_STAPLER *st;
+    STACK_OF(OPENSSL_STRING) *aia;
+    STAPLE_ENTRY *e;
+    X509 *issuer;
+    size_t i;
+
+    if (ctx->cert == NULL) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_NO_CERTIFICATE_ASSIGNED);
+        return NULL;
+    }
+    if ((st = OPENSSL_zalloc(sizeof(*st))) == NULL)
+        return NULL;
+    st->libctx = ctx->libctx;
+    if ((st->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+    if (source != NULL && !stapler_source_is_http(source)) {
+        if (OPENSSL_strncasecmp(source, "file:", 5) == 0)
+            source += 5;
+        if ((st->file = OPENSSL_strdup(source)) == NULL)
+            goto err;
+    }
+
+    for (i = 0; i < SSL_PKEY_NUM; i++) {
+        CERT_PKEY *cpk = &ctx->cert->pkeys[i];
+
+        if (cpk->x509 == NULL)
+            continue;
+        e = &st->entries[st->num++];
+        if (!X509_up_ref(cpk->x509))
+            goto err;
+        e->cert = cpk->x509;
+
+        if ((issuer = stapler_find_issuer(ctx, cpk)) == NULL) {
+            ERR_raise(ERR_LIB_SSL, SSL_R_NO_ISSUER_CERTIFICATE);
+            goto err;
+        }
+        e->id = OCSP_cert_to_id(NULL, cpk->x509, issuer);
+        X509_free(issuer);
+        if (e->id == NULL)
+            goto err;
+
+        if (st->file != NULL)
+            continue;
+        if (source != NULL) {
+            e->url = OPENSSL_strdup(source);
+        } else {
+            aia = X509_get1_ocsp(cpk->x509);
+            if (sk_OPENSSL_STRING_num(aia) > 0)
+                e->url = OPENSSL_strdup(sk_OPENSSL_STRING_value(aia, 0));
+            X509_email_free(aia);
+            if (e->url == NULL) {
+                ERR_raise(ERR_LIB_SSL, SSL_R_NO_OCSP_RESPONDER);
+                goto err;
+            }
+        }
+        if (e->url == NULL)
+            goto err;
+    }
+    if (st->num == 0) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_NO_CERTIFICATE_ASSIGNED);
+        goto err;
+    }
+
+    /* Get the first responses now so that a bad configuration shows */
+    for (i = 0; i < st->num; i++)
+        if (!stapler_update(st, &st->entries[i]))
+            goto err;
+
+    if ((flags & SSL_OCSP_STAPLING_NO_THREAD) == 0) {
+        if ((st->mutex = ossl_crypto_mutex_new()) == NULL
+                || (st->cv = ossl_crypto_condvar_new()) == NULL
+                || (st->thread = ossl_crypto_thread_native_start(stapler_thread_main,
+                                                                 st, 1)) == NULL) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+            goto err;
+        }
+    }
+
+    return st;
+ err:
+    ossl_ocsp_stapler_free(st);
+    return NULL;
+}
+
+void ossl_ocsp_stapler_free(OSSL_OCSP_STAPLER *st)
+{
+    CRYPTO_THREAD_RETVAL rv;
+    size_t i;
+
+    if (st == NULL)
+        return;
+
+    if (st->thread != NULL) {
+        /* A fetch in progress is waited for, at most STAPLE_HTTP_TIMEOUT */
+        ossl_crypto_mutex_lock(st->mutex);
+        st->stop = 1;
+        ossl_crypto_condvar_signal(st->cv);
+        ossl_crypto_mutex_unlock(st->mutex);
+        ossl_crypto_thread_native_join(st->thread, &rv);
+        ossl_crypto_thread_native_clean(st->thread);
+    }
+    ossl_crypto_condvar_free(&st->cv);
+    ossl_crypto_mutex_free(&st->mutex);
+
+    for (i = 0; i < st->num; i++) {
+        X509_free(st->entries[i].cert);
+        OCSP_CERTID_free(st->entries[i].id);
+        OPENSSL_free(st->entries[i].url);
+        ossl_ocsp_staple_free(st->entries[i].staple);
+    }
+    OPENSSL_free(st->file);
+    CRYPTO_THREAD_lock_free(st->lock);
+    OPENSSL_free(st);
+}
+
+int ossl_ocsp_stapler_refresh(OSSL_OCSP_STAPLER *st)
+{
+    size_t i;
+    int ret = 1;
+
+    for (i = 0; i < st->num; i++)
+        if (!stapler_update(st, &st->entries[i]))
+            ret = 0;
+
+    if (st->thread != NULL) {
+        /* The next refresh of the background thread has moved */
+        ossl_crypto_mutex_lock(st->mutex);
+        ossl_crypto_condvar_signal(st->cv);
+        ossl_crypto_mutex_unlock(st->mutex);
+    }
+    return ret;
+}
+
+OSSL_OCSP_STAPLE *ossl_ocsp_stapler_get1(OSSL_OCSP_STAPLER *st, X509 *x)
+{
+    OSSL_OCSP_STAPLE *staple = NULL;
+    STAPLE_ENTRY *e;
+    size_t i;
+    int ref;
+
+    if (x == NULL || !CRYPTO_THREAD_read_lock(st->lock))
+        return NULL;
+    for (i = 0; i < st->num; i++) {
+        e = &st->entries[i];
+        if (e->cert != x && X509_cmp(e->cert, x) != 0)
+            continue;
+        if (e->staple != NULL
+                && (ossl_time_is_zero(e->staple->expires)
+                    || ossl_time_compare(ossl_time_now(),
+                                         e->staple->expires) < 0)
+                && CRYPTO_UP_REF(&e->staple->references, &ref))
+            staple = e->staple;
+        break;
+    }
+    CRYPTO_THREAD_unlock(st->lock);
+    return staple;
+}
+
+#endif
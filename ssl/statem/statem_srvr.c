@@ -2185,6 +2185,17 @@ static int tls_handle_status_request(SSL_CONNECTION *s)
             }
         }
     }
+#ifndef OPENSSL_NO_OCSP
+    else if (s->ext.status_type != TLSEXT_STATUSTYPE_nothing && sctx != NULL
+             && sctx->ocsp_stapler != NULL && s->s3.tmp.cert != NULL) {
+        /* Staple the cached response for the certificate we will send */
+        ossl_ocsp_staple_free(s->ext.ocsp.staple);
+        s->ext.ocsp.staple = ossl_ocsp_stapler_get1(sctx->ocsp_stapler,
+                                                    s->s3.tmp.cert->x509);
+        if (s->ext.ocsp.staple != NULL)
+            s->ext.status_expected = 1;
+    }
+#endif
 
     return 1;
 }
@@ -4307,9 +4318,17 @@ CON_FUNC_RETURN tls_construct_new_session_ticket(SSL_CONNECTION *s, WPACKET *pkt
  */
 int tls_construct_cert_status_body(SSL_CONNECTION *s, WPACKET *pkt)
 {
+    const unsigned char *resp = s->ext.ocsp.resp;
+    size_t resp_len = s->ext.ocsp.resp_len;
+
+#ifndef OPENSSL_NO_OCSP
+    if (resp == NULL && s->ext.ocsp.staple != NULL) {
+        resp = s->ext.ocsp.staple->der;
+        resp_len = s->ext.ocsp.staple->len;
+    }
+#endif
     if (!WPACKET_put_bytes_u8(pkt, s->ext.status_type)
-            || !WPACKET_sub_memcpy_u24(pkt, s->ext.ocsp.resp,
-                                       s->ext.ocsp.resp_len)) {
+            || !WPACKET_sub_memcpy_u24(pkt, resp, resp_len)) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
         return 0;
     }
@@ -13,7 +13,10 @@
 #include <openssl/rand.h>
 #include <openssl/asn1.h>
 #include <openssl/asn1t.h>
+#include <openssl/err.h>
 #include <openssl/obj_mac.h>
+#include <openssl/evp.h>
+#include <openssl/x509v3.h>
 #include "internal/numbers.h"
 #include "testutil.h"
 
@@ -233,6 +236,40 @@ static unsigned char t_invalid_template[] = {
     0x0c, 0x01, 0x41             /* UTF8String, length 1, "A" */
 };
 
+/* GENERAL_NAMES holding the dNSName "ab", as SEQUENCE OF and primitive */
+static const unsigned char t_general_names[] = {
+    0x30, 0x04, 0x82, 0x02, 0x61, 0x62
+};
+static const unsigned char t_general_names_primitive[] = {
+    0x10, 0x04, 0x82, 0x02, 0x61, 0x62
+};
+
+/* X.690 8.10.1 and 8.12.1: SET OF and SEQUENCE OF must be constructed */
+static int test_primitive_sequence_of(void)
+{
+    GENERAL_NAMES *gens = NULL;
+    const unsigned char *p = t_general_names;
+    int ret = 0;
+
+    if (!TEST_ptr(gens = d2i_GENERAL_NAMES(NULL, &p, sizeof(t_general_names)))
+        || !TEST_int_eq(sk_GENERAL_NAME_num(gens), 1))
+        goto err;
+    GENERAL_NAMES_free(gens);
+
+    p = t_general_names_primitive;
+    ERR_clear_error();
+    if (!TEST_ptr_null(gens = d2i_GENERAL_NAMES(NULL, &p,
+                                                sizeof(t_general_names_primitive)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_error()),
+                        ASN1_R_TYPE_NOT_CONSTRUCTED))
+        goto err;
+
+    ret = 1;
+ err:
+    GENERAL_NAMES_free(gens);
+    return ret;
+}
+
 static int test_invalid_template(void)
 {
     const unsigned char *p = t_invalid_template;
@@ -271,6 +308,539 @@ err:
     return ret;
 }
 
+/* Arena decoder *********************************************************** */
+
+typedef struct arena_test_st ARENA_TEST;
+
+static const ASN1_ITEM *ARENA_TEST_it(void);
+
+struct arena_test_st {
+    ASN1_INTEGER *num;
+    ASN1_BOOLEAN flag;
+    ASN1_OBJECT *oid;
+    ASN1_UTF8STRING *label;
+    STACK_OF(ASN1_INTEGER) *list;
+    ASN1_BIT_STRING *bits;
+    ASN1_STRING *dirstr;
+    ASN1_TYPE *any;
+    ASN1_OCTET_STRING octets;
+    GENERAL_NAME *name;
+    ARENA_TEST *next;
+};
+
+ASN1_SEQUENCE(ARENA_TEST) = {
+    ASN1_SIMPLE(ARENA_TEST, num, ASN1_INTEGER),
+    ASN1_OPT(ARENA_TEST, flag, ASN1_TBOOLEAN),
+    ASN1_SIMPLE(ARENA_TEST, oid, ASN1_OBJECT),
+    ASN1_EXP_OPT(ARENA_TEST, label, ASN1_UTF8STRING, 0),
+    ASN1_IMP_SEQUENCE_OF_OPT(ARENA_TEST, list, ASN1_INTEGER, 1),
+    ASN1_SIMPLE(ARENA_TEST, bits, ASN1_BIT_STRING),
+    ASN1_SIMPLE(ARENA_TEST, dirstr, DIRECTORYSTRING),
+    ASN1_SIMPLE(ARENA_TEST, any, ASN1_ANY),
+    ASN1_EMBED(ARENA_TEST, octets, ASN1_OCTET_STRING),
+    ASN1_OPT(ARENA_TEST, name, GENERAL_NAME),
+    ASN1_EXP_OPT(ARENA_TEST, next, ARENA_TEST, 9)
+} static_ASN1_SEQUENCE_END(ARENA_TEST)
+
+/* Every field present, with a nested ARENA_TEST */
+static const unsigned char t_arena_full[] = {
+    0x30, 0x49, 0x02, 0x02, 0xff, 0x7f, 0x01, 0x01, 0x00, 0x06, 0x03, 0x55,
+    0x04, 0x03, 0xa0, 0x04, 0x0c, 0x02, 0x68, 0x69, 0xa1, 0x07, 0x02, 0x01,
+    0x01, 0x02, 0x02, 0x01, 0x00, 0x03, 0x02, 0x03, 0xa8, 0x13, 0x02, 0x43,
+    0x41, 0x30, 0x02, 0x05, 0x00, 0x04, 0x02, 0x61, 0x62, 0x82, 0x05, 0x78,
+    0x2e, 0x63, 0x6f, 0x6d, 0xa9, 0x15, 0x30, 0x13, 0x02, 0x01, 0x00, 0x06,
+    0x04, 0x2a, 0x03, 0x04, 0x05, 0x03, 0x01, 0x00, 0x0c, 0x01, 0x7a, 0x05,
+    0x00, 0x04, 0x00
+};
+
+/* No OPTIONAL fields, a context specific tag as ANY */
+static const unsigned char t_arena_minimal[] = {
+    0x30, 0x13, 0x02, 0x01, 0x05, 0x06, 0x03, 0x55, 0x04, 0x03, 0x03, 0x01,
+    0x00, 0x0c, 0x01, 0x7a, 0x85, 0x01, 0x00, 0x04, 0x00
+};
+
+/* dNSName, iPAddress and directoryName */
+static const unsigned char t_arena_names[] = {
+    0x30, 0x1d, 0x82, 0x05, 0x78, 0x2e, 0x63, 0x6f, 0x6d, 0x87, 0x04, 0x7f,
+    0x00, 0x00, 0x01, 0xa4, 0x0e, 0x30, 0x0c, 0x31, 0x0a, 0x30, 0x08, 0x06,
+    0x03, 0x55, 0x04, 0x03, 0x0c, 0x01, 0x61
+};
+
+/* A critical basicConstraints extension */
+static const unsigned char t_arena_exts[] = {
+    0x30, 0x0e, 0x30, 0x0c, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff,
+    0x04, 0x02, 0x30, 0x00
+};
+
+/*
+ * Decodes |der| into |arena| and with ASN1_item_d2i() and checks that both
+ * encode back to |expect|.
+ */
+static ASN1_VALUE *arena_decode(ASN1_ARENA *arena, const ASN1_ITEM *it,
+                                const unsigned char *der, long len,
+                                const unsigned char *expect, long explen)
+{
+    const unsigned char *p = der;
+    ASN1_VALUE *val, *ref = NULL;
+    unsigned char *enc = NULL, *refenc = NULL;
+    int enclen, refenclen;
+
+    if (!TEST_ptr(val = ASN1_item_d2i_arena(arena, &p, len, it))
+        || !TEST_ptr_eq(p, der + len)
+        || !TEST_int_gt(enclen = ASN1_item_i2d(val, &enc, it), 0)
+        || !TEST_mem_eq(enc, enclen, expect, explen))
+        val = NULL;
+
+    p = der;
+    if (val != NULL
+        && (!TEST_ptr(ref = ASN1_item_d2i(NULL, &p, len, it))
+            || !TEST_int_gt(refenclen = ASN1_item_i2d(ref, &refenc, it), 0)
+            || !TEST_mem_eq(enc, enclen, refenc, refenclen)))
+        val = NULL;
+
+    OPENSSL_free(enc);
+    OPENSSL_free(refenc);
+    ASN1_item_free(ref, it);
+    return val;
+}
+
+static int test_arena_decode(void)
+{
+    ASN1_ARENA *arena = NULL;
+    ARENA_TEST *full, *min;
+    GENERAL_NAMES *names;
+    X509_EXTENSIONS *exts;
+    X509_EXTENSION *ext;
+    long num;
+    int i, ret = 0;
+
+    if (!TEST_ptr(arena = ASN1_ARENA_new()))
+        return 0;
+
+    /* Decode several times to make sure the arena can be reused */
+    for (i = 0; i < 3; i++) {
+        full = (ARENA_TEST *)arena_decode(arena, ASN1_ITEM_rptr(ARENA_TEST),
+                                          t_arena_full, sizeof(t_arena_full),
+                                          t_arena_full, sizeof(t_arena_full));
+        min = (ARENA_TEST *)arena_decode(arena, ASN1_ITEM_rptr(ARENA_TEST),
+                                         t_arena_minimal,
+                                         sizeof(t_arena_minimal),
+                                         t_arena_minimal,
+                                         sizeof(t_arena_minimal));
+        names = (GENERAL_NAMES *)
+            arena_decode(arena, ASN1_ITEM_rptr(GENERAL_NAMES), t_arena_names,
+                         sizeof(t_arena_names), t_arena_names,
+                         sizeof(t_arena_names));
+        exts = (X509_EXTENSIONS *)
+            arena_decode(arena, ASN1_ITEM_rptr(X509_EXTENSIONS), t_arena_exts,
+                         sizeof(t_arena_exts), t_arena_exts,
+                         sizeof(t_arena_exts));
+        if (!TEST_ptr(full) || !TEST_ptr(min) || !TEST_ptr(names)
+            || !TEST_ptr(exts))
+            goto err;
+
+        if (!TEST_true(ASN1_INTEGER_get_int64(&num, full->num))
+            || !TEST_long_eq(num, -129)
+            || !TEST_int_eq(full->flag, 0)
+            || !TEST_int_eq(OBJ_obj2nid(full->oid), NID_commonName)
+            || !TEST_int_eq(sk_ASN1_INTEGER_num(full->list), 2)
+            || !TEST_int_eq(ASN1_STRING_type(full->dirstr),
+                            V_ASN1_PRINTABLESTRING)
+            || !TEST_int_eq(ASN1_TYPE_get(full->any), V_ASN1_SEQUENCE)
+            || !TEST_mem_eq(ASN1_STRING_get0_data(&full->octets),
+                            ASN1_STRING_length(&full->octets), "ab", 2)
+            || !TEST_int_eq(full->name->type, GEN_DNS)
+            || !TEST_ptr(full->next)
+            || !TEST_ptr_null(full->next->next)
+            || !TEST_int_eq(full->next->flag, 1)
+            || !TEST_int_eq(OBJ_obj2nid(full->next->oid), NID_undef)
+            || !TEST_int_eq(min->flag, 1)
+            || !TEST_ptr_null(min->label)
+            || !TEST_ptr_null(min->list)
+            || !TEST_int_eq(ASN1_TYPE_get(min->any), V_ASN1_OTHER)
+            || !TEST_ptr_null(min->name)
+            || !TEST_int_eq(sk_GENERAL_NAME_num(names), 3)
+            || !TEST_int_eq(sk_GENERAL_NAME_value(names, 2)->type, GEN_DIRNAME)
+            || !TEST_int_eq(sk_X509_EXTENSION_num(exts), 1)
+            || !TEST_ptr(ext = sk_X509_EXTENSION_value(exts, 0))
+            || !TEST_true(X509_EXTENSION_get_critical(ext))
+            || !TEST_int_eq(OBJ_obj2nid(X509_EXTENSION_get_object(ext)),
+                            NID_basic_constraints))
+            goto err;
+
+        ASN1_ARENA_reset(arena);
+    }
+    ret = 1;
+ err:
+    ASN1_ARENA_free(arena);
+    return ret;
+}
+
+static int test_arena_decode_errors(void)
+{
+    static const unsigned char missing[] = { 0x30, 0x03, 0x02, 0x01, 0x05 };
+    unsigned char buf[sizeof(t_arena_minimal) + 2];
+    unsigned char full[sizeof(t_arena_full)];
+    const unsigned char *p;
+    ASN1_ARENA *arena = NULL;
+    int ret = 0;
+
+    if (!TEST_ptr(arena = ASN1_ARENA_new()))
+        return 0;
+
+    p = missing;
+    if (!TEST_ptr_null(ASN1_item_d2i_arena(arena, &p, sizeof(missing),
+                                           ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                        ASN1_R_FIELD_MISSING))
+        goto err;
+
+    /* An INTEGER in place of the OBJECT IDENTIFIER */
+    memcpy(buf, t_arena_minimal, sizeof(t_arena_minimal));
+    buf[5] = V_ASN1_INTEGER;
+    p = buf;
+    ERR_clear_error();
+    if (!TEST_ptr_null(ASN1_item_d2i_arena(arena, &p, sizeof(t_arena_minimal),
+                                           ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()), ASN1_R_WRONG_TAG))
+        goto err;
+
+    /* More than 7 unused bits in the BIT STRING */
+    memcpy(buf, t_arena_minimal, sizeof(t_arena_minimal));
+    buf[12] = 8;
+    p = buf;
+    ERR_clear_error();
+    if (!TEST_ptr_null(ASN1_item_d2i_arena(arena, &p, sizeof(t_arena_minimal),
+                                           ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                        ASN1_R_INVALID_BIT_STRING_BITS_LEFT))
+        goto err;
+
+    /* A NULL following the last field */
+    memcpy(buf, t_arena_minimal, sizeof(t_arena_minimal));
+    buf[1] += 2;
+    buf[sizeof(t_arena_minimal)] = V_ASN1_NULL;
+    buf[sizeof(t_arena_minimal) + 1] = 0;
+    p = buf;
+    ERR_clear_error();
+    if (!TEST_ptr_null(ASN1_item_d2i_arena(arena, &p, sizeof(buf),
+                                           ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                        ASN1_R_SEQUENCE_LENGTH_MISMATCH))
+        goto err;
+
+    /* A primitive SEQUENCE OF, which neither decoder accepts */
+    memcpy(full, t_arena_full, sizeof(t_arena_full));
+    full[20] = V_ASN1_CONTEXT_SPECIFIC | 1;
+    p = full;
+    ERR_clear_error();
+    if (!TEST_ptr_null(ASN1_item_d2i_arena(arena, &p, sizeof(full),
+                                           ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_error()),
+                        ASN1_R_TYPE_NOT_CONSTRUCTED))
+        goto err;
+    p = full;
+    ERR_clear_error();
+    if (!TEST_ptr_null(ASN1_item_d2i(NULL, &p, sizeof(full),
+                                     ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_error()),
+                        ASN1_R_TYPE_NOT_CONSTRUCTED))
+        goto err;
+
+    /* Indefinite length encodings are left to ASN1_item_d2i() */
+    memcpy(buf, t_arena_minimal, sizeof(t_arena_minimal));
+    buf[1] = 0x80;
+    buf[sizeof(t_arena_minimal)] = 0;
+    buf[sizeof(t_arena_minimal) + 1] = 0;
+    if (!TEST_ptr(arena_decode(arena, ASN1_ITEM_rptr(ARENA_TEST), buf,
+                               sizeof(buf), t_arena_minimal,
+                               sizeof(t_arena_minimal))))
+        goto err;
+
+    ret = 1;
+ err:
+    ERR_clear_error();
+    ASN1_ARENA_free(arena);
+    return ret;
+}
+
+/*
+ * A CHOICE whose NEW_PRE callback allocates it, which makes the arena decoder
+ * hand it to ASN1_item_d2i() once it sees the callback do so
+ */
+typedef struct {
+    int type;
+    union {
+        ASN1_INTEGER *num;
+        ASN1_UTF8STRING *str;
+    } value;
+} ARENA_CHOICE;
+
+DECLARE_ASN1_ITEM(ARENA_CHOICE)
+
+static int arena_choice_cb(int operation, ASN1_VALUE **pval,
+                           const ASN1_ITEM *it, void *exarg)
+{
+    if (operation != ASN1_OP_NEW_PRE)
+        return 1;
+    if ((*pval = OPENSSL_zalloc(sizeof(ARENA_CHOICE))) == NULL)
+        return 0;
+    ((ARENA_CHOICE *)*pval)->type = -1;
+    return 2;
+}
+
+ASN1_CHOICE_cb(ARENA_CHOICE, arena_choice_cb) = {
+    ASN1_SIMPLE(ARENA_CHOICE, value.num, ASN1_INTEGER),
+    ASN1_SIMPLE(ARENA_CHOICE, value.str, ASN1_UTF8STRING)
+} ASN1_CHOICE_END_cb(ARENA_CHOICE, ARENA_CHOICE, type)
+
+typedef struct {
+    ASN1_INTEGER *num;
+    ARENA_CHOICE *choice;
+} ARENA_OUTER;
+
+ASN1_SEQUENCE(ARENA_OUTER) = {
+    ASN1_SIMPLE(ARENA_OUTER, num, ASN1_INTEGER),
+    ASN1_SIMPLE(ARENA_OUTER, choice, ARENA_CHOICE)
+} static_ASN1_SEQUENCE_END(ARENA_OUTER)
+
+static int test_arena_decode_choice(void)
+{
+    /* The INTEGER 5 followed by the UTF8String "hi" */
+    static const unsigned char der[] = {
+        0x30, 0x07, 0x02, 0x01, 0x05, 0x0c, 0x02, 0x68, 0x69
+    };
+    ASN1_ARENA *arena = NULL;
+    ARENA_OUTER *outer;
+    int i, ret = 0;
+
+    if (!TEST_ptr(arena = ASN1_ARENA_new()))
+        return 0;
+
+    /* The first time finds out that it must delegate, the others know */
+    for (i = 0; i < 3; i++) {
+        outer = (ARENA_OUTER *)arena_decode(arena, ASN1_ITEM_rptr(ARENA_OUTER),
+                                            der, sizeof(der), der,
+                                            sizeof(der));
+        if (!TEST_ptr(outer)
+            || !TEST_ptr(outer->choice)
+            || !TEST_int_eq(outer->choice->type, 1)
+            || !TEST_mem_eq(ASN1_STRING_get0_data(outer->choice->value.str),
+                            ASN1_STRING_length(outer->choice->value.str),
+                            "hi", 2))
+            goto err;
+        ASN1_ARENA_reset(arena);
+    }
+    ret = 1;
+ err:
+    ASN1_ARENA_free(arena);
+    return ret;
+}
+
+/* Returns a self signed certificate and a CRL with two entries */
+static int arena_cert_crl(EVP_PKEY *pkey, X509 **cert, X509_CRL **crl)
+{
+    X509 *x = NULL;
+    X509_CRL *c = NULL;
+    X509_NAME *name;
+    X509_REVOKED *rev;
+    BASIC_CONSTRAINTS *bc = NULL;
+    ASN1_TIME *now = NULL;
+    ASN1_ENUMERATED *reason = NULL;
+    ASN1_INTEGER *serial = NULL;
+    int i, ret = 0;
+
+    if (!TEST_ptr(x = X509_new())
+        || !TEST_true(X509_set_version(x, X509_VERSION_3))
+        || !TEST_true(ASN1_INTEGER_set(X509_get_serialNumber(x), 1))
+        || !TEST_ptr(name = X509_get_subject_name(x))
+        || !TEST_true(X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                                 (unsigned char *)"arena",
+                                                 -1, -1, 0))
+        || !TEST_true(X509_set_issuer_name(x, name))
+        || !TEST_ptr(X509_gmtime_adj(X509_getm_notBefore(x), 0))
+        || !TEST_ptr(X509_gmtime_adj(X509_getm_notAfter(x), 86400))
+        || !TEST_true(X509_set_pubkey(x, pkey))
+        || !TEST_ptr(bc = BASIC_CONSTRAINTS_new()))
+        goto err;
+    bc->ca = 1;
+    if (!TEST_true(X509_add1_ext_i2d(x, NID_basic_constraints, bc, 1, 0))
+        || !TEST_int_gt(X509_sign(x, pkey, EVP_sha256()), 0))
+        goto err;
+
+    if (!TEST_ptr(c = X509_CRL_new())
+        || !TEST_true(X509_CRL_set_version(c, X509_CRL_VERSION_2))
+        || !TEST_true(X509_CRL_set_issuer_name(c, name))
+        || !TEST_ptr(now = X509_gmtime_adj(NULL, 0))
+        || !TEST_true(X509_CRL_set1_lastUpdate(c, now))
+        || !TEST_ptr(reason = ASN1_ENUMERATED_new())
+        || !TEST_true(ASN1_ENUMERATED_set(reason, CRL_REASON_KEY_COMPROMISE))
+        || !TEST_ptr(serial = ASN1_INTEGER_new()))
+        goto err;
+    for (i = 2; i <= 3; i++) {
+        if (!TEST_ptr(rev = X509_REVOKED_new()))
+            goto err;
+        if (!TEST_true(ASN1_INTEGER_set(serial, i))
+            || !TEST_true(X509_REVOKED_set_serialNumber(rev, serial))
+            || !TEST_true(X509_REVOKED_set_revocationDate(rev, now))
+            || !TEST_true(X509_REVOKED_add1_ext_i2d(rev, NID_crl_reason,
+                                                    reason, 0, 0))
+            || !TEST_true(X509_CRL_add0_revoked(c, rev))) {
+            X509_REVOKED_free(rev);
+            goto err;
+        }
+    }
+    if (!TEST_int_gt(X509_CRL_sign(c, pkey, EVP_sha256()), 0))
+        goto err;
+
+    *cert = x;
+    *crl = c;
+    x = NULL;
+    c = NULL;
+    ret = 1;
+ err:
+    X509_free(x);
+    X509_CRL_free(c);
+    BASIC_CONSTRAINTS_free(bc);
+    ASN1_TIME_free(now);
+    ASN1_ENUMERATED_free(reason);
+    ASN1_INTEGER_free(serial);
+    return ret;
+}
+
+/*
+ * X509 and X509_CRL have callbacks and reference counts, the arena decoder
+ * must run the callbacks and leave the result usable with the functions for
+ * the types that only look at it.
+ */
+static int test_arena_decode_x509(void)
+{
+    ASN1_ARENA *arena = NULL;
+    EVP_PKEY *pkey = NULL;
+    X509 *cert = NULL, *x, *xcopy = NULL;
+    X509_CRL *crl = NULL, *c, *ccopy = NULL;
+    X509_REVOKED *rev;
+    ASN1_INTEGER *serial = NULL;
+    unsigned char *certder = NULL, *crlder = NULL;
+    int certlen, crllen, i, ret = 0;
+
+    if (!TEST_ptr(arena = ASN1_ARENA_new())
+        || !TEST_ptr(pkey = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256"))
+        || !arena_cert_crl(pkey, &cert, &crl)
+        || !TEST_int_gt(certlen = i2d_X509(cert, &certder), 0)
+        || !TEST_int_gt(crllen = i2d_X509_CRL(crl, &crlder), 0)
+        || !TEST_ptr(serial = ASN1_INTEGER_new())
+        || !TEST_true(ASN1_INTEGER_set(serial, 3)))
+        goto err;
+
+    for (i = 0; i < 3; i++) {
+        x = (X509 *)arena_decode(arena, ASN1_ITEM_rptr(X509), certder, certlen,
+                                 certder, certlen);
+        c = (X509_CRL *)arena_decode(arena, ASN1_ITEM_rptr(X509_CRL), crlder,
+                                     crllen, crlder, crllen);
+        if (!TEST_ptr(x) || !TEST_ptr(c)
+            || !TEST_int_eq(X509_verify(x, pkey), 1)
+            || !TEST_int_eq(X509_check_ca(x), 1)
+            || !TEST_int_eq(X509_cmp(x, cert), 0)
+            || !TEST_int_eq(X509_CRL_verify(c, pkey), 1)
+            || !TEST_int_eq(sk_X509_REVOKED_num(X509_CRL_get_REVOKED(c)), 2)
+            || !TEST_int_eq(X509_CRL_get0_by_serial(c, &rev, serial), 1)
+            || !TEST_int_eq(ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(rev),
+                                             serial), 0)
+            || !TEST_int_eq(X509_CRL_get0_by_cert(c, &rev, x), 0)
+            || !TEST_false(X509_up_ref(x))
+            || !TEST_false(X509_CRL_up_ref(c))
+            || !TEST_ptr(xcopy = X509_dup(x))
+            || !TEST_ptr(ccopy = X509_CRL_dup(c)))
+            goto err;
+        ASN1_ARENA_reset(arena);
+        /* The copies outlive the arena and can be shared */
+        if (!TEST_int_eq(X509_cmp(xcopy, cert), 0)
+            || !TEST_int_eq(X509_CRL_verify(ccopy, pkey), 1)
+            || !TEST_true(X509_up_ref(xcopy))
+            || !TEST_true(X509_CRL_up_ref(ccopy)))
+            goto err;
+        X509_free(xcopy);
+        X509_free(xcopy);
+        X509_CRL_free(ccopy);
+        X509_CRL_free(ccopy);
+        xcopy = NULL;
+        ccopy = NULL;
+    }
+    ret = 1;
+ err:
+    ASN1_ARENA_free(arena);
+    X509_free(xcopy);
+    X509_CRL_free(ccopy);
+    ASN1_INTEGER_free(serial);
+    OPENSSL_free(certder);
+    OPENSSL_free(crlder);
+    X509_free(cert);
+    X509_CRL_free(crl);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+/* Wraps |t_arena_minimal| in |levels| ARENA_TESTs */
+static unsigned char *arena_nest(int levels, long *len)
+{
+    unsigned char *der, *p;
+    long inner = sizeof(t_arena_minimal), seq;
+    int i;
+
+    /* Every level adds at most 12 header bytes and the minimal fields */
+    if ((der = OPENSSL_malloc(levels * (sizeof(t_arena_minimal) + 12)
+                              + sizeof(t_arena_minimal))) == NULL)
+        return NULL;
+    memcpy(der, t_arena_minimal, inner);
+
+    for (i = 0; i < levels; i++) {
+        seq = (sizeof(t_arena_minimal) - 2) + ASN1_object_size(1, inner, 9);
+        p = der + ASN1_object_size(1, seq, V_ASN1_SEQUENCE) - inner;
+        memmove(p, der, inner);
+        p = der;
+        ASN1_put_object(&p, 1, seq, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL);
+        memcpy(p, t_arena_minimal + 2, sizeof(t_arena_minimal) - 2);
+        p += sizeof(t_arena_minimal) - 2;
+        ASN1_put_object(&p, 1, inner, 9, V_ASN1_CONTEXT_SPECIFIC);
+        inner = ASN1_object_size(1, seq, V_ASN1_SEQUENCE);
+    }
+    *len = inner;
+    return der;
+}
+
+static int test_arena_decode_nesting(void)
+{
+    ASN1_ARENA *arena = NULL;
+    const unsigned char *p;
+    unsigned char *der = NULL;
+    long len = 0;
+    int ret = 0;
+
+    if (!TEST_ptr(arena = ASN1_ARENA_new())
+        || !TEST_ptr(der = arena_nest(25, &len))
+        || !TEST_ptr(arena_decode(arena, ASN1_ITEM_rptr(ARENA_TEST), der, len,
+                                  der, len)))
+        goto err;
+    OPENSSL_free(der);
+
+    if (!TEST_ptr(der = arena_nest(40, &len)))
+        goto err;
+    p = der;
+    if (!TEST_ptr_null(ASN1_item_d2i_arena(arena, &p, len,
+                                           ASN1_ITEM_rptr(ARENA_TEST)))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                        ASN1_R_NESTED_TOO_DEEP))
+        goto err;
+
+    ret = 1;
+ err:
+    ERR_clear_error();
+    OPENSSL_free(der);
+    ASN1_ARENA_free(arena);
+    return ret;
+}
+
 int setup_tests(void)
 {
 #ifndef OPENSSL_NO_DEPRECATED_3_0
@@ -283,6 +853,12 @@ int setup_tests(void)
     ADD_TEST(test_gentime);
     ADD_TEST(test_utctime);
     ADD_TEST(test_invalid_template);
+    ADD_TEST(test_primitive_sequence_of);
     ADD_TEST(test_reuse_asn1_object);
+    ADD_TEST(test_arena_decode);
+    ADD_TEST(test_arena_decode_errors);
+    ADD_TEST(test_arena_decode_nesting);
+    ADD_TEST(test_arena_decode_choice);
+    ADD_TEST(test_arena_decode_x509);
     return 1;
 }
@@ -429,6 +429,66 @@ static int test_bio_base64_corner_case_bug(int idx)
     return generic_case(&t, 0);
 }
 
+/*
+ * Decodes |len| bytes of |in| in two calls of at most 63 bytes each, which
+ * keeps EVP_DecodeUpdate() from decoding whole blocks of 64 characters at
+ * once, as it does with longer input.
+ */
+static int decode_split(unsigned char *out, int *outl,
+                        const unsigned char *in, int len)
+{
+    EVP_ENCODE_CTX *ctx = EVP_ENCODE_CTX_new();
+    int first = len > 63 ? 63 : len, n1 = 0, n2 = 0, rv;
+
+    if (!TEST_ptr(ctx))
+        return -2;
+    EVP_DecodeInit(ctx);
+    rv = EVP_DecodeUpdate(ctx, out, &n1, in, first);
+    if (rv > 0)
+        rv = EVP_DecodeUpdate(ctx, out + n1, &n2, in + first, len - first);
+    *outl = n1 + n2;
+    EVP_ENCODE_CTX_free(ctx);
+    return rv;
+}
+
+/*
+ * Replaces the character at position |idx| of a line of 64 base64
+ * characters with every possible byte and checks that decoding the line in
+ * one call gives the same result as decoding it in pieces.
+ */
+static int test_decode_block(int idx)
+{
+    EVP_ENCODE_CTX *ctx = NULL;
+    unsigned char raw[48], line[65], out[64], expect[64];
+    int c, rv, exp_rv, outl, exp_outl, ret = 0;
+
+    if (!TEST_int_eq(RAND_bytes(raw, sizeof(raw)), 1)
+        || !TEST_int_eq(EVP_EncodeBlock(line, raw, sizeof(raw)), 64)
+        || !TEST_ptr(ctx = EVP_ENCODE_CTX_new()))
+        goto err;
+    line[64] = '\n';
+
+    for (c = 0; c < 256; c++) {
+        line[idx] = (unsigned char)c;
+        exp_rv = decode_split(expect, &exp_outl, line, sizeof(line));
+        if (exp_rv == -2)
+            goto err;
+        EVP_DecodeInit(ctx);
+        outl = 0;
+        rv = EVP_DecodeUpdate(ctx, out, &outl, line, sizeof(line));
+        if (!TEST_int_eq(rv, exp_rv)
+            || !TEST_int_eq(outl, exp_outl)
+            || (rv >= 0 && !TEST_mem_eq(out, outl, expect, exp_outl))) {
+            TEST_info("character 0x%02x at position %d", c, idx);
+            goto err;
+        }
+    }
+    ret = 1;
+ err:
+    EVP_ENCODE_CTX_free(ctx);
+    return ret;
+}
+
 int setup_tests(void)
 {
     int numidx;
@@ -484,5 +544,11 @@ int setup_tests(void)
     numidx = 2 * 2;
     ADD_ALL_TESTS(test_bio_base64_corner_case_bug, numidx);
 
+    /*
+     * Every byte at every position of a line that EVP_DecodeUpdate() would
+     * otherwise decode as a whole, possibly with assembler code.
+     */
+    ADD_ALL_TESTS(test_decode_block, 64);
+
     return 1;
 }
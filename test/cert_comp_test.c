@@ -243,6 +243,71 @@ static int test_ssl_cert_comp(int test)
 
     return testresult;
 }
+
+/*
+ * Contexts of the same library context share compressed certificates, so
+ * that a chain is only ever compressed once.
+ */
+static int test_ssl_cert_comp_shared(void)
+{
+    SSL_CTX *sctx1 = NULL, *sctx2 = NULL, *sctx3 = NULL;
+    SSL *ssl = NULL;
+    OSSL_LIB_CTX *libctx = NULL;
+    OSSL_COMP_CERT *cc;
+    int alg = TLSEXT_comp_cert_none;
+    int testresult = 0;
+
+#ifndef OPENSSL_NO_BROTLI
+    alg = TLSEXT_comp_cert_brotli;
+#endif
+#ifndef OPENSSL_NO_ZLIB
+    alg = TLSEXT_comp_cert_zlib;
+#endif
+#ifndef OPENSSL_NO_ZSTD
+    alg = TLSEXT_comp_cert_zstd;
+#endif
+
+    if (!TEST_ptr(libctx = OSSL_LIB_CTX_new())
+            || !TEST_true(create_ssl_ctx_pair(NULL, TLS_server_method(),
+                                              NULL, TLS1_3_VERSION, 0,
+                                              &sctx1, NULL, cert, privkey))
+            || !TEST_true(create_ssl_ctx_pair(NULL, TLS_server_method(),
+                                              NULL, TLS1_3_VERSION, 0,
+                                              &sctx2, NULL, cert, privkey))
+            || !TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                              NULL, TLS1_3_VERSION, 0,
+                                              &sctx3, NULL, cert, privkey))
+            || !TEST_true(SSL_CTX_compress_certs(sctx1, alg))
+            || !TEST_true(SSL_CTX_compress_certs(sctx2, alg))
+            || !TEST_true(SSL_CTX_compress_certs(sctx3, alg)))
+        goto end;
+
+    cc = sctx1->cert->key->comp_cert[alg];
+    if (!TEST_ptr(cc)
+            || !TEST_ptr_eq(sctx2->cert->key->comp_cert[alg], cc)
+            || !TEST_ptr_ne(sctx3->cert->key->comp_cert[alg], cc))
+        goto end;
+
+    /* Compressing again, or switching contexts, reuses the same data */
+    if (!TEST_ptr(ssl = SSL_new(sctx1))
+            || !TEST_true(SSL_compress_certs(ssl, alg))
+            || !TEST_ptr_eq(SSL_CONNECTION_FROM_SSL(ssl)->cert->key->comp_cert[alg],
+                            cc)
+            || !TEST_ptr(SSL_set_SSL_CTX(ssl, sctx2))
+            || !TEST_ptr_eq(SSL_CONNECTION_FROM_SSL(ssl)->cert->key->comp_cert[alg],
+                            cc))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(ssl);
+    SSL_CTX_free(sctx1);
+    SSL_CTX_free(sctx2);
+    SSL_CTX_free(sctx3);
+    OSSL_LIB_CTX_free(libctx);
+    return testresult;
+}
 #endif
 
 OPT_TEST_DECLARE_USAGE("certdir\n")
@@ -267,6 +332,7 @@ int setup_tests(void)
         goto err;
 
     ADD_ALL_TESTS(test_ssl_cert_comp, 4);
+    ADD_TEST(test_ssl_cert_comp_shared);
     return 1;
 
  err:
@@ -14,8 +14,10 @@
 #include <openssl/err.h>
 #include <openssl/pem.h>
 #include <openssl/x509.h>
+#include <openssl/x509v3.h>
 
 #include "testutil.h"
+#include "threadstest.h"
 
 #define PARAM_TIME 1474934400 /* Sep 27th, 2016 */
 
@@ -189,6 +191,8 @@ static const char **unknown_critical_crls[] = {
 
 static X509 *test_root = NULL;
 static X509 *test_leaf = NULL;
+/* Directory for the files of indexed CRLs */
+static const char *tmpdir = NULL;
 
 /*
  * Glue an array of strings together.  Return a BIO and put the string
@@ -432,9 +436,476 @@ static int test_reuse_crl(int idx)
     return r;
 }
 
+/*
+ * Write |crl| to the file |name| in the temporary directory in DER or PEM form
+ * and return the path of the file, which the caller must free.
+ */
+static char *write_CRL_file(X509_CRL *crl, const char *name, int pem)
+{
+    char *file = test_mk_file_path(tmpdir, name);
+    BIO *b = NULL;
+    int r = 0;
+
+    if (TEST_ptr(file) && TEST_ptr(b = BIO_new_file(file, "wb")))
+        r = pem ? PEM_write_bio_X509_CRL(b, crl) : i2d_X509_CRL_bio(b, crl);
+    BIO_free(b);
+    if (!TEST_true(r)) {
+        OPENSSL_free(file);
+        return NULL;
+    }
+    return file;
+}
+
+static int test_indexed_crl(int pem)
+{
+    char *file = NULL;
+    X509_CRL *revoked_crl = CRL_from_strings(kRevokedCRL);
+    X509_CRL *basic_crl = CRL_from_strings(kBasicCRL);
+    X509_CRL *indexed = NULL;
+    X509_REVOKED *rev = NULL;
+    unsigned char *der1 = NULL, *der2 = NULL;
+    unsigned char md1[EVP_MAX_MD_SIZE], md2[EVP_MAX_MD_SIZE];
+    unsigned int mdlen1, mdlen2;
+    BIO *out1 = NULL, *out2 = NULL;
+    char *text1 = NULL, *text2 = NULL;
+    long textlen1, textlen2;
+    int len1, len2, r = 0;
+
+    if (!TEST_ptr(revoked_crl)
+        || !TEST_ptr(basic_crl)
+        || !TEST_ptr(file = write_CRL_file(revoked_crl, pem ? "indexed_crl.pem"
+                                                            : "indexed_crl.der",
+                                           pem))
+        || !TEST_ptr(indexed = X509_CRL_load_indexed(file, NULL, NULL)))
+        goto err;
+
+    /* The indexed CRL must look exactly like the one it came from */
+    if (!TEST_int_gt(len1 = i2d_X509_CRL(revoked_crl, &der1), 0)
+        || !TEST_int_gt(len2 = i2d_X509_CRL(indexed, &der2), 0)
+        || !TEST_mem_eq(der1, len1, der2, len2)
+        || !TEST_true(X509_CRL_digest(revoked_crl, EVP_sha1(), md1, &mdlen1))
+        || !TEST_true(X509_CRL_digest(indexed, EVP_sha1(), md2, &mdlen2))
+        || !TEST_mem_eq(md1, mdlen1, md2, mdlen2)
+        || !TEST_int_eq(X509_NAME_cmp(X509_CRL_get_issuer(indexed),
+                                      X509_CRL_get_issuer(revoked_crl)), 0)
+        || !TEST_int_eq(X509_CRL_verify(indexed,
+                                        X509_get0_pubkey(test_root)), 1))
+        goto err;
+
+    if (!TEST_int_eq(X509_CRL_get0_by_cert(indexed, &rev, test_leaf), 1)
+        || !TEST_ptr(rev)
+        || !TEST_int_eq(ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(rev),
+                                         X509_get0_serialNumber(test_leaf)), 0)
+        || !TEST_int_eq(X509_CRL_get0_by_cert(indexed, NULL, test_root), 0)
+        || !TEST_int_eq(verify(test_leaf, test_root,
+                               make_CRL_stack(basic_crl, indexed),
+                               X509_V_FLAG_CRL_CHECK),
+                        X509_V_ERR_CERT_REVOKED))
+        goto err;
+
+    /* It prints the same entries */
+    if (!TEST_ptr(out1 = BIO_new(BIO_s_mem()))
+        || !TEST_ptr(out2 = BIO_new(BIO_s_mem()))
+        || !TEST_true(X509_CRL_print(out1, revoked_crl))
+        || !TEST_true(X509_CRL_print(out2, indexed)))
+        goto err;
+    textlen1 = BIO_get_mem_data(out1, &text1);
+    textlen2 = BIO_get_mem_data(out2, &text2);
+    if (!TEST_mem_eq(text1, textlen1, text2, textlen2))
+        goto err;
+
+    /* An indexed CRL without a CRL number can not take a delta */
+    if (!TEST_false(X509_CRL_set1_delta(indexed, basic_crl,
+                                        X509_get0_pubkey(test_root)))
+        || !TEST_false(X509_CRL_set1_delta(basic_crl, indexed,
+                                           X509_get0_pubkey(test_root))))
+        goto err;
+
+    r = 1;
+ err:
+    ERR_clear_error();
+    BIO_free(out1);
+    BIO_free(out2);
+    OPENSSL_free(der1);
+    OPENSSL_free(der2);
+    X509_CRL_free(indexed);
+    X509_CRL_free(basic_crl);
+    X509_CRL_free(revoked_crl);
+    OPENSSL_free(file);
+    return r;
+}
+
+static int test_indexed_critical_crl(int n)
+{
+    X509_CRL *crl = CRL_from_strings(unknown_critical_crls[n]);
+    X509_CRL *indexed = NULL;
+    char *file = NULL;
+    int r;
+
+    r = TEST_ptr(crl)
+        && TEST_ptr(file = write_CRL_file(crl, "indexed_critical.der", 0))
+        && TEST_ptr(indexed = X509_CRL_load_indexed(file, NULL, NULL))
+        && TEST_int_eq(verify(test_leaf, test_root,
+                              make_CRL_stack(indexed, NULL),
+                              X509_V_FLAG_CRL_CHECK),
+                       X509_V_ERR_UNHANDLED_CRITICAL_CRL_EXTENSION);
+    X509_CRL_free(indexed);
+    X509_CRL_free(crl);
+    OPENSSL_free(file);
+    return r;
+}
+
+/*
+ * A lookup that finds an entry that cannot be decoded, here because its
+ * reason code is not an ENUMERATED, must fail rather than report it as
+ * revoked or not revoked.
+ */
+static int test_indexed_crl_bad_entry(void)
+{
+    static const unsigned char bad_reason[] = { 0x05, 0x00 };
+    EVP_PKEY *key = NULL;
+    X509_CRL *crl = X509_CRL_new(), *indexed = NULL;
+    X509_REVOKED *rev = X509_REVOKED_new(), *found = NULL;
+    X509_EXTENSION *ext = NULL;
+    ASN1_OCTET_STRING *data = ASN1_OCTET_STRING_new();
+    ASN1_INTEGER *serial = ASN1_INTEGER_new();
+    ASN1_TIME *t = ASN1_TIME_set(NULL, PARAM_TIME - 3600);
+    BIO *out = NULL;
+    char *file = NULL;
+    int r = 0;
+
+    if (!TEST_ptr(crl) || !TEST_ptr(rev) || !TEST_ptr(data)
+        || !TEST_ptr(serial) || !TEST_ptr(t)
+        || !TEST_ptr(key = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256"))
+        || !TEST_true(X509_CRL_set_version(crl, X509_CRL_VERSION_2))
+        || !TEST_true(X509_CRL_set_issuer_name(crl,
+                                               X509_get_subject_name(test_root)))
+        || !TEST_true(X509_CRL_set1_lastUpdate(crl, t))
+        || !TEST_true(ASN1_INTEGER_set(serial, 42))
+        || !TEST_true(X509_REVOKED_set_serialNumber(rev, serial))
+        || !TEST_true(X509_REVOKED_set_revocationDate(rev, t))
+        || !TEST_true(ASN1_OCTET_STRING_set(data, bad_reason,
+                                            sizeof(bad_reason)))
+        || !TEST_ptr(ext = X509_EXTENSION_create_by_NID(NULL, NID_crl_reason,
+                                                        0, data))
+        || !TEST_true(X509_REVOKED_add_ext(rev, ext, -1))
+        || !TEST_true(X509_CRL_add0_revoked(crl, rev)))
+        goto err;
+    rev = NULL;
+    if (!TEST_int_gt(X509_CRL_sign(crl, key, EVP_sha256()), 0)
+        || !TEST_ptr(file = write_CRL_file(crl, "indexed_bad_entry.der", 0))
+        || !TEST_ptr(indexed = X509_CRL_load_indexed(file, NULL, NULL)))
+        goto err;
+
+    ERR_clear_error();
+    if (!TEST_int_eq(X509_CRL_get0_by_serial(indexed, &found, serial), -1)
+        || !TEST_ptr_null(found)
+        || !TEST_ulong_ne(ERR_peek_error(), 0))
+        goto err;
+    ERR_clear_error();
+    if (!TEST_ptr(out = BIO_new(BIO_s_mem()))
+        || !TEST_false(X509_CRL_print(out, indexed))
+        || !TEST_ulong_ne(ERR_peek_error(), 0))
+        goto err;
+
+    r = 1;
+ err:
+    ERR_clear_error();
+    BIO_free(out);
+    X509_CRL_free(indexed);
+    X509_CRL_free(crl);
+    X509_REVOKED_free(rev);
+    X509_EXTENSION_free(ext);
+    ASN1_OCTET_STRING_free(data);
+    ASN1_INTEGER_free(serial);
+    ASN1_TIME_free(t);
+    EVP_PKEY_free(key);
+    OPENSSL_free(file);
+    return r;
+}
+
+/*
+ * Serial numbers of the generated CRLs. Every third one is revoked by the
+ * base CRL, and the delta CRL removes the first of them and adds some more.
+ */
+#define DELTA_SERIALS 300
+
+static int64_t delta_serial(int i)
+{
+    int64_t s = (int64_t)i * 7919;
+
+    return (i & 1) != 0 ? -s : s << (i % 40);
+}
+
+static X509_CRL *make_delta_test_CRL(EVP_PKEY *key, X509_NAME *issuer,
+                                     long number, long base, int delta)
+{
+    X509_CRL *crl = X509_CRL_new();
+    X509_REVOKED *rev = NULL;
+    ASN1_INTEGER *num = ASN1_INTEGER_new();
+    ASN1_ENUMERATED *reason = ASN1_ENUMERATED_new();
+    ASN1_TIME *t = ASN1_TIME_set(NULL, PARAM_TIME - 3600);
+    int i, ok = 0;
+
+    if (!TEST_ptr(crl) || !TEST_ptr(num) || !TEST_ptr(reason)
+        || !TEST_ptr(t)
+        || !TEST_true(X509_CRL_set_version(crl, X509_CRL_VERSION_2))
+        || !TEST_true(X509_CRL_set_issuer_name(crl, issuer))
+        || !TEST_true(X509_CRL_set1_lastUpdate(crl, t))
+        || !TEST_true(ASN1_INTEGER_set(num, number))
+        || !TEST_int_eq(X509_CRL_add1_ext_i2d(crl, NID_crl_number, num, 0,
+                                              0), 1))
+        goto err;
+    if (delta
+        && (!TEST_true(ASN1_INTEGER_set(num, base))
+            || !TEST_int_eq(X509_CRL_add1_ext_i2d(crl, NID_delta_crl, num, 1,
+                                                  0), 1)))
+        goto err;
+
+    for (i = 0; i < DELTA_SERIALS; i++) {
+        long code;
+
+        if (!delta && i % 3 == 0)
+            code = i % 2 == 0 ? CRL_REASON_KEY_COMPROMISE : -1;
+        else if (delta && i == 0)
+            code = CRL_REASON_REMOVE_FROM_CRL;
+        else if (delta && i % 3 == 1)
+            code = CRL_REASON_SUPERSEDED;
+        else
+            continue;
+        if (!TEST_ptr(rev = X509_REVOKED_new())
+            || !TEST_true(ASN1_INTEGER_set_int64(num, delta_serial(i)))
+            || !TEST_true(X509_REVOKED_set_serialNumber(rev, num))
+            || !TEST_true(X509_REVOKED_set_revocationDate(rev, t)))
+            goto err;
+        if (code >= 0
+            && (!TEST_true(ASN1_ENUMERATED_set(reason, code))
+                || !TEST_int_eq(X509_REVOKED_add1_ext_i2d(rev, NID_crl_reason,
+                                                          reason, 0, 0), 1)))
+            goto err;
+        if (!TEST_true(X509_CRL_add0_revoked(crl, rev)))
+            goto err;
+        rev = NULL;
+    }
+    ok = TEST_true(X509_CRL_sort(crl))
+        && TEST_int_gt(X509_CRL_sign(crl, key, EVP_sha256()), 0);
+
+ err:
+    if (ok) {
+        /* Decode it again to cache the CRL numbers */
+        X509_CRL *dup = X509_CRL_dup(crl);
+
+        X509_CRL_free(crl);
+        ok = TEST_ptr(crl = dup);
+    }
+    X509_REVOKED_free(rev);
+    ASN1_INTEGER_free(num);
+    ASN1_ENUMERATED_free(reason);
+    ASN1_TIME_free(t);
+    if (!ok) {
+        X509_CRL_free(crl);
+        crl = NULL;
+    }
+    return crl;
+}
+
+static int test_indexed_crl_delta(void)
+{
+    EVP_PKEY *key = NULL, *other = NULL;
+    X509_NAME *issuer = X509_NAME_new();
+    X509_CRL *base = NULL, *delta = NULL, *newer = NULL, *newest = NULL;
+    X509_CRL *forged = NULL, *indexed = NULL;
+    X509_REVOKED *rev;
+    ASN1_INTEGER *serial = ASN1_INTEGER_new();
+    char *file = NULL;
+    int i, ret, expect, r = 0;
+
+    if (!TEST_ptr(issuer) || !TEST_ptr(serial)
+        || !TEST_true(X509_NAME_add_entry_by_txt(issuer, "CN", MBSTRING_ASC,
+                                                 (unsigned char *)"Delta CA",
+                                                 -1, -1, 0))
+        || !TEST_ptr(key = EVP_PKEY_Q_keygen(NULL, NULL, "RSA", (size_t)2048))
+        || !TEST_ptr(base = make_delta_test_CRL(key, issuer, 10, 0, 0))
+        || !TEST_ptr(delta = make_delta_test_CRL(key, issuer, 11, 10, 1))
+        || !TEST_ptr(newer = make_delta_test_CRL(key, issuer, 12, 10, 1))
+        || !TEST_ptr(newest = make_delta_test_CRL(key, issuer, 13, 10, 1))
+        || !TEST_ptr(other = EVP_PKEY_Q_keygen(NULL, NULL, "RSA", (size_t)2048))
+        || !TEST_ptr(forged = make_delta_test_CRL(other, issuer, 14, 10, 1))
+        || !TEST_ptr(file = write_CRL_file(base, "indexed_base.der", 0))
+        || !TEST_ptr(indexed = X509_CRL_load_indexed(file, NULL, NULL))
+        || !TEST_int_eq(X509_CRL_verify(indexed, key), 1))
+        goto err;
+
+    /* Lookups must agree with the fully decoded CRL */
+    for (i = 0; i < DELTA_SERIALS; i++) {
+        X509_REVOKED *rev2 = NULL;
+
+        rev = NULL;
+        if (!TEST_true(ASN1_INTEGER_set_int64(serial, delta_serial(i)))
+            || !TEST_int_eq(ret = X509_CRL_get0_by_serial(indexed, &rev,
+                                                          serial),
+                            X509_CRL_get0_by_serial(base, &rev2, serial)))
+            goto err;
+        if (ret != 0
+            && (!TEST_ptr(rev)
+                || !TEST_int_eq(ASN1_INTEGER_cmp(
+                                    X509_REVOKED_get0_serialNumber(rev),
+                                    X509_REVOKED_get0_serialNumber(rev2)), 0)
+                || !TEST_int_eq(ASN1_TIME_compare(
+                                    X509_REVOKED_get0_revocationDate(rev),
+                                    X509_REVOKED_get0_revocationDate(rev2)),
+                                0)))
+            goto err;
+    }
+
+    /* A delta may only be set once it is known to apply */
+    if (!TEST_false(X509_CRL_set1_delta(indexed, base, key))
+        || !TEST_false(X509_CRL_set1_delta(base, delta, key))
+        || !TEST_false(X509_CRL_set1_delta(indexed, newer, other))
+        || !TEST_true(X509_CRL_set1_delta(indexed, newer, key))
+        || !TEST_false(X509_CRL_set1_delta(indexed, delta, key))
+        || !TEST_false(X509_CRL_set1_delta(indexed, forged, key)))
+        goto err;
+    ERR_clear_error();
+
+    for (i = 0; i < DELTA_SERIALS; i++) {
+        if (i == 0)
+            expect = 2;
+        else if (i % 3 == 0 || i % 3 == 1)
+            expect = 1;
+        else
+            expect = 0;
+        if (!TEST_true(ASN1_INTEGER_set_int64(serial, delta_serial(i)))
+            || !TEST_int_eq(X509_CRL_get0_by_serial(indexed, NULL, serial),
+                            expect)) {
+            TEST_info("serial %d", i);
+            goto err;
+        }
+    }
+
+    /* Entries of a delta CRL outlive its replacement */
+    rev = NULL;
+    if (!TEST_true(ASN1_INTEGER_set_int64(serial, delta_serial(1)))
+        || !TEST_int_eq(X509_CRL_get0_by_serial(indexed, &rev, serial), 1)
+        || !TEST_true(X509_CRL_set1_delta(indexed, newest, key))
+        || !TEST_int_eq(ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(rev),
+                                         serial), 0))
+        goto err;
+    r = 1;
+
+ err:
+    X509_CRL_free(indexed);
+    X509_CRL_free(base);
+    X509_CRL_free(delta);
+    X509_CRL_free(newer);
+    X509_CRL_free(newest);
+    X509_CRL_free(forged);
+    EVP_PKEY_free(other);
+    X509_NAME_free(issuer);
+    ASN1_INTEGER_free(serial);
+    EVP_PKEY_free(key);
+    OPENSSL_free(file);
+    return r;
+}
+
+OPT_TEST_DECLARE_USAGE("tmpdir\n")
+
+#define LOOKUP_THREADS 4
+
+static X509_CRL *thread_crl = NULL;
+static CRYPTO_RWLOCK *thread_lock = NULL;
+static int thread_failed = 0;
+
+static void do_indexed_lookups(void)
+{
+    ASN1_INTEGER *serial = ASN1_INTEGER_new();
+    X509_REVOKED *rev;
+    int i, j, failed = serial == NULL;
+
+    for (j = 0; !failed && j < 10; j++) {
+        for (i = 0; i < DELTA_SERIALS; i++) {
+            rev = NULL;
+            if (!ASN1_INTEGER_set_int64(serial, delta_serial(i))
+                || X509_CRL_get0_by_serial(thread_crl, &rev, serial)
+                   != (i % 3 == 0)
+                || (rev != NULL
+                    && ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(rev),
+                                        serial) != 0))
+                failed = 1;
+        }
+    }
+    ASN1_INTEGER_free(serial);
+    if (failed && CRYPTO_THREAD_write_lock(thread_lock)) {
+        thread_failed = 1;
+        CRYPTO_THREAD_unlock(thread_lock);
+    }
+}
+
+/* Lookups in an indexed CRL from several threads decode each entry once */
+static int test_indexed_crl_threads(void)
+{
+    EVP_PKEY *key = NULL;
+    X509_NAME *issuer = X509_NAME_new();
+    X509_CRL *base = NULL;
+    X509_REVOKED *rev1 = NULL, *rev2 = NULL;
+    ASN1_INTEGER *serial = ASN1_INTEGER_new();
+    thread_t threads[LOOKUP_THREADS];
+    char *file = NULL;
+    int i, r = 0;
+
+    thread_failed = 0;
+    if (!TEST_ptr(issuer) || !TEST_ptr(serial)
+        || !TEST_true(X509_NAME_add_entry_by_txt(issuer, "CN", MBSTRING_ASC,
+                                                 (unsigned char *)"Thread CA",
+                                                 -1, -1, 0))
+        || !TEST_ptr(thread_lock = CRYPTO_THREAD_lock_new())
+        || !TEST_ptr(key = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256"))
+        || !TEST_ptr(base = make_delta_test_CRL(key, issuer, 10, 0, 0))
+        || !TEST_ptr(file = write_CRL_file(base, "indexed_threads.der", 0))
+        || !TEST_ptr(thread_crl = X509_CRL_load_indexed(file, NULL, NULL)))
+        goto err;
+
+    for (i = 0; i < LOOKUP_THREADS; i++)
+        if (!TEST_true(run_thread(&threads[i], do_indexed_lookups)))
+            break;
+    while (--i >= 0)
+        wait_for_thread(threads[i]);
+    if (!TEST_false(thread_failed))
+        goto err;
+
+    for (i = 0; i < DELTA_SERIALS; i += 3) {
+        if (!TEST_true(ASN1_INTEGER_set_int64(serial, delta_serial(i)))
+            || !TEST_int_eq(X509_CRL_get0_by_serial(thread_crl, &rev1,
+                                                    serial), 1)
+            || !TEST_int_eq(X509_CRL_get0_by_serial(thread_crl, &rev2,
+                                                    serial), 1)
+            || !TEST_ptr_eq(rev1, rev2))
+            goto err;
+    }
+    r = 1;
+
+ err:
+    X509_CRL_free(thread_crl);
+    thread_crl = NULL;
+    CRYPTO_THREAD_lock_free(thread_lock);
+    thread_lock = NULL;
+    X509_CRL_free(base);
+    X509_NAME_free(issuer);
+    ASN1_INTEGER_free(serial);
+    EVP_PKEY_free(key);
+    OPENSSL_free(file);
+    return r;
+}
+
 int setup_tests(void)
 {
-    if (!TEST_ptr(test_root = X509_from_strings(kCRLTestRoot))
+    if (!test_skip_common_options()) {
+        TEST_error("Error parsing test options\n");
+        return 0;
+    }
+
+    if (!TEST_ptr(tmpdir = test_get_argument(0))
+        || !TEST_ptr(test_root = X509_from_strings(kCRLTestRoot))
         || !TEST_ptr(test_leaf = X509_from_strings(kCRLTestLeaf)))
         return 0;
 
@@ -444,6 +915,11 @@ int setup_tests(void)
     ADD_TEST(test_known_critical_crl);
     ADD_ALL_TESTS(test_unknown_critical_crl, OSSL_NELEM(unknown_critical_crls));
     ADD_ALL_TESTS(test_reuse_crl, 6);
+    ADD_ALL_TESTS(test_indexed_crl, 2);
+    ADD_ALL_TESTS(test_indexed_critical_crl, OSSL_NELEM(unknown_critical_crls));
+    ADD_TEST(test_indexed_crl_bad_entry);
+    ADD_TEST(test_indexed_crl_delta);
+    ADD_TEST(test_indexed_crl_threads);
     return 1;
 }
 
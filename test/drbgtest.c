@@ -886,6 +886,150 @@ err:
     return ret;
 }
 
+static unsigned int generate_counter(EVP_RAND_CTX *drbg)
+{
+    return prov_rand(drbg)->generate_counter;
+}
+
+/*
+ * Test that small RAND_bytes() requests are served from the per thread
+ * buffer and that buffered output is discarded when it has to be.
+ */
+static int test_rand_buffer(void)
+{
+    EVP_RAND_CTX *public, *primary;
+    unsigned char buf[2 * RAND_BUFFER_MAX_REQUEST], prev[16];
+    unsigned int count;
+    int i, ret = 0;
+
+    if (using_fips_rng())
+        return TEST_skip("DRBG internals of the FIPS provider may differ");
+
+    if (!TEST_ptr(public = RAND_get0_public(NULL))
+            || !TEST_ptr(primary = RAND_get0_primary(NULL)))
+        goto err;
+
+    /* There is no buffer by default */
+    count = generate_counter(public);
+    for (i = 0; i < 4; i++)
+        if (!TEST_int_eq(RAND_bytes(buf, 16), 1))
+            goto err;
+    if (!TEST_uint_eq(generate_counter(public), count + 4))
+        goto err;
+
+    if (!TEST_true(RAND_set_public_buffer_size(NULL, 1024))
+            || !TEST_false(RAND_set_public_buffer_size(NULL,
+                                                        RAND_BUFFER_MAX_SIZE + 1)))
+        goto err;
+
+    /* The first request fills the buffer, the next ones use it */
+    if (!TEST_int_eq(RAND_bytes(prev, sizeof(prev)), 1))
+        goto err;
+    count = generate_counter(public);
+    for (i = 0; i < 16; i++) {
+        if (!TEST_int_eq(RAND_bytes(buf, sizeof(prev)), 1)
+                || !TEST_mem_ne(buf, sizeof(prev), prev, sizeof(prev)))
+            goto err;
+        memcpy(prev, buf, sizeof(prev));
+    }
+    if (!TEST_uint_eq(generate_counter(public), count))
+        goto err;
+
+    /* Large requests go straight to the DRBG */
+    if (!TEST_int_eq(RAND_bytes(buf, sizeof(buf)), 1)
+            || !TEST_uint_eq(generate_counter(public), count + 1))
+        goto err;
+
+    /* Running out refills the buffer */
+    for (i = 0; i < 1024 / RAND_BUFFER_MAX_REQUEST; i++)
+        if (!TEST_int_eq(RAND_bytes(buf, RAND_BUFFER_MAX_REQUEST), 1))
+            goto err;
+    if (!TEST_uint_eq(generate_counter(public), count + 2))
+        goto err;
+
+    /*
+     * RAND_add() reseeds the primary DRBG and discards the buffer, so the
+     * next request has to go to the public DRBG which then reseeds too.
+     */
+    count = reseed_counter(public);
+    RAND_add(buf, sizeof(buf), 0);
+    if (!TEST_int_eq(RAND_bytes(buf, 16), 1)
+            || !TEST_uint_gt(reseed_counter(public), count))
+        goto err;
+
+    /* So does any other reseed of the primary or the public DRBG */
+    count = reseed_counter(public);
+    if (!TEST_true(EVP_RAND_reseed(primary, 0, NULL, 0, NULL, 0))
+            || !TEST_int_eq(RAND_bytes(buf, 16), 1)
+            || !TEST_uint_gt(reseed_counter(public), count))
+        goto err;
+    if (!TEST_true(EVP_RAND_reseed(public, 0, NULL, 0, NULL, 0)))
+        goto err;
+    count = generate_counter(public);
+    if (!TEST_int_eq(RAND_bytes(buf, 16), 1)
+            || !TEST_uint_eq(generate_counter(public), count + 1))
+        goto err;
+
+    /* Without a buffer every request is passed on */
+    if (!TEST_true(RAND_set_public_buffer_size(NULL, 0)))
+        goto err;
+    count = generate_counter(public);
+    for (i = 0; i < 4; i++)
+        if (!TEST_int_eq(RAND_bytes(buf, 16), 1))
+            goto err;
+    if (!TEST_uint_eq(generate_counter(public), count + 4))
+        goto err;
+
+    ret = 1;
+ err:
+    RAND_set_public_buffer_size(NULL, RAND_BUFFER_DEFAULT_SIZE);
+    return ret;
+}
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_RAND_SEED_EGD)
+/*
+ * Test that a child process does not return the bytes its parent has
+ * buffered.
+ */
+static int test_rand_buffer_fork(void)
+{
+    unsigned char parent[RANDOM_SIZE], child[RANDOM_SIZE];
+    int fd[2], status, ret = 0;
+    pid_t pid;
+
+    /* Make sure there is buffered output */
+    if (!TEST_true(RAND_set_public_buffer_size(NULL, 1024))
+            || !TEST_int_eq(RAND_bytes(parent, sizeof(parent)), 1)
+            || !TEST_int_ge(pipe(fd), 0))
+        goto err;
+
+    if (!TEST_int_ge(pid = fork(), 0)) {
+        close(fd[0]);
+        close(fd[1]);
+        goto err;
+    }
+    if (pid == 0) {
+        close(fd[0]);
+        status = RAND_bytes(child, sizeof(child)) == 1
+                 && write(fd[1], child, sizeof(child)) == sizeof(child);
+        close(fd[1]);
+        exit(status == 0);
+    }
+
+    close(fd[1]);
+    if (TEST_int_eq(waitpid(pid, &status, 0), pid)
+            && TEST_int_eq(status, 0)
+            && TEST_true(read(fd[0], child, sizeof(child)) == sizeof(child))
+            && TEST_int_eq(RAND_bytes(parent, sizeof(parent)), 1)
+            && TEST_mem_ne(parent, sizeof(parent), child, sizeof(child)))
+        ret = 1;
+    close(fd[0]);
+ err:
+    RAND_set_public_buffer_size(NULL, RAND_BUFFER_DEFAULT_SIZE);
+    return ret;
+}
+#endif
+
 int setup_tests(void)
 {
     ADD_TEST(test_rand_reseed);
@@ -893,6 +1037,10 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_rand_fork_safety, RANDOM_SIZE);
 #endif
     ADD_TEST(test_rand_prediction_resistance);
+    ADD_TEST(test_rand_buffer);
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_RAND_SEED_EGD)
+    ADD_TEST(test_rand_buffer_fork);
+#endif
 #if defined(OPENSSL_THREADS)
     ADD_TEST(test_multi_thread);
 #endif
@@ -546,6 +546,279 @@ static int named_group_creation_test(void)
     return ret;
 }
 
+static const int precomp_curves[] = {
+    NID_X9_62_prime256v1,
+    NID_secp384r1,
+    NID_secp521r1,
+    NID_secp256k1,
+    NID_brainpoolP256r1,
+#ifndef OPENSSL_NO_EC2M
+    NID_sect233k1,
+#endif
+};
+
+/*
+ * Checks fixed-base tables against EC_POINT_mul(), for groups without and
+ * with precomputed multiples of the generator.
+ */
+static int point_precomp_test(int n)
+{
+    BN_CTX *ctx = NULL;
+    EC_GROUP *group = NULL;
+    EC_POINT *P = NULL, *r1 = NULL, *r2 = NULL;
+    EC_POINT_PRECOMP *pre = NULL;
+    BIGNUM *k = NULL, *a = NULL, *b = NULL;
+    const BIGNUM *order;
+    int nid = precomp_curves[n % OSSL_NELEM(precomp_curves)];
+    int i, ret = 0;
+
+    if (!TEST_ptr(group = EC_GROUP_new_by_curve_name(nid))
+        || !TEST_ptr(ctx = BN_CTX_new()))
+        goto err;
+    if (n >= (int)OSSL_NELEM(precomp_curves)) {
+#ifdef OPENSSL_NO_DEPRECATED_3_0
+        ret = TEST_skip("EC_GROUP_precompute_mult() is not available");
+        goto err;
+#else
+        if (!TEST_true(EC_GROUP_precompute_mult(group, ctx)))
+            goto err;
+#endif
+    }
+    if (!TEST_ptr(order = EC_GROUP_get0_order(group))
+        || !TEST_ptr(P = EC_POINT_new(group))
+        || !TEST_ptr(r1 = EC_POINT_new(group))
+        || !TEST_ptr(r2 = EC_POINT_new(group))
+        || !TEST_ptr(k = BN_new())
+        || !TEST_ptr(a = BN_new())
+        || !TEST_ptr(b = BN_new())
+        || !TEST_true(BN_rand_range(k, order))
+        || !TEST_true(EC_POINT_mul(group, P, k, NULL, NULL, ctx))
+        || !TEST_ptr(pre = ossl_ec_point_precomp_new(group, P, ctx)))
+        goto err;
+
+    for (i = 0; i < 10; i++) {
+        if (!TEST_true(BN_rand_range(a, order))
+            || !TEST_true(BN_rand_range(b, order)))
+            goto err;
+        switch (i) {
+        case 0:
+            BN_zero(b);
+            break;
+        case 1:
+            BN_one(b);
+            break;
+        case 2:
+            if (!TEST_true(BN_sub(b, order, BN_value_one())))
+                goto err;
+            break;
+        case 3:
+            /* Out of range scalars get reduced */
+            if (!TEST_true(BN_add(b, b, order))
+                || !TEST_true(BN_lshift(b, b, 1)))
+                goto err;
+            break;
+        case 4:
+            BN_set_negative(b, 1);
+            break;
+        }
+
+        if (!TEST_true(ossl_ec_point_mul_precomp(group, r1, i == 5 ? NULL : a,
+                                                 pre, b, ctx))
+            || !TEST_true(EC_POINT_mul(group, r2, i == 5 ? NULL : a,
+                                       P, b, ctx))
+            || !TEST_int_eq(EC_POINT_cmp(group, r1, r2, ctx), 0)) {
+            TEST_info("Curve %s, iteration %d%s", OBJ_nid2sn(nid), i,
+                      n >= (int)OSSL_NELEM(precomp_curves)
+                      ? ", generator precomputed" : "");
+            goto err;
+        }
+    }
+
+    ret = 1;
+ err:
+    ossl_ec_point_precomp_free(pre);
+    EC_POINT_free(P);
+    EC_POINT_free(r1);
+    EC_POINT_free(r2);
+    BN_free(k);
+    BN_free(a);
+    BN_free(b);
+    EC_GROUP_free(group);
+    BN_CTX_free(ctx);
+    return ret;
+}
+
+static const struct {
+    int nid;
+    int has_table;
+} precomp_keys[] = {
+    { NID_X9_62_prime256v1, 1 },
+    { NID_secp384r1, 1 },
+#ifndef OPENSSL_NO_EC2M
+    /* No precomputed multiples of the generator, so no table either */
+    { NID_sect233k1, 0 },
+#endif
+};
+
+/* ECDSA verification with a precomputed public key */
+static int ecdsa_precomputed_public_test(int n)
+{
+    EC_KEY *key = NULL, *other = NULL;
+    ECDSA_SIG *sig = NULL;
+    unsigned char dgst[32] = { 1, 2, 3 };
+    int nid = precomp_keys[n].nid;
+    int ret = 0;
+
+    if (!TEST_ptr(key = EC_KEY_new_by_curve_name(nid))
+        || !TEST_ptr(other = EC_KEY_new_by_curve_name(nid))
+        || !TEST_true(EC_KEY_generate_key(key))
+        || !TEST_true(EC_KEY_generate_key(other))
+        || !TEST_ptr(sig = ECDSA_do_sign(dgst, sizeof(dgst), key))
+        || !TEST_true(ossl_ec_key_precompute_public(key))
+        || !TEST_int_eq(ossl_ec_key_has_public_precomp(key),
+                        precomp_keys[n].has_table)
+        || !TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig, key), 1))
+        goto err;
+
+    dgst[0] ^= 1;
+    if (!TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig, key), 0))
+        goto err;
+    dgst[0] ^= 1;
+
+    /* A new public key must not be verified with the old table */
+    if (!TEST_true(EC_KEY_set_public_key(key, EC_KEY_get0_public_key(other)))
+        || !TEST_false(ossl_ec_key_has_public_precomp(key))
+        || !TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig, key), 0))
+        goto err;
+
+    ret = 1;
+ err:
+    ECDSA_SIG_free(sig);
+    EC_KEY_free(key);
+    EC_KEY_free(other);
+    return ret;
+}
+
+static const int msm_curves[] = {
+    NID_X9_62_prime256v1,
+    NID_secp384r1,
+    NID_brainpoolP256r1,
+#ifndef OPENSSL_NO_EC2M
+    NID_sect283k1,
+#endif
+};
+
+/*
+ * Checks multi-scalar multiplications large enough for Pippenger's method
+ * against single multiplications, with repeated and opposite points and
+ * unusual scalars mixed in.  idx / OSSL_NELEM(msm_curves) selects
+ * EC_POINTs_mul() or ossl_ec_points_mul_public(), which may take variable
+ * time.
+ */
+static int msm_test(int idx)
+{
+    const size_t num = 200;
+    BN_CTX *ctx = NULL;
+    EC_GROUP *group = NULL;
+    EC_POINT **points = NULL, *r1 = NULL, *r2 = NULL, *t = NULL;
+    BIGNUM **scalars = NULL, *g = NULL;
+    const BIGNUM *order;
+    size_t i;
+    int n = idx % OSSL_NELEM(msm_curves);
+    int public = idx / OSSL_NELEM(msm_curves);
+    int ret = 0;
+
+    if (!TEST_ptr(group = EC_GROUP_new_by_curve_name(msm_curves[n]))
+        || !TEST_ptr(ctx = BN_CTX_new())
+        || !TEST_ptr(order = EC_GROUP_get0_order(group))
+        || !TEST_ptr(points = OPENSSL_zalloc(num * sizeof(*points)))
+        || !TEST_ptr(scalars = OPENSSL_zalloc(num * sizeof(*scalars)))
+        || !TEST_ptr(r1 = EC_POINT_new(group))
+        || !TEST_ptr(r2 = EC_POINT_new(group))
+        || !TEST_ptr(t = EC_POINT_new(group))
+        || !TEST_ptr(g = BN_new())
+        || !TEST_true(BN_rand_range(g, order)))
+        goto err;
+
+    for (i = 0; i < num; i++) {
+        if (!TEST_ptr(points[i] = EC_POINT_new(group))
+            || !TEST_ptr(scalars[i] = BN_new())
+            || !TEST_true(BN_rand_range(scalars[i], order)))
+            goto err;
+
+        switch (i % 10) {
+        case 1:
+            /* The same point and scalar twice */
+            if (!TEST_true(EC_POINT_copy(points[i], points[i - 1]))
+                || !TEST_ptr(BN_copy(scalars[i], scalars[i - 1])))
+                goto err;
+            continue;
+        case 2:
+            /* The opposite point */
+            if (!TEST_true(EC_POINT_copy(points[i], points[i - 1]))
+                || !TEST_true(EC_POINT_invert(group, points[i], ctx)))
+                goto err;
+            continue;
+        case 3:
+            if (!TEST_true(EC_POINT_set_to_infinity(group, points[i])))
+                goto err;
+            continue;
+        case 4:
+            BN_zero(scalars[i]);
+            break;
+        case 5:
+            BN_set_negative(scalars[i], 1);
+            break;
+        case 6:
+            if (!TEST_true(BN_add(scalars[i], scalars[i], order)))
+                goto err;
+            break;
+        }
+        if (!TEST_true(BN_rand_range(g, order))
+            || !TEST_true(EC_POINT_mul(group, points[i], g, NULL, NULL, ctx)))
+            goto err;
+    }
+
+    if (public) {
+        if (!TEST_true(ossl_ec_points_mul_public(group, r1, g, num,
+                                                 (const EC_POINT **)points,
+                                                 (const BIGNUM **)scalars,
+                                                 ctx)))
+            goto err;
+    } else if (!TEST_true(EC_POINTs_mul(group, r1, g, num,
+                                        (const EC_POINT **)points,
+                                        (const BIGNUM **)scalars, ctx))) {
+        goto err;
+    }
+    if (!TEST_true(EC_POINT_mul(group, r2, g, NULL, NULL, ctx)))
+        goto err;
+    for (i = 0; i < num; i++)
+        if (!TEST_true(EC_POINT_mul(group, t, NULL, points[i], scalars[i], ctx))
+            || !TEST_true(EC_POINT_add(group, r2, r2, t, ctx)))
+            goto err;
+    if (!TEST_int_eq(EC_POINT_cmp(group, r1, r2, ctx), 0)) {
+        TEST_info("Curve %s%s", OBJ_nid2sn(msm_curves[n]),
+                  public ? ", public scalars" : "");
+        goto err;
+    }
+
+    ret = 1;
+ err:
+    for (i = 0; points != NULL && i < num; i++)
+        EC_POINT_free(points[i]);
+    for (i = 0; scalars != NULL && i < num; i++)
+        BN_free(scalars[i]);
+    OPENSSL_free(points);
+    OPENSSL_free(scalars);
+    EC_POINT_free(r1);
+    EC_POINT_free(r2);
+    EC_POINT_free(t);
+    BN_free(g);
+    EC_GROUP_free(group);
+    BN_CTX_free(ctx);
+    return ret;
+}
+
 int setup_tests(void)
 {
     crv_len = EC_get_builtin_curves(NULL, 0);
@@ -567,6 +840,9 @@ int setup_tests(void)
     ADD_TEST(decoded_flag_test);
     ADD_ALL_TESTS(ecpkparams_i2d2i_test, crv_len);
     ADD_TEST(named_group_creation_test);
+    ADD_ALL_TESTS(point_precomp_test, 2 * OSSL_NELEM(precomp_curves));
+    ADD_ALL_TESTS(ecdsa_precomputed_public_test, OSSL_NELEM(precomp_keys));
+    ADD_ALL_TESTS(msm_test, 2 * OSSL_NELEM(msm_curves));
 
     return 1;
 }
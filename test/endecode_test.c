@@ -1277,6 +1277,85 @@ const OPTIONS *test_get_options(void)
     return options;
 }
 
+static void add_decoder_failures(OSSL_DECODER *dec, void *arg)
+{
+    uint64_t failures = 0;
+
+    if (OSSL_DECODER_get_stats(dec, NULL, &failures))
+        *(uint64_t *)arg += failures;
+}
+
+static uint64_t decoder_failures(void)
+{
+    uint64_t failures = 0;
+
+    OSSL_DECODER_do_all_provided(testctx, add_decoder_failures, &failures);
+    return failures;
+}
+
+static int decode_private_key(const void *encoded, long encoded_len,
+                              const char *structure, const char *keytype,
+                              EVP_PKEY *expected)
+{
+    OSSL_DECODER_CTX *dctx = NULL;
+    EVP_PKEY *pkey = NULL;
+    const unsigned char *der = encoded;
+    size_t der_len = (size_t)encoded_len;
+    int ok;
+
+    ok = TEST_ptr(dctx = OSSL_DECODER_CTX_new_for_pkey(&pkey, "DER", structure,
+                                                       keytype,
+                                                       EVP_PKEY_KEYPAIR,
+                                                       testctx, testpropq))
+        && TEST_true(OSSL_DECODER_from_data(dctx, &der, &der_len))
+        && TEST_int_eq(EVP_PKEY_eq(pkey, expected), 1);
+    OSSL_DECODER_CTX_free(dctx);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+/*
+ * Decoding the same kind of key again should go straight down the decoder
+ * chain that was learned from the previous decoding, and decoding another
+ * kind of key in between, without a structure or key type given, must still
+ * work.
+ */
+static int test_decoder_path(void)
+{
+    void *rsa_der = NULL, *pss_der = NULL;
+    long rsa_der_len = 0, pss_der_len = 0;
+    uint64_t failures;
+    int i, ok = 0;
+
+    if (!encode_EVP_PKEY_prov(OPENSSL_FILE, OPENSSL_LINE,
+                              &rsa_der, &rsa_der_len, key_RSA,
+                              EVP_PKEY_KEYPAIR, "DER", "type-specific",
+                              NULL, NULL)
+            || !encode_EVP_PKEY_prov(OPENSSL_FILE, OPENSSL_LINE,
+                                     &pss_der, &pss_der_len, key_RSA_PSS,
+                                     EVP_PKEY_KEYPAIR, "DER", "PrivateKeyInfo",
+                                     NULL, NULL))
+        goto end;
+
+    for (i = 0; i < 3; i++) {
+        if (!decode_private_key(rsa_der, rsa_der_len, "type-specific", "RSA",
+                                key_RSA))
+            goto end;
+        failures = decoder_failures();
+        if (!decode_private_key(rsa_der, rsa_der_len, "type-specific", "RSA",
+                                key_RSA)
+                || !TEST_uint64_t_eq(decoder_failures(), failures)
+                || !decode_private_key(pss_der, pss_der_len, NULL, NULL,
+                                       key_RSA_PSS))
+            goto end;
+    }
+    ok = 1;
+ end:
+    OPENSSL_free(rsa_der);
+    OPENSSL_free(pss_der);
+    return ok;
+}
+
 int setup_tests(void)
 {
     const char *rsa_file = NULL;
@@ -1475,6 +1554,7 @@ int setup_tests(void)
 # ifndef OPENSSL_NO_RC4
         ADD_TEST_SUITE_PROTECTED_PVK(RSA);
 # endif
+        ADD_TEST(test_decoder_path);
     }
 
     return 1;
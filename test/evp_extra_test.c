@@ -32,6 +32,7 @@
 #include <openssl/rsa.h>
 #include <openssl/engine.h>
 #include <openssl/proverr.h>
+#include <openssl/thread.h>
 #include "testutil.h"
 #include "internal/nelem.h"
 #include "internal/sizes.h"
@@ -5892,6 +5893,574 @@ static int test_aes_rc4_keylen_change_cve_2023_5363(void)
 }
 #endif
 
+#ifndef OPENSSL_NO_ECX
+# define VERIFY_BATCH_N 150
+
+/*
+ * idx 0: Ed25519, which has a dedicated batch verification
+ * idx 1: ECDSA, which is verified one signature after the other
+ */
+static int test_verify_batch(int idx)
+{
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_SIGNATURE *alg = NULL;
+    unsigned char *sigbuf = NULL, *msgbuf = NULL;
+    const unsigned char *sigs[VERIFY_BATCH_N], *tbs[VERIFY_BATCH_N] = { NULL };
+    size_t siglens[VERIFY_BATCH_N], tbslens[VERIFY_BATCH_N];
+    int results[VERIFY_BATCH_N];
+    /* Spread over several of the internal batches */
+    const size_t bad[] = { 3, 70, 71, 149 };
+    size_t i, maxsig;
+    int testresult = 0;
+
+    if (idx == 1) {
+# ifdef OPENSSL_NO_EC
+        return TEST_skip("EC is disabled");
+# else
+        pkey = load_example_ec_key();
+# endif
+    } else {
+        pkey = load_example_ed25519_key();
+    }
+    if (!TEST_ptr(pkey)
+            || !TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey,
+                                                          testpropq)))
+        goto err;
+    if (idx == 0
+            && !TEST_ptr(alg = EVP_SIGNATURE_fetch(testctx, "ED25519",
+                                                   testpropq)))
+        goto err;
+
+    maxsig = EVP_PKEY_get_size(pkey);
+    if (!TEST_ptr(sigbuf = OPENSSL_malloc(maxsig * VERIFY_BATCH_N))
+            || !TEST_ptr(msgbuf = OPENSSL_malloc(VERIFY_BATCH_N)))
+        goto err;
+    for (i = 0; i < VERIFY_BATCH_N; i++)
+        msgbuf[i] = (unsigned char)i;
+
+    for (i = 0; i < VERIFY_BATCH_N; i++) {
+        /* ECDSA takes digests, Ed25519 messages of any length */
+        if (idx == 1) {
+            tbslens[i] = 32 + (i % 3) * 16;
+            if (!TEST_ptr(tbs[i] = OPENSSL_memdup(msgbuf, tbslens[i])))
+                goto err;
+            ((unsigned char *)tbs[i])[0] = (unsigned char)i;
+            if (!TEST_int_gt(EVP_PKEY_sign_init(ctx), 0))
+                goto err;
+        } else {
+            tbs[i] = msgbuf;
+            tbslens[i] = i;
+            if (!TEST_int_gt(EVP_PKEY_sign_message_init(ctx, alg, NULL), 0))
+                goto err;
+        }
+        sigs[i] = sigbuf + i * maxsig;
+        siglens[i] = maxsig;
+        if (!TEST_int_gt(EVP_PKEY_sign(ctx, sigbuf + i * maxsig, &siglens[i],
+                                       tbs[i], tbslens[i]), 0))
+            goto err;
+    }
+
+    if (idx == 1) {
+        if (!TEST_int_gt(EVP_PKEY_verify_init(ctx), 0))
+            goto err;
+    } else if (!TEST_int_gt(EVP_PKEY_verify_message_init(ctx, alg, NULL), 0)) {
+        goto err;
+    }
+
+    if (!TEST_int_eq(EVP_PKEY_verify_batch(ctx, VERIFY_BATCH_N, sigs, siglens,
+                                           tbs, tbslens, results), 1))
+        goto err;
+    for (i = 0; i < VERIFY_BATCH_N; i++)
+        if (!TEST_int_eq(results[i], 1))
+            goto err;
+
+    /* Break a few of them in different ways */
+    sigbuf[bad[0] * maxsig + 1] ^= 0x01;
+    sigbuf[bad[1] * maxsig + siglens[bad[1]] - 1] ^= 0x01;
+    siglens[bad[2]]--;
+    /* ECDSA would ignore a shorter digest that is still long enough */
+    if (idx == 1)
+        ((unsigned char *)tbs[bad[3]])[1] ^= 0x01;
+    else
+        tbslens[bad[3]]--;
+
+    if (!TEST_int_eq(EVP_PKEY_verify_batch(ctx, VERIFY_BATCH_N, sigs, siglens,
+                                           tbs, tbslens, results), 0))
+        goto err;
+    for (i = 0; i < VERIFY_BATCH_N; i++) {
+        int expected = i != bad[0] && i != bad[1] && i != bad[2] && i != bad[3];
+
+        if (!TEST_int_eq(results[i], expected)) {
+            TEST_info("Signature %zu", i);
+            goto err;
+        }
+    }
+
+    /* The results agree with single verification */
+    for (i = 0; i < VERIFY_BATCH_N; i++) {
+        if (idx == 0
+                && !TEST_int_gt(EVP_PKEY_verify_message_init(ctx, alg, NULL),
+                                0))
+            goto err;
+        if (!TEST_int_eq(EVP_PKEY_verify(ctx, sigs[i], siglens[i],
+                                         tbs[i], tbslens[i]) == 1,
+                         results[i]))
+            goto err;
+    }
+
+    testresult = 1;
+ err:
+    if (idx == 1)
+        for (i = 0; i < VERIFY_BATCH_N; i++)
+            OPENSSL_free((unsigned char *)tbs[i]);
+    OPENSSL_free(sigbuf);
+    OPENSSL_free(msgbuf);
+    EVP_SIGNATURE_free(alg);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(pkey);
+    return testresult;
+}
+
+# define SMALL_ORDER_N 150
+
+/*
+ * Signatures with a small order component pass the cofactored verification
+ * equation but not the cofactorless one that EVP_PKEY_verify() checks.  The
+ * batch must give the same results as EVP_PKEY_verify(), whether or not the
+ * group they are in fails.
+ */
+static const unsigned char small_order_seed[32] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+/* Made with small_order_seed, but R has a component of order 8 */
+static const unsigned char small_order_r_sig[64] = {
+    0x83, 0xcb, 0x23, 0x73, 0x9e, 0xdf, 0x79, 0xec, 0x51, 0xce, 0x4a, 0xaa,
+    0x96, 0xf0, 0xe6, 0xaf, 0x12, 0x7b, 0x89, 0x28, 0x95, 0x24, 0x69, 0x4e,
+    0x81, 0x8b, 0x56, 0x25, 0xdf, 0xb7, 0x88, 0xba, 0xce, 0xb1, 0x58, 0xf6,
+    0x9f, 0x14, 0xa1, 0x44, 0x9e, 0x1a, 0x70, 0x2e, 0x17, 0x43, 0x81, 0xd3,
+    0x8b, 0xba, 0xe9, 0x22, 0xc1, 0x7a, 0x5f, 0x65, 0x0e, 0xc4, 0xa2, 0xa7,
+    0x85, 0x84, 0x31, 0x06
+};
+
+/* The public key of small_order_seed plus a point of order 8 */
+static const unsigned char small_order_pub[32] = {
+    0xb5, 0x02, 0xff, 0x3d, 0x92, 0xe3, 0x1d, 0x81, 0x90, 0xb4, 0xaa, 0x4e,
+    0xa0, 0x41, 0x40, 0x05, 0x16, 0x7f, 0xad, 0x08, 0x9c, 0x4d, 0xe9, 0xda,
+    0xc8, 0xa2, 0xfc, 0x85, 0x0f, 0xed, 0x4f, 0x58
+};
+
+/*
+ * Made with small_order_seed for small_order_pub, only the first passes the
+ * cofactorless equation
+ */
+static const unsigned char small_order_pub_sigs[2][64] = {
+    {
+        0x02, 0x76, 0x06, 0x1c, 0xe8, 0x40, 0xeb, 0x2b, 0x32, 0x5e, 0xb3, 0xb3,
+        0xa7, 0xda, 0x2e, 0xd3, 0xde, 0x31, 0xc5, 0x48, 0x23, 0x3e, 0x97, 0x3a,
+        0x4d, 0x84, 0x87, 0xf3, 0x7b, 0xc3, 0x79, 0x5b, 0x10, 0x46, 0x10, 0xbd,
+        0x1e, 0x44, 0x3c, 0x87, 0x84, 0x48, 0x0b, 0x73, 0x83, 0xfd, 0x14, 0x43,
+        0x85, 0x43, 0xfe, 0x66, 0x6d, 0xb6, 0x3e, 0x1b, 0x7c, 0x1a, 0x52, 0xbd,
+        0x14, 0xf4, 0xd7, 0x04
+    },
+    {
+        0xe9, 0xb7, 0xbe, 0xe5, 0x95, 0x05, 0xa4, 0x68, 0xd9, 0x68, 0x8e, 0x6b,
+        0x52, 0x01, 0x4d, 0xff, 0x79, 0x9d, 0x1d, 0x1d, 0x73, 0xa9, 0x09, 0xe3,
+        0x68, 0x89, 0x63, 0xa3, 0xff, 0xce, 0xfd, 0xf4, 0x4d, 0x7d, 0xe9, 0x8a,
+        0x85, 0x56, 0x7b, 0x32, 0x35, 0x7a, 0x12, 0x22, 0x35, 0xeb, 0xec, 0x43,
+        0x62, 0x53, 0x69, 0xfc, 0x25, 0x24, 0xa3, 0x80, 0xa9, 0x1c, 0x5e, 0x1d,
+        0x18, 0x28, 0xf8, 0x0d
+
+    }
+};
+
+/*
+ * A provider that passes everything on to the default provider, except that
+ * its Ed25519 signature has no batch verification.  EVP_PKEY_verify_batch()
+ * then verifies one signature after the other, which it only does after
+ * EVP_PKEY_verify_init().  That is set up for pure Ed25519 here, like
+ * EVP_PKEY_verify_message_init() does, rather than for Ed25519ph.
+ */
+static OSSL_LIB_CTX *nobatch_libctx = NULL;
+static OSSL_PROVIDER *nobatch_deflt = NULL;
+static OSSL_DISPATCH nobatch_ed25519_fns[64];
+static OSSL_ALGORITHM nobatch_sigs[2];
+
+static const OSSL_ALGORITHM *nobatch_query(void *provctx, int operation_id,
+                                           int *no_cache)
+{
+    if (operation_id == OSSL_OP_SIGNATURE) {
+        *no_cache = 0;
+        return nobatch_sigs;
+    }
+    return OSSL_PROVIDER_query_operation(nobatch_deflt, operation_id,
+                                         no_cache);
+}
+
+static void nobatch_unquery(void *provctx, int operation_id,
+                            const OSSL_ALGORITHM *algs)
+{
+    if (algs != nobatch_sigs)
+        OSSL_PROVIDER_unquery_operation(nobatch_deflt, operation_id, algs);
+}
+
+static void nobatch_teardown(void *provctx)
+{
+    OSSL_PROVIDER_unload(nobatch_deflt);
+    OSSL_LIB_CTX_free(nobatch_libctx);
+    nobatch_deflt = NULL;
+    nobatch_libctx = NULL;
+}
+
+static const OSSL_DISPATCH nobatch_dispatch_table[] = {
+    { OSSL_FUNC_PROVIDER_QUERY_OPERATION, (void (*)(void))nobatch_query },
+    { OSSL_FUNC_PROVIDER_UNQUERY_OPERATION, (void (*)(void))nobatch_unquery },
+    { OSSL_FUNC_PROVIDER_TEARDOWN, (void (*)(void))nobatch_teardown },
+    OSSL_DISPATCH_END
+};
+
+static int nobatch_provider_init(const OSSL_CORE_HANDLE *handle,
+                                 const OSSL_DISPATCH *in,
+                                 const OSSL_DISPATCH **out, void **provctx)
+{
+    const OSSL_ALGORITHM *algs = NULL, *alg;
+    const OSSL_DISPATCH *fn;
+    size_t i = 0;
+    int no_cache = 0;
+
+    if ((nobatch_libctx = OSSL_LIB_CTX_new()) == NULL
+            || (nobatch_deflt = OSSL_PROVIDER_load(nobatch_libctx,
+                                                   "default")) == NULL
+            || (algs = OSSL_PROVIDER_query_operation(nobatch_deflt,
+                                                     OSSL_OP_SIGNATURE,
+                                                     &no_cache)) == NULL)
+        goto err;
+
+    for (alg = algs; alg->algorithm_names != NULL; alg++)
+        if (OPENSSL_strncasecmp(alg->algorithm_names, "ED25519:", 8) == 0)
+            break;
+    if (alg->algorithm_names == NULL)
+        goto err;
+
+    for (fn = alg->implementation; fn->function_id != 0; fn++) {
+        if (fn->function_id == OSSL_FUNC_SIGNATURE_VERIFY_BATCH
+                || fn->function_id == OSSL_FUNC_SIGNATURE_VERIFY_INIT)
+            continue;
+        if (i == OSSL_NELEM(nobatch_ed25519_fns) - 2)
+            goto err;
+        nobatch_ed25519_fns[i++] = *fn;
+        if (fn->function_id == OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_INIT) {
+            nobatch_ed25519_fns[i] = *fn;
+            nobatch_ed25519_fns[i++].function_id =
+                OSSL_FUNC_SIGNATURE_VERIFY_INIT;
+        }
+    }
+    nobatch_ed25519_fns[i].function_id = 0;
+    nobatch_sigs[0] = *alg;
+    nobatch_sigs[0].implementation = nobatch_ed25519_fns;
+    memset(&nobatch_sigs[1], 0, sizeof(nobatch_sigs[1]));
+    OSSL_PROVIDER_unquery_operation(nobatch_deflt, OSSL_OP_SIGNATURE, algs);
+
+    *provctx = OSSL_PROVIDER_get0_provider_ctx(nobatch_deflt);
+    *out = nobatch_dispatch_table;
+    return 1;
+
+ err:
+    if (algs != NULL)
+        OSSL_PROVIDER_unquery_operation(nobatch_deflt, OSSL_OP_SIGNATURE, algs);
+    nobatch_teardown(NULL);
+    return 0;
+}
+
+/*
+ * Verifies |n| signatures with the provider's batch verification, with the
+ * one signature after the other of EVP_PKEY_verify_batch() and one by one
+ * with EVP_PKEY_verify(), and checks that the results are identical.
+ */
+static int verify_batch_all_paths(EVP_PKEY *pkey, size_t n,
+                                  const unsigned char **sigs,
+                                  const size_t *siglens,
+                                  const unsigned char **tbs,
+                                  const size_t *tbslens, const int *expected)
+{
+    OSSL_LIB_CTX *libctx = NULL;
+    OSSL_PROVIDER *prov = NULL;
+    EVP_PKEY *nbpkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL, *nbctx = NULL;
+    EVP_SIGNATURE *alg = NULL;
+    unsigned char pub[32];
+    size_t i, publen = sizeof(pub);
+    int results[SMALL_ORDER_N], nbresults[SMALL_ORDER_N];
+    int all = 1, ret = 0;
+
+    for (i = 0; i < n; i++)
+        all = all && expected[i];
+
+    if (!TEST_ptr(libctx = OSSL_LIB_CTX_new())
+            || !TEST_true(OSSL_PROVIDER_add_builtin(libctx, "nobatch",
+                                                    nobatch_provider_init))
+            || !TEST_ptr(prov = OSSL_PROVIDER_load(libctx, "nobatch"))
+            || !TEST_true(EVP_PKEY_get_raw_public_key(pkey, pub, &publen))
+            || !TEST_ptr(nbpkey = EVP_PKEY_new_raw_public_key_ex(libctx,
+                                                                 "ED25519",
+                                                                 NULL, pub,
+                                                                 publen))
+            || !TEST_ptr(nbctx = EVP_PKEY_CTX_new_from_pkey(libctx, nbpkey,
+                                                            NULL))
+            || !TEST_int_gt(EVP_PKEY_verify_init(nbctx), 0)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(nbctx, n, sigs, siglens,
+                                                  tbs, tbslens, nbresults),
+                            all))
+        goto err;
+
+    if (!TEST_ptr(alg = EVP_SIGNATURE_fetch(testctx, "ED25519", testpropq))
+            || !TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey,
+                                                          testpropq))
+            || !TEST_int_gt(EVP_PKEY_verify_message_init(ctx, alg, NULL), 0)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(ctx, n, sigs, siglens,
+                                                  tbs, tbslens, results),
+                            all))
+        goto err;
+
+    for (i = 0; i < n; i++) {
+        if (!TEST_int_eq(results[i], expected[i])
+                || !TEST_int_eq(nbresults[i], expected[i])
+                || !TEST_int_gt(EVP_PKEY_verify_message_init(ctx, alg, NULL),
+                                0)
+                || !TEST_int_eq(EVP_PKEY_verify(ctx, sigs[i], siglens[i],
+                                                tbs[i], tbslens[i]) == 1,
+                                expected[i])) {
+            TEST_info("Signature %zu", i);
+            goto err;
+        }
+    }
+
+    ret = 1;
+ err:
+    EVP_SIGNATURE_free(alg);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_CTX_free(nbctx);
+    EVP_PKEY_free(nbpkey);
+    OSSL_PROVIDER_unload(prov);
+    OSSL_LIB_CTX_free(libctx);
+    return ret;
+}
+
+/*
+ * idx 0: a batch of valid signatures, invalid ones and one whose R has a
+ * small order component
+ * idx 1: a public key with a small order component
+ */
+static int test_verify_batch_small_order(int idx)
+{
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_SIGNATURE *alg = NULL;
+    unsigned char sigbuf[SMALL_ORDER_N][64], msgbuf[SMALL_ORDER_N];
+    const unsigned char *sigs[SMALL_ORDER_N], *tbs[SMALL_ORDER_N];
+    size_t siglens[SMALL_ORDER_N], tbslens[SMALL_ORDER_N];
+    int expected[SMALL_ORDER_N];
+    size_t i, j, n;
+    int testresult = 0;
+
+    if (idx == 0) {
+        if (!TEST_ptr(alg = EVP_SIGNATURE_fetch(testctx, "ED25519",
+                                                testpropq)))
+            goto err;
+        pkey = EVP_PKEY_new_raw_private_key_ex(testctx, "ED25519", testpropq,
+                                               small_order_seed,
+                                               sizeof(small_order_seed));
+        if (!TEST_ptr(pkey)
+                || !TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey,
+                                                              testpropq)))
+            goto err;
+        n = SMALL_ORDER_N;
+        for (i = 0; i < n; i++) {
+            msgbuf[i] = (unsigned char)i;
+            tbs[i] = msgbuf;
+            tbslens[i] = i;
+            sigs[i] = sigbuf[i];
+            siglens[i] = sizeof(sigbuf[i]);
+            expected[i] = 1;
+            if (!TEST_int_gt(EVP_PKEY_sign_message_init(ctx, alg, NULL), 0)
+                    || !TEST_int_gt(EVP_PKEY_sign(ctx, sigbuf[i], &siglens[i],
+                                                  tbs[i], tbslens[i]), 0))
+                goto err;
+        }
+        tbs[7] = (const unsigned char *)"small order R";
+        tbslens[7] = strlen("small order R");
+        sigs[7] = small_order_r_sig;
+        expected[7] = 0;
+        /*
+         * Make the whole batch fail and the group of the small order R too,
+         * so that it is also checked on its own
+         */
+        tbs[6] = (const unsigned char *)"wrong message";
+        tbslens[6] = strlen("wrong message");
+        expected[6] = 0;
+        sigbuf[140][40] ^= 0x01;
+        expected[140] = 0;
+    } else {
+        pkey = EVP_PKEY_new_raw_public_key_ex(testctx, "ED25519", testpropq,
+                                              small_order_pub,
+                                              sizeof(small_order_pub));
+        if (!TEST_ptr(pkey))
+            goto err;
+        n = 2;
+        tbs[0] = (const unsigned char *)"torsion key 0";
+        tbs[1] = (const unsigned char *)"torsion key 1";
+        for (i = 0; i < n; i++) {
+            tbslens[i] = strlen((const char *)tbs[i]);
+            sigs[i] = small_order_pub_sigs[i];
+            siglens[i] = sizeof(small_order_pub_sigs[i]);
+            expected[i] = i == 0;
+        }
+    }
+
+    if (!verify_batch_all_paths(pkey, n, sigs, siglens, tbs, tbslens,
+                                expected))
+        goto err;
+
+    /* The valid ones on their own pass as a whole */
+    for (i = j = 0; i < n; i++) {
+        if (!expected[i])
+            continue;
+        sigs[j] = sigs[i];
+        siglens[j] = siglens[i];
+        tbs[j] = tbs[i];
+        tbslens[j] = tbslens[i];
+        expected[j++] = 1;
+    }
+    if (!verify_batch_all_paths(pkey, j, sigs, siglens, tbs, tbslens,
+                                expected))
+        goto err;
+
+    testresult = 1;
+ err:
+    EVP_SIGNATURE_free(alg);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(pkey);
+    return testresult;
+}
+#endif
+
+#define SIGN_BATCH_N 40
+
+/*
+ * idx 0: RSA PKCS#1 v1.5, signed serially
+ * idx 1: RSA PKCS#1 v1.5, spread over the thread pool
+ * idx 2: RSA PSS, spread over the thread pool
+ * idx 3: ECDSA, which is signed one digest after the other by libcrypto
+ */
+static int test_sign_batch(int idx)
+{
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    unsigned char *sigbuf = NULL, *single = NULL;
+    unsigned char tbsbuf[SIGN_BATCH_N][32];
+    unsigned char *sigs[SIGN_BATCH_N];
+    const unsigned char *tbs[SIGN_BATCH_N];
+    size_t siglens[SIGN_BATCH_N], tbslens[SIGN_BATCH_N];
+    size_t i, maxsig, singlelen;
+    int testresult = 0;
+
+    if (idx == 3) {
+#ifdef OPENSSL_NO_EC
+        return TEST_skip("EC is disabled");
+#else
+        pkey = load_example_ec_key();
+#endif
+    } else {
+        pkey = load_example_rsa_key();
+    }
+    if (idx > 0 && idx < 3 && OSSL_set_max_threads(testctx, 4) == 0)
+        TEST_note("No thread pool, signing serially");
+
+    if (!TEST_ptr(pkey)
+            || !TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey,
+                                                          testpropq))
+            || !TEST_int_gt(EVP_PKEY_sign_init(ctx), 0)
+            || !TEST_int_gt(EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()),
+                            0))
+        goto err;
+    if (idx == 2
+            && !TEST_int_gt(EVP_PKEY_CTX_set_rsa_padding(ctx,
+                                                         RSA_PKCS1_PSS_PADDING),
+                            0))
+        goto err;
+
+    maxsig = EVP_PKEY_get_size(pkey);
+    if (!TEST_ptr(sigbuf = OPENSSL_malloc(maxsig * SIGN_BATCH_N))
+            || !TEST_ptr(single = OPENSSL_malloc(maxsig)))
+        goto err;
+    for (i = 0; i < SIGN_BATCH_N; i++) {
+        memset(tbsbuf[i], (int)i, sizeof(tbsbuf[i]));
+        tbs[i] = tbsbuf[i];
+        tbslens[i] = sizeof(tbsbuf[i]);
+        sigs[i] = sigbuf + i * maxsig;
+        siglens[i] = maxsig;
+    }
+
+    if (!TEST_int_eq(evp_pkey_sign_batch(ctx, SIGN_BATCH_N, sigs, siglens,
+                                         tbs, tbslens), 1))
+        goto err;
+
+    for (i = 0; i < SIGN_BATCH_N; i++) {
+        /* PKCS#1 v1.5 signatures are deterministic */
+        if (idx < 2) {
+            singlelen = maxsig;
+            if (!TEST_int_gt(EVP_PKEY_sign(ctx, single, &singlelen,
+                                           tbs[i], tbslens[i]), 0)
+                    || !TEST_mem_eq(sigs[i], siglens[i], single, singlelen))
+                goto err;
+        }
+    }
+
+    if (!TEST_int_gt(EVP_PKEY_verify_init(ctx), 0)
+            || !TEST_int_gt(EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()),
+                            0))
+        goto err;
+    if (idx == 2
+            && !TEST_int_gt(EVP_PKEY_CTX_set_rsa_padding(ctx,
+                                                         RSA_PKCS1_PSS_PADDING),
+                            0))
+        goto err;
+    for (i = 0; i < SIGN_BATCH_N; i++)
+        if (!TEST_int_eq(EVP_PKEY_verify(ctx, sigs[i], siglens[i],
+                                         tbs[i], tbslens[i]), 1)) {
+            TEST_info("Signature %zu", i);
+            goto err;
+        }
+
+    /* A buffer that is too small fails the batch */
+    if (!TEST_int_gt(EVP_PKEY_sign_init(ctx), 0))
+        goto err;
+    for (i = 0; i < SIGN_BATCH_N; i++)
+        siglens[i] = maxsig;
+    siglens[SIGN_BATCH_N - 1] = 1;
+    if (!TEST_int_le(evp_pkey_sign_batch(ctx, SIGN_BATCH_N, sigs, siglens,
+                                         tbs, tbslens), 0))
+        goto err;
+
+    /* Only EVP_PKEY_sign_init() is supported */
+    if (!TEST_int_gt(EVP_PKEY_verify_init(ctx), 0)
+            || !TEST_int_lt(evp_pkey_sign_batch(ctx, SIGN_BATCH_N, sigs,
+                                                siglens, tbs, tbslens), 0))
+        goto err;
+
+    testresult = 1;
+ err:
+    OSSL_set_max_threads(testctx, 0);
+    OPENSSL_free(sigbuf);
+    OPENSSL_free(single);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(pkey);
+    return testresult;
+}
+
 static int test_invalid_ctx_for_digest(void)
 {
     int ret;
@@ -6096,6 +6665,12 @@ int setup_tests(void)
 
     ADD_TEST(test_invalid_ctx_for_digest);
 
+#ifndef OPENSSL_NO_ECX
+    ADD_ALL_TESTS(test_verify_batch, 2);
+    ADD_ALL_TESTS(test_verify_batch_small_order, 2);
+#endif
+    ADD_ALL_TESTS(test_sign_batch, 4);
+
     return 1;
 }
 
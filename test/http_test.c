@@ -13,6 +13,8 @@
 #include <openssl/x509v3.h>
 #include <string.h>
 
+#include "internal/e_os.h"
+#include "internal/sockets.h"
 #include "testutil.h"
 
 static const ASN1_ITEM *x509_it = NULL;
@@ -479,9 +481,409 @@ static int test_hdr_resp_hdr_limit_256(void)
     return test_http_resp_hdr_limit(256);
 }
 
+#if defined(OPENSSL_THREADS) && !defined(OPENSSL_NO_SOCK)
+# include "threadstest.h"
+
+/*-
+ * Loopback server running in its own thread for testing connection reuse:
+ * It answers each POST request received on any of its connections with the
+ * request content, using HTTP/1.0 with keep-alive.
+ */
+# define MAX_CLIENTS 8
+# define MAX_REQUESTS 6
+
+typedef struct {
+    BIO *bio;
+    char buf[1024];
+    size_t len;
+} client_conn;
+
+static int listen_fd = -1;
+static char *server_port = NULL;
+static CRYPTO_RWLOCK *server_lock = NULL;
+static int server_stop;
+static int server_accepted;
+static int server_requests;
+static int server_fail_next;    /* One of the SERVER_FAIL_* values below */
+
+/* Close the connection without answering the next request */
+# define SERVER_FAIL_CLOSE 1
+/* Answer the next request with an HTTP error status */
+# define SERVER_FAIL_STATUS 2
+static thread_t server_thread;
+
+static int server_stopped(void)
+{
+    int ret = 1;
+
+    if (CRYPTO_THREAD_read_lock(server_lock)) {
+        ret = server_stop;
+        CRYPTO_THREAD_unlock(server_lock);
+    }
+    return ret;
+}
+
+static int write_all(BIO *bio, const char *buf, size_t len)
+{
+    int n;
+
+    while (len > 0) {
+        if ((n = BIO_write(bio, buf, (int)len)) > 0) {
+            buf += n;
+            len -= n;
+        } else if (!BIO_should_retry(bio)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void set_server_fail_next(int fail)
+{
+    if (CRYPTO_THREAD_write_lock(server_lock)) {
+        server_fail_next = fail;
+        CRYPTO_THREAD_unlock(server_lock);
+    }
+}
+
+static int get_server_fail_next(void)
+{
+    int ret = 0;
+
+    if (CRYPTO_THREAD_write_lock(server_lock)) {
+        ret = server_fail_next;
+        server_fail_next = 0;
+        CRYPTO_THREAD_unlock(server_lock);
+    }
+    return ret;
+}
+
+/* Answer all requests received completely on |c|, return 0 on error */
+static int serve_requests(client_conn *c)
+{
+    static const char error_resp[] =
+        "HTTP/1.0 500 Internal Server Error\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Length: 0\r\n\r\n";
+    char hdr[200], *end, *cl;
+    size_t hdr_len, body_len;
+    int n;
+
+    for (;;) {
+        c->buf[c->len] = '\0';
+        if ((end = strstr(c->buf, "\r\n\r\n")) == NULL)
+            return 1;
+        hdr_len = end + 4 - c->buf;
+        cl = strstr(c->buf, "Content-Length: ");
+        body_len = cl != NULL && cl < end ? strtoul(cl + 16, NULL, 10) : 0;
+        if (c->len < hdr_len + body_len)
+            return 1;
+        server_requests++;
+        switch (get_server_fail_next()) {
+        case SERVER_FAIL_CLOSE:
+            return 0;
+        case SERVER_FAIL_STATUS:
+            if (!write_all(c->bio, error_resp, sizeof(error_resp) - 1))
+                return 0;
+            c->len -= hdr_len + body_len;
+            memmove(c->buf, c->buf + hdr_len + body_len, c->len);
+            continue;
+        }
+        n = BIO_snprintf(hdr, sizeof(hdr),
+                         "HTTP/1.0 200 OK\r\n"
+                         "Content-Type: application/octet-stream\r\n"
+                         "Connection: keep-alive\r\n"
+                         "Content-Length: %d\r\n\r\n", (int)body_len);
+        if (n <= 0 || !write_all(c->bio, hdr, n)
+                || !write_all(c->bio, c->buf + hdr_len, body_len))
+            return 0;
+        c->len -= hdr_len + body_len;
+        memmove(c->buf, c->buf + hdr_len + body_len, c->len);
+    }
+}
+
+static void http_server(void)
+{
+    client_conn clients[MAX_CLIENTS];
+    size_t num = 0, i;
+    int fd, n, progress;
+
+    memset(clients, 0, sizeof(clients));
+    while (!server_stopped()) {
+        progress = 0;
+        if (num < MAX_CLIENTS
+                && (fd = BIO_accept_ex(listen_fd, NULL, BIO_SOCK_NONBLOCK)) >= 0) {
+            if ((clients[num].bio = BIO_new_socket(fd, BIO_CLOSE)) == NULL) {
+                BIO_closesocket(fd);
+            } else {
+                num++;
+                server_accepted++;
+            }
+            progress = 1;
+        }
+        for (i = 0; i < num; i++) {
+            client_conn *c = &clients[i];
+
+            if (c->bio == NULL)
+                continue;
+            n = BIO_read(c->bio, c->buf + c->len, sizeof(c->buf) - 1 - c->len);
+            if (n > 0) {
+                c->len += n;
+                progress = 1;
+                if (serve_requests(c))
+                    continue;
+            } else if (BIO_should_retry(c->bio)) {
+                continue;
+            }
+            BIO_free(c->bio);
+            c->bio = NULL;
+        }
+        if (!progress)
+            OSSL_sleep(1);
+    }
+    for (i = 0; i < num; i++)
+        BIO_free(clients[i].bio);
+}
+
+static int start_server(void)
+{
+    BIO_ADDRINFO *res = NULL;
+    union BIO_sock_info_u info;
+    int ret = 0;
+
+    server_stop = 0;
+    server_accepted = 0;
+    server_requests = 0;
+    server_fail_next = 0;
+    info.addr = NULL;
+    if (!TEST_true(BIO_lookup_ex("127.0.0.1", "0", BIO_LOOKUP_SERVER, AF_INET,
+                                 SOCK_STREAM, 0, &res))
+            || !TEST_int_ge(listen_fd = BIO_socket(AF_INET, SOCK_STREAM, 0, 0),
+                            0)
+            || !TEST_true(BIO_listen(listen_fd, BIO_ADDRINFO_address(res),
+                                     BIO_SOCK_REUSEADDR | BIO_SOCK_NONBLOCK))
+            || !TEST_ptr(info.addr = BIO_ADDR_new())
+            || !TEST_true(BIO_sock_info(listen_fd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_ptr(server_port = BIO_ADDR_service_string(info.addr, 1))
+            || !TEST_true(run_thread(&server_thread, http_server)))
+        goto end;
+    ret = 1;
+ end:
+    BIO_ADDR_free(info.addr);
+    BIO_ADDRINFO_free(res);
+    if (!ret && listen_fd >= 0) {
+        BIO_closesocket(listen_fd);
+        listen_fd = -1;
+    }
+    return ret;
+}
+
+/* Stop the server and return the number of connections it has accepted */
+static int stop_server(void)
+{
+    if (listen_fd < 0)
+        return -1;
+    if (CRYPTO_THREAD_write_lock(server_lock)) {
+        server_stop = 1;
+        CRYPTO_THREAD_unlock(server_lock);
+    }
+    wait_for_thread(server_thread);
+    BIO_closesocket(listen_fd);
+    listen_fd = -1;
+    OPENSSL_free(server_port);
+    server_port = NULL;
+    return server_accepted;
+}
+
+/* Request |i| consists of a small DER-encoded INTEGER with value |i| */
+static BIO *new_request(int i)
+{
+    const unsigned char der[] = { 0x30, 0x03, 0x02, 0x01, (unsigned char)i };
+    BIO *req = BIO_new(BIO_s_mem());
+
+    if (req != NULL && BIO_write(req, der, sizeof(der)) != (int)sizeof(der)) {
+        BIO_free(req);
+        req = NULL;
+    }
+    return req;
+}
+
+static int response_ok(BIO *resp, int i)
+{
+    const unsigned char der[] = { 0x30, 0x03, 0x02, 0x01, (unsigned char)i };
+    unsigned char *data;
+    long len = BIO_get_mem_data(resp, &data);
+
+    return TEST_mem_eq(data, len, der, sizeof(der));
+}
+
+/* Several transfers to the same server reuse a single connection */
+static int test_http_pool(void)
+{
+    OSSL_HTTP_POOL *pool = NULL;
+    BIO *req = NULL, *resp = NULL;
+    int i, res = 0;
+
+    if (!start_server()
+            || !TEST_ptr(pool = OSSL_HTTP_POOL_new(0, 60)))
+        goto end;
+    for (i = 1; i <= 3; i++) {
+        if (!TEST_ptr(req = new_request(i))
+                || !TEST_ptr(resp = OSSL_HTTP_POOL_transfer(pool, "127.0.0.1",
+                                                            server_port, "/",
+                                                            0, "", NULL,
+                                                            NULL, NULL, 0, NULL,
+                                                            "application/octet-stream",
+                                                            req, NULL, 1, 0, 10))
+                || !response_ok(resp, i))
+            goto end;
+        BIO_free(req);
+        BIO_free(resp);
+        req = resp = NULL;
+    }
+    OSSL_HTTP_POOL_free(pool);
+    pool = NULL;
+    res = TEST_int_eq(stop_server(), 1);
+ end:
+    BIO_free(req);
+    BIO_free(resp);
+    OSSL_HTTP_POOL_free(pool);
+    stop_server();
+    return res;
+}
+
+/*
+ * A request that fails on a reused connection is sent once more on a new one
+ * only if the server has not answered it.
+ * idx 0: the server closes the connection without answering, the retry works
+ * idx 1: the server answers with an error status, which is final
+ */
+static int test_http_pool_retry(int idx)
+{
+    OSSL_HTTP_POOL *pool = NULL;
+    BIO *req = NULL, *resp = NULL;
+    int i, res = 0;
+
+    if (!start_server()
+            || !TEST_ptr(pool = OSSL_HTTP_POOL_new(0, 60)))
+        goto end;
+    for (i = 1; i <= 2; i++) {
+        if (i == 2)
+            set_server_fail_next(idx == 0 ? SERVER_FAIL_CLOSE
+                                          : SERVER_FAIL_STATUS);
+        if (!TEST_ptr(req = new_request(i)))
+            goto end;
+        resp = OSSL_HTTP_POOL_transfer(pool, "127.0.0.1", server_port, "/",
+                                       0, "", NULL, NULL, NULL, 0, NULL,
+                                       "application/octet-stream", req,
+                                       NULL, 1, 0, 10);
+        if (i == 1 || idx == 0) {
+            if (!TEST_ptr(resp) || !response_ok(resp, i))
+                goto end;
+        } else if (!TEST_ptr_null(resp)) {
+            goto end;
+        }
+        BIO_free(req);
+        BIO_free(resp);
+        req = resp = NULL;
+    }
+    ERR_clear_error();
+    OSSL_HTTP_POOL_free(pool);
+    pool = NULL;
+    if (idx == 0)
+        res = TEST_int_eq(stop_server(), 2) && TEST_int_eq(server_requests, 3);
+    else
+        res = TEST_int_eq(stop_server(), 1) && TEST_int_eq(server_requests, 2);
+ end:
+    BIO_free(req);
+    BIO_free(resp);
+    OSSL_HTTP_POOL_free(pool);
+    stop_server();
+    return res;
+}
+
+/*
+ * Send MAX_REQUESTS requests concurrently, pipelined on |idx| + 1 connections
+ * using a single thread, and check that each gets its own response
+ */
+static int test_http_multi(int idx)
+{
+    int num_conns = idx + 1;
+    OSSL_HTTP_REQ_CTX *conns[MAX_REQUESTS] = { NULL };
+    OSSL_HTTP_REQ_CTX *rctx[MAX_REQUESTS] = { NULL };
+    OSSL_HTTP_REQ_CTX *done;
+    OSSL_HTTP_MULTI *multi = NULL;
+    BIO *req = NULL;
+    int i, ok, running, num_done = 0, res = 0;
+
+    if (!start_server()
+            || !TEST_ptr(multi = OSSL_HTTP_MULTI_new()))
+        goto end;
+    for (i = 0; i < num_conns; i++)
+        if (!TEST_ptr(conns[i] = OSSL_HTTP_open("127.0.0.1", server_port, "",
+                                                NULL, 0, NULL, NULL, NULL, NULL,
+                                                0, 10)))
+            goto end;
+    for (i = 0; i < MAX_REQUESTS; i++) {
+        if (i < num_conns)
+            rctx[i] = conns[i];
+        else if (!TEST_ptr(rctx[i] =
+                           OSSL_HTTP_REQ_CTX_new_pipelined(conns[i % num_conns])))
+            goto end;
+        if (!TEST_ptr(req = new_request(i + 1))
+                || !TEST_true(OSSL_HTTP_set1_request(rctx[i], "/", NULL,
+                                                     "application/octet-stream",
+                                                     req, NULL, 1, 0, -1, 1))
+                || !TEST_true(OSSL_HTTP_MULTI_add(multi, rctx[i])))
+            goto end;
+        BIO_free(req);
+        req = NULL;
+    }
+
+    while ((running = OSSL_HTTP_MULTI_perform(multi)) > 0)
+        if (!TEST_int_ge(OSSL_HTTP_MULTI_wait(multi, 1000), 0))
+            goto end;
+    if (!TEST_int_eq(running, 0))
+        goto end;
+    while ((done = OSSL_HTTP_MULTI_get_done(multi, &ok)) != NULL) {
+        for (i = 0; i < MAX_REQUESTS && rctx[i] != done; i++)
+            continue;
+        if (!TEST_int_lt(i, MAX_REQUESTS)
+                || !TEST_true(ok)
+                || !response_ok(OSSL_HTTP_REQ_CTX_get0_mem_bio(done), i + 1))
+            goto end;
+        num_done++;
+    }
+    if (!TEST_int_eq(num_done, MAX_REQUESTS))
+        goto end;
+
+    for (i = num_conns; i < MAX_REQUESTS; i++) {
+        OSSL_HTTP_REQ_CTX_free(rctx[i]);
+        rctx[i] = NULL;
+    }
+    for (i = 0; i < num_conns; i++) {
+        OSSL_HTTP_close(conns[i], 1);
+        conns[i] = NULL;
+    }
+    res = TEST_int_eq(stop_server(), num_conns);
+ end:
+    BIO_free(req);
+    OSSL_HTTP_MULTI_free(multi);
+    for (i = num_conns; i < MAX_REQUESTS; i++)
+        OSSL_HTTP_REQ_CTX_free(rctx[i]);
+    for (i = 0; i < num_conns; i++)
+        OSSL_HTTP_close(conns[i], 0);
+    stop_server();
+    return res;
+}
+#endif
+
 void cleanup_tests(void)
 {
     X509_free(x509);
+#if defined(OPENSSL_THREADS) && !defined(OPENSSL_NO_SOCK)
+    CRYPTO_THREAD_lock_free(server_lock);
+#endif
 }
 
 OPT_TEST_DECLARE_USAGE("cert.pem\n")
@@ -518,5 +920,12 @@ int setup_tests(void)
     ADD_TEST(test_hdr_resp_hdr_limit_none);
     ADD_TEST(test_hdr_resp_hdr_limit_short);
     ADD_TEST(test_hdr_resp_hdr_limit_256);
+#if defined(OPENSSL_THREADS) && !defined(OPENSSL_NO_SOCK)
+    if (!TEST_ptr(server_lock = CRYPTO_THREAD_lock_new()))
+        return 0;
+    ADD_TEST(test_http_pool);
+    ADD_ALL_TESTS(test_http_pool_retry, 2);
+    ADD_ALL_TESTS(test_http_multi, 3);
+#endif
     return 1;
 }
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <openssl/ssl.h>
+#include <openssl/ocsp.h>
+#include <openssl/err.h>
+#include "helpers/ssltestlib.h"
+#include "testutil.h"
+
+#undef OSSL_NO_USABLE_TLS1_3
+#if defined(OPENSSL_NO_TLS1_3) \
+    || (defined(OPENSSL_NO_EC) && defined(OPENSSL_NO_DH))
+# define OSSL_NO_USABLE_TLS1_3
+#endif
+
+#ifndef OPENSSL_NO_OCSP
+
+static char *responder = NULL;
+static char *server_pem = NULL;
+static char *staple_file = NULL;
+
+/* The last OCSP response the client was sent */
+static unsigned char *stapled = NULL;
+static long stapled_len = 0;
+
+static int status_cb(SSL *s, void *arg)
+{
+    const unsigned char *p;
+    long len = SSL_get_tlsext_status_ocsp_resp(s, &p);
+
+    OPENSSL_free(stapled);
+    stapled = NULL;
+    stapled_len = 0;
+    if (len > 0 && (stapled = OPENSSL_memdup(p, len)) != NULL)
+        stapled_len = len;
+    return 1;
+}
+
+static int stapled_response_ok(void)
+{
+    const unsigned char *p = stapled;
+    OCSP_RESPONSE *resp;
+    int ret;
+
+    if (!TEST_ptr(stapled)
+            || !TEST_ptr(resp = d2i_OCSP_RESPONSE(NULL, &p, stapled_len)))
+        return 0;
+    ret = TEST_int_eq(OCSP_response_status(resp),
+                      OCSP_RESPONSE_STATUS_SUCCESSFUL);
+    OCSP_RESPONSE_free(resp);
+    return ret;
+}
+
+static int make_ctxs(int version, SSL_CTX **sctx, SSL_CTX **cctx)
+{
+    if (!TEST_true(create_ssl_ctx_pair(NULL, TLS_server_method(),
+                                       TLS_client_method(), version, version,
+                                       sctx, cctx, NULL, NULL))
+            /* server.pem holds the certificate, its key and its issuer */
+            || !TEST_int_eq(SSL_CTX_use_certificate_chain_file(*sctx,
+                                                               server_pem), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(*sctx, server_pem,
+                                                        SSL_FILETYPE_PEM), 1)
+            || !TEST_true(SSL_CTX_set_tlsext_status_cb(*cctx, status_cb)))
+        return 0;
+    return 1;
+}
+
+static int do_handshake(SSL_CTX *sctx, SSL_CTX *cctx)
+{
+    SSL *serverssl = NULL, *clientssl = NULL;
+    int ret = 0;
+
+    OPENSSL_free(stapled);
+    stapled = NULL;
+    stapled_len = 0;
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(SSL_set_tlsext_status_type(clientssl,
+                                                     TLSEXT_STATUSTYPE_ocsp))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+    ret = 1;
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    return ret;
+}
+
+/*
+ * Staple responses fetched from the responder, by the background thread
+ * (idx 0 and 1) or on demand (idx 2 and 3), with TLSv1.2 and TLSv1.3
+ */
+static int test_stapling_http(int idx)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    uint64_t flags = idx < 2 ? 0 : SSL_OCSP_STAPLING_NO_THREAD;
+    int version = idx % 2 == 0 ? TLS1_2_VERSION : TLS1_3_VERSION;
+    int ret = 0;
+
+# ifdef OPENSSL_NO_TLS1_2
+    if (version == TLS1_2_VERSION)
+        return TEST_skip("TLSv1.2 is disabled");
+# endif
+# ifdef OSSL_NO_USABLE_TLS1_3
+    if (version == TLS1_3_VERSION)
+        return TEST_skip("No usable TLSv1.3");
+# endif
+
+    if (!make_ctxs(version, &sctx, &cctx))
+        goto end;
+
+    /* No staple before stapling is enabled */
+    if (!TEST_true(do_handshake(sctx, cctx))
+            || !TEST_ptr_null(stapled))
+        goto end;
+
+    if (!TEST_true(SSL_CTX_enable_ocsp_stapling(sctx, responder, flags))
+            || !TEST_true(do_handshake(sctx, cctx))
+            || !stapled_response_ok())
+        goto end;
+
+    if (!TEST_true(SSL_CTX_refresh_ocsp_staples(sctx))
+            || !TEST_true(do_handshake(sctx, cctx))
+            || !stapled_response_ok())
+        goto end;
+
+    ret = 1;
+ end:
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return ret;
+}
+
+/*
+ * Staple a response read from a file and keep stapling it while the file
+ * cannot be read
+ */
+static int test_stapling_file(void)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    char *source = NULL;
+    BIO *out = NULL;
+    int ret = 0;
+
+    if (!make_ctxs(0, &sctx, &cctx)
+            || !TEST_true(SSL_CTX_enable_ocsp_stapling(sctx, responder,
+                                                       SSL_OCSP_STAPLING_NO_THREAD))
+            || !TEST_true(do_handshake(sctx, cctx))
+            || !stapled_response_ok())
+        goto end;
+
+    if (!TEST_ptr(out = BIO_new_file(staple_file, "wb"))
+            || !TEST_int_eq(BIO_write(out, stapled, (int)stapled_len),
+                            (int)stapled_len))
+        goto end;
+    BIO_free(out);
+    out = NULL;
+
+    if (!TEST_ptr(source = OPENSSL_malloc(strlen(staple_file) + 6)))
+        goto end;
+    strcpy(source, "file:");
+    strcat(source, staple_file);
+    if (!TEST_true(SSL_CTX_enable_ocsp_stapling(sctx, source,
+                                                SSL_OCSP_STAPLING_NO_THREAD))
+            || !TEST_true(do_handshake(sctx, cctx))
+            || !stapled_response_ok())
+        goto end;
+
+    if (!TEST_int_eq(remove(staple_file), 0)
+            || !TEST_false(SSL_CTX_refresh_ocsp_staples(sctx))
+            || !TEST_true(do_handshake(sctx, cctx))
+            || !stapled_response_ok())
+        goto end;
+
+    ret = 1;
+ end:
+    BIO_free(out);
+    OPENSSL_free(source);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return ret;
+}
+
+static int test_stapling_errors(void)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    int ret = 0;
+
+    if (!make_ctxs(0, &sctx, &cctx))
+        goto end;
+
+    /* server.pem does not name an OCSP responder */
+    ERR_clear_error();
+    if (!TEST_false(SSL_CTX_enable_ocsp_stapling(sctx, NULL, 0))
+            || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                            SSL_R_NO_OCSP_RESPONDER))
+        goto end;
+
+    if (!TEST_false(SSL_CTX_enable_ocsp_stapling(sctx, "file:nonexistent.der",
+                                                 0))
+            || !TEST_false(SSL_CTX_refresh_ocsp_staples(sctx)))
+        goto end;
+
+    /* Nothing is stapled after the failures */
+    if (!TEST_true(do_handshake(sctx, cctx))
+            || !TEST_ptr_null(stapled))
+        goto end;
+
+    ret = 1;
+ end:
+    ERR_clear_error();
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return ret;
+}
+
+#endif /* OPENSSL_NO_OCSP */
+
+OPT_TEST_DECLARE_USAGE("responder_url server.pem tmpfile\n")
+
+int setup_tests(void)
+{
+    if (!test_skip_common_options()) {
+        TEST_error("Error parsing test options\n");
+        return 0;
+    }
+
+#ifndef OPENSSL_NO_OCSP
+    if (!TEST_ptr(responder = test_get_argument(0))
+            || !TEST_ptr(server_pem = test_get_argument(1))
+            || !TEST_ptr(staple_file = test_get_argument(2)))
+        return 0;
+
+    ADD_ALL_TESTS(test_stapling_http, 4);
+    ADD_TEST(test_stapling_file);
+    ADD_TEST(test_stapling_errors);
+#endif
+    return 1;
+}
+
+void cleanup_tests(void)
+{
+#ifndef OPENSSL_NO_OCSP
+    OPENSSL_free(stapled);
+#endif
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 2017-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2017-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -125,6 +125,71 @@ static int test_empty_payload(void)
     return ret;
 }
 
+/*
+ * The data is decoded line by line while reading, check that larger objects
+ * with and without a header come back unchanged.
+ */
+static int test_write_read(int idx)
+{
+    static const char *hdr = "Proc-Type: 4,ENCRYPTED\n"
+                             "DEK-Info: AES-128-CBC,00112233445566778899AABBCCDDEEFF\n";
+    BIO *b = BIO_new(BIO_s_mem());
+    unsigned char raw[3000];
+    char *name = NULL, *header = NULL;
+    unsigned char *data = NULL;
+    long len;
+    size_t i;
+    int ret = 0;
+
+    for (i = 0; i < sizeof(raw); i++)
+        raw[i] = (unsigned char)(i * 7 + idx);
+    if (!TEST_ptr(b)
+        || !TEST_true(PEM_write_bio(b, pemtype, idx == 0 ? "" : hdr,
+                                    raw, (long)(sizeof(raw) - idx)))
+        || !TEST_true(PEM_read_bio_ex(b, &name, &header, &data, &len, 0))
+        || !TEST_str_eq(name, pemtype)
+        || !TEST_str_eq(header, idx == 0 ? "" : hdr)
+        || !TEST_mem_eq(data, len, raw, sizeof(raw) - idx))
+        goto err;
+    ret = 1;
+ err:
+    BIO_free(b);
+    OPENSSL_free(name);
+    OPENSSL_free(header);
+    OPENSSL_free(data);
+    return ret;
+}
+
+static int test_data_after_padding(void)
+{
+    BIO *b;
+    static char *pay =
+        "-----BEGIN PEMTESTDATA-----\n"
+        "aGVsbG8gd29ybGQ=\n"
+        "aGVsbG8gd29ybGQ=\n"
+        "-----END PEMTESTDATA-----\n";
+    char *name = NULL, *header = NULL;
+    unsigned char *data = NULL;
+    long len;
+    int ret = 0;
+
+    b = BIO_new_mem_buf(pay, strlen(pay));
+    if (!TEST_ptr(b))
+        return 0;
+
+    /* Expected to fail because there is more data after the padding */
+    if (!TEST_false(PEM_read_bio_ex(b, &name, &header, &data, &len, 0)))
+        goto err;
+
+    ret = 1;
+ err:
+    OPENSSL_free(name);
+    OPENSSL_free(header);
+    OPENSSL_free(data);
+    BIO_free(b);
+    return ret;
+}
+
 static int test_protected_params(void)
 {
     BIO *b;
@@ -162,6 +227,8 @@ int setup_tests(void)
     ADD_TEST(test_invalid);
     ADD_TEST(test_cert_key_cert);
     ADD_TEST(test_empty_payload);
+    ADD_ALL_TESTS(test_write_read, 2);
+    ADD_TEST(test_data_after_padding);
     ADD_TEST(test_protected_params);
     return 1;
 }
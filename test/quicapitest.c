@@ -1029,6 +1029,66 @@ static int test_back_pressure(void)
     return testresult;
 }
 
+/* Test that SSL_writev_ex() sends the buffers as one stream of data */
+static int test_quic_writev(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0, i;
+    static const char hdr[] = "HTTP/1.1 200 OK\r\n\r\n";
+    unsigned char body[3000], expected[sizeof(hdr) - 1 + sizeof(body) + 2];
+    unsigned char buf[sizeof(expected)];
+    SSL_IOVEC iov[4];
+    size_t readbytes, total = 0, written;
+
+    for (i = 0; i < (int)sizeof(body); i++)
+        body[i] = (unsigned char)i;
+    iov[0].base = hdr;
+    iov[0].len = sizeof(hdr) - 1;
+    iov[1].base = NULL;
+    iov[1].len = 0;
+    iov[2].base = body;
+    iov[2].len = sizeof(body);
+    iov[3].base = "\r\n";
+    iov[3].len = 2;
+    memcpy(expected, hdr, sizeof(hdr) - 1);
+    memcpy(expected + sizeof(hdr) - 1, body, sizeof(body));
+    memcpy(expected + sizeof(hdr) - 1 + sizeof(body), "\r\n", 2);
+
+    if (!TEST_ptr(cctx)
+            || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                                    privkey, 0, &qtserv,
+                                                    &clientquic, NULL, NULL))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    if (!TEST_true(SSL_writev_ex(clientquic, iov, OSSL_NELEM(iov),
+                                 SSL_WRITE_FLAG_CONCLUDE, &written))
+            || !TEST_size_t_eq(written, sizeof(expected)))
+        goto err;
+
+    for (i = 0; i < 100 && total < sizeof(expected); i++) {
+        SSL_handle_events(clientquic);
+        ossl_quic_tserver_tick(qtserv);
+        if (!TEST_true(ossl_quic_tserver_read(qtserv, 0, buf + total,
+                                              sizeof(buf) - total,
+                                              &readbytes)))
+            goto err;
+        total += readbytes;
+    }
+    if (!TEST_mem_eq(buf, total, expected, sizeof(expected))
+            || !TEST_true(ossl_quic_tserver_has_read_ended(qtserv, 0)))
+        goto err;
+
+    testresult = 1;
+ err:
+    SSL_free(clientquic);
+    ossl_quic_tserver_free(qtserv);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
 
 static int dgram_ctr = 0;
 
@@ -2339,6 +2399,7 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_quic_set_fd, 3);
     ADD_TEST(test_bio_ssl);
     ADD_TEST(test_back_pressure);
+    ADD_TEST(test_quic_writev);
     ADD_TEST(test_multiple_dgrams);
     ADD_ALL_TESTS(test_non_io_retry, 2);
     ADD_TEST(test_quic_psk);
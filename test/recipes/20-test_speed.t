@@ -17,7 +17,7 @@ use OpenSSL::Test::Utils;
 
 setup("test_speed");
 
-plan tests => 25;
+plan tests => 27;
 
 ok(run(app(['openssl', 'speed', '-testmode'])),
        "Simple test of all speed algorithms");
@@ -111,6 +111,13 @@ ok(run(app(['openssl', 'speed', '-testmode', '-seconds', 1, '-bytes', 1,
             'aes-128-cbc'])),
        "Test that bad bytes value doesn't make speed to crash");
 
+ok(run(app(['openssl', 'speed', '-testmode', '-bytes', 16, '-rand_buffer', 0,
+            'rand', 'drbg'])),
+       "Test the rand_buffer option and the DRBG algorithms");
+
+ok(run(app(['openssl', 'speed', '-testmode', '-bytes', 1000, 'base64'])),
+       "Test the base64 algorithms");
+
 #No need to -testmode for testing -help. All we're doing is testing the option
 #parsing. We don't sanity check the output
 ok(run(app(['openssl', 'speed', '-help'])),
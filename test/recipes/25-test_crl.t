@@ -1,5 +1,5 @@
 #! /usr/bin/env perl
-# Copyright 2015-2021 The OpenSSL Project Authors. All Rights Reserved.
+# Copyright 2015-2025 The OpenSSL Project Authors. All Rights Reserved.
 #
 # Licensed under the Apache License 2.0 (the "License").  You may not use
 # this file except in compliance with the License.  You can obtain a copy
@@ -11,6 +11,7 @@ use strict;
 use warnings;
 
 use File::Spec;
+use File::Temp qw(tempdir);
 use OpenSSL::Test qw/:DEFAULT srctop_file/;
 
 setup("test_crl");
@@ -27,7 +28,9 @@ subtest 'crl conversions' => sub {
     tconversion( -type => "crl", -in => srctop_file("test","testcrl.pem") );
 };
 
-ok(run(test(['crltest'])));
+# crltest writes the files of indexed CRLs to a directory of its own
+my $tmpdir = tempdir(CLEANUP => 1);
+ok(run(test(['crltest', $tmpdir])));
 
 ok(compare1stline([qw{openssl crl -noout -fingerprint -in},
                    srctop_file('test', 'testcrl.pem')],
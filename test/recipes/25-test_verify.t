@@ -29,7 +29,7 @@ sub verify {
     run(app([@args]));
 }
 
-plan tests => 193;
+plan tests => 195;
 
 # Canonical success
 ok(verify("ee-cert", "sslserver", ["root-cert"], ["ca-cert"]),
@@ -589,3 +589,21 @@ ok(!verify("ee-cert-policies-bad", "", ["root-cert"], ["ca-pol-cert"],
            "-policy_check", "-policy", "1.3.6.1.4.1.16604.998855.1",
            "-explicit_policy"),
    "Bad certificate policy");
+
+# Parallel verification, the results must be reported in order
+SKIP: {
+    skip "thread pool disabled", 2 if disabled("thread-pool");
+
+    my @path = qw(test certs);
+    my @args = (qw(openssl verify -auth_level 1 -parallel 4 -trusted),
+                srctop_file(@path, "root-cert.pem"),
+                "-untrusted", srctop_file(@path, "ca-cert.pem"));
+    my @good = map { srctop_file(@path, "$_.pem") }
+                   qw(ee-cert ee-client ee-cert ee-client ee-cert);
+    my @out = run(app([@args, @good]), capture => 1);
+    my @expected = map { "$_: OK\n" } @good;
+
+    is_deeply(\@out, \@expected, "parallel verify in order");
+    ok(!run(app([@args, @good, srctop_file(@path, "ee-cert2.pem")])),
+       "parallel verify reports a failure");
+}
@@ -6,11 +6,28 @@
 # https://www.openssl.org/source/license.html
 
 
+use File::Copy;
 use OpenSSL::Test qw/:DEFAULT srctop_file/;
 
 setup("test_load_cert_file");
 
-plan tests => 1;
+plan tests => 2;
 
 ok(run(test(["x509_load_cert_file_test", srctop_file("test", "certs", "leaf-chain.pem"),
              srctop_file("test", "certs", "cyrillic_crl.pem")])));
+
+SKIP: {
+    # The rehash command is not available on all platforms (e.g. Windows)
+    skip "rehash is not available on this platform", 1
+        unless run(app(["openssl", "rehash", "-help"]));
+
+    indir "load_cert_file.$$" => sub {
+        copy(srctop_file("test", "certs", "leaf-chain.pem"), "leaf-chain.pem");
+        ok(run(app(["openssl", "rehash", "-index", "certs.idx", "."]))
+           && run(test(["x509_load_cert_file_test",
+                        srctop_file("test", "certs", "leaf-chain.pem"),
+                        srctop_file("test", "certs", "cyrillic_crl.pem"),
+                        "certs.idx"])),
+           "Look up certificates in an index written by rehash");
+    }, create => 1, cleanup => 1;
+}
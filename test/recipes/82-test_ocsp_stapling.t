@@ -0,0 +1,64 @@
+#! /usr/bin/env perl
+# Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+use strict;
+use warnings;
+
+use IPC::Open3;
+use OpenSSL::Test qw/:DEFAULT srctop_file bldtop_file/;
+use OpenSSL::Test::Utils;
+use Symbol 'gensym';
+
+my $test_name = "test_ocsp_stapling";
+setup($test_name);
+
+plan skip_all => "$test_name requires OCSP support"
+    if disabled("ocsp");
+plan skip_all => "$test_name requires EC cryptography"
+    if disabled("ec");
+plan skip_all => "$test_name requires sock enabled"
+    if disabled("sock");
+plan skip_all => "$test_name requires TLS enabled"
+    if alldisabled(available_protocols("tls"));
+plan skip_all => "$test_name is not available Windows or VMS"
+    if $^O =~ /^(VMS|MSWin32|msys)$/;
+
+plan tests => 2;
+
+my $shlib_wrap   = bldtop_file("util", "shlib_wrap.sh");
+my $apps_openssl = bldtop_file("apps", "openssl");
+
+my $index_txt             = srctop_file("test", "ocsp-tests", "index.txt");
+my $ocsp_pem              = srctop_file("test", "ocsp-tests", "ocsp.pem");
+my $intermediate_cert_pem = srctop_file("test", "ocsp-tests", "intermediate-cert.pem");
+my $server_pem            = srctop_file("test", "ocsp-tests", "server.pem");
+
+# The responder listens on a port chosen by the OS, see
+# 82-test_ocsp_cert_chain.t
+my @ocsp_cmd = ("ocsp", "-port", "0", "-index", $index_txt,
+                "-rsigner", $ocsp_pem, "-CA", $intermediate_cert_pem);
+my $ocsp_pid = open3(my $ocsp_i, my $ocsp_o, my $ocsp_e = gensym,
+                     $shlib_wrap, $apps_openssl, @ocsp_cmd);
+
+my $port = "0";
+while (<$ocsp_o>) {
+    print($_);
+    chomp;
+    if (/^ACCEPT 0.0.0.0:(\d+)/ || /^ACCEPT \[::\]:(\d+)/) {
+        $port = $1;
+    }
+    last;
+}
+ok($port ne "0", "ocsp server port check");
+
+ok(run(test(["ocsp_stapling_test", "http://localhost:${port}/ocsp",
+             $server_pem, "ocsp-staple.der"])),
+   "running ocsp_stapling_test");
+
+kill 'HUP', $ocsp_pid;
+waitpid($ocsp_pid, 0);
@@ -1,11 +1,21 @@
 #! /usr/bin/env perl
-# Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+# Copyright 2024-2025 The OpenSSL Project Authors. All Rights Reserved.
 #
 # Licensed under the Apache License 2.0 (the "License").  You may not use
 # this file except in compliance with the License.  You can obtain a copy
 # in the file LICENSE in the source distribution or at
 # https://www.openssl.org/source/license.html
 
-use OpenSSL::Test::Simple;
+use OpenSSL::Test;
 
-simple_test("test_bio_base64", "bio_base64_test", "bio_base64");
+setup("test_bio_base64");
+
+plan tests => 2;
+
+ok(run(test(["bio_base64_test"])), "running bio_base64_test");
+
+# Again without the AVX2 code, on x86_64 this leaves the C block decoder
+{
+    local $ENV{OPENSSL_ia32cap} = ":~0x20";
+    ok(run(test(["bio_base64_test"])), "running bio_base64_test without AVX2");
+}
@@ -22,9 +22,12 @@
 #include <openssl/err.h>
 #include <openssl/rand.h>
 #include <openssl/bn.h>
+#include <openssl/thread.h>
 
 #include "testutil.h"
 
+#include "crypto/bn.h"
+
 #include "rsa_local.h"
 #include <openssl/rsa.h>
 
@@ -500,6 +503,85 @@ static int test_sp80056b_keygen(int id)
     return ret;
 }
 
+#ifndef OPENSSL_NO_DEFAULT_THREAD_POOL
+static int test_sp80056b_keygen_threads(void)
+{
+    OSSL_LIB_CTX *libctx = NULL;
+    RSA *key = NULL;
+    int ret;
+
+    ret = TEST_ptr(libctx = OSSL_LIB_CTX_new())
+          && TEST_true(OSSL_set_max_threads(libctx, 4))
+          && TEST_ptr(key = ossl_rsa_new_with_ctx(libctx));
+    if (ret) {
+        ossl_rsa_set_gen_threads(key, 4);
+        ret = TEST_true(ossl_rsa_sp800_56b_generate_key(key, 3072, NULL, NULL))
+              && TEST_true(ossl_rsa_sp800_56b_check_keypair(key, NULL, -1,
+                                                            3072));
+    }
+
+    RSA_free(key);
+    OSSL_LIB_CTX_free(libctx);
+    return ret;
+}
+
+/*
+ * The parallel prime search must find the same prime as the serial one when
+ * given the same starting values.
+ */
+static int test_derive_prime_threads(void)
+{
+    OSSL_LIB_CTX *libctx = NULL;
+    BN_CTX *ctx = NULL;
+    BIGNUM *e = NULL, *Xp = NULL, *Xp1 = NULL, *Xp2 = NULL;
+    BIGNUM *p = NULL, *p_threads = NULL, *Xpout = NULL;
+    int ret = 0;
+
+    if (!TEST_ptr(libctx = OSSL_LIB_CTX_new())
+            || !TEST_true(OSSL_set_max_threads(libctx, 4))
+            || !TEST_ptr(ctx = BN_CTX_new_ex(libctx))
+            || !TEST_ptr(e = BN_new())
+            || !TEST_ptr(Xp = BN_new())
+            || !TEST_ptr(Xp1 = BN_new())
+            || !TEST_ptr(Xp2 = BN_new())
+            || !TEST_ptr(p = BN_new())
+            || !TEST_ptr(p_threads = BN_new())
+            || !TEST_ptr(Xpout = BN_new())
+            || !TEST_true(BN_set_word(e, 65537))
+            || !TEST_true(BN_rand(Xp1, 141, BN_RAND_TOP_ONE,
+                                  BN_RAND_BOTTOM_ODD))
+            || !TEST_true(BN_rand(Xp2, 141, BN_RAND_TOP_ONE,
+                                  BN_RAND_BOTTOM_ODD)))
+        goto err;
+
+    /* Let the serial search pick an X that leads to a prime */
+    if (!TEST_true(ossl_bn_rsa_fips186_4_gen_prob_primes(p, Xp, NULL, NULL,
+                                                         NULL, Xp1, Xp2, 2048,
+                                                         e, 1, ctx, NULL))
+            || !TEST_true(ossl_bn_rsa_fips186_4_gen_prob_primes(p_threads,
+                                                                Xpout, NULL,
+                                                                NULL, Xp, Xp1,
+                                                                Xp2, 2048, e,
+                                                                4, ctx, NULL))
+            || !TEST_BN_eq(p, p_threads)
+            || !TEST_BN_eq(Xp, Xpout))
+        goto err;
+
+    ret = 1;
+err:
+    BN_free(e);
+    BN_free(Xp);
+    BN_free(Xp1);
+    BN_free(Xp2);
+    BN_free(p);
+    BN_free(p_threads);
+    BN_free(Xpout);
+    BN_CTX_free(ctx);
+    OSSL_LIB_CTX_free(libctx);
+    return ret;
+}
+#endif
+
 static int test_check_private_key(void)
 {
     int ret = 0;
@@ -586,5 +668,9 @@ int setup_tests(void)
     ADD_TEST(test_invalid_keypair);
     ADD_TEST(test_pq_diff);
     ADD_ALL_TESTS(test_sp80056b_keygen, (int)OSSL_NELEM(keygen_size));
+#ifndef OPENSSL_NO_DEFAULT_THREAD_POOL
+    ADD_TEST(test_sp80056b_keygen_threads);
+    ADD_TEST(test_derive_prime_threads);
+#endif
     return 1;
 }
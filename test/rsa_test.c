@@ -278,6 +278,56 @@ static int test_rsa_pkcs1(int idx)
                            NULL, NULL);
 }
 
+/*
+ * Private key operations with keys that are alive at the same time, more of
+ * them than a thread keeps blindings for, and with keys that are freed and
+ * replaced by others, which are likely to be allocated at the same address.
+ */
+static int test_rsa_blinding_many_keys(void)
+{
+    int ret = 0;
+    RSA *keys[7] = { NULL };
+    unsigned char ptext[256];
+    unsigned char ctext[256];
+    unsigned char ctext_ex[256];
+    static unsigned char ptext_ex[] = "\x54\x85\x9b\x34\x2c\x49\xea\x2a";
+    int plen = sizeof(ptext_ex) - 1;
+    int i, round, num;
+
+    for (i = 0; i < (int)OSSL_NELEM(keys); i++)
+        if (!TEST_int_gt(rsa_setkey(&keys[i], ctext_ex, i % 3), 0))
+            goto err;
+
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < (int)OSSL_NELEM(keys); i++) {
+            num = RSA_public_encrypt(plen, ptext_ex, ctext, keys[i],
+                                     RSA_PKCS1_PADDING);
+            if (!TEST_int_gt(num, 0))
+                goto err;
+            num = RSA_private_decrypt(num, ctext, ptext, keys[i],
+                                      RSA_PKCS1_PADDING);
+            if (!TEST_mem_eq(ptext, num, ptext_ex, plen)) {
+                TEST_info("round %d, key %d", round, i);
+                goto err;
+            }
+        }
+        /* Replace every other key with one with a different modulus */
+        for (i = round % 2; i < (int)OSSL_NELEM(keys); i += 2) {
+            RSA_free(keys[i]);
+            keys[i] = NULL;
+            if (!TEST_int_gt(rsa_setkey(&keys[i], ctext_ex, (i + round) % 3),
+                             0))
+                goto err;
+        }
+    }
+
+    ret = 1;
+err:
+    for (i = 0; i < (int)OSSL_NELEM(keys); i++)
+        RSA_free(keys[i]);
+    return ret;
+}
+
 static int test_rsa_oaep(int idx)
 {
     int ret = 0;
@@ -713,6 +763,7 @@ int setup_tests(void)
 {
     ADD_ALL_TESTS(test_rsa_pkcs1, 3);
     ADD_ALL_TESTS(test_rsa_oaep, 3);
+    ADD_TEST(test_rsa_blinding_many_keys);
     ADD_ALL_TESTS(test_rsa_security_bit, OSSL_NELEM(rsa_security_bits_cases));
     ADD_TEST(test_rsa_saos);
     ADD_TEST(test_EVP_rsa_legacy_key);
@@ -1300,14 +1300,22 @@ end:
 #define SENDFILE_CHUNK                  (4 * 4096)
 #define min(a,b)                        ((a) > (b) ? (b) : (a))
 
+/* How execute_test_ktls_sendfile() hands the data to the kernel */
+#define SENDFILE_MODE_PLAIN             0
+#define SENDFILE_MODE_ZEROCOPY_OPTION   1
+#define SENDFILE_MODE_ZEROCOPY_FLAG     2
+#define SENDFILE_MODE_SPLICE            3
+#define SENDFILE_MODES                  4
+
 static int execute_test_ktls_sendfile(int tls_version, const char *cipher,
-                                      int zerocopy)
+                                      int mode)
 {
     SSL_CTX *cctx = NULL, *sctx = NULL;
     SSL *clientssl = NULL, *serverssl = NULL;
     unsigned char *buf, *buf_dst;
     BIO *out = NULL, *in = NULL;
-    int cfd = -1, sfd = -1, ffd, err;
+    int cfd = -1, sfd = -1, ffd, err, flags = 0;
+    int pipefd[2] = { -1, -1 };
     ssize_t chunk_size = 0;
     off_t chunk_off = 0;
     int testresult = 0;
@@ -1358,10 +1366,21 @@ static int execute_test_ktls_sendfile(int tls_version, const char *cipher,
     if (!TEST_true(SSL_set_options(serverssl, SSL_OP_ENABLE_KTLS)))
         goto end;
 
-    if (zerocopy) {
+    if (mode == SENDFILE_MODE_ZEROCOPY_OPTION) {
         if (!TEST_true(SSL_set_options(serverssl,
                                        SSL_OP_ENABLE_KTLS_TX_ZEROCOPY_SENDFILE)))
             goto end;
+    } else if (mode == SENDFILE_MODE_ZEROCOPY_FLAG) {
+        flags = SSL_SENDFILE_FLAG_ZEROCOPY;
+    } else if (mode == SENDFILE_MODE_SPLICE) {
+# if defined(OPENSSL_SYS_LINUX)
+        if (!TEST_int_eq(pipe(pipefd), 0))
+            goto end;
+        flags = SSL_SENDFILE_FLAG_SPLICE;
+# else
+        testresult = TEST_skip("splice is only supported on Linux");
+        goto end;
+# endif
     }
 
     if (!TEST_true(create_ssl_connection(serverssl, clientssl,
@@ -1391,13 +1410,21 @@ static int execute_test_ktls_sendfile(int tls_version, const char *cipher,
     BIO_get_fp(in, &ffdp);
     ffd = fileno(ffdp);
 
+    /* With splice the data comes from a pipe that is fed from the file */
+    if (pipefd[0] != -1)
+        ffd = pipefd[0];
+
     while (chunk_off < SENDFILE_SZ) {
         chunk_size = min(SENDFILE_CHUNK, SENDFILE_SZ - chunk_off);
+        if (pipefd[1] != -1
+                && !TEST_int_eq(write(pipefd[1], buf + chunk_off, chunk_size),
+                                chunk_size))
+            goto end;
         while ((err = SSL_sendfile(serverssl,
                                    ffd,
                                    chunk_off,
                                    chunk_size,
-                                   0)) != chunk_size) {
+                                   flags)) != chunk_size) {
             if (SSL_get_error(serverssl, err) != SSL_ERROR_WANT_WRITE)
                 goto end;
         }
@@ -1437,11 +1464,156 @@ end:
         close(cfd);
     if (sfd != -1)
         close(sfd);
+    if (pipefd[0] != -1)
+        close(pipefd[0]);
+    if (pipefd[1] != -1)
+        close(pipefd[1]);
     OPENSSL_free(buf);
     OPENSSL_free(buf_dst);
     return testresult;
 }
 
+# if !defined(OSSL_NO_USABLE_TLS1_3)
+/*
+ * Transfer |len| bytes of |buf| from |writer| to |reader| and check that
+ * they arrive unchanged.
+ */
+static int ktls_transfer(SSL *writer, SSL *reader, const unsigned char *buf,
+                         unsigned char *dst, size_t len)
+{
+    size_t written = 0, readbytes = 0, n;
+
+    memset(dst, 0, len);
+    while (written < len || readbytes < len) {
+        if (written < len) {
+            if (SSL_write_ex(writer, buf + written, len - written, &n))
+                written += n;
+            else if (!TEST_int_eq(SSL_get_error(writer, 0),
+                                  SSL_ERROR_WANT_WRITE))
+                return 0;
+        }
+        if (SSL_read_ex(reader, dst + readbytes, len - readbytes, &n))
+            readbytes += n;
+        else if (!TEST_int_eq(SSL_get_error(reader, 0), SSL_ERROR_WANT_READ))
+            return 0;
+    }
+
+    return TEST_mem_eq(buf, len, dst, len);
+}
+
+/*
+ * Test that TLS 1.3 key updates in both directions keep the kernel doing the
+ * record processing and that the data is transferred unchanged.
+ */
+static int execute_test_ktls_key_update(const char *cipher)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    SSL_CONNECTION *clientsc, *serversc;
+    unsigned char *buf = NULL, *buf_dst = NULL;
+    const size_t bufsz = 4 * SSL3_RT_MAX_PLAIN_LENGTH;
+    int cfd = -1, sfd = -1, testresult = 0, i;
+
+    if (!TEST_true(create_test_sockets(&cfd, &sfd, SOCK_STREAM, NULL)))
+        goto end;
+
+    if (!ktls_chk_platform(cfd)) {
+        testresult = TEST_skip("Kernel does not support KTLS");
+        goto end;
+    }
+
+    if (is_fips && strstr(cipher, "CHACHA") != NULL) {
+        testresult = TEST_skip("CHACHA is not supported in FIPS");
+        goto end;
+    }
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       TLS1_3_VERSION, TLS1_3_VERSION,
+                                       &sctx, &cctx, cert, privkey))
+        || !TEST_true(SSL_CTX_set_ciphersuites(cctx, cipher))
+        || !TEST_true(SSL_CTX_set_ciphersuites(sctx, cipher))
+        || !TEST_true(create_ssl_objects2(sctx, cctx, &serverssl,
+                                          &clientssl, sfd, cfd))
+        || !TEST_ptr(clientsc = SSL_CONNECTION_FROM_SSL_ONLY(clientssl))
+        || !TEST_ptr(serversc = SSL_CONNECTION_FROM_SSL_ONLY(serverssl))
+        || !TEST_true(SSL_set_options(clientssl, SSL_OP_ENABLE_KTLS))
+        || !TEST_true(SSL_set_options(serverssl, SSL_OP_ENABLE_KTLS))
+        || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                            SSL_ERROR_NONE)))
+        goto end;
+
+    if (!BIO_get_ktls_send(clientsc->wbio)
+            || !BIO_get_ktls_recv(clientsc->rbio)
+            || !BIO_get_ktls_send(serversc->wbio)
+            || !BIO_get_ktls_recv(serversc->rbio)) {
+        testresult = TEST_skip("KTLS not supported in both directions for %s",
+                               cipher);
+        goto end;
+    }
+
+    buf = OPENSSL_malloc(bufsz);
+    buf_dst = OPENSSL_malloc(bufsz);
+    if (!TEST_ptr(buf) || !TEST_ptr(buf_dst)
+            || !TEST_int_gt(RAND_bytes_ex(libctx, buf, bufsz, 0), 0)
+            || !TEST_true(ktls_transfer(clientssl, serverssl, buf, buf_dst,
+                                        bufsz)))
+        goto end;
+
+    for (i = 0; i < 2; i++) {
+        SSL *updater = i == 0 ? clientssl : serverssl;
+        SSL *peer = i == 0 ? serverssl : clientssl;
+
+        /*
+         * The peer updates its own sending keys in response, so this covers
+         * both a TLS_TX and a TLS_RX rekey on each side.
+         */
+        if (!TEST_true(SSL_key_update(updater, SSL_KEY_UPDATE_REQUESTED)))
+            goto end;
+        if (!ktls_transfer(updater, peer, buf, buf_dst, bufsz)) {
+#ifndef OPENSSL_KTLS_TLS13_REKEY
+            /* Without it the new keys can't be handed to the kernel */
+            if (ERR_GET_REASON(ERR_peek_last_error())
+                    == SSL_R_RECORD_LAYER_FAILURE) {
+                ERR_clear_error();
+                testresult = TEST_skip("Kernel does not support TLS 1.3 KTLS key updates");
+            }
+#endif
+            goto end;
+        }
+        if (!TEST_true(ktls_transfer(peer, updater, buf, buf_dst, bufsz)))
+            goto end;
+    }
+
+    /* The kernel must still be doing the record processing */
+    if (!TEST_true(BIO_get_ktls_send(clientsc->wbio))
+            || !TEST_true(BIO_get_ktls_recv(clientsc->rbio))
+            || !TEST_true(BIO_get_ktls_send(serversc->wbio))
+            || !TEST_true(BIO_get_ktls_recv(serversc->rbio)))
+        goto end;
+
+    testresult = 1;
+end:
+    OPENSSL_free(buf);
+    OPENSSL_free(buf_dst);
+    if (clientssl) {
+        SSL_shutdown(clientssl);
+        SSL_free(clientssl);
+    }
+    if (serverssl) {
+        SSL_shutdown(serverssl);
+        SSL_free(serverssl);
+    }
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    if (cfd != -1)
+        close(cfd);
+    if (sfd != -1)
+        close(sfd);
+    return testresult;
+}
+# endif
+
 static struct ktls_test_cipher {
     int tls_version;
     const char *cipher;
@@ -1498,14 +1670,29 @@ static int test_ktls(int test)
 static int test_ktls_sendfile(int test)
 {
     struct ktls_test_cipher *cipher;
-    int tst = test >> 1;
+    int tst = test / SENDFILE_MODES;
 
     OPENSSL_assert(tst < (int)NUM_KTLS_TEST_CIPHERS);
     cipher = &ktls_test_ciphers[tst];
 
     return execute_test_ktls_sendfile(cipher->tls_version, cipher->cipher,
-                                      test & 1);
+                                      test % SENDFILE_MODES);
 }
+
+# if !defined(OSSL_NO_USABLE_TLS1_3)
+static int test_ktls_key_update(int test)
+{
+    struct ktls_test_cipher *cipher;
+
+    OPENSSL_assert(test < (int)NUM_KTLS_TEST_CIPHERS);
+    cipher = &ktls_test_ciphers[test];
+
+    if (cipher->tls_version != TLS1_3_VERSION)
+        return TEST_skip("Key updates are only done in TLS 1.3");
+
+    return execute_test_ktls_key_update(cipher->cipher);
+}
+# endif
 #endif
 
 static int test_large_message_tls(void)
@@ -11259,6 +11446,474 @@ end:
 }
 #endif /* OSSL_NO_USABLE_TLS1_3 */
 
+/*
+ * Test SSL_read_borrow() and SSL_read_release()
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3
+ */
+static int test_read_borrow(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0, i;
+    unsigned char *msg = NULL, buf[10];
+    const unsigned char *data, *prev;
+    const size_t msglen = 20000;
+    size_t len, written, readbytes;
+    int version = idx == 0 ? TLS1_2_VERSION : TLS1_3_VERSION;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2 in this build");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx == 1)
+        return TEST_skip("No usable TLSv1.3 in this build");
+#endif
+
+    if (!TEST_ptr(msg = OPENSSL_malloc(msglen)))
+        goto end;
+    for (i = 0; i < (int)msglen; i++)
+        msg[i] = (unsigned char)(i * 13);
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), version, version,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    /* Nothing to borrow yet */
+    if (!TEST_false(SSL_read_borrow(serverssl, &data, &len))
+            || !TEST_int_eq(SSL_get_error(serverssl, 0), SSL_ERROR_WANT_READ))
+        goto end;
+
+    /* Two records: a full one and the rest */
+    if (!TEST_true(SSL_write_ex(clientssl, msg, msglen, &written)))
+        goto end;
+
+    /* The first record is handed out whole and can be borrowed again */
+    if (!TEST_true(SSL_read_borrow(serverssl, &data, &len))
+            || !TEST_size_t_eq(len, SSL3_RT_MAX_PLAIN_LENGTH)
+            || !TEST_mem_eq(data, len, msg, len)
+            || !TEST_true(SSL_read_borrow(serverssl, &prev, &len))
+            || !TEST_ptr_eq(prev, data)
+            || !TEST_size_t_eq(len, SSL3_RT_MAX_PLAIN_LENGTH))
+        goto end;
+
+    /* A partial release leaves the rest of the record in place */
+    if (!TEST_true(SSL_read_release(serverssl, 100))
+            || !TEST_true(SSL_read_borrow(serverssl, &data, &len))
+            || !TEST_ptr_eq(data, prev + 100)
+            || !TEST_size_t_eq(len, SSL3_RT_MAX_PLAIN_LENGTH - 100)
+            || !TEST_false(SSL_read_release(serverssl, len + 1))
+            || !TEST_true(SSL_read_release(serverssl, len)))
+        goto end;
+
+    /* A normal read in between invalidates the loan */
+    if (!TEST_true(SSL_read_borrow(serverssl, &data, &len))
+            || !TEST_size_t_eq(len, msglen - SSL3_RT_MAX_PLAIN_LENGTH)
+            || !TEST_mem_eq(data, len, msg + SSL3_RT_MAX_PLAIN_LENGTH, len)
+            || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg + SSL3_RT_MAX_PLAIN_LENGTH,
+                            sizeof(buf))
+            || !TEST_false(SSL_read_release(serverssl, 1)))
+        goto end;
+    ERR_clear_error();
+
+    if (!TEST_true(SSL_read_borrow(serverssl, &data, &len))
+            || !TEST_size_t_eq(len, msglen - SSL3_RT_MAX_PLAIN_LENGTH
+                                    - sizeof(buf))
+            || !TEST_mem_eq(data, len,
+                            msg + SSL3_RT_MAX_PLAIN_LENGTH + sizeof(buf), len)
+            || !TEST_true(SSL_read_release(serverssl, len))
+            || !TEST_size_t_eq(SSL_pending(serverssl), 0)
+            || !TEST_false(SSL_read_borrow(serverssl, &data, &len))
+            || !TEST_int_eq(SSL_get_error(serverssl, 0), SSL_ERROR_WANT_READ))
+        goto end;
+
+    /* The connection carries on normally afterwards */
+    if (!TEST_true(SSL_write_ex(serverssl, msg, 10, &written))
+            || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg, 10))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    OPENSSL_free(msg);
+    return testresult;
+}
+
+/*
+ * Test SSL_CTX_set_record_buffer_pool()
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3
+ */
+static int test_record_buffer_pool(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    SSL_RECORD_BUFFER_POOL_STATS st1, st2;
+    int testresult = 0, i;
+    unsigned char buf[64];
+    size_t written, readbytes;
+    int version = idx == 0 ? TLS1_2_VERSION : TLS1_3_VERSION;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2 in this build");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx == 1)
+        return TEST_skip("No usable TLSv1.3 in this build");
+#endif
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), version, version,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    /* Bad watermarks are rejected and an unset pool has empty statistics */
+    if (!TEST_false(SSL_CTX_set_record_buffer_pool(sctx, 2, 1))
+            || !TEST_true(SSL_CTX_get_record_buffer_pool_stats(sctx, &st1))
+            || !TEST_uint64_t_eq(st1.misses, 0))
+        goto end;
+    ERR_clear_error();
+
+    if (!TEST_true(SSL_CTX_set_record_buffer_pool(sctx, 0, 1024 * 1024))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_true(SSL_CTX_get_record_buffer_pool_stats(sctx, &st1)))
+        goto end;
+
+    /* The server gives its buffers back to the pool once it is idle */
+    if (!TEST_uint64_t_gt(st1.misses, 0)
+            || !TEST_uint64_t_gt(st1.returns, 0)
+            || !TEST_size_t_gt(st1.idle_buffers, 0)
+            || !TEST_size_t_ge(st1.idle_bytes, SSL3_RT_MAX_PLAIN_LENGTH))
+        goto end;
+
+    /* ...and the traffic that follows reuses them */
+    for (i = 0; i < 10; i++) {
+        if (!TEST_true(SSL_write_ex(clientssl, "ping", 4, &written))
+                || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf),
+                                          &readbytes))
+                || !TEST_true(SSL_write_ex(serverssl, buf, readbytes,
+                                           &written))
+                || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf),
+                                          &readbytes))
+                || !TEST_mem_eq(buf, readbytes, "ping", 4))
+            goto end;
+    }
+    if (!TEST_true(SSL_CTX_get_record_buffer_pool_stats(sctx, &st2))
+            || !TEST_uint64_t_ge(st2.hits, st1.hits + 20)
+            || !TEST_uint64_t_eq(st2.misses, st1.misses)
+            || !TEST_size_t_eq(st2.idle_buffers, st1.idle_buffers))
+        goto end;
+
+    /* Lowering the high watermark trims the pool */
+    if (!TEST_true(SSL_CTX_set_record_buffer_pool(sctx, 0, 1))
+            || !TEST_true(SSL_CTX_get_record_buffer_pool_stats(sctx, &st2))
+            || !TEST_size_t_eq(st2.idle_buffers, 0)
+            || !TEST_size_t_eq(st2.idle_bytes, 0)
+            || !TEST_uint64_t_eq(st2.frees, st1.idle_buffers))
+        goto end;
+
+    /* Buffers that do not fit are freed instead of being kept */
+    if (!TEST_true(SSL_write_ex(clientssl, "ping", 4, &written))
+            || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_true(SSL_CTX_get_record_buffer_pool_stats(sctx, &st1))
+            || !TEST_size_t_eq(st1.idle_buffers, 0)
+            || !TEST_uint64_t_gt(st1.frees, st2.frees))
+        goto end;
+
+    /* Connections outlive a pool that has been switched off */
+    if (!TEST_true(SSL_CTX_set_record_buffer_pool(sctx, 0, 0))
+            || !TEST_true(SSL_write_ex(serverssl, "pong", 4, &written))
+            || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, "pong", 4))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+
+/*
+ * Test SSL_writev_ex()
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3
+ * Test 2: TLSv1.3 with small records that span several buffers
+ * Test 3: TLSv1.3 non-blocking write that has to be retried
+ */
+static int test_writev(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0, i, ret;
+    static const char hdr[] = "HTTP/1.1 200 OK\r\nContent-Length: 20000\r\n\r\n";
+    unsigned char *body = NULL, *expected = NULL, *buf = NULL;
+    const size_t bodylen = 20000;
+    size_t explen = sizeof(hdr) - 1 + bodylen + 2, written, total;
+    SSL_IOVEC iov[4], badiov;
+    BIO *bretry = NULL, *tmp = NULL;
+    int version = idx == 0 ? TLS1_2_VERSION : TLS1_3_VERSION;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2 in this build");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx > 0)
+        return TEST_skip("No usable TLSv1.3 in this build");
+#endif
+
+    body = OPENSSL_malloc(bodylen);
+    expected = OPENSSL_malloc(explen);
+    buf = OPENSSL_malloc(explen);
+    if (!TEST_ptr(body) || !TEST_ptr(expected) || !TEST_ptr(buf))
+        goto end;
+    for (i = 0; i < (int)bodylen; i++)
+        body[i] = (unsigned char)(i * 7);
+    iov[0].base = hdr;
+    iov[0].len = sizeof(hdr) - 1;
+    iov[1].base = NULL;
+    iov[1].len = 0;
+    iov[2].base = body;
+    iov[2].len = bodylen;
+    iov[3].base = "\r\n";
+    iov[3].len = 2;
+    memcpy(expected, hdr, sizeof(hdr) - 1);
+    memcpy(expected + sizeof(hdr) - 1, body, bodylen);
+    memcpy(expected + sizeof(hdr) - 1 + bodylen, "\r\n", 2);
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), version, version,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    badiov.base = NULL;
+    badiov.len = 1;
+    if (!TEST_false(SSL_writev_ex(clientssl, &badiov, 1, 0, &written)))
+        goto end;
+    ERR_clear_error();
+
+    if (idx == 2
+            && !TEST_true(SSL_set_max_send_fragment(clientssl, 512)))
+        goto end;
+
+    if (idx == 3) {
+        if (!TEST_ptr(bretry = BIO_new(bio_s_always_retry())))
+            goto end;
+        tmp = SSL_get_wbio(clientssl);
+        if (!TEST_int_eq(BIO_up_ref(tmp), 1)) {
+            tmp = NULL;
+            goto end;
+        }
+        SSL_set0_wbio(clientssl, bretry);
+        bretry = NULL;
+
+        ret = SSL_writev_ex(clientssl, iov, OSSL_NELEM(iov), 0, &written);
+        if (!TEST_false(ret)
+                || !TEST_int_eq(SSL_get_error(clientssl, ret),
+                                SSL_ERROR_WANT_WRITE))
+            goto end;
+        SSL_set0_wbio(clientssl, tmp);
+        tmp = NULL;
+    }
+
+    if (!TEST_true(SSL_writev_ex(clientssl, iov, OSSL_NELEM(iov), 0,
+                                 &written))
+            || !TEST_size_t_eq(written, explen))
+        goto end;
+
+    for (total = 0; total < explen; total += written)
+        if (!TEST_true(SSL_read_ex(serverssl, buf + total, explen - total,
+                                   &written)))
+            goto end;
+    if (!TEST_mem_eq(buf, total, expected, explen))
+        goto end;
+
+    /* An empty vector writes nothing */
+    if (!TEST_true(SSL_writev_ex(clientssl, NULL, 0, 0, &written))
+            || !TEST_size_t_eq(written, 0))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    BIO_free(tmp);
+    OPENSSL_free(body);
+    OPENSSL_free(expected);
+    OPENSSL_free(buf);
+    return testresult;
+}
+
+static int coalesce_writes;
+
+static long count_writes_cb(BIO *bio, int oper, const char *argp, size_t len,
+                            int argi, long argl, int ret, size_t *processed)
+{
+    if (oper == (BIO_CB_WRITE | BIO_CB_RETURN) && ret > 0)
+        coalesce_writes++;
+    return ret;
+}
+
+static int read_all(SSL *s, unsigned char *buf, size_t len)
+{
+    size_t readbytes, total = 0;
+
+    while (total < len) {
+        if (!TEST_true(SSL_read_ex(s, buf + total, len - total, &readbytes)))
+            return 0;
+        total += readbytes;
+    }
+    return 1;
+}
+
+/*
+ * Test that small application data records are held back and written
+ * together when record coalescing is enabled
+ * Test 0: TLSv1.2, threshold set on the SSL
+ * Test 1: TLSv1.3, threshold set on the SSL
+ * Test 2: TLSv1.3, threshold set on the SSL_CTX
+ */
+static int test_record_coalescing(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0, i, writes;
+    unsigned char msg[50], buf[100 * sizeof(msg)];
+    size_t written;
+    int version = idx == 0 ? TLS1_2_VERSION : TLS1_3_VERSION;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2 in this build");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx > 0)
+        return TEST_skip("No usable TLSv1.3 in this build");
+#endif
+
+    for (i = 0; i < (int)sizeof(msg); i++)
+        msg[i] = (unsigned char)i;
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), version, version,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (idx == 2) {
+        if (!TEST_false(SSL_CTX_set_record_coalescing(cctx, 16 * 1024 * 1024))
+                || !TEST_true(SSL_CTX_set_record_coalescing(cctx, 4096)))
+            goto end;
+    }
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                      &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    if (idx != 2 && !TEST_true(SSL_set_record_coalescing(clientssl, 4096)))
+        goto end;
+
+    BIO_set_callback_ex(SSL_get_wbio(clientssl), count_writes_cb);
+    coalesce_writes = 0;
+
+    /* Twenty small records fit below the threshold, so nothing is written */
+    for (i = 0; i < 20; i++)
+        if (!TEST_true(SSL_write_ex(clientssl, msg, sizeof(msg), &written)))
+            goto end;
+    if (!TEST_int_eq(coalesce_writes, 0)
+            || !TEST_int_eq(SSL_flush_records(clientssl), 1)
+            || !TEST_int_eq(coalesce_writes, 1))
+        goto end;
+
+    /* Flushing again has nothing to do */
+    if (!TEST_int_eq(SSL_flush_records(clientssl), 1)
+            || !TEST_int_eq(coalesce_writes, 1)
+            || !TEST_true(read_all(serverssl, buf, 20 * sizeof(msg))))
+        goto end;
+    for (i = 0; i < 20; i++)
+        if (!TEST_mem_eq(buf + i * sizeof(msg), sizeof(msg), msg, sizeof(msg)))
+            goto end;
+
+    /* The threshold is reached a few times */
+    coalesce_writes = 0;
+    for (i = 0; i < 100; i++)
+        if (!TEST_true(SSL_write_ex(clientssl, msg, sizeof(msg), &written)))
+            goto end;
+    writes = coalesce_writes;
+    if (!TEST_int_gt(writes, 0) || !TEST_int_lt(writes, 5))
+        goto end;
+
+    /* Reading flushes what is left, so that the peer sees all of it */
+    if (!TEST_false(SSL_read_ex(clientssl, buf, sizeof(buf), &written))
+            || !TEST_int_eq(SSL_get_error(clientssl, 0), SSL_ERROR_WANT_READ)
+            || !TEST_int_eq(coalesce_writes, writes + 1)
+            || !TEST_true(read_all(serverssl, buf, 100 * sizeof(msg))))
+        goto end;
+    for (i = 0; i < 100; i++)
+        if (!TEST_mem_eq(buf + i * sizeof(msg), sizeof(msg), msg, sizeof(msg)))
+            goto end;
+
+    /* Reading still flushes if coalescing was turned off in the meantime */
+    coalesce_writes = 0;
+    if (!TEST_true(SSL_write_ex(clientssl, msg, sizeof(msg), &written))
+            || !TEST_true(SSL_set_record_coalescing(clientssl, 0))
+            || !TEST_false(SSL_read_ex(clientssl, buf, sizeof(buf), &written))
+            || !TEST_int_eq(SSL_get_error(clientssl, 0), SSL_ERROR_WANT_READ)
+            || !TEST_int_eq(coalesce_writes, 1)
+            || !TEST_true(read_all(serverssl, buf, sizeof(msg)))
+            || !TEST_mem_eq(buf, sizeof(msg), msg, sizeof(msg))
+            || !TEST_true(SSL_set_record_coalescing(clientssl, 4096)))
+        goto end;
+
+    /*
+     * Records of other types must not overtake held back data. The alert is
+     * written right after it.
+     */
+    coalesce_writes = 0;
+    if (!TEST_true(SSL_write_ex(clientssl, msg, sizeof(msg), &written))
+            || !TEST_int_eq(coalesce_writes, 0)
+            || !TEST_int_eq(SSL_shutdown(clientssl), 0)
+            || !TEST_int_eq(coalesce_writes, 2)
+            || !TEST_true(read_all(serverssl, buf, sizeof(msg)))
+            || !TEST_mem_eq(buf, sizeof(msg), msg, sizeof(msg))
+            || !TEST_false(SSL_read_ex(serverssl, buf, sizeof(buf), &written))
+            || !TEST_int_eq(SSL_get_error(serverssl, 0), SSL_ERROR_ZERO_RETURN))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+
 #if !defined(OPENSSL_NO_TLS1_2) && !defined(OPENSSL_NO_DYNAMIC_ENGINE)
 /*
  * Test TLSv1.2 with a pipeline capable cipher. TLSv1.3 and DTLS do not
@@ -12547,7 +13202,10 @@ int setup_tests(void)
 #if !defined(OPENSSL_NO_KTLS) && !defined(OPENSSL_NO_SOCK)
 # if !defined(OPENSSL_NO_TLS1_2) || !defined(OSSL_NO_USABLE_TLS1_3)
     ADD_ALL_TESTS(test_ktls, NUM_KTLS_TEST_CIPHERS * 4);
-    ADD_ALL_TESTS(test_ktls_sendfile, NUM_KTLS_TEST_CIPHERS * 2);
+    ADD_ALL_TESTS(test_ktls_sendfile, NUM_KTLS_TEST_CIPHERS * SENDFILE_MODES);
+# endif
+# if !defined(OSSL_NO_USABLE_TLS1_3)
+    ADD_ALL_TESTS(test_ktls_key_update, NUM_KTLS_TEST_CIPHERS);
 # endif
 #endif
     ADD_TEST(test_large_message_tls);
@@ -12707,6 +13365,10 @@ int setup_tests(void)
     ADD_TEST(test_read_ahead_key_change);
     ADD_ALL_TESTS(test_tls13_record_padding, 6);
 #endif
+    ADD_ALL_TESTS(test_read_borrow, 2);
+    ADD_ALL_TESTS(test_record_buffer_pool, 2);
+    ADD_ALL_TESTS(test_writev, 4);
+    ADD_ALL_TESTS(test_record_coalescing, 3);
 #if !defined(OPENSSL_NO_TLS1_2) && !defined(OSSL_NO_USABLE_TLS1_3)
     ADD_ALL_TESTS(test_serverinfo_custom, 4);
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -11,6 +11,7 @@
 #include <internal/cryptlib.h>
 #include <internal/thread_arch.h>
 #include <internal/thread.h>
+#include <internal/time.h>
 #include <openssl/thread.h>
 #include "testutil.h"
 
@@ -243,6 +244,188 @@ cleanup:
     OSSL_LIB_CTX_free(cust_ctx);
     return status;
 }
+
+# define TEST_POOL_TASKS 1000
+
+static uint32_t test_pool_fn(void *data)
+{
+    uint32_t *ldata = (uint32_t *)data;
+
+    return ++*ldata;
+}
+
+typedef struct {
+    OSSL_LIB_CTX *ctx;
+    uint32_t values[16];
+} TEST_POOL_NESTED;
+
+static uint32_t test_pool_nested_fn(void *data)
+{
+    TEST_POOL_NESTED *nested = data;
+    OSSL_THREAD_TASK *t[OSSL_NELEM(nested->values)];
+    CRYPTO_THREAD_RETVAL retval;
+    uint32_t sum = 0;
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(t); i++)
+        t[i] = ossl_crypto_pool_submit(nested->ctx, test_pool_fn,
+                                       &nested->values[i]);
+    for (i = 0; i < OSSL_NELEM(t); i++) {
+        if (ossl_crypto_pool_wait(t[i], &retval))
+            sum += retval;
+        ossl_crypto_pool_task_free(t[i]);
+    }
+    return sum;
+}
+
+static int test_thread_pool(void)
+{
+    OSSL_LIB_CTX *ctx = OSSL_LIB_CTX_new();
+    OSSL_THREAD_TASK **t = NULL;
+    TEST_POOL_NESTED *nested = NULL;
+    CRYPTO_THREAD_RETVAL retval;
+    uint32_t *local = NULL;
+    size_t i, j;
+    int cancelled = 0, status = 0;
+
+    if (!TEST_ptr(ctx)
+            || !TEST_ptr(t = OPENSSL_zalloc(TEST_POOL_TASKS * sizeof(*t)))
+            || !TEST_ptr(local = OPENSSL_zalloc(TEST_POOL_TASKS
+                                                * sizeof(*local)))
+            || !TEST_ptr(nested = OPENSSL_zalloc(4 * sizeof(*nested))))
+        goto cleanup;
+
+    /* no pool without threads */
+    if (!TEST_ptr_null(ossl_crypto_pool_submit(ctx, test_pool_fn, &local[0])))
+        goto cleanup;
+
+    if (!TEST_int_eq(OSSL_set_max_threads(ctx, 4), 1))
+        goto cleanup;
+
+    /* many small tasks */
+    for (i = 0; i < TEST_POOL_TASKS; i++) {
+        local[i] = (uint32_t)i;
+        if (!TEST_ptr(t[i] = ossl_crypto_pool_submit(ctx, test_pool_fn,
+                                                     &local[i])))
+            goto cleanup;
+    }
+    for (i = 0; i < TEST_POOL_TASKS; i++) {
+        if (!TEST_int_eq(ossl_crypto_pool_wait(t[i], &retval), 1)
+                || !TEST_uint_eq(retval, i + 1)
+                || !TEST_uint_eq(local[i], i + 1)
+                || !TEST_true(ossl_crypto_pool_task_done(t[i])))
+            goto cleanup;
+        ossl_crypto_pool_task_free(t[i]);
+        t[i] = NULL;
+    }
+
+    /* tasks queuing and waiting on further tasks */
+    for (i = 0; i < 4; i++) {
+        nested[i].ctx = ctx;
+        for (j = 0; j < OSSL_NELEM(nested[i].values); j++)
+            nested[i].values[j] = (uint32_t)j;
+        if (!TEST_ptr(t[i] = ossl_crypto_pool_submit(ctx, test_pool_nested_fn,
+                                                     &nested[i])))
+            goto cleanup;
+    }
+    for (i = 0; i < 4; i++) {
+        j = OSSL_NELEM(nested[i].values);
+        if (!TEST_int_eq(ossl_crypto_pool_wait(t[i], &retval), 1)
+                || !TEST_uint_eq(retval, j * (j + 1) / 2))
+            goto cleanup;
+        ossl_crypto_pool_task_free(t[i]);
+        t[i] = NULL;
+    }
+
+    /* cancellation, some of the tasks are likely to have started already */
+    for (i = 0; i < TEST_POOL_TASKS; i++) {
+        local[i] = 0;
+        if (!TEST_ptr(t[i] = ossl_crypto_pool_submit(ctx, test_pool_fn,
+                                                     &local[i])))
+            goto cleanup;
+    }
+    for (i = TEST_POOL_TASKS; i-- > 0;) {
+        if (ossl_crypto_pool_cancel(t[i])) {
+            cancelled++;
+            if (!TEST_int_eq(ossl_crypto_pool_wait(t[i], &retval), 0)
+                    || !TEST_uint_eq(local[i], 0))
+                goto cleanup;
+        } else if (!TEST_int_eq(ossl_crypto_pool_wait(t[i], &retval), 1)
+                       || !TEST_uint_eq(local[i], 1)) {
+            goto cleanup;
+        }
+        ossl_crypto_pool_task_free(t[i]);
+        t[i] = NULL;
+    }
+    TEST_info("cancelled %d of %d queued tasks", cancelled, TEST_POOL_TASKS);
+
+    status = 1;
+cleanup:
+    for (i = 0; t != NULL && i < TEST_POOL_TASKS; i++)
+        ossl_crypto_pool_task_free(t[i]);
+    OPENSSL_free(t);
+    OPENSSL_free(local);
+    OPENSSL_free(nested);
+    /* Also stops the pool workers */
+    OSSL_LIB_CTX_free(ctx);
+    return status;
+}
+
+/*
+ * Not a pass/fail test: compares the latency of handing a trivial task to
+ * the persistent pool and collecting its result with starting and joining a
+ * thread for it.  A waiter runs tasks that no worker has picked up yet
+ * itself, so the pool figure includes that case.
+ */
+static int test_thread_pool_latency(void)
+{
+    OSSL_LIB_CTX *ctx = OSSL_LIB_CTX_new();
+    OSSL_THREAD_TASK *task;
+    OSSL_TIME start, pool_time, start_join_time;
+    CRYPTO_THREAD_RETVAL retval;
+    uint32_t local = 0;
+    void *t;
+    int i, status = 0;
+
+    if (!TEST_ptr(ctx) || !TEST_int_eq(OSSL_set_max_threads(ctx, 1), 1))
+        goto cleanup;
+
+    /* warm up, this starts the pool worker */
+    task = ossl_crypto_pool_submit(ctx, test_pool_fn, &local);
+    if (!TEST_int_eq(ossl_crypto_pool_wait(task, &retval), 1))
+        goto cleanup;
+    ossl_crypto_pool_task_free(task);
+
+    start = ossl_time_now();
+    for (i = 0; i < TEST_POOL_TASKS; i++) {
+        task = ossl_crypto_pool_submit(ctx, test_pool_fn, &local);
+        if (!TEST_int_eq(ossl_crypto_pool_wait(task, &retval), 1))
+            goto cleanup;
+        ossl_crypto_pool_task_free(task);
+    }
+    pool_time = ossl_time_subtract(ossl_time_now(), start);
+
+    start = ossl_time_now();
+    for (i = 0; i < TEST_POOL_TASKS; i++) {
+        t = ossl_crypto_thread_start(ctx, test_pool_fn, &local);
+        if (!TEST_ptr(t)
+                || !TEST_int_eq(ossl_crypto_thread_join(t, &retval), 1)
+                || !TEST_int_eq(ossl_crypto_thread_clean(t), 1))
+            goto cleanup;
+    }
+    start_join_time = ossl_time_subtract(ossl_time_now(), start);
+
+    TEST_info("average task latency: pool %llu ns, start/join %llu ns",
+              (unsigned long long)ossl_time2ticks(pool_time)
+              / TEST_POOL_TASKS,
+              (unsigned long long)ossl_time2ticks(start_join_time)
+              / TEST_POOL_TASKS);
+
+    status = TEST_uint_eq(local, 2 * TEST_POOL_TASKS + 1);
+cleanup:
+    OSSL_LIB_CTX_free(ctx);
+    return status;
+}
 # endif
 
 static uint32_t test_thread_native_multiple_joins_fn1(void *data)
@@ -300,6 +483,8 @@ int setup_tests(void)
     ADD_TEST(test_thread_native_multiple_joins);
 # if !defined(OPENSSL_NO_DEFAULT_THREAD_POOL)
     ADD_TEST(test_thread_internal);
+    ADD_TEST(test_thread_pool);
+    ADD_TEST(test_thread_pool_latency);
 # endif
 #endif
 
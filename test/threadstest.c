@@ -27,6 +27,7 @@
 #include <openssl/rand.h>
 #include <openssl/pem.h>
 #include <openssl/evp.h>
+#include <openssl/x509.h>
 #include "internal/tsan_assist.h"
 #include "internal/nelem.h"
 #include "internal/time.h"
@@ -1014,6 +1015,61 @@ static int test_multi_shared_pkey(void)
     return test_multi_shared_pkey_common(&thread_shared_evp_pkey);
 }
 
+static X509 *shared_x509 = NULL;
+
+static void thread_lazy_pubkey(void)
+{
+    EVP_PKEY *pk = X509_get0_pubkey(shared_x509);
+
+    if (!TEST_ptr(pk)
+            || !TEST_ptr_eq(X509_get0_pubkey(shared_x509), pk)
+            || !TEST_int_eq(EVP_PKEY_eq(pk, shared_evp_pkey), 1))
+        multi_set_success(0);
+}
+
+/*
+ * The public key of a parsed certificate is decoded on first use, by
+ * whichever of the threads sharing the certificate gets there first.
+ */
+static int test_multi_lazy_pubkey(void)
+{
+    X509 *x = NULL;
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int len, testresult = 0;
+
+    multi_intialise();
+    if (!thread_setup_libctx(1, default_provider)
+            || !TEST_ptr(shared_evp_pkey = load_pkey_pem(privkey, multi_libctx))
+            || !TEST_ptr(x = X509_new_ex(multi_libctx, NULL))
+            || !TEST_ptr(X509_gmtime_adj(X509_getm_notBefore(x), 0))
+            || !TEST_ptr(X509_gmtime_adj(X509_getm_notAfter(x), 60))
+            || !TEST_true(X509_set_pubkey(x, shared_evp_pkey))
+            || !TEST_int_gt(X509_sign(x, shared_evp_pkey, EVP_sha256()), 0)
+            || !TEST_int_gt(len = i2d_X509(x, &der), 0)
+            || !TEST_ptr(shared_x509 = X509_new_ex(multi_libctx, NULL)))
+        goto err;
+    p = der;
+    if (!TEST_ptr(d2i_X509(&shared_x509, &p, len))
+            || !start_threads(MAXIMUM_THREADS - 1, &thread_lazy_pubkey))
+        goto err;
+
+    thread_lazy_pubkey();
+
+    if (!teardown_threads()
+            || !TEST_true(multi_success))
+        goto err;
+    testresult = 1;
+ err:
+    X509_free(shared_x509);
+    shared_x509 = NULL;
+    X509_free(x);
+    OPENSSL_free(der);
+    EVP_PKEY_free(shared_evp_pkey);
+    thead_teardown_libctx();
+    return testresult;
+}
+
 static int test_multi_load_unload_provider(void)
 {
     EVP_MD *sha256 = NULL;
@@ -1303,6 +1359,7 @@ int setup_tests(void)
     ADD_TEST(test_multi_general_worker_fips_provider);
     ADD_TEST(test_multi_fetch_worker);
     ADD_TEST(test_multi_shared_pkey);
+    ADD_TEST(test_multi_lazy_pubkey);
 #ifndef OPENSSL_NO_DEPRECATED_3_0
     ADD_TEST(test_multi_downgrade_shared_pkey);
 #endif
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Decodes a set of certificates and CRLs, for example those in
+ * fuzz/corpora/x509 and fuzz/corpora/crl, with ASN1_item_d2i() and with
+ * ASN1_item_d2i_arena(), checks that both give the same result and reports
+ * the time taken per structure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/asn1t.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include "internal/nelem.h"
+#include "internal/time.h"
+
+typedef struct {
+    unsigned char *der;
+    long len;
+    const ASN1_ITEM *it;
+} INPUT;
+
+static char *prog;
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s file ...\n", prog);
+    fprintf(stderr, "  file  A certificate or CRL in DER or PEM format, files that\n");
+    fprintf(stderr, "        cannot be decoded are skipped\n");
+    exit(EXIT_FAILURE);
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+/* Runs |op| until at least 0.2 seconds have passed and returns us per run */
+#define TIME_OP(us, op)                                                     \
+    do {                                                                    \
+        OSSL_TIME start_ = ossl_time_now(), elapsed_;                       \
+        size_t runs_ = 0;                                                   \
+                                                                            \
+        do {                                                                \
+            op;                                                             \
+            runs_++;                                                        \
+            elapsed_ = ossl_time_subtract(ossl_time_now(), start_);         \
+        } while (ossl_time2us(elapsed_) < 200000);                          \
+        (us) = (double)ossl_time2us(elapsed_) / runs_;                      \
+    } while (0)
+
+/* Reads |file| and returns the DER of the certificate or CRL in it */
+static int load(const char *file, INPUT *in)
+{
+    BIO *bio = BIO_new_file(file, "rb");
+    char *name = NULL, *header = NULL;
+    unsigned char *data = NULL, *tmp, *der;
+    long len = 0, derlen;
+    int n;
+
+    if (bio == NULL)
+        return 0;
+    for (;;) {
+        if ((tmp = OPENSSL_realloc(data, len + 4096)) == NULL)
+            fail("allocation");
+        data = tmp;
+        if ((n = BIO_read(bio, data + len, 4096)) <= 0)
+            break;
+        len += n;
+    }
+    BIO_free(bio);
+
+    if (len > 5 && memcmp(data, "-----", 5) == 0) {
+        bio = BIO_new_mem_buf(data, (int)len);
+        if (bio != NULL && PEM_read_bio(bio, &name, &header, &der, &derlen)) {
+            if (strcmp(name, PEM_STRING_X509) == 0
+                || strcmp(name, PEM_STRING_X509_CRL) == 0) {
+                OPENSSL_free(data);
+                data = der;
+                len = derlen;
+            } else {
+                OPENSSL_free(der);
+            }
+        }
+        OPENSSL_free(name);
+        OPENSSL_free(header);
+        BIO_free(bio);
+    }
+    ERR_clear_error();
+
+    if (len == 0) {
+        OPENSSL_free(data);
+        return 0;
+    }
+    in->der = data;
+    in->len = len;
+    return 1;
+}
+
+static void decode_all(const INPUT *in, size_t n, const ASN1_ITEM *it)
+{
+    const unsigned char *p;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (in[i].it != it)
+            continue;
+        p = in[i].der;
+        ASN1_item_free(ASN1_item_d2i(NULL, &p, in[i].len, it), it);
+    }
+}
+
+static void decode_all_arena(ASN1_ARENA *arena, const INPUT *in, size_t n,
+                             const ASN1_ITEM *it)
+{
+    const unsigned char *p;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (in[i].it != it)
+            continue;
+        p = in[i].der;
+        ASN1_item_d2i_arena(arena, &p, in[i].len, it);
+        ASN1_ARENA_reset(arena);
+    }
+}
+
+/*
+ * Works out whether |in| is a certificate or a CRL and checks that the arena
+ * decoder gives the same result. Returns 0 if it is neither.
+ */
+static int check(ASN1_ARENA *arena, INPUT *in)
+{
+    const ASN1_ITEM *items[2];
+    const unsigned char *p;
+    unsigned char *enc1 = NULL, *enc2 = NULL;
+    ASN1_VALUE *ref = NULL, *val;
+    size_t i;
+    int len1, len2;
+
+    items[0] = ASN1_ITEM_rptr(X509);
+    items[1] = ASN1_ITEM_rptr(X509_CRL);
+    for (i = 0; ref == NULL && i < OSSL_NELEM(items); i++) {
+        in->it = items[i];
+        p = in->der;
+        ref = ASN1_item_d2i(NULL, &p, in->len, in->it);
+    }
+    p = in->der;
+    val = ASN1_item_d2i_arena(arena, &p, in->len, in->it);
+    if (ref == NULL && val == NULL) {
+        ERR_clear_error();
+        return 0;
+    }
+    if (ref == NULL || val == NULL)
+        fail("decoder comparison");
+
+    len1 = ASN1_item_i2d(ref, &enc1, in->it);
+    len2 = ASN1_item_i2d(val, &enc2, in->it);
+    if (len1 <= 0 || len1 != len2 || memcmp(enc1, enc2, len1) != 0)
+        fail("encoding comparison");
+    OPENSSL_free(enc1);
+    OPENSSL_free(enc2);
+    ASN1_item_free(ref, in->it);
+    ASN1_ARENA_reset(arena);
+    return 1;
+}
+
+static void report(ASN1_ARENA *arena, const INPUT *in, size_t n,
+                   const ASN1_ITEM *it, const char *what)
+{
+    double us, arena_us;
+    size_t i, count = 0;
+
+    for (i = 0; i < n; i++)
+        if (in[i].it == it)
+            count++;
+    if (count == 0)
+        return;
+
+    TIME_OP(us, decode_all(in, n, it));
+    TIME_OP(arena_us, decode_all_arena(arena, in, n, it));
+    printf("%zu %s\n", count, what);
+    printf("  ASN1_item_d2i       %9.2f us each\n", us / count);
+    printf("  ASN1_item_d2i_arena %9.2f us each (%.2fx)\n", arena_us / count,
+           us / arena_us);
+}
+
+int main(int ac, char **av)
+{
+    ASN1_ARENA *arena;
+    INPUT *in;
+    size_t n = 0, i;
+
+    prog = av[0];
+    if (ac < 2)
+        usage();
+
+    if ((in = OPENSSL_malloc((ac - 1) * sizeof(*in))) == NULL
+        || (arena = ASN1_ARENA_new()) == NULL)
+        fail("allocation");
+    for (i = 1; i < (size_t)ac; i++) {
+        if (!load(av[i], &in[n]))
+            continue;
+        if (check(arena, &in[n]))
+            n++;
+        else
+            OPENSSL_free(in[n].der);
+    }
+    if (n == 0)
+        fail("loading certificates and CRLs");
+
+    report(arena, in, n, ASN1_ITEM_rptr(X509), "certificates");
+    report(arena, in, n, ASN1_ITEM_rptr(X509_CRL), "CRLs");
+
+    for (i = 0; i < n; i++)
+        OPENSSL_free(in[i].der);
+    OPENSSL_free(in);
+    ASN1_ARENA_free(arena);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Times multi-scalar multiplications with EC_POINTs_mul(), which is
+ * constant time, and ossl_ec_points_mul_public(), and batches of Ed25519
+ * verifications for 2 up to 10000 points, the latter against a
+ * single EVP_PKEY_verify().
+ */
+
+/* EC_POINTs_mul() is deprecated for public use */
+#include "internal/deprecated.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+#include <openssl/objects.h>
+#include "internal/nelem.h"
+#include "internal/time.h"
+#include "ec_local.h"
+
+static const size_t sizes[] = {
+    2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 10000
+};
+
+#define MAX_POINTS 10000
+
+static char *prog;
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [-n max] [curve ...]\n", prog);
+    fprintf(stderr, "  -n #   Largest number of points, default %d\n",
+            MAX_POINTS);
+    fprintf(stderr, "  curve  A curve name, or ED25519; default is\n");
+    fprintf(stderr, "         P-256 P-384 ED25519\n");
+    exit(EXIT_FAILURE);
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+/* Runs |op| until at least 0.2 seconds have passed and returns us per run */
+#define TIME_OP(us, op)                                                     \
+    do {                                                                    \
+        OSSL_TIME start_ = ossl_time_now(), elapsed_;                       \
+        size_t runs_ = 0;                                                   \
+                                                                            \
+        do {                                                                \
+            op;                                                             \
+            runs_++;                                                        \
+            elapsed_ = ossl_time_subtract(ossl_time_now(), start_);         \
+        } while (ossl_time2us(elapsed_) < 200000);                          \
+        (us) = (double)ossl_time2us(elapsed_) / runs_;                      \
+    } while (0)
+
+static void time_ec(const char *name, size_t max)
+{
+    int nid = EC_curve_nist2nid(name);
+    EC_GROUP *group;
+    EC_POINT **points, *r;
+    BIGNUM **scalars, *k;
+    BN_CTX *ctx;
+    const BIGNUM *order;
+    size_t i, s;
+    double us;
+
+    if (nid == NID_undef)
+        nid = OBJ_sn2nid(name);
+    if ((group = EC_GROUP_new_by_curve_name(nid)) == NULL)
+        fail(name);
+    order = EC_GROUP_get0_order(group);
+    ctx = BN_CTX_new();
+    points = OPENSSL_malloc(max * sizeof(*points));
+    scalars = OPENSSL_malloc(max * sizeof(*scalars));
+    r = EC_POINT_new(group);
+    k = BN_new();
+    if (ctx == NULL || points == NULL || scalars == NULL || r == NULL
+        || k == NULL)
+        fail("allocation");
+
+    for (i = 0; i < max; i++) {
+        points[i] = EC_POINT_new(group);
+        scalars[i] = BN_new();
+        if (points[i] == NULL || scalars[i] == NULL
+            || !BN_rand_range(k, order)
+            || !EC_POINT_mul(group, points[i], k, NULL, NULL, ctx)
+            || !BN_rand_range(scalars[i], order))
+            fail("point generation");
+    }
+
+    printf("%s EC_POINTs_mul\n", name);
+    for (s = 0; s < OSSL_NELEM(sizes) && sizes[s] <= max; s++) {
+        TIME_OP(us, if (!EC_POINTs_mul(group, r, NULL, sizes[s],
+                                       (const EC_POINT **)points,
+                                       (const BIGNUM **)scalars, ctx))
+                        fail("EC_POINTs_mul"));
+        printf("%6zu points %12.1f us %9.2f us/point\n", sizes[s], us,
+               us / sizes[s]);
+    }
+
+    printf("%s ossl_ec_points_mul_public\n", name);
+    for (s = 0; s < OSSL_NELEM(sizes) && sizes[s] <= max; s++) {
+        TIME_OP(us, if (!ossl_ec_points_mul_public(group, r, NULL, sizes[s],
+                                                   (const EC_POINT **)points,
+                                                   (const BIGNUM **)scalars,
+                                                   ctx))
+                        fail("ossl_ec_points_mul_public"));
+        printf("%6zu points %12.1f us %9.2f us/point\n", sizes[s], us,
+               us / sizes[s]);
+    }
+
+    for (i = 0; i < max; i++) {
+        EC_POINT_free(points[i]);
+        BN_free(scalars[i]);
+    }
+    OPENSSL_free(points);
+    OPENSSL_free(scalars);
+    EC_POINT_free(r);
+    BN_free(k);
+    BN_CTX_free(ctx);
+    EC_GROUP_free(group);
+}
+
+#ifndef OPENSSL_NO_ECX
+static void time_ed25519(size_t max)
+{
+    EVP_PKEY *pkey;
+    EVP_SIGNATURE *alg;
+    EVP_PKEY_CTX *ctx;
+    unsigned char (*sigs)[64], (*msgs)[32];
+    const unsigned char **sigp, **msgp;
+    size_t *siglens, *msglens, i, s, siglen;
+    int *results;
+    double us;
+
+    pkey = EVP_PKEY_Q_keygen(NULL, NULL, "ED25519");
+    alg = EVP_SIGNATURE_fetch(NULL, "ED25519", NULL);
+    sigs = OPENSSL_malloc(max * sizeof(*sigs));
+    msgs = OPENSSL_malloc(max * sizeof(*msgs));
+    sigp = OPENSSL_malloc(max * sizeof(*sigp));
+    msgp = OPENSSL_malloc(max * sizeof(*msgp));
+    siglens = OPENSSL_malloc(max * sizeof(*siglens));
+    msglens = OPENSSL_malloc(max * sizeof(*msglens));
+    results = OPENSSL_malloc(max * sizeof(*results));
+    if (pkey == NULL || alg == NULL || sigs == NULL || msgs == NULL
+        || sigp == NULL || msgp == NULL || siglens == NULL || msglens == NULL
+        || results == NULL)
+        fail("ED25519 setup");
+
+    for (i = 0; i < max; i++) {
+        memset(msgs[i], 0, sizeof(msgs[i]));
+        memcpy(msgs[i], &i, sizeof(i));
+        siglen = sizeof(sigs[i]);
+        if ((ctx = EVP_PKEY_CTX_new(pkey, NULL)) == NULL
+            || EVP_PKEY_sign_message_init(ctx, alg, NULL) <= 0
+            || EVP_PKEY_sign(ctx, sigs[i], &siglen, msgs[i],
+                             sizeof(msgs[i])) <= 0)
+            fail("ED25519 signing");
+        EVP_PKEY_CTX_free(ctx);
+        sigp[i] = sigs[i];
+        msgp[i] = msgs[i];
+        siglens[i] = siglen;
+        msglens[i] = sizeof(msgs[i]);
+    }
+
+    if ((ctx = EVP_PKEY_CTX_new(pkey, NULL)) == NULL)
+        fail("ED25519 verify init");
+
+    /* The baseline the batches are compared against */
+    TIME_OP(us, if (EVP_PKEY_verify_message_init(ctx, alg, NULL) <= 0
+                    || EVP_PKEY_verify(ctx, sigp[0], siglens[0], msgp[0],
+                                       msglens[0]) != 1)
+                    fail("EVP_PKEY_verify"));
+    printf("ED25519 EVP_PKEY_verify %9.2f us/sig\n", us);
+
+    if (EVP_PKEY_verify_message_init(ctx, alg, NULL) <= 0)
+        fail("ED25519 verify init");
+
+    printf("ED25519 EVP_PKEY_verify_batch\n");
+    for (s = 0; s < OSSL_NELEM(sizes) && sizes[s] <= max; s++) {
+        TIME_OP(us, if (EVP_PKEY_verify_batch(ctx, sizes[s], sigp, siglens,
+                                              msgp, msglens, results) != 1)
+                        fail("EVP_PKEY_verify_batch"));
+        printf("%6zu sigs   %12.1f us %9.2f us/sig\n", sizes[s], us,
+               us / sizes[s]);
+    }
+
+    EVP_PKEY_CTX_free(ctx);
+    EVP_SIGNATURE_free(alg);
+    EVP_PKEY_free(pkey);
+    OPENSSL_free(sigs);
+    OPENSSL_free(msgs);
+    OPENSSL_free(sigp);
+    OPENSSL_free(msgp);
+    OPENSSL_free(siglens);
+    OPENSSL_free(msglens);
+    OPENSSL_free(results);
+}
+#endif
+
+int main(int ac, char **av)
+{
+    static const char *defaults[] = {
+        "P-256", "P-384",
+#ifndef OPENSSL_NO_ECX
+        "ED25519"
+#endif
+    };
+    size_t max = MAX_POINTS;
+    int i;
+
+    prog = av[0];
+    for (ac--, av++; ac > 0 && av[0][0] == '-'; ac--, av++) {
+        if (strcmp(av[0], "-n") != 0 || ac < 2)
+            usage();
+        if ((max = (size_t)atol(av[1])) < 2)
+            usage();
+        ac--, av++;
+    }
+    if (ac == 0) {
+        ac = OSSL_NELEM(defaults);
+        av = (char **)defaults;
+    }
+
+    for (i = 0; i < ac; i++) {
+#ifndef OPENSSL_NO_ECX
+        if (OPENSSL_strcasecmp(av[i], "ED25519") == 0) {
+            time_ed25519(max);
+            continue;
+        }
+#endif
+        time_ec(av[i], max);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Transfers data over a TLS 1.3 connection on the loopback interface, once
+ * with records processed by OpenSSL and once with kernel TLS, checks that
+ * every byte arrives unchanged and reports the CPU time used per GB.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
+#define CHUNK   (4 * 16384)
+
+static char *prog;
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [-m MB] [-c ciphersuite] cert key\n", prog);
+    fprintf(stderr, "  -m #   Megabytes to transfer, default 256\n");
+    fprintf(stderr, "  -c #   TLS 1.3 ciphersuite, default TLS_AES_128_GCM_SHA256\n");
+    exit(EXIT_FAILURE);
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        fail("getrusage");
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+        + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+/* Creates a connected pair of non-blocking TCP sockets on 127.0.0.1 */
+static void tcp_pair(int *cfd, int *sfd)
+{
+    struct sockaddr_in sin;
+    socklen_t len = sizeof(sin);
+    int lfd;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((lfd = socket(AF_INET, SOCK_STREAM, 0)) < 0
+        || bind(lfd, (struct sockaddr *)&sin, sizeof(sin)) != 0
+        || listen(lfd, 1) != 0
+        || getsockname(lfd, (struct sockaddr *)&sin, &len) != 0
+        || (*cfd = socket(AF_INET, SOCK_STREAM, 0)) < 0
+        || connect(*cfd, (struct sockaddr *)&sin, sizeof(sin)) != 0
+        || (*sfd = accept(lfd, NULL, NULL)) < 0
+        || fcntl(*cfd, F_SETFL, O_NONBLOCK) != 0
+        || fcntl(*sfd, F_SETFL, O_NONBLOCK) != 0)
+        fail("socket setup");
+    close(lfd);
+}
+
+static int want_retry(SSL *s, int ret)
+{
+    int err = SSL_get_error(s, ret);
+
+    return err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE;
+}
+
+static void run(SSL_CTX *sctx, SSL_CTX *cctx, size_t total, int ktls)
+{
+    SSL *server, *client;
+    unsigned char *out, *in;
+    size_t written = 0, received = 0, n, i;
+    int cfd, sfd, sdone = 0, cdone = 0, ret;
+    double start, cpu;
+
+    tcp_pair(&cfd, &sfd);
+    if ((server = SSL_new(sctx)) == NULL || (client = SSL_new(cctx)) == NULL
+        || !SSL_set_fd(server, sfd) || !SSL_set_fd(client, cfd))
+        fail("SSL setup");
+    if (ktls) {
+        SSL_set_options(server, SSL_OP_ENABLE_KTLS);
+        SSL_set_options(client, SSL_OP_ENABLE_KTLS);
+    }
+
+    while (!sdone || !cdone) {
+        if (!cdone) {
+            if ((ret = SSL_connect(client)) == 1)
+                cdone = 1;
+            else if (!want_retry(client, ret))
+                fail("SSL_connect");
+        }
+        if (!sdone) {
+            if ((ret = SSL_accept(server)) == 1)
+                sdone = 1;
+            else if (!want_retry(server, ret))
+                fail("SSL_accept");
+        }
+    }
+
+    if (ktls && !BIO_get_ktls_send(SSL_get_wbio(server))
+        && !BIO_get_ktls_recv(SSL_get_rbio(client))) {
+        printf("kernel TLS     not available\n");
+        goto end;
+    }
+
+    out = OPENSSL_malloc(CHUNK);
+    in = OPENSSL_malloc(CHUNK);
+    if (out == NULL || in == NULL)
+        fail("allocation");
+    for (i = 0; i < CHUNK; i++)
+        out[i] = (unsigned char)(i * 31 + 7);
+
+    start = cpu_seconds();
+    while (received < total) {
+        if (written < total) {
+            if (SSL_write_ex(server, out + written % CHUNK,
+                             CHUNK - written % CHUNK, &n))
+                written += n;
+            else if (!want_retry(server, 0))
+                fail("SSL_write_ex");
+        }
+        if (SSL_read_ex(client, in, CHUNK - received % CHUNK, &n)) {
+            if (memcmp(in, out + received % CHUNK, n) != 0)
+                fail("data check");
+            received += n;
+        } else if (!want_retry(client, 0)) {
+            fail("SSL_read_ex");
+        }
+    }
+    cpu = cpu_seconds() - start;
+
+    printf("%-14s %10.3f CPU s/GB (send %s, receive %s)\n",
+           ktls ? "kernel TLS" : "userspace", cpu * (1 << 30) / total,
+           BIO_get_ktls_send(SSL_get_wbio(server)) ? "kernel" : "user",
+           BIO_get_ktls_recv(SSL_get_rbio(client)) ? "kernel" : "user");
+    OPENSSL_free(out);
+    OPENSSL_free(in);
+ end:
+    SSL_free(server);
+    SSL_free(client);
+    close(cfd);
+    close(sfd);
+}
+
+int main(int ac, char **av)
+{
+    const char *ciphersuite = "TLS_AES_128_GCM_SHA256";
+    size_t mb = 256;
+    SSL_CTX *sctx, *cctx;
+
+    prog = av[0];
+    for (ac--, av++; ac > 0 && av[0][0] == '-'; ac -= 2, av += 2) {
+        if (ac < 2)
+            usage();
+        if (strcmp(av[0], "-m") == 0 && (mb = (size_t)atol(av[1])) > 0)
+            continue;
+        if (strcmp(av[0], "-c") == 0) {
+            ciphersuite = av[1];
+            continue;
+        }
+        usage();
+    }
+    if (ac != 2)
+        usage();
+
+    if ((sctx = SSL_CTX_new(TLS_server_method())) == NULL
+        || (cctx = SSL_CTX_new(TLS_client_method())) == NULL
+        || !SSL_CTX_set_min_proto_version(sctx, TLS1_3_VERSION)
+        || !SSL_CTX_set_min_proto_version(cctx, TLS1_3_VERSION)
+        || !SSL_CTX_set_ciphersuites(sctx, ciphersuite)
+        || !SSL_CTX_set_ciphersuites(cctx, ciphersuite)
+        || SSL_CTX_use_certificate_chain_file(sctx, av[0]) != 1
+        || SSL_CTX_use_PrivateKey_file(sctx, av[1], SSL_FILETYPE_PEM) != 1)
+        fail("SSL_CTX setup");
+
+    run(sctx, cctx, mb << 20, 0);
+    run(sctx, cctx, mb << 20, 1);
+
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return EXIT_SUCCESS;
+}
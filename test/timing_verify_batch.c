@@ -0,0 +1,244 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Times the verification of many leaf certificates issued by the same
+ * intermediate CA, one by one with X509_verify_cert() and as a batch with
+ * X509_verify_cert_batch(), which checks the signature of the intermediate
+ * CA only once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include "internal/nelem.h"
+#include "internal/time.h"
+
+#define NUM_LEAVES 1000
+
+static char *prog;
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [-n num] [-t threads] [key ...]\n", prog);
+    fprintf(stderr, "  -n #   Number of leaf certificates, default %d\n",
+            NUM_LEAVES);
+    fprintf(stderr, "  -t #   Threads of the batch, default 1\n");
+    fprintf(stderr, "  key    Key of the CAs, RSA or EC; default is both\n");
+    exit(EXIT_FAILURE);
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+/* Runs |op| until at least 0.2 seconds have passed and returns us per run */
+#define TIME_OP(us, op)                                                     \
+    do {                                                                    \
+        OSSL_TIME start_ = ossl_time_now(), elapsed_;                       \
+        size_t runs_ = 0;                                                   \
+                                                                            \
+        do {                                                                \
+            op;                                                             \
+            runs_++;                                                        \
+            elapsed_ = ossl_time_subtract(ossl_time_now(), start_);         \
+        } while (ossl_time2us(elapsed_) < 200000);                          \
+        (us) = (double)ossl_time2us(elapsed_) / runs_;                      \
+    } while (0)
+
+static EVP_PKEY *keygen(const char *key)
+{
+    EVP_PKEY *pkey;
+
+    if (strcmp(key, "RSA") == 0)
+        pkey = EVP_PKEY_Q_keygen(NULL, NULL, "RSA", (size_t)2048);
+    else
+        pkey = EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256");
+    if (pkey == NULL)
+        fail("key generation");
+    return pkey;
+}
+
+/*
+ * Returns a certificate for |pkey| named |cn| and signed by |signer|, decoded
+ * from its DER encoding like certificates received from a peer
+ */
+static X509 *make_cert(const char *cn, long serial, EVP_PKEY *pkey,
+                       X509 *issuer, EVP_PKEY *signer, int ca)
+{
+    X509 *x = X509_new();
+    X509 *ret;
+    X509_NAME *name;
+    X509V3_CTX v3;
+    X509_EXTENSION *ext;
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int len;
+
+    if (x == NULL
+        || !X509_set_version(x, X509_VERSION_3)
+        || !ASN1_INTEGER_set(X509_get_serialNumber(x), serial)
+        || (name = X509_get_subject_name(x)) == NULL
+        || !X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                       (const unsigned char *)cn, -1, -1, 0)
+        || !X509_set_issuer_name(x, issuer != NULL
+                                    ? X509_get_subject_name(issuer) : name)
+        || X509_gmtime_adj(X509_getm_notBefore(x), -3600) == NULL
+        || X509_gmtime_adj(X509_getm_notAfter(x), 86400) == NULL
+        || !X509_set_pubkey(x, pkey))
+        fail("certificate setup");
+    X509V3_set_ctx(&v3, issuer != NULL ? issuer : x, x, NULL, NULL, 0);
+    if ((ext = X509V3_EXT_conf_nid(NULL, &v3, NID_basic_constraints,
+                                   ca ? "critical,CA:TRUE"
+                                      : "critical,CA:FALSE")) == NULL
+        || !X509_add_ext(x, ext, -1))
+        fail("certificate extensions");
+    X509_EXTENSION_free(ext);
+    if (X509_sign(x, signer, EVP_sha256()) <= 0)
+        fail("certificate signing");
+    if ((len = i2d_X509(x, &der)) <= 0)
+        fail("certificate encoding");
+    p = der;
+    if ((ret = d2i_X509(NULL, &p, len)) == NULL)
+        fail("certificate decoding");
+    OPENSSL_free(der);
+    X509_free(x);
+    return ret;
+}
+
+static void init_ctxs(X509_STORE_CTX **ctxs, size_t num, X509_STORE *store,
+                      X509 **leaves, STACK_OF(X509) *untrusted)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++) {
+        X509_STORE_CTX_cleanup(ctxs[i]);
+        if (!X509_STORE_CTX_init(ctxs[i], store, leaves[i], untrusted))
+            fail("X509_STORE_CTX_init");
+    }
+}
+
+static void verify_serial(X509_STORE_CTX **ctxs, size_t num, X509_STORE *store,
+                          X509 **leaves, STACK_OF(X509) *untrusted)
+{
+    size_t i;
+
+    init_ctxs(ctxs, num, store, leaves, untrusted);
+    for (i = 0; i < num; i++)
+        if (X509_verify_cert(ctxs[i]) != 1)
+            fail("X509_verify_cert");
+}
+
+static void verify_batch(X509_STORE_CTX **ctxs, size_t num, int *results,
+                         size_t threads, X509_STORE *store, X509 **leaves,
+                         STACK_OF(X509) *untrusted)
+{
+    size_t i;
+
+    init_ctxs(ctxs, num, store, leaves, untrusted);
+    if (!X509_verify_cert_batch(ctxs, num, results, threads))
+        fail("X509_verify_cert_batch");
+    for (i = 0; i < num; i++)
+        if (results[i] != 1)
+            fail("X509_verify_cert_batch");
+}
+
+static void time_verify(const char *key, size_t num, size_t threads)
+{
+    EVP_PKEY *rootkey, *cakey, *leafkey;
+    X509 *root, *ca, **leaves;
+    X509_STORE *store;
+    X509_STORE_CTX **ctxs;
+    STACK_OF(X509) *untrusted;
+    int *results;
+    char cn[32];
+    size_t i;
+    double us, batch_us;
+
+    rootkey = keygen(key);
+    cakey = keygen(key);
+    leafkey = keygen("EC");
+    root = make_cert("Root", 1, rootkey, NULL, rootkey, 1);
+    ca = make_cert("CA", 2, cakey, root, rootkey, 1);
+    leaves = OPENSSL_malloc(num * sizeof(*leaves));
+    ctxs = OPENSSL_zalloc(num * sizeof(*ctxs));
+    results = OPENSSL_malloc(num * sizeof(*results));
+    if (leaves == NULL || ctxs == NULL || results == NULL)
+        fail("allocation");
+    for (i = 0; i < num; i++) {
+        BIO_snprintf(cn, sizeof(cn), "leaf %zu", i);
+        leaves[i] = make_cert(cn, (long)(i + 3), leafkey, ca, cakey, 0);
+        if ((ctxs[i] = X509_STORE_CTX_new()) == NULL)
+            fail("X509_STORE_CTX_new");
+    }
+    if ((store = X509_STORE_new()) == NULL
+        || !X509_STORE_add_cert(store, root)
+        || (untrusted = sk_X509_new_null()) == NULL
+        || !sk_X509_push(untrusted, ca))
+        fail("store setup");
+
+    TIME_OP(us, verify_serial(ctxs, num, store, leaves, untrusted));
+    TIME_OP(batch_us, verify_batch(ctxs, num, results, threads, store, leaves,
+                                   untrusted));
+    printf("%s CAs, %zu leaves\n", key, num);
+    printf("  X509_verify_cert       %9.2f us/cert\n", us / num);
+    printf("  X509_verify_cert_batch %9.2f us/cert (%.2fx)\n", batch_us / num,
+           us / batch_us);
+
+    for (i = 0; i < num; i++) {
+        X509_STORE_CTX_free(ctxs[i]);
+        X509_free(leaves[i]);
+    }
+    OPENSSL_free(ctxs);
+    OPENSSL_free(leaves);
+    OPENSSL_free(results);
+    sk_X509_free(untrusted);
+    X509_STORE_free(store);
+    X509_free(root);
+    X509_free(ca);
+    EVP_PKEY_free(rootkey);
+    EVP_PKEY_free(cakey);
+    EVP_PKEY_free(leafkey);
+}
+
+int main(int ac, char **av)
+{
+    static const char *keys[] = { "RSA", "EC" };
+    size_t num = NUM_LEAVES, threads = 1;
+    int i, done = 0;
+
+    prog = av[0];
+    for (i = 1; i < ac && av[i][0] == '-'; i++) {
+        if (strcmp(av[i], "-n") == 0 && i + 1 < ac)
+            num = (size_t)strtoul(av[++i], NULL, 10);
+        else if (strcmp(av[i], "-t") == 0 && i + 1 < ac)
+            threads = (size_t)strtoul(av[++i], NULL, 10);
+        else
+            usage();
+    }
+    if (num == 0)
+        usage();
+
+    for (; i < ac; i++) {
+        if (strcmp(av[i], "RSA") != 0 && strcmp(av[i], "EC") != 0)
+            usage();
+        time_verify(av[i], num, threads);
+        done = 1;
+    }
+    for (i = 0; !done && i < (int)OSSL_NELEM(keys); i++)
+        time_verify(keys[i], num, threads);
+    return EXIT_SUCCESS;
+}
@@ -2170,6 +2170,14 @@ struct X509_pubkey_st {
     /* extra data for the callback, used by d2i_PUBKEY_ex */
     OSSL_LIB_CTX *libctx;
     char *propq;
+
+    /* Flag to force legacy keys */
+    unsigned int flag_force_legacy : 1;
+
+    /* Lazy decoding state, see x509_pubkey_ex_d2i_lazy() */
+    uint64_t pending;
+    unsigned char *spki;
+    size_t spki_len;
 };
 
 ASN1_SEQUENCE(X509_PUBKEY_INTERNAL) = {
@@ -1,5 +1,5 @@
 /*
- * Copyright 2015-2022 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2015-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -15,6 +15,7 @@
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
 #include <openssl/err.h>
+#include <openssl/thread.h>
 #include "testutil.h"
 
 static const char *certs_dir;
@@ -290,6 +291,167 @@ static int test_purpose_any(void)
     return do_test_purpose(X509_PURPOSE_ANY, 1);
 }
 
+#define BATCH_SIZE 8
+
+/*
+ * Verify a batch of jobs that share their issuers, alternating between
+ * a chain that verifies and one that does not, with |idx| threads.
+ */
+static int test_verify_batch(int idx)
+{
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *untrcert = load_cert_from_file(ca_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    STACK_OF(X509) *trusted = sk_X509_new_null();
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    X509_STORE_CTX *ctxs[BATCH_SIZE] = { NULL };
+    int results[BATCH_SIZE];
+    size_t threads = idx == 0 ? 0 : idx == 1 ? 1 : 4;
+    int i, testresult = 0;
+
+    if (!TEST_ptr(eecert)
+            || !TEST_ptr(untrcert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(trusted)
+            || !TEST_ptr(untrusted)
+            || !TEST_true(sk_X509_push(trusted, trcert)))
+        goto err;
+    trcert = NULL;
+    if (!TEST_true(sk_X509_push(untrusted, untrcert)))
+        goto err;
+    untrcert = NULL;
+
+    for (i = 0; i < BATCH_SIZE; i++) {
+        if (!TEST_ptr(ctxs[i] = X509_STORE_CTX_new())
+                || !TEST_true(X509_STORE_CTX_init(ctxs[i], NULL, eecert,
+                                                  untrusted))
+                || !TEST_true(X509_STORE_CTX_set_purpose(ctxs[i],
+                                                         i % 2 == 0
+                                                         ? X509_PURPOSE_SSL_SERVER
+                                                         : X509_PURPOSE_SSL_CLIENT)))
+            goto err;
+        X509_STORE_CTX_set0_trusted_stack(ctxs[i], trusted);
+    }
+
+    if (threads > 1 && !OSSL_set_max_threads(NULL, threads))
+        TEST_info("Thread pool not available, verifying serially");
+    if (!TEST_true(X509_verify_cert_batch(ctxs, BATCH_SIZE, results, threads)))
+        goto err;
+    for (i = 0; i < BATCH_SIZE; i++) {
+        if (!TEST_int_eq(results[i], i % 2 == 0 ? 1 : 0)
+                || !TEST_int_eq(X509_STORE_CTX_get_error(ctxs[i]),
+                                i % 2 == 0 ? X509_V_OK
+                                           : X509_V_ERR_INVALID_PURPOSE))
+            goto err;
+    }
+
+    testresult = 1;
+ err:
+    OSSL_set_max_threads(NULL, 0);
+    for (i = 0; i < BATCH_SIZE; i++)
+        X509_STORE_CTX_free(ctxs[i]);
+    OSSL_STACK_OF_X509_free(trusted);
+    OSSL_STACK_OF_X509_free(untrusted);
+    X509_free(eecert);
+    X509_free(untrcert);
+    X509_free(trcert);
+    return testresult;
+}
+
+/*
+ * A copy of a certificate with a corrupted signature must not pass because
+ * the signature of the original was found valid earlier in the batch
+ */
+static int test_verify_batch_tampered(void)
+{
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *untrcert = load_cert_from_file(ca_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    X509 *bad = NULL;
+    STACK_OF(X509) *trusted = sk_X509_new_null();
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    X509_STORE_CTX *ctxs[2] = { NULL };
+    int results[2];
+    unsigned char *der = NULL;
+    const unsigned char *p;
+    int i, len, testresult = 0;
+
+    if (!TEST_ptr(eecert)
+            || !TEST_ptr(untrcert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(trusted)
+            || !TEST_ptr(untrusted)
+            || !TEST_true(sk_X509_push(trusted, trcert)))
+        goto err;
+    trcert = NULL;
+    if (!TEST_true(sk_X509_push(untrusted, untrcert)))
+        goto err;
+    untrcert = NULL;
+
+    /* The last byte of the DER is part of the signature */
+    if (!TEST_int_gt(len = i2d_X509(eecert, &der), 0))
+        goto err;
+    der[len - 1] ^= 1;
+    p = der;
+    if (!TEST_ptr(bad = d2i_X509(NULL, &p, len)))
+        goto err;
+
+    for (i = 0; i < 2; i++) {
+        if (!TEST_ptr(ctxs[i] = X509_STORE_CTX_new())
+                || !TEST_true(X509_STORE_CTX_init(ctxs[i], NULL,
+                                                  i == 0 ? eecert : bad,
+                                                  untrusted)))
+            goto err;
+        X509_STORE_CTX_set0_trusted_stack(ctxs[i], trusted);
+    }
+    if (!TEST_true(X509_verify_cert_batch(ctxs, 2, results, 1))
+            || !TEST_int_eq(results[0], 1)
+            || !TEST_int_eq(results[1], 0)
+            || !TEST_int_eq(X509_STORE_CTX_get_error(ctxs[1]),
+                            X509_V_ERR_CERT_SIGNATURE_FAILURE))
+        goto err;
+
+    testresult = 1;
+ err:
+    for (i = 0; i < 2; i++)
+        X509_STORE_CTX_free(ctxs[i]);
+    OSSL_STACK_OF_X509_free(trusted);
+    OSSL_STACK_OF_X509_free(untrusted);
+    OPENSSL_free(der);
+    X509_free(bad);
+    X509_free(eecert);
+    X509_free(untrcert);
+    X509_free(trcert);
+    return testresult;
+}
+
+/* A batch must not mix library contexts */
+static int test_verify_batch_libctx(void)
+{
+    OSSL_LIB_CTX *other = OSSL_LIB_CTX_new();
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509_STORE_CTX *ctxs[2] = { NULL };
+    int results[2];
+    int testresult = 0;
+
+    if (!TEST_ptr(other)
+            || !TEST_ptr(eecert)
+            || !TEST_ptr(ctxs[0] = X509_STORE_CTX_new())
+            || !TEST_ptr(ctxs[1] = X509_STORE_CTX_new_ex(other, NULL))
+            || !TEST_true(X509_STORE_CTX_init(ctxs[0], NULL, eecert, NULL))
+            || !TEST_true(X509_STORE_CTX_init(ctxs[1], NULL, eecert, NULL))
+            || !TEST_false(X509_verify_cert_batch(ctxs, 2, results, 1)))
+        goto err;
+
+    testresult = 1;
+ err:
+    X509_STORE_CTX_free(ctxs[0]);
+    X509_STORE_CTX_free(ctxs[1]);
+    X509_free(eecert);
+    OSSL_LIB_CTX_free(other);
+    return testresult;
+}
+
 OPT_TEST_DECLARE_USAGE("certs-dir\n")
 
 int setup_tests(void)
@@ -322,6 +484,9 @@ int setup_tests(void)
     ADD_TEST(test_purpose_ssl_client);
     ADD_TEST(test_purpose_ssl_server);
     ADD_TEST(test_purpose_any);
+    ADD_ALL_TESTS(test_verify_batch, 3);
+    ADD_TEST(test_verify_batch_tampered);
+    ADD_TEST(test_verify_batch_libctx);
     return 1;
  err:
     cleanup_tests();
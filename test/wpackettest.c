@@ -18,6 +18,9 @@ static const unsigned char simple2[] = { 0x01, 0xff };
 static const unsigned char simple3[] = { 0x00, 0x00, 0x00, 0x01, 0xff };
 static const unsigned char nestedsub[] = { 0x03, 0xff, 0x01, 0xff };
 static const unsigned char seqsub[] = { 0x01, 0xff, 0x01, 0xff };
+static const unsigned char deepsub[] = {
+    0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0xff
+};
 static const unsigned char empty[] = { 0x00 };
 static const unsigned char alloc[] = { 0x02, 0xfe, 0xff };
 static const unsigned char submem[] = { 0x03, 0x02, 0xfe, 0xff };
@@ -190,6 +193,7 @@ static int test_WPACKET_start_sub_packet(void)
     WPACKET pkt;
     size_t written;
     size_t len;
+    size_t i;
 
     if (!TEST_true(WPACKET_init(&pkt, buf))
             || !TEST_true(WPACKET_start_sub_packet(&pkt))
@@ -263,6 +267,32 @@ static int test_WPACKET_start_sub_packet(void)
             || !TEST_true(WPACKET_finish(&pkt)))
         return cleanup(&pkt);
 
+    /* Sub-packets nested deeper than those kept in the WPACKET itself */
+    if (!TEST_size_t_gt(sizeof(deepsub) - 1, WPACKET_SUB_POOL)
+            || !TEST_true(WPACKET_init(&pkt, buf)))
+        return cleanup(&pkt);
+    for (i = 0; i < sizeof(deepsub) - 1; i++)
+        if (!TEST_true(WPACKET_start_sub_packet_u8(&pkt)))
+            return cleanup(&pkt);
+    if (!TEST_true(WPACKET_put_bytes_u8(&pkt, 0xff)))
+        return cleanup(&pkt);
+    for (i = 0; i < sizeof(deepsub) - 1; i++)
+        if (!TEST_true(WPACKET_close(&pkt)))
+            return cleanup(&pkt);
+    if (!TEST_false(WPACKET_close(&pkt))
+            || !TEST_true(WPACKET_finish(&pkt))
+            || !TEST_true(WPACKET_get_total_written(&pkt, &written))
+            || !TEST_mem_eq(buf->data, written, deepsub, sizeof(deepsub)))
+        return cleanup(&pkt);
+
+    /* Deeply nested sub-packets that are abandoned */
+    if (!TEST_true(WPACKET_init(&pkt, buf)))
+        return cleanup(&pkt);
+    for (i = 0; i < sizeof(deepsub) - 1; i++)
+        if (!TEST_true(WPACKET_start_sub_packet_u8(&pkt)))
+            return cleanup(&pkt);
+    WPACKET_cleanup(&pkt);
+
     return 1;
 }
 
@@ -13,6 +13,7 @@
 
 static const char *chain;
 static const char *crl;
+static const char *index_file;
 
 static int test_load_cert_file(void)
 {
@@ -49,7 +50,70 @@ err:
     return ret;
 }
 
-OPT_TEST_DECLARE_USAGE("cert.pem [crl.pem]\n")
+/* Look up each certificate of the chain in an index holding the chain */
+static int test_load_index(void)
+{
+    int ret = 0, i;
+    X509_STORE *store = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    X509_LOOKUP *lookup = NULL;
+    X509_OBJECT *obj = NULL;
+    X509_NAME *unknown = NULL;
+    STACK_OF(X509) *certs = NULL;
+
+    if (!TEST_ptr(certs = load_certs_pem(chain))
+        || !TEST_ptr(store = X509_STORE_new())
+        || !TEST_ptr(lookup = X509_STORE_add_lookup(store, X509_LOOKUP_index()))
+        || !TEST_int_eq(X509_LOOKUP_load_index(lookup, index_file), 1)
+        || !TEST_ptr(ctx = X509_STORE_CTX_new())
+        || !TEST_true(X509_STORE_CTX_init(ctx, store, NULL, NULL)))
+        goto err;
+
+    /* Nothing is loaded until a certificate is looked up */
+    if (!TEST_int_eq(sk_X509_OBJECT_num(X509_STORE_get0_objects(store)), 0))
+        goto err;
+
+    for (i = 0; i < sk_X509_num(certs); i++) {
+        X509 *x = sk_X509_value(certs, i);
+
+        if (!TEST_ptr(obj = X509_STORE_CTX_get_obj_by_subject(ctx, X509_LU_X509,
+                                                               X509_get_subject_name(x)))
+            || !TEST_int_eq(X509_cmp(X509_OBJECT_get0_X509(obj), x), 0))
+            goto err;
+        X509_OBJECT_free(obj);
+        obj = NULL;
+    }
+
+    if (!TEST_ptr(unknown = X509_NAME_new())
+        || !TEST_true(X509_NAME_add_entry_by_txt(unknown, "CN", MBSTRING_ASC,
+                                                 (unsigned char *)"unknown",
+                                                 -1, -1, 0))
+        || !TEST_ptr_null(X509_STORE_CTX_get_obj_by_subject(ctx, X509_LU_X509,
+                                                            unknown)))
+        goto err;
+
+    /* A PEM file is not an index */
+    ERR_set_mark();
+    if (!TEST_int_ne(X509_LOOKUP_load_index(lookup, chain), 1)
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                        X509_R_INVALID_INDEX_FILE)) {
+        ERR_clear_last_mark();
+        goto err;
+    }
+    ERR_pop_to_mark();
+
+    ret = 1;
+
+err:
+    X509_OBJECT_free(obj);
+    X509_NAME_free(unknown);
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    OSSL_STACK_OF_X509_free(certs);
+    return ret;
+}
+
+OPT_TEST_DECLARE_USAGE("cert.pem [crl.pem [index]]\n")
 
 int setup_tests(void)
 {
@@ -63,7 +127,10 @@ int setup_tests(void)
         return 0;
 
     crl = test_get_argument(1);
+    index_file = test_get_argument(2);
 
     ADD_TEST(test_load_cert_file);
+    if (index_file != NULL)
+        ADD_TEST(test_load_index);
     return 1;
 }
@@ -121,6 +121,39 @@ static int test_x509_crl_tbs_cache(void)
     return ret;
 }
 
+/*
+ * The public key of a parsed certificate is only decoded on first use. Check
+ * that it is decoded correctly when reached through each of the accessors.
+ */
+static int test_x509_lazy_pubkey(void)
+{
+    int ret = 0;
+    X509 *x = NULL, *dup = NULL;
+    X509_PUBKEY *xpk = NULL;
+    EVP_PKEY *pk;
+    const unsigned char *p = certdata;
+
+    if (!TEST_ptr(x = d2i_X509(NULL, &p, sizeof(certdata)))
+        || !TEST_ptr(dup = X509_dup(x))
+        || !TEST_ptr(xpk = X509_PUBKEY_dup(X509_get_X509_PUBKEY(x)))
+        || !TEST_ptr(pk = X509_PUBKEY_get0(xpk))
+        || !TEST_int_eq(EVP_PKEY_eq(pk, pubkey), 1)
+        || !TEST_ptr(pk = X509_get0_pubkey(x))
+        || !TEST_ptr_eq(X509_get0_pubkey(x), pk)
+        || !TEST_int_eq(EVP_PKEY_eq(pk, pubkey), 1)
+        || !TEST_int_eq(X509_PUBKEY_eq(X509_get_X509_PUBKEY(dup), xpk), 1)
+        || !TEST_int_eq(X509_verify(dup, pubkey), 1)
+        || !TEST_int_eq(X509_check_private_key(x, privkey), 1))
+        goto err;
+
+    ret = 1;
+ err:
+    X509_PUBKEY_free(xpk);
+    X509_free(dup);
+    X509_free(x);
+    return ret;
+}
+
 static int test_asn1_item_verify(void)
 {
     int ret = 0;
@@ -209,6 +242,7 @@ int setup_tests(void)
 
     ADD_TEST(test_x509_tbs_cache);
     ADD_TEST(test_x509_crl_tbs_cache);
+    ADD_TEST(test_x509_lazy_pubkey);
     ADD_TEST(test_asn1_item_verify);
     return 1;
 }
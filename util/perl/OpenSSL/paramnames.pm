@@ -403,6 +403,7 @@ my %params = (
 # Key generation parameters
     'PKEY_PARAM_RSA_BITS' =>             '*PKEY_PARAM_BITS',
     'PKEY_PARAM_RSA_PRIMES' =>           "primes",
+    'PKEY_PARAM_RSA_THREADS' =>          '*KDF_PARAM_THREADS',
     'PKEY_PARAM_RSA_DIGEST' =>           '*PKEY_PARAM_DIGEST',
     'PKEY_PARAM_RSA_DIGEST_PROPS' =>     '*PKEY_PARAM_PROPERTIES',
     'PKEY_PARAM_RSA_MASKGENFUNC' =>      '*PKEY_PARAM_MASKGENFUNC',
@@ -424,6 +425,7 @@ my %params = (
     'PKEY_PARAM_EC_POINT_CONVERSION_FORMAT' => "point-format",
     'PKEY_PARAM_EC_GROUP_CHECK_TYPE' =>        "group-check",
     'PKEY_PARAM_EC_INCLUDE_PUBLIC' =>          "include-public",
+    'PKEY_PARAM_EC_PRECOMPUTE_PUBLIC' =>       "precompute-public",
     'PKEY_PARAM_FIPS_SIGN_CHECK' =>            "sign-check",
     'PKEY_PARAM_FIPS_APPROVED_INDICATOR' => '*ALG_PARAM_FIPS_APPROVED_INDICATOR',
 
@@ -587,6 +589,8 @@ my %params = (
     'LIBSSL_RECORD_LAYER_PARAM_MAX_EARLY_DATA' => "max_early_data",
     'LIBSSL_RECORD_LAYER_PARAM_BLOCK_PADDING' =>  "block_padding",
     'LIBSSL_RECORD_LAYER_PARAM_HS_PADDING' =>     "hs_padding",
+    'LIBSSL_RECORD_LAYER_PARAM_COALESCE' =>       "coalesce_threshold",
+    'LIBSSL_RECORD_LAYER_PARAM_BUFFER_POOL' =>    "buffer_pool",
 );
 
 # Generate string based macros for public consumption